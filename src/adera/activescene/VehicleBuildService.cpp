@@ -0,0 +1,159 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "VehicleBuildService.h"
+
+#include <osp/core/Resources.h>
+
+namespace adera
+{
+
+VehicleBuildService::VehicleBuildService(std::size_t const workerCount, std::size_t const queueCapacity)
+{
+    m_workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        Worker &rWorker = *m_workers.emplace_back(std::make_unique<Worker>(queueCapacity));
+        rWorker.thread = std::thread{run_worker, std::cref(*this), std::ref(rWorker)};
+    }
+}
+
+VehicleBuildService::~VehicleBuildService()
+{
+    m_stop.store(true, std::memory_order_release);
+    for (std::unique_ptr<Worker> &rpWorker : m_workers)
+    {
+        rpWorker->wake.fetch_add(1, std::memory_order_release);
+        rpWorker->wake.notify_one();
+    }
+    for (std::unique_ptr<Worker> &rpWorker : m_workers)
+    {
+        rpWorker->thread.join();
+    }
+
+    // Unfinished jobs and unclaimed results are dropped with the queues. Results don't hold
+    // resource owners yet, so nothing else needs to be released.
+}
+
+void VehicleBuildService::set_prefab_index(PrefabIndex_t prefabIndex)
+{
+    LGRN_ASSERTMV(m_inFlight == 0, "Prefab index can't be changed while vehicles are being built", m_inFlight);
+    m_prefabIndex = std::move(prefabIndex);
+}
+
+bool VehicleBuildService::submit(VehicleBuildJob&& rJob)
+{
+    // Round-robin, skipping workers with full queues
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+    {
+        Worker &rWorker = *m_workers[m_nextSubmit];
+        m_nextSubmit = (m_nextSubmit + 1) % m_workers.size();
+
+        if (rWorker.jobs.try_push(std::move(rJob)))
+        {
+            ++ m_inFlight;
+            rWorker.wake.fetch_add(1, std::memory_order_release);
+            rWorker.wake.notify_one();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<VehicleBuildResult> VehicleBuildService::poll()
+{
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+    {
+        Worker &rWorker = *m_workers[m_nextPoll];
+        m_nextPoll = (m_nextPoll + 1) % m_workers.size();
+
+        std::optional<VehicleBuildResult> result = rWorker.results.try_pop();
+        if (result.has_value())
+        {
+            -- m_inFlight;
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+void VehicleBuildService::run_worker(VehicleBuildService const& service, Worker& rWorker)
+{
+    while ( ! service.m_stop.load(std::memory_order_acquire) )
+    {
+        // Read the wake counter before checking for jobs, so a job submitted in between
+        // changes the counter and wait() returns immediately
+        uint32_t const wake = rWorker.wake.load(std::memory_order_acquire);
+
+        std::optional<VehicleBuildJob> job = rWorker.jobs.try_pop();
+        if ( ! job.has_value() )
+        {
+            rWorker.wake.wait(wake, std::memory_order_acquire);
+            continue;
+        }
+
+        VehicleBuilder builder{&service.m_prefabIndex};
+        job->func(builder, job->description);
+
+        VehicleBuildResult result
+        {
+            .pData      = std::make_unique<VehicleData>(builder.finalize_release()),
+            .prefabRefs = builder.prefab_refs(),
+            .spawn      = job->spawn
+        };
+
+        // Results queue is only full if the main thread stopped polling; wait for it
+        while ( ! rWorker.results.try_push(std::move(result)) )
+        {
+            if (service.m_stop.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void create_prefab_owners(VehicleData& rData, osp::ArrayView<PrefabRef const> const prefabRefs, osp::Resources& rResources)
+{
+    for (PartId const part : rData.m_partIds.bitview().zeros())
+    {
+        if (std::size_t(part) >= prefabRefs.size())
+        {
+            continue;
+        }
+
+        PrefabRef const &ref = prefabRefs[part];
+        if (ref.m_importer == lgrn::id_null<osp::ResId>())
+        {
+            continue;
+        }
+
+        osp::PrefabPair &rPrefabPair = rData.m_partPrefabs[part];
+        rPrefabPair.m_prefabId = ref.m_prefabId;
+        rPrefabPair.m_importer = rResources.owner_create(osp::restypes::gc_importer, ref.m_importer);
+    }
+}
+
+} // namespace adera
@@ -0,0 +1,153 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "VehicleBuilder.h"
+
+#include <osp/activescene/vehicles.h>
+#include <osp/core/spsc_queue.h>
+
+#include <entt/core/any.hpp>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace adera
+{
+
+struct VehicleBuildJob
+{
+    /**
+     * @brief Adds parts, machines and welds to a VehicleBuilder. Runs on a worker thread.
+     */
+    using Func_t = void(*)(VehicleBuilder& rBuilder, entt::any const& description);
+
+    Func_t                                          func{nullptr};
+    entt::any                                       description;
+    osp::active::ACtxVehicleSpawn::TmpToInit        spawn;
+};
+
+struct VehicleBuildResult
+{
+    std::unique_ptr<VehicleData>                    pData;
+    std::vector<PrefabRef>                          prefabRefs;     ///< Parallel with VehicleData::m_partPrefabs
+    osp::active::ACtxVehicleSpawn::TmpToInit        spawn;
+};
+
+/**
+ * @brief Builds VehicleData on worker threads so spawning never waits on VehicleBuilder
+ *
+ * Each worker has its own pair of single-producer single-consumer queues: jobs in, finished
+ * vehicles out. submit() and poll() must be called from the same thread, which is the only
+ * thread allowed to touch Resources. Workers only read the PrefabIndex_t given to
+ * set_prefab_index, and prefab owners are created later with create_prefab_owners.
+ */
+class VehicleBuildService
+{
+public:
+
+    VehicleBuildService(std::size_t workerCount, std::size_t queueCapacity = 64);
+    ~VehicleBuildService();
+
+    VehicleBuildService(VehicleBuildService const& copy) = delete;
+    VehicleBuildService(VehicleBuildService&& move) = delete;
+
+    /**
+     * @brief Replace the index used to look up prefabs by name
+     *
+     * Workers read the index without synchronization, so this can only be called while no jobs
+     * are in flight.
+     */
+    void set_prefab_index(PrefabIndex_t prefabIndex);
+
+    /**
+     * @brief Queue a vehicle to be built
+     *
+     * @return false if every worker's queue is full, rJob is left untouched
+     */
+    bool submit(VehicleBuildJob&& rJob);
+
+    /**
+     * @brief Take a finished vehicle, if there is one
+     */
+    std::optional<VehicleBuildResult> poll();
+
+    /**
+     * @return Number of jobs submitted but not yet returned by poll()
+     */
+    std::size_t in_flight() const noexcept { return m_inFlight; }
+
+private:
+
+    struct Worker
+    {
+        Worker(std::size_t const queueCapacity)
+         : jobs     {queueCapacity}
+         , results  {queueCapacity}
+        { }
+
+        osp::SpscQueue<VehicleBuildJob>     jobs;
+        osp::SpscQueue<VehicleBuildResult>  results;
+
+        alignas(64) std::atomic<uint32_t>   wake{0};
+        std::thread                         thread;
+    };
+
+    static void run_worker(VehicleBuildService const& service, Worker& rWorker);
+
+    std::vector<std::unique_ptr<Worker>>    m_workers;
+    PrefabIndex_t                           m_prefabIndex;
+
+    std::size_t                             m_nextSubmit{0};
+    std::size_t                             m_nextPoll{0};
+    std::size_t                             m_inFlight{0};
+
+    alignas(64) std::atomic<bool>           m_stop{false};
+};
+
+/**
+ * @brief VehicleBuildService and the vehicles it built that are being spawned
+ */
+struct ACtxVehicleBuild
+{
+    std::unique_ptr<VehicleBuildService>        pService;
+
+    /// Built vehicles pointed to by ACtxVehicleSpawnVB::dataVB, freed once spawning is done
+    std::vector<std::unique_ptr<VehicleData>>   spawning;
+};
+
+/**
+ * @brief Create the resource owners skipped by a VehicleBuilder that was made with a PrefabIndex_t
+ *
+ * @param rData         [ref] Vehicle to add owners to
+ * @param prefabRefs    [in] Prefab of each part, from VehicleBuilder::prefab_refs
+ * @param rResources    [ref] Resources to create owners with
+ */
+void create_prefab_owners(VehicleData& rData, osp::ArrayView<PrefabRef const> prefabRefs, osp::Resources& rResources);
+
+} // namespace adera
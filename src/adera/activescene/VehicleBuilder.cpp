@@ -35,12 +35,12 @@ using osp::restypes::gc_importer;
 
 VehicleBuilder::~VehicleBuilder()
 {
-    // clear resource owners
-    for ([[maybe_unused]] auto && [_, value] : std::exchange(m_prefabs, {}))
+    if (m_pResources == nullptr || ! m_data.has_value())
     {
-        m_pResources->owner_destroy(gc_importer, std::move(value.m_importer));
+        return;
     }
 
+    // clear resource owners
     for ([[maybe_unused]] auto && rPrefabPair : std::exchange(m_data->m_partPrefabs, {}))
     {
         m_pResources->owner_destroy(gc_importer, std::move(rPrefabPair.m_importer));
@@ -49,15 +49,21 @@ VehicleBuilder::~VehicleBuilder()
 
 void VehicleBuilder::set_prefabs(std::initializer_list<SetPrefab> const& setPrefabs)
 {
-    auto const& endIt = std::end(m_prefabs);
+    auto const& endIt = std::end(*m_pPrefabIndex);
     for (SetPrefab const& set : setPrefabs)
     {
-        auto const& foundIt = m_prefabs.find(set.m_prefabName);
+        auto const& foundIt = m_pPrefabIndex->find(set.m_prefabName);
         if (foundIt != endIt)
         {
-            auto &rPrefabPair = m_data->m_partPrefabs[std::size_t(set.m_part)];
-            rPrefabPair.m_prefabId = foundIt->second.m_prefabId;
-            rPrefabPair.m_importer = m_pResources->owner_create(gc_importer, foundIt->second.m_importer);
+            PrefabRef const& ref = foundIt->second;
+            m_partPrefabRefs[std::size_t(set.m_part)] = ref;
+
+            if (m_pResources != nullptr)
+            {
+                auto &rPrefabPair = m_data->m_partPrefabs[std::size_t(set.m_part)];
+                rPrefabPair.m_prefabId = ref.m_prefabId;
+                rPrefabPair.m_importer = m_pResources->owner_create(gc_importer, ref.m_importer);
+            }
         }
         else
         {
@@ -85,17 +91,19 @@ WeldId VehicleBuilder::weld(osp::ArrayView<PartToWeld const> toWeld)
     return weld;
 }
 
-void VehicleBuilder::index_prefabs()
+PrefabIndex_t make_prefab_index(osp::Resources const& resources)
 {
-    for (unsigned int i = 0; i < m_pResources->ids(gc_importer).capacity(); ++i)
+    PrefabIndex_t out;
+
+    for (unsigned int i = 0; i < resources.ids(gc_importer).capacity(); ++i)
     {
         auto const resId = osp::ResId(i);
-        if ( ! m_pResources->ids(gc_importer).exists(resId))
+        if ( ! resources.ids(gc_importer).exists(resId))
         {
             continue;
         }
 
-        auto const *pPrefabData = m_pResources->data_try_get<osp::Prefabs>(gc_importer, resId);
+        auto const *pPrefabData = resources.data_try_get<osp::Prefabs const>(gc_importer, resId);
         if (pPrefabData == nullptr)
         {
             continue; // No prefab data
@@ -103,12 +111,11 @@ void VehicleBuilder::index_prefabs()
 
         for (osp::PrefabId j = 0; j < pPrefabData->m_prefabNames.size(); ++j)
         {
-            osp::ResIdOwner_t owner = m_pResources->owner_create(gc_importer, resId);
-
-            m_prefabs.emplace(pPrefabData->m_prefabNames[j],
-                              osp::PrefabPair{std::move(owner), j});
+            out.emplace(pPrefabData->m_prefabNames[j], PrefabRef{resId, j});
         }
     }
+
+    return out;
 }
 
 osp::link::MachAnyId VehicleBuilder::create_machine(PartId const part,
@@ -277,9 +284,113 @@ VehicleData VehicleBuilder::finalize_release()
         return count == 0;
     }));
 
+    rData.m_template = make_vehicle_template(rData);
+
     VehicleData dataOut{std::move(*m_data)};
     m_data.emplace();
     return dataOut;
 }
 
+VehicleTemplate make_vehicle_template(VehicleData const& data)
+{
+    using osp::link::MachAnyId;
+    using osp::link::MachinePair;
+    using osp::link::MachTypeId;
+    using osp::link::NodeId;
+    using osp::link::NodeTypeId;
+
+    VehicleTemplate out;
+
+    // Assign dense indices to existing IDs
+
+    std::vector<uint32_t> partDense(data.m_partIds.capacity(), lgrn::id_null<uint32_t>());
+    for (PartId const part : data.m_partIds.bitview().zeros())
+    {
+        partDense[part] = uint32_t(out.parts.size());
+        out.parts.push_back(part);
+    }
+
+    std::vector<uint32_t> machDense(data.m_machines.ids.capacity(), lgrn::id_null<uint32_t>());
+    out.machTypeCount.resize(data.m_machines.perType.size(), 0);
+    for (MachAnyId const mach : data.m_machines.ids.bitview().zeros())
+    {
+        MachTypeId const type = data.m_machines.machTypes[mach];
+
+        machDense[mach] = uint32_t(out.machs.size());
+        out.machs       .push_back(mach);
+        out.machTypes   .push_back(type);
+        out.machParts   .push_back(partDense[data.m_machToPart[mach]]);
+        ++ out.machTypeCount[type];
+    }
+
+    // Parts and Welds
+
+    out.weldPartOffsets.push_back(0);
+    for (WeldId const weld : data.m_weldIds.bitview().zeros())
+    {
+        out.welds.push_back(weld);
+        for (PartId const part : data.m_weldToParts[weld])
+        {
+            out.weldParts.push_back(partDense[part]);
+        }
+        out.weldPartOffsets.push_back(uint32_t(out.weldParts.size()));
+    }
+
+    out.partMachOffsets.push_back(0);
+    for (PartId const part : out.parts)
+    {
+        for (MachinePair const& pair : data.m_partToMachines[part])
+        {
+            MachAnyId const mach = data.m_machines.perType[pair.type].localToAny[pair.local];
+            out.partMachs.push_back(machDense[mach]);
+        }
+        out.partMachOffsets.push_back(uint32_t(out.partMachs.size()));
+    }
+
+    // Nodes
+
+    out.nodePerType.resize(data.m_nodePerType.size());
+    for (NodeTypeId nodeType = 0; std::size_t(nodeType) < data.m_nodePerType.size(); ++nodeType)
+    {
+        PerNodeType const               &src    = data.m_nodePerType[nodeType];
+        VehicleTemplate::NodeWiring     &rDst   = out.nodePerType[nodeType];
+
+        std::vector<uint32_t> nodeDense(src.nodeIds.capacity(), lgrn::id_null<uint32_t>());
+        for (NodeId const node : src.nodeIds.bitview().zeros())
+        {
+            nodeDense[node] = uint32_t(rDst.nodes.size());
+            rDst.nodes.push_back(node);
+        }
+
+        rDst.nodeJuncOffsets.push_back(0);
+        for (NodeId const node : rDst.nodes)
+        {
+            for (Junction const& junc : src.nodeToMach[node])
+            {
+                MachAnyId const mach = data.m_machines.perType[junc.type].localToAny[junc.local];
+                rDst.nodeJuncMach   .push_back(machDense[mach]);
+                rDst.nodeJuncCustom .push_back(junc.custom);
+            }
+            rDst.nodeJuncOffsets.push_back(uint32_t(rDst.nodeJuncMach.size()));
+        }
+
+        rDst.machPortOffsets.push_back(0);
+        for (MachAnyId const mach : out.machs)
+        {
+            if (src.machToNode.contains(mach))
+            {
+                for (NodeId const node : src.machToNode[mach])
+                {
+                    rDst.machPortNode.push_back( (node != lgrn::id_null<NodeId>())
+                                                 ? nodeDense[node]
+                                                 : lgrn::id_null<uint32_t>() );
+                }
+            }
+            rDst.machPortOffsets.push_back(uint32_t(rDst.machPortNode.size()));
+        }
+    }
+
+    return out;
+}
+
 } // namespace testapp
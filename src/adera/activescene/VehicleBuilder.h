@@ -65,6 +65,48 @@ struct PerNodeType : osp::link::Nodes
     int                     m_connectCountTotal{0};
 };
 
+/**
+ * @brief A VehicleData's IDs and connections, renumbered to be dense
+ *
+ * The n-th existing PartId is dense part n, and the same for Welds, Machines and Nodes of each
+ * type. A spawned copy only needs a list of its newly created IDs to resolve every connection,
+ * without iterating registries or going through IntArrayMultiMaps.
+ *
+ * Built once with make_vehicle_template, and shared by every vehicle spawned from the same
+ * VehicleData.
+ */
+struct VehicleTemplate
+{
+    struct NodeWiring
+    {
+        std::vector<osp::link::NodeId>      nodes;          ///< [dense node] -> NodeId in VehicleData
+
+        /// nodeJuncMach[nodeJuncOffsets[node] .. nodeJuncOffsets[node + 1]] -> dense machine
+        std::vector<uint32_t>               nodeJuncOffsets;
+        std::vector<uint32_t>               nodeJuncMach;
+        std::vector<osp::link::JuncCustom>  nodeJuncCustom; ///< Parallel with nodeJuncMach
+
+        /// machPortNode[machPortOffsets[mach] .. machPortOffsets[mach + 1]] -> dense node or null
+        std::vector<uint32_t>               machPortOffsets;
+        std::vector<uint32_t>               machPortNode;
+    };
+
+    std::vector<PartId>                     parts;          ///< [dense part] -> PartId in VehicleData
+    std::vector<uint32_t>                   partMachOffsets;
+    std::vector<uint32_t>                   partMachs;      ///< [partMachOffsets[part] ..] -> dense machine
+
+    std::vector<WeldId>                     welds;          ///< [dense weld] -> WeldId in VehicleData
+    std::vector<uint32_t>                   weldPartOffsets;
+    std::vector<uint32_t>                   weldParts;      ///< [weldPartOffsets[weld] ..] -> dense part
+
+    std::vector<osp::link::MachAnyId>       machs;          ///< [dense machine] -> MachAnyId in VehicleData
+    std::vector<osp::link::MachTypeId>      machTypes;      ///< [dense machine]
+    std::vector<uint32_t>                   machParts;      ///< [dense machine] -> dense part
+    std::vector<std::size_t>                machTypeCount;  ///< [MachTypeId] -> number of machines
+
+    std::vector<NodeWiring>                 nodePerType;
+};
+
 struct VehicleData
 {
     using MachToNodeCustom_t = lgrn::IntArrayMultiMap<osp::link::MachAnyId,
@@ -87,10 +129,41 @@ struct VehicleData
     std::vector<PartId>                     m_machToPart;
 
     std::vector<PerNodeType>                m_nodePerType;
+
+    VehicleTemplate                         m_template;
+};
+
+/**
+ * @brief Build the VehicleTemplate used to spawn copies of a VehicleData
+ *
+ * Must be called again if the VehicleData is modified.
+ */
+VehicleTemplate make_vehicle_template(VehicleData const& data);
+
+struct PrefabRef
+{
+    osp::ResId      m_importer{lgrn::id_null<osp::ResId>()};
+    osp::PrefabId   m_prefabId{0};
 };
 
+/**
+ * @brief Prefab name -> Importer and Prefab, without holding resource owners
+ *
+ * Names point into importer data, so these importers must stay loaded while the index is used.
+ */
+using PrefabIndex_t = entt::dense_map< std::string_view, PrefabRef >;
+
+/**
+ * @brief Index all prefabs of all loaded importers
+ */
+PrefabIndex_t make_prefab_index(osp::Resources const& resources);
+
 /**
  * Used to easily create VehicleData
+ *
+ * If constructed with a PrefabIndex_t instead of Resources, the builder never touches Resources,
+ * and can be used on any thread. Prefab owners are not created in this case; use
+ * prefab_refs() to create them later.
  */
 class VehicleBuilder
 {
@@ -111,14 +184,24 @@ public:
     using WeldVec_t = std::vector<VehicleBuilder::PartToWeld>;
 
     VehicleBuilder(osp::Resources *pResources)
-     : m_pResources{pResources}
+     : m_pResources     {pResources}
+     , m_ownPrefabIndex {make_prefab_index(*pResources)}
+     , m_pPrefabIndex   {&m_ownPrefabIndex}
     {
-        auto &rData = m_data.emplace();
-        rData.m_machines.perType.resize(osp::link::MachTypeReg_t::size());
-        rData.m_nodePerType.resize(osp::link::NodeTypeReg_t::size());
-        index_prefabs();
+        init_data();
     };
 
+    VehicleBuilder(PrefabIndex_t const *pPrefabIndex)
+     : m_pResources     {nullptr}
+     , m_pPrefabIndex   {pPrefabIndex}
+    {
+        init_data();
+    };
+
+    // m_pPrefabIndex may point to m_ownPrefabIndex
+    VehicleBuilder(VehicleBuilder const& copy) = delete;
+    VehicleBuilder(VehicleBuilder&& move) = delete;
+
     ~VehicleBuilder();
 
     template <std::size_t N>
@@ -166,13 +249,28 @@ public:
 
     [[nodiscard]] VehicleData finalize_release();
 
+    /**
+     * @brief Prefab of each part set by set_prefabs, parallel with VehicleData::m_partPrefabs
+     */
+    [[nodiscard]] std::vector<PrefabRef> const& prefab_refs() const noexcept
+    {
+        return m_partPrefabRefs;
+    }
+
 private:
 
-    void index_prefabs();
+    void init_data()
+    {
+        auto &rData = m_data.emplace();
+        rData.m_machines.perType.resize(osp::link::MachTypeReg_t::size());
+        rData.m_nodePerType.resize(osp::link::NodeTypeReg_t::size());
+    }
 
     osp::Resources *m_pResources;
 
-    entt::dense_map< std::string_view, osp::PrefabPair > m_prefabs;
+    PrefabIndex_t           m_ownPrefabIndex;
+    PrefabIndex_t const*    m_pPrefabIndex;
+    std::vector<PrefabRef>  m_partPrefabRefs;
 
     std::vector<uint16_t> m_partMachCount;
     std::optional<VehicleData> m_data;
@@ -190,6 +288,7 @@ std::array<PartId, N> VehicleBuilder::create_parts()
     std::size_t const capacity = m_data->m_partIds.capacity();
     m_partMachCount                 .resize(capacity);
     m_data->m_partPrefabs           .resize(capacity);
+    m_partPrefabRefs                .resize(capacity);
     m_data->m_partTransformWeld     .resize(capacity);
     m_data->m_partToWeld            .resize(capacity);
     m_data->m_weldToParts     .data_reserve(capacity);
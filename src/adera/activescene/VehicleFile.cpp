@@ -0,0 +1,700 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "VehicleFile.h"
+
+#include <osp/core/Resources.h>
+#include <osp/link/signal.h>
+#include <osp/util/logging.h>
+#include <osp/vehicles/ImporterData.h>
+
+#include <Corrade/Containers/Optional.h>
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace osp;
+using namespace osp::link;
+
+using osp::restypes::gc_importer;
+
+namespace adera
+{
+
+namespace
+{
+
+constexpr uint32_t node_section_count(std::size_t const nodeTypeCount) noexcept
+{
+    return uint32_t(EVehicleSection::Count) + uint32_t(nodeTypeCount) * uint32_t(ENodeSection::Count);
+}
+
+template <typename ID_T>
+std::vector<uint64_t> registry_bits(lgrn::IdRegistryStl<ID_T> const& ids)
+{
+    std::size_t const capacity = ids.capacity();
+    std::vector<uint64_t> out(1 + (capacity + 63) / 64, 0);
+    out[0] = capacity;
+    for (std::size_t const id : ids.bitview().zeros())
+    {
+        out[1 + id / 64] |= uint64_t(1) << (id % 64);
+    }
+    return out;
+}
+
+template <typename ID_T, typename DATA_T>
+void add_multimap(
+        SectionWriter&                                  rWriter,
+        uint32_t const                                  offsetSection,
+        uint32_t const                                  dataSection,
+        lgrn::IdRegistryStl<ID_T> const&                ids,
+        lgrn::IntArrayMultiMap<ID_T, DATA_T> const&     map)
+{
+    std::vector<uint32_t>   offsets(ids.capacity() + 1, 0);
+    std::vector<DATA_T>     data;
+
+    for (std::size_t id = 0; id < ids.capacity(); ++id)
+    {
+        if (ids.exists(ID_T(id)))
+        {
+            auto const span = map[ID_T(id)];
+            data.insert(data.end(), span.begin(), span.end());
+        }
+        offsets[id + 1] = uint32_t(data.size());
+    }
+
+    rWriter.add(offsetSection, offsets);
+    rWriter.add(dataSection,   data);
+}
+
+template <typename ID_T>
+void load_registry(lgrn::IdRegistryStl<ID_T>& rIds, ArrayView<uint64_t const> const bits)
+{
+    std::size_t const capacity = bits.isEmpty() ? 0 : std::size_t(bits[0]);
+
+    // A new registry creates IDs in order, so create all of them then remove the gaps
+    std::vector<ID_T> created(capacity);
+    rIds.create(created.begin(), created.end());
+
+    for (std::size_t id = 0; id < capacity; ++id)
+    {
+        if ( ((bits[1 + id / 64] >> (id % 64)) & 1) == 0 )
+        {
+            rIds.remove(ID_T(id));
+        }
+    }
+}
+
+template <typename T>
+void load_vector(std::vector<T>& rVec, std::size_t const capacity, ArrayView<T const> const values, T const& fill)
+{
+    rVec.resize(std::max(capacity, values.size()), fill);
+    std::copy(values.begin(), values.end(), rVec.begin());
+}
+
+template <typename ID_T, typename DATA_T>
+void load_multimap(
+        lgrn::IntArrayMultiMap<ID_T, DATA_T>&   rMap,
+        lgrn::IdRegistryStl<ID_T> const&        ids,
+        ArrayView<uint32_t const> const         offsets,
+        ArrayView<DATA_T const> const           data)
+{
+    rMap.ids_reserve(ids.capacity());
+    rMap.data_reserve(data.size());
+
+    for (std::size_t const id : ids.bitview().zeros())
+    {
+        bool const        inFile    = id + 1 < offsets.size()
+                                     && offsets[id] <= offsets[id + 1]
+                                     && offsets[id + 1] <= data.size();
+        std::size_t const first     = inFile ? offsets[id]     : 0;
+        std::size_t const last      = inFile ? offsets[id + 1] : 0;
+
+        DATA_T *pOut = rMap.emplace(ID_T(id), last - first);
+        std::copy(data.begin() + first, data.begin() + last, pOut);
+    }
+}
+
+template <typename VALUE_T, typename STORED_T = VALUE_T>
+void load_node_values(PerNodeType& rPerNodeType, ArrayView<STORED_T const> const stored)
+{
+    rPerNodeType.m_nodeValues.emplace< SignalValues_t<VALUE_T> >();
+    auto &rValues = entt::any_cast< SignalValues_t<VALUE_T>& >(rPerNodeType.m_nodeValues);
+    rValues.resize(std::max<std::size_t>(rPerNodeType.nodeIds.capacity(), stored.size()));
+    std::copy(stored.begin(), stored.end(), rValues.begin());
+}
+
+/**
+ * @return true if bits is a registry written by registry_bits, with a bitset matching its capacity
+ */
+bool registry_valid(ArrayView<uint64_t const> const bits) noexcept
+{
+    return    ! bits.isEmpty()
+           && bits[0] <= (bits.size() - 1) * 64
+           && (bits[0] + 63) / 64 == bits.size() - 1;
+}
+
+bool registry_has(ArrayView<uint64_t const> const bits, std::size_t const id) noexcept
+{
+    return id < bits[0] && ((bits[1 + id / 64] >> (id % 64)) & 1) != 0;
+}
+
+/**
+ * @brief Check every ID and offset in a vehicle file against the registries and arrays it
+ *        indexes, so SysVehicleFile::load can use them without further checks
+ *
+ * IDs referenced by existing Parts, Welds, Machines, and Nodes must exist. Entries of IDs that
+ * don't exist are loaded as-is and are only required to be null or within capacity.
+ */
+bool contents_valid(VehicleFileView const& file)
+{
+    auto const sec = [] (EVehicleSection const section) { return vehicle_file_section(section); };
+
+    VehicleFileHeader const& header = file.header();
+
+    auto const partBits = file.section<uint64_t>(sec(EVehicleSection::PartIds));
+    auto const weldBits = file.section<uint64_t>(sec(EVehicleSection::WeldIds));
+    auto const machBits = file.section<uint64_t>(sec(EVehicleSection::MachIds));
+
+    if ( ! (registry_valid(partBits) && registry_valid(weldBits) && registry_valid(machBits)) )
+    {
+        return false;
+    }
+
+    std::size_t const partCapacity  = partBits[0];
+    std::size_t const weldCapacity  = weldBits[0];
+    std::size_t const machCapacity  = machBits[0];
+
+    auto const null_or_below = [] (auto const id, std::size_t const capacity)
+    {
+        return id == lgrn::id_null< std::remove_cv_t<decltype(id)> >() || std::size_t(id) < capacity;
+    };
+
+    // Machine local IDs, needed to check MachinePairs and Junctions
+
+    auto const localToAnyOffsets    = file.section<uint32_t> (sec(EVehicleSection::LocalToAnyOffsets));
+    auto const localToAny           = file.section<MachAnyId>(sec(EVehicleSection::LocalToAny));
+
+    if ( ! csr_valid(localToAnyOffsets, header.machTypeCount, localToAny.size()) )
+    {
+        return false;
+    }
+
+    for (MachAnyId const mach : localToAny)
+    {
+        if ( ! (mach == lgrn::id_null<MachAnyId>() || registry_has(machBits, mach)) )
+        {
+            return false;
+        }
+    }
+
+    auto const local_to_any = [&] (MachTypeId const type, MachLocalId const local) -> MachAnyId
+    {
+        if (   type >= header.machTypeCount
+            || local >= localToAnyOffsets[type + 1] - localToAnyOffsets[type])
+        {
+            return lgrn::id_null<MachAnyId>();
+        }
+        return localToAny[localToAnyOffsets[type] + local];
+    };
+
+    // Machines
+
+    auto const machTypes    = file.section<MachTypeId> (sec(EVehicleSection::MachTypes));
+    auto const machToLocal  = file.section<MachLocalId>(sec(EVehicleSection::MachToLocal));
+    auto const machToPart   = file.section<PartId>     (sec(EVehicleSection::MachToPart));
+
+    for (std::size_t mach = 0; mach < machCapacity; ++mach)
+    {
+        if (registry_has(machBits, mach))
+        {
+            if (   mach >= machTypes.size() || mach >= machToLocal.size() || mach >= machToPart.size()
+                || local_to_any(machTypes[mach], machToLocal[mach]) != mach
+                || ! registry_has(partBits, machToPart[mach]) )
+            {
+                return false;
+            }
+        }
+        else if (   (mach < machTypes.size()  && ! null_or_below(machTypes[mach],  header.machTypeCount))
+                 || (mach < machToPart.size() && ! null_or_below(machToPart[mach], partCapacity)) )
+        {
+            return false;
+        }
+    }
+
+    // Parts and Welds
+
+    auto const partToWeld           = file.section<WeldId>     (sec(EVehicleSection::PartToWeld));
+    auto const partToMachOffsets    = file.section<uint32_t>   (sec(EVehicleSection::PartToMachOffsets));
+    auto const partToMach           = file.section<MachinePair>(sec(EVehicleSection::PartToMach));
+    auto const weldToPartOffsets    = file.section<uint32_t>   (sec(EVehicleSection::WeldToPartOffsets));
+    auto const weldToPart           = file.section<PartId>     (sec(EVehicleSection::WeldToPart));
+    auto const partPrefab           = file.section<uint32_t>   (sec(EVehicleSection::PartPrefab));
+    auto const nameOffsets          = file.section<uint32_t>   (sec(EVehicleSection::PrefabNameOffsets));
+    auto const nameChars            = file.section<char>       (sec(EVehicleSection::PrefabNameChars));
+
+    if (   nameOffsets.isEmpty()
+        || ! csr_valid(nameOffsets,       nameOffsets.size() - 1, nameChars.size())
+        || ! csr_valid(partToMachOffsets, partCapacity,           partToMach.size())
+        || ! csr_valid(weldToPartOffsets, weldCapacity,           weldToPart.size()))
+    {
+        return false;
+    }
+
+    for (std::size_t part = 0; part < partCapacity; ++part)
+    {
+        bool const exists = registry_has(partBits, part);
+
+        if (part < partToWeld.size() && ! ( exists ? (partToWeld[part] == lgrn::id_null<WeldId>()
+                                                      || registry_has(weldBits, partToWeld[part]))
+                                                   : null_or_below(partToWeld[part], weldCapacity) ))
+        {
+            return false;
+        }
+        if (part < partPrefab.size() && ! null_or_below(partPrefab[part], nameOffsets.size() - 1))
+        {
+            return false;
+        }
+    }
+
+    for (MachinePair const& pair : partToMach)
+    {
+        if (local_to_any(pair.type, pair.local) == lgrn::id_null<MachAnyId>())
+        {
+            return false;
+        }
+    }
+
+    for (PartId const part : weldToPart)
+    {
+        if ( ! registry_has(partBits, part) )
+        {
+            return false;
+        }
+    }
+
+    // Nodes
+
+    for (NodeTypeId nodeType = 0; nodeType < header.nodeTypeCount; ++nodeType)
+    {
+        auto const nsec = [nodeType] (ENodeSection const section) { return vehicle_file_section(nodeType, section); };
+
+        auto const nodeBits             = file.section<uint64_t>  (nsec(ENodeSection::NodeIds));
+        auto const nodeToMachOffsets    = file.section<uint32_t>  (nsec(ENodeSection::NodeToMachOffsets));
+        auto const nodeToMach           = file.section<Junction>  (nsec(ENodeSection::NodeToMach));
+        auto const machToNodeOffsets    = file.section<uint32_t>  (nsec(ENodeSection::MachToNodeOffsets));
+        auto const machToNode           = file.section<NodeId>    (nsec(ENodeSection::MachToNode));
+        auto const machToNodeCustom     = file.section<JuncCustom>(nsec(ENodeSection::MachToNodeCustom));
+        auto const valueType            = file.section<uint32_t>  (nsec(ENodeSection::NodeValueType));
+
+        if (   ! registry_valid(nodeBits)
+            || ! csr_valid(nodeToMachOffsets, nodeBits[0],  nodeToMach.size())
+            || ! csr_valid(machToNodeOffsets, machCapacity, machToNode.size())
+            || machToNodeCustom.size() != machToNode.size()
+            || valueType.size() != 1
+            || valueType[0] > uint32_t(EVehicleNodeValues::Bool))
+        {
+            return false;
+        }
+
+        for (Junction const& junc : nodeToMach)
+        {
+            if (local_to_any(junc.type, junc.local) == lgrn::id_null<MachAnyId>())
+            {
+                return false;
+            }
+        }
+
+        for (NodeId const node : machToNode)
+        {
+            if ( ! (node == lgrn::id_null<NodeId>() || registry_has(nodeBits, node)) )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+std::optional<VehicleFileView> VehicleFileView::map(std::string const& path)
+{
+    Corrade::Containers::Optional<MappedFile_t> mapped = Corrade::Utility::Path::mapRead(path);
+    if ( ! mapped)
+    {
+        OSP_LOG_WARN("Failed to map vehicle file: {}", path);
+        return std::nullopt;
+    }
+
+    std::size_t const fileSize = mapped->size();
+    if (fileSize < sizeof(VehicleFileHeader))
+    {
+        OSP_LOG_WARN("Vehicle file too small: {}", path);
+        return std::nullopt;
+    }
+
+    VehicleFileHeader header;
+    std::memcpy(&header, mapped->data(), sizeof(VehicleFileHeader));
+
+    if (   header.magic     != gc_vfMagic
+        || header.version   != gc_vfVersion
+        || header.byteOrder != gc_vfByteOrder)
+    {
+        OSP_LOG_WARN("Not a compatible vehicle file: {}", path);
+        return std::nullopt;
+    }
+
+    if (   header.machTypeCount > MachTypeReg_t::size()
+        || header.nodeTypeCount > NodeTypeReg_t::size()
+        || header.sectionCount  != node_section_count(header.nodeTypeCount))
+    {
+        OSP_LOG_WARN("Vehicle file has an unknown Machine or Node type: {}", path);
+        return std::nullopt;
+    }
+
+    if ( ! file_sections_valid(*mapped, sizeof(VehicleFileHeader), header.sectionCount) )
+    {
+        OSP_LOG_WARN("Vehicle file has a bad section table, or a section out of bounds: {}", path);
+        return std::nullopt;
+    }
+
+    VehicleFileView view{std::move(*mapped)};
+    if ( ! contents_valid(view) )
+    {
+        OSP_LOG_WARN("Vehicle file has an ID or offset out of range: {}", path);
+        return std::nullopt;
+    }
+
+    return view;
+}
+
+bool SysVehicleFile::write(VehicleData const& vehicle, Resources const& rResources, std::string const& path)
+{
+    auto const sec = [] (EVehicleSection const section) { return vehicle_file_section(section); };
+
+    std::size_t const nodeTypeCount = vehicle.m_nodePerType.size();
+    std::size_t const machTypeCount = vehicle.m_machines.perType.size();
+
+    SectionWriter writer{node_section_count(nodeTypeCount)};
+
+    // Parts
+
+    std::vector<uint32_t>                           partPrefab(vehicle.m_partPrefabs.size(), lgrn::id_null<uint32_t>());
+    std::vector<uint32_t>                           prefabNameOffsets{0};
+    std::vector<char>                               prefabNameChars;
+    std::unordered_map<std::string_view, uint32_t>  prefabNameIndex;
+
+    for (std::size_t const part : vehicle.m_partIds.bitview().zeros())
+    {
+        PrefabPair const& prefab = vehicle.m_partPrefabs[part];
+        if ( ! prefab.m_importer.has_value())
+        {
+            continue;
+        }
+
+        auto const &prefabs = rResources.data_get<Prefabs const>(gc_importer, prefab.m_importer.value());
+        std::string_view const name = prefabs.m_prefabNames[prefab.m_prefabId];
+
+        auto const [it, inserted] = prefabNameIndex.emplace(name, uint32_t(prefabNameIndex.size()));
+        if (inserted)
+        {
+            prefabNameChars.insert(prefabNameChars.end(), name.begin(), name.end());
+            prefabNameOffsets.push_back(uint32_t(prefabNameChars.size()));
+        }
+        partPrefab[part] = it->second;
+    }
+
+    writer.add(sec(EVehicleSection::PartIds),           registry_bits(vehicle.m_partIds));
+    writer.add(sec(EVehicleSection::PartTransformWeld), vehicle.m_partTransformWeld);
+    writer.add(sec(EVehicleSection::PartPrefab),        partPrefab);
+    writer.add(sec(EVehicleSection::PartToWeld),        vehicle.m_partToWeld);
+    add_multimap(writer, sec(EVehicleSection::PartToMachOffsets), sec(EVehicleSection::PartToMach),
+                 vehicle.m_partIds, vehicle.m_partToMachines);
+
+    writer.add(sec(EVehicleSection::PrefabNameOffsets), prefabNameOffsets);
+    writer.add(sec(EVehicleSection::PrefabNameChars),   prefabNameChars);
+
+    // Welds
+
+    writer.add(sec(EVehicleSection::WeldIds),           registry_bits(vehicle.m_weldIds));
+    add_multimap(writer, sec(EVehicleSection::WeldToPartOffsets), sec(EVehicleSection::WeldToPart),
+                 vehicle.m_weldIds, vehicle.m_weldToParts);
+
+    // Machines
+
+    Machines const &machines = vehicle.m_machines;
+
+    std::vector<uint32_t>   localToAnyOffsets{0};
+    std::vector<MachAnyId>  localToAny;
+    for (PerMachType const& perType : machines.perType)
+    {
+        std::size_t const first = localToAny.size();
+        localToAny.resize(first + perType.localIds.capacity(), lgrn::id_null<MachAnyId>());
+        for (std::size_t const local : perType.localIds.bitview().zeros())
+        {
+            localToAny[first + local] = perType.localToAny[local];
+        }
+        localToAnyOffsets.push_back(uint32_t(localToAny.size()));
+    }
+
+    writer.add(sec(EVehicleSection::MachIds),           registry_bits(machines.ids));
+    writer.add(sec(EVehicleSection::MachTypes),         machines.machTypes);
+    writer.add(sec(EVehicleSection::MachToLocal),       machines.machToLocal);
+    writer.add(sec(EVehicleSection::MachToPart),        vehicle.m_machToPart);
+    writer.add(sec(EVehicleSection::LocalToAnyOffsets), localToAnyOffsets);
+    writer.add(sec(EVehicleSection::LocalToAny),        localToAny);
+
+    // Nodes
+
+    for (NodeTypeId nodeType = 0; std::size_t(nodeType) < nodeTypeCount; ++nodeType)
+    {
+        PerNodeType const &perNodeType = vehicle.m_nodePerType[nodeType];
+        auto const nsec = [nodeType] (ENodeSection const section) { return vehicle_file_section(nodeType, section); };
+
+        writer.add(nsec(ENodeSection::NodeIds), registry_bits(perNodeType.nodeIds));
+        add_multimap(writer, nsec(ENodeSection::NodeToMachOffsets), nsec(ENodeSection::NodeToMach),
+                     perNodeType.nodeIds, perNodeType.nodeToMach);
+        add_multimap(writer, nsec(ENodeSection::MachToNodeOffsets), nsec(ENodeSection::MachToNode),
+                     machines.ids, perNodeType.machToNode);
+
+        // Offsets are shared with MachToNode
+        std::vector<JuncCustom> custom;
+        for (std::size_t mach = 0; mach < machines.ids.capacity(); ++mach)
+        {
+            if (machines.ids.exists(MachAnyId(mach)))
+            {
+                auto const span = perNodeType.m_machToNodeCustom[MachAnyId(mach)];
+                custom.insert(custom.end(), span.begin(), span.end());
+            }
+        }
+        writer.add(nsec(ENodeSection::MachToNodeCustom), custom);
+
+        std::vector<int32_t> const connectCount(perNodeType.m_nodeConnectCount.begin(),
+                                                perNodeType.m_nodeConnectCount.end());
+        writer.add(nsec(ENodeSection::NodeConnectCount), connectCount);
+
+        EVehicleNodeValues valueType = EVehicleNodeValues::None;
+        if (auto const *pFloat = entt::any_cast< SignalValues_t<float> >(&perNodeType.m_nodeValues))
+        {
+            valueType = EVehicleNodeValues::Float;
+            writer.add(nsec(ENodeSection::NodeValues), *pFloat);
+        }
+        else if (auto const *pInt = entt::any_cast< SignalValues_t<int32_t> >(&perNodeType.m_nodeValues))
+        {
+            valueType = EVehicleNodeValues::Int32;
+            writer.add(nsec(ENodeSection::NodeValues), *pInt);
+        }
+        else if (auto const *pBool = entt::any_cast< SignalValues_t<bool> >(&perNodeType.m_nodeValues))
+        {
+            valueType = EVehicleNodeValues::Bool;
+            writer.add(nsec(ENodeSection::NodeValues), std::vector<uint8_t>(pBool->begin(), pBool->end()));
+        }
+        else if (bool(perNodeType.m_nodeValues))
+        {
+            OSP_LOG_WARN("Node type {} has values of an unsupported type, they will not be saved", nodeType);
+        }
+
+        std::array<uint32_t, 1> const valueTypeSec{uint32_t(valueType)};
+        writer.add(nsec(ENodeSection::NodeValueType), arrayView(valueTypeSec));
+    }
+
+    VehicleFileHeader const header
+    {
+        .magic          = gc_vfMagic,
+        .version        = gc_vfVersion,
+        .byteOrder      = gc_vfByteOrder,
+        .machTypeCount  = uint32_t(machTypeCount),
+        .nodeTypeCount  = uint32_t(nodeTypeCount),
+        .sectionCount   = node_section_count(nodeTypeCount),
+        .reserved       = 0
+    };
+
+    return writer.write_file(header, path);
+}
+
+VehicleData SysVehicleFile::load(VehicleFileView const& file, Resources& rResources)
+{
+    auto const sec = [] (EVehicleSection const section) { return vehicle_file_section(section); };
+
+    VehicleFileHeader const& header = file.header();
+
+    VehicleData out;
+    out.m_machines.perType.resize(MachTypeReg_t::size());
+    out.m_nodePerType.resize(NodeTypeReg_t::size());
+
+    // Registries first, as they determine the size of everything else
+
+    load_registry(out.m_partIds,        file.section<uint64_t>(sec(EVehicleSection::PartIds)));
+    load_registry(out.m_weldIds,        file.section<uint64_t>(sec(EVehicleSection::WeldIds)));
+    load_registry(out.m_machines.ids,   file.section<uint64_t>(sec(EVehicleSection::MachIds)));
+
+    std::size_t const partCapacity = out.m_partIds.capacity();
+    std::size_t const machCapacity = out.m_machines.ids.capacity();
+
+    // Parts
+
+    load_vector(out.m_partTransformWeld, partCapacity,
+                file.section<Matrix4>(sec(EVehicleSection::PartTransformWeld)), Matrix4{});
+    load_vector(out.m_partToWeld, partCapacity,
+                file.section<WeldId>(sec(EVehicleSection::PartToWeld)), lgrn::id_null<WeldId>());
+    load_multimap(out.m_partToMachines, out.m_partIds,
+                  file.section<uint32_t>   (sec(EVehicleSection::PartToMachOffsets)),
+                  file.section<MachinePair>(sec(EVehicleSection::PartToMach)));
+
+    // Prefabs are matched by name against all loaded importers
+
+    auto const nameOffsets  = file.section<uint32_t>(sec(EVehicleSection::PrefabNameOffsets));
+    auto const nameChars    = file.section<char>    (sec(EVehicleSection::PrefabNameChars));
+    auto const partPrefab   = file.section<uint32_t>(sec(EVehicleSection::PartPrefab));
+
+    PrefabIndex_t const prefabIndex = make_prefab_index(rResources);
+
+    std::vector<PrefabRef> foundPrefabs;
+    for (std::size_t i = 0; i + 1 < nameOffsets.size(); ++i)
+    {
+        if (nameOffsets[i] > nameOffsets[i + 1] || nameOffsets[i + 1] > nameChars.size())
+        {
+            break;
+        }
+
+        auto const name     = std::string_view{nameChars.data() + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]};
+        auto const foundIt  = prefabIndex.find(name);
+        if (foundIt != prefabIndex.end())
+        {
+            foundPrefabs.push_back(foundIt->second);
+        }
+        else
+        {
+            OSP_LOG_WARN("Prefab {} not found!", name);
+            foundPrefabs.push_back({});
+        }
+    }
+
+    out.m_partPrefabs.resize(partCapacity);
+    for (std::size_t const part : out.m_partIds.bitview().zeros())
+    {
+        uint32_t const nameIndex = part < partPrefab.size() ? partPrefab[part] : lgrn::id_null<uint32_t>();
+        if (nameIndex >= foundPrefabs.size() || foundPrefabs[nameIndex].m_importer == lgrn::id_null<ResId>())
+        {
+            continue;
+        }
+
+        PrefabRef const &found = foundPrefabs[nameIndex];
+        out.m_partPrefabs[part] = { rResources.owner_create(gc_importer, found.m_importer), found.m_prefabId };
+    }
+
+    // Welds
+
+    load_multimap(out.m_weldToParts, out.m_weldIds,
+                  file.section<uint32_t>(sec(EVehicleSection::WeldToPartOffsets)),
+                  file.section<PartId>  (sec(EVehicleSection::WeldToPart)));
+
+    // Machines
+
+    load_vector(out.m_machines.machTypes, machCapacity,
+                file.section<MachTypeId>(sec(EVehicleSection::MachTypes)), lgrn::id_null<MachTypeId>());
+    load_vector(out.m_machines.machToLocal, machCapacity,
+                file.section<MachLocalId>(sec(EVehicleSection::MachToLocal)), lgrn::id_null<MachLocalId>());
+    load_vector(out.m_machToPart, machCapacity,
+                file.section<PartId>(sec(EVehicleSection::MachToPart)), lgrn::id_null<PartId>());
+
+    auto const localToAnyOffsets    = file.section<uint32_t> (sec(EVehicleSection::LocalToAnyOffsets));
+    auto const localToAny           = file.section<MachAnyId>(sec(EVehicleSection::LocalToAny));
+
+    for (MachTypeId type = 0; type < header.machTypeCount && std::size_t(type) + 1 < localToAnyOffsets.size(); ++type)
+    {
+        if (   localToAnyOffsets[type] > localToAnyOffsets[type + 1]
+            || localToAnyOffsets[type + 1] > localToAny.size())
+        {
+            break;
+        }
+
+        PerMachType &rPerType = out.m_machines.perType[type];
+
+        auto const typeLocalToAny = localToAny.slice(localToAnyOffsets[type], localToAnyOffsets[type + 1]);
+
+        std::vector<MachLocalId> created(typeLocalToAny.size());
+        rPerType.localIds.create(created.begin(), created.end());
+        for (std::size_t local = 0; local < typeLocalToAny.size(); ++local)
+        {
+            if (typeLocalToAny[local] == lgrn::id_null<MachAnyId>())
+            {
+                rPerType.localIds.remove(MachLocalId(local));
+            }
+        }
+
+        load_vector(rPerType.localToAny, rPerType.localIds.capacity(), typeLocalToAny, lgrn::id_null<MachAnyId>());
+    }
+
+    // Nodes
+
+    for (NodeTypeId nodeType = 0; nodeType < header.nodeTypeCount; ++nodeType)
+    {
+        PerNodeType &rPerNodeType = out.m_nodePerType[nodeType];
+        auto const nsec = [nodeType] (ENodeSection const section) { return vehicle_file_section(nodeType, section); };
+
+        load_registry(rPerNodeType.nodeIds, file.section<uint64_t>(nsec(ENodeSection::NodeIds)));
+
+        load_multimap(rPerNodeType.nodeToMach, rPerNodeType.nodeIds,
+                      file.section<uint32_t>(nsec(ENodeSection::NodeToMachOffsets)),
+                      file.section<Junction>(nsec(ENodeSection::NodeToMach)));
+
+        auto const machToNodeOffsets = file.section<uint32_t>(nsec(ENodeSection::MachToNodeOffsets));
+        load_multimap(rPerNodeType.machToNode, out.m_machines.ids, machToNodeOffsets,
+                      file.section<NodeId>(nsec(ENodeSection::MachToNode)));
+        load_multimap(rPerNodeType.m_machToNodeCustom, out.m_machines.ids, machToNodeOffsets,
+                      file.section<JuncCustom>(nsec(ENodeSection::MachToNodeCustom)));
+
+        auto const connectCount = file.section<int32_t>(nsec(ENodeSection::NodeConnectCount));
+        rPerNodeType.m_nodeConnectCount.assign(connectCount.begin(), connectCount.end());
+        rPerNodeType.m_nodeConnectCount.resize(std::max(rPerNodeType.nodeIds.capacity(), connectCount.size()), 0);
+        rPerNodeType.m_connectCountTotal = int(file.section<Junction>(nsec(ENodeSection::NodeToMach)).size());
+
+        auto const valueType = file.section<uint32_t>(nsec(ENodeSection::NodeValueType));
+        switch (valueType.isEmpty() ? EVehicleNodeValues::None : EVehicleNodeValues(valueType[0]))
+        {
+        case EVehicleNodeValues::Float:
+            load_node_values<float>(rPerNodeType, file.section<float>(nsec(ENodeSection::NodeValues)));
+            break;
+        case EVehicleNodeValues::Int32:
+            load_node_values<int32_t>(rPerNodeType, file.section<int32_t>(nsec(ENodeSection::NodeValues)));
+            break;
+        case EVehicleNodeValues::Bool:
+            load_node_values<bool, uint8_t>(rPerNodeType, file.section<uint8_t>(nsec(ENodeSection::NodeValues)));
+            break;
+        case EVehicleNodeValues::None:
+        default:
+            break;
+        }
+    }
+
+    out.m_template = make_vehicle_template(out);
+
+    return out;
+}
+
+} // namespace adera
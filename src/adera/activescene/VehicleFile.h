@@ -0,0 +1,201 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "VehicleBuilder.h"
+
+#include <osp/core/section_file.h>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Path.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace adera
+{
+
+/**
+ * @brief Binary vehicle file layout
+ *
+ * A file is a VehicleFileHeader, a table of VehicleFileSections, then the section contents, as
+ * described in osp/core/section_file.h.
+ *
+ * * Registries are stored as a bitset of existing IDs, preceded by the ID capacity.
+ * * IntArrayMultiMaps are stored as CSR: offsets of (capacity + 1) and a data array.
+ * * Per-Node-type sections are repeated for each Node type, after the fixed sections.
+ *
+ * Values are in native byte order; files with a different byte order are rejected. Machine
+ * and Node type IDs are stored as-is, so files are only compatible with builds that
+ * register the same types in the same order.
+ */
+inline constexpr std::array<char, 8>    gc_vfMagic      {'O', 'S', 'P', 'V', 'E', 'H', '\0', '\0'};
+inline constexpr uint32_t               gc_vfVersion    = 1;
+inline constexpr uint32_t               gc_vfByteOrder  = 0x01020304;
+inline constexpr std::size_t            gc_vfAlign      = osp::gc_sectionAlign;
+
+struct VehicleFileHeader
+{
+    std::array<char, 8> magic;
+    uint32_t            version;
+    uint32_t            byteOrder;
+    uint32_t            machTypeCount;
+    uint32_t            nodeTypeCount;
+    uint32_t            sectionCount;
+    uint32_t            reserved;
+};
+
+using VehicleFileSection = osp::FileSection;
+
+enum class EVehicleSection : uint32_t
+{
+    PartIds,            ///< uint64_t: capacity, then bitset of existing PartIds
+    PartTransformWeld,  ///< Matrix4 [PartId]
+    PartPrefab,         ///< uint32_t [PartId] -> index into prefab name table, or null
+    PartToWeld,         ///< WeldId [PartId]
+    PartToMachOffsets,  ///< uint32_t [PartId + 1]
+    PartToMach,         ///< MachinePair
+
+    WeldIds,            ///< uint64_t: capacity, then bitset of existing WeldIds
+    WeldToPartOffsets,  ///< uint32_t [WeldId + 1]
+    WeldToPart,         ///< PartId
+
+    PrefabNameOffsets,  ///< uint32_t [name + 1]
+    PrefabNameChars,    ///< char, names are not null-terminated
+
+    MachIds,            ///< uint64_t: capacity, then bitset of existing MachAnyIds
+    MachTypes,          ///< MachTypeId [MachAnyId]
+    MachToLocal,        ///< MachLocalId [MachAnyId]
+    MachToPart,         ///< PartId [MachAnyId]
+    LocalToAnyOffsets,  ///< uint32_t [MachTypeId + 1]
+    LocalToAny,         ///< MachAnyId, null for local IDs that don't exist
+
+    Count
+};
+
+enum class ENodeSection : uint32_t
+{
+    NodeIds,            ///< uint64_t: capacity, then bitset of existing NodeIds
+    NodeToMachOffsets,  ///< uint32_t [NodeId + 1]
+    NodeToMach,         ///< Junction
+    MachToNodeOffsets,  ///< uint32_t [MachAnyId + 1]
+    MachToNode,         ///< NodeId
+    MachToNodeCustom,   ///< JuncCustom, parallel with MachToNode
+    NodeConnectCount,   ///< int32_t [NodeId]
+    NodeValueType,      ///< uint32_t: EVehicleNodeValues
+    NodeValues,         ///< Values [NodeId], bool is stored as uint8_t
+
+    Count
+};
+
+enum class EVehicleNodeValues : uint32_t { None, Float, Int32, Bool };
+
+constexpr uint32_t vehicle_file_section(EVehicleSection const section) noexcept
+{
+    return uint32_t(section);
+}
+
+constexpr uint32_t vehicle_file_section(osp::link::NodeTypeId const nodeType, ENodeSection const section) noexcept
+{
+    return   uint32_t(EVehicleSection::Count)
+           + uint32_t(nodeType) * uint32_t(ENodeSection::Count)
+           + uint32_t(section);
+}
+
+/**
+ * @brief Read-only view of a memory-mapped vehicle file
+ *
+ * Sections are accessed in place; nothing is copied until SysVehicleFile::load.
+ */
+class VehicleFileView
+{
+    using MappedFile_t = Corrade::Containers::Array<char const, Corrade::Utility::Path::MapDeleter>;
+
+public:
+
+    /**
+     * @brief Map a vehicle file and validate its header, section table, and contents
+     *
+     * Every stored ID and CSR offset is checked against the registry or array it indexes, so a
+     * truncated or corrupt file is rejected here instead of being read out of bounds by load.
+     *
+     * @return Empty optional if the file can't be mapped or isn't a valid vehicle file
+     */
+    static std::optional<VehicleFileView> map(std::string const& path);
+
+    [[nodiscard]] VehicleFileHeader const& header() const noexcept
+    {
+        return *reinterpret_cast<VehicleFileHeader const*>(m_file.data());
+    }
+
+    template <typename T>
+    [[nodiscard]] osp::ArrayView<T const> section(uint32_t const index) const noexcept
+    {
+        return osp::file_section<T>(m_file, sections()[index]);
+    }
+
+private:
+
+    VehicleFileView(MappedFile_t file) : m_file{std::move(file)} { }
+
+    [[nodiscard]] osp::ArrayView<VehicleFileSection const> sections() const noexcept
+    {
+        return osp::file_sections(m_file, sizeof(VehicleFileHeader), header().sectionCount);
+    }
+
+    MappedFile_t m_file;
+};
+
+class SysVehicleFile
+{
+public:
+
+    /**
+     * @brief Write VehicleData to a binary vehicle file
+     *
+     * @param vehicle       [in] Vehicle to write, usually from VehicleBuilder::finalize_release
+     * @param rResources    [in] Resources, used to look up Prefab names
+     * @param path          [in] File to write
+     *
+     * @return true if the file was written
+     */
+    static bool write(VehicleData const& vehicle, osp::Resources const& rResources, std::string const& path);
+
+    /**
+     * @brief Create VehicleData from a mapped vehicle file
+     *
+     * Every container is sized once and filled with a bulk copy from the mapped sections.
+     * Prefabs are matched by name against importers that are currently loaded. The file must be
+     * validated by VehicleFileView::map.
+     *
+     * @param file          [in] Mapped vehicle file
+     * @param rResources    [ref] Resources, to find Prefabs and create owners for them
+     */
+    static VehicleData load(VehicleFileView const& file, osp::Resources& rResources);
+};
+
+} // namespace adera
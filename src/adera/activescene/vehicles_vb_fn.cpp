@@ -78,7 +78,7 @@ void SysVehicleSpawnVB::create_parts_and_welds(ACtxVehicleSpawn& rVehicleSpawn,
     rVehicleSpawn.spawnedWelds      .resize(weldTotal);
     rVehicleSpawn.spawnedPrefabs    .resize(partTotal);
     rVSVB.remapParts                .resize(remapPartTotal, lgrn::id_null<PartId>());
-    rVSVB.remapWelds                .resize(remapPartTotal, lgrn::id_null<WeldId>());
+    rVSVB.remapWelds                .resize(remapWeldTotal, lgrn::id_null<WeldId>());
 
     // Create new Scene PartIds and WeldIds
 
@@ -109,9 +109,6 @@ void SysVehicleSpawnVB::create_parts_and_welds(ACtxVehicleSpawn& rVehicleSpawn,
 
     // Populate remap vectors and set weld connections
 
-    auto itDstPartIds = rVehicleSpawn.spawnedParts.cbegin();
-    auto itDstWeldIds = rVehicleSpawn.spawnedWelds.cbegin();
-
     for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
     {
         auto const spVhId = SpVehicleId{spVhInt};
@@ -122,36 +119,40 @@ void SysVehicleSpawnVB::create_parts_and_welds(ACtxVehicleSpawn& rVehicleSpawn,
             continue;
         }
 
+        VehicleTemplate const &tmpl = pVData->m_template;
+
+        // New IDs were created in the same order as the template's dense IDs
+        auto const dstParts = arrayView(rVehicleSpawn.spawnedParts.data(), partTotal)
+                                .sliceSize(rVehicleSpawn.spawnedPartOffsets[spVhId].value, tmpl.parts.size());
+        auto const dstWelds = arrayView(rVehicleSpawn.spawnedWelds.data(), weldTotal)
+                                .sliceSize(rVehicleSpawn.spawnedWeldOffsets[spVhId].value, tmpl.welds.size());
+
         std::size_t const remapPartOffset = rVSVB.remapPartOffsets[spVhId];
         std::size_t const remapWeldOffset = rVSVB.remapWeldOffsets[spVhId];
 
-        for (PartId const srcPart : pVData->m_partIds.bitview().zeros())
+        // Populate maps for "VehicleBuilder PartId/WeldId -> ACtxParts PartId/WeldId"
+        for (std::size_t i = 0; i < tmpl.parts.size(); ++i)
         {
-            PartId const dstPart = *itDstPartIds;
-            ++itDstPartIds;
-
-            // Populate map for "VehicleBuilder PartId -> ACtxParts PartId"
-            rVSVB.remapParts[remapPartOffset + srcPart] = dstPart;
+            rVSVB.remapParts[remapPartOffset + tmpl.parts[i]] = dstParts[i];
         }
-
-        for (WeldId const srcWeld : pVData->m_weldIds.bitview().zeros())
+        for (std::size_t i = 0; i < tmpl.welds.size(); ++i)
         {
-            WeldId const dstWeld = *itDstWeldIds;
-            ++itDstWeldIds;
-
-            // Populate map for "VehicleBuilder WeldId -> ACtxParts WeldId"
-            // rVehicleSpawnVB.remapWelds
-            rVSVB.remapWelds[remapWeldOffset + srcWeld] = dstWeld;
+            rVSVB.remapWelds[remapWeldOffset + tmpl.welds[i]] = dstWelds[i];
+        }
 
-            // Use remaps to connect ACtxParts WeldIds and PartIds
-            // rScnParts.m_partToWeld and rScnParts.m_weldToParts
+        // Connect ACtxParts WeldIds and PartIds
+        // rScnParts.m_partToWeld and rScnParts.m_weldToParts
+        for (std::size_t i = 0; i < tmpl.welds.size(); ++i)
+        {
+            WeldId const    dstWeld     = dstWelds[i];
+            uint32_t const  partsFirst  = tmpl.weldPartOffsets[i];
+            uint32_t const  partsLast   = tmpl.weldPartOffsets[i + 1];
 
-            auto const srcWeldPartSpan  = pVData->m_weldToParts[srcWeld];
-            WeldId *pDstWeldPartOut     = rScnParts.weldToParts.emplace(dstWeld, srcWeldPartSpan.size());
+            PartId *pDstWeldPartOut = rScnParts.weldToParts.emplace(dstWeld, partsLast - partsFirst);
 
-            for (PartId const srcPart : srcWeldPartSpan)
+            for (uint32_t j = partsFirst; j < partsLast; ++j)
             {
-                PartId const dstPart = rVSVB.remapParts[remapPartOffset + srcPart];
+                PartId const dstPart = dstParts[tmpl.weldParts[j]];
 
                 (*pDstWeldPartOut) = dstPart;
                 std::advance(pDstWeldPartOut, 1);
@@ -181,7 +182,7 @@ void SysVehicleSpawnVB::request_prefabs(ACtxVehicleSpawn& rVehicleSpawn, ACtxVeh
         }
 
         // Copy Part data from VehicleBuilder to scene
-        for (uint32_t srcPart : pVData->m_partIds.bitview().zeros())
+        for (PartId const srcPart : pVData->m_template.parts)
         {
             PartId const dstPart = *itDstPartIds;
             ++itDstPartIds;
@@ -207,5 +208,302 @@ void SysVehicleSpawnVB::request_prefabs(ACtxVehicleSpawn& rVehicleSpawn, ACtxVeh
     }
 }
 
+void SysVehicleSpawnVB::create_machines(ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts)
+{
+    using namespace osp::link;
+
+    std::size_t const newVehicleCount = rVehicleSpawn.new_vehicle_count();
+    ACtxVehicleSpawnVB &rVSVB = rVehicleSpawnVB;
+    Machines &rDstMachines = rScnParts.machines;
+
+    // Count total machines, and calculate offsets for remaps
+
+    uint32_t    machTotal       = 0;
+    std::size_t remapMachTotal  = 0;
+
+    rVSVB.machtypeCount.assign(MachTypeReg_t::size(), 0);
+    rVSVB.remapMachOffsets              .resize(newVehicleCount);
+    rVehicleSpawn.spawnedMachOffsets    .resize(newVehicleCount);
+
+    for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
+    {
+        auto const spVhId = SpVehicleId{spVhInt};
+        VehicleData const* pVData = rVSVB.dataVB[spVhId];
+        if (pVData == nullptr)
+        {
+            continue;
+        }
+
+        VehicleTemplate const &tmpl = pVData->m_template;
+
+        rVehicleSpawn.spawnedMachOffsets[spVhId] = SpMachAnyId{machTotal};
+        machTotal += tmpl.machs.size();
+
+        rVSVB.remapMachOffsets[spVhId] = remapMachTotal;
+        remapMachTotal += pVData->m_machines.ids.capacity();
+
+        for (MachTypeId type = 0; type < tmpl.machTypeCount.size(); ++type)
+        {
+            rVSVB.machtypeCount[type] += tmpl.machTypeCount[type];
+        }
+    }
+
+    rVehicleSpawn.spawnedMachs  .resize(machTotal);
+    rVSVB.remapMachs            .resize(remapMachTotal, lgrn::id_null<MachAnyId>());
+
+    // Create all MachAnyIds, then all MachLocalIds of each type, at once
+
+    rDstMachines.ids.create(rVehicleSpawn.spawnedMachs.begin(), rVehicleSpawn.spawnedMachs.end());
+    rDstMachines.machTypes  .resize(rDstMachines.ids.capacity());
+    rDstMachines.machToLocal.resize(rDstMachines.ids.capacity());
+
+    // New MachLocalIds of each type are taken in order from tmpLocals[typeNext[type]]
+    std::vector<std::size_t> typeNext(MachTypeReg_t::size(), 0);
+    rVSVB.tmpLocals.resize(machTotal);
+
+    std::size_t localTotal = 0;
+    for (MachTypeId type = 0; type < rVSVB.machtypeCount.size(); ++type)
+    {
+        std::size_t const count = rVSVB.machtypeCount[type];
+        if (count == 0)
+        {
+            continue;
+        }
+
+        PerMachType &rDstPerType = rDstMachines.perType[type];
+        auto const  first        = rVSVB.tmpLocals.begin() + std::ptrdiff_t(localTotal);
+        rDstPerType.localIds.create(first, first + std::ptrdiff_t(count));
+        rDstPerType.localToAny.resize(rDstPerType.localIds.capacity());
+
+        typeNext[type] = localTotal;
+        localTotal += count;
+    }
+
+    // Populate remaps and MachAnyId<->MachLocalId maps
+
+    for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
+    {
+        auto const spVhId = SpVehicleId{spVhInt};
+        VehicleData const* pVData = rVSVB.dataVB[spVhId];
+        if (pVData == nullptr)
+        {
+            continue;
+        }
+
+        VehicleTemplate const   &tmpl           = pVData->m_template;
+        std::size_t const       remapMachOffset = rVSVB.remapMachOffsets[spVhId];
+        auto const              dstMachs        = arrayView(rVehicleSpawn.spawnedMachs.data(), machTotal)
+                                                    .sliceSize(rVehicleSpawn.spawnedMachOffsets[spVhId].value, tmpl.machs.size());
+
+        for (std::size_t i = 0; i < tmpl.machs.size(); ++i)
+        {
+            MachAnyId const     dstMach     = dstMachs[i];
+            MachTypeId const    type        = tmpl.machTypes[i];
+            MachLocalId const   dstLocal    = rVSVB.tmpLocals[typeNext[type]];
+            ++ typeNext[type];
+
+            // Populate map for "VehicleBuilder MachAnyId -> ACtxParts MachAnyId"
+            rVSVB.remapMachs[remapMachOffset + tmpl.machs[i]] = dstMach;
+
+            // MachLocalIds don't need a remap, since they can be obtained from a MachAnyId
+            rDstMachines.machTypes[dstMach]                 = type;
+            rDstMachines.machToLocal[dstMach]               = dstLocal;
+            rDstMachines.perType[type].localToAny[dstLocal] = dstMach;
+        }
+    }
+}
+
+void SysVehicleSpawnVB::update_part_machine_maps(ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts)
+{
+    using namespace osp::link;
+
+    std::size_t const newVehicleCount = rVehicleSpawn.new_vehicle_count();
+    ACtxVehicleSpawnVB const &rVSVB = rVehicleSpawnVB;
+
+    rScnParts.machineToPart .resize(rScnParts.machines.ids.capacity());
+    rScnParts.partToMachines.ids_reserve(rScnParts.partIds.capacity());
+    rScnParts.partToMachines.data_reserve(rScnParts.machines.ids.capacity());
+
+    for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
+    {
+        auto const spVhId = SpVehicleId{spVhInt};
+        VehicleData const* pVData = rVSVB.dataVB[spVhId];
+        if (pVData == nullptr)
+        {
+            continue;
+        }
+
+        VehicleTemplate const &tmpl = pVData->m_template;
+
+        auto const dstParts = arrayView(rVehicleSpawn.spawnedParts.data(), rVehicleSpawn.spawnedParts.size())
+                                .sliceSize(rVehicleSpawn.spawnedPartOffsets[spVhId].value, tmpl.parts.size());
+        auto const dstMachs = arrayView(rVehicleSpawn.spawnedMachs.data(), rVehicleSpawn.spawnedMachs.size())
+                                .sliceSize(rVehicleSpawn.spawnedMachOffsets[spVhId].value, tmpl.machs.size());
+
+        // Update rScnParts machine->part map
+        for (std::size_t i = 0; i < tmpl.machs.size(); ++i)
+        {
+            rScnParts.machineToPart[dstMachs[i]] = dstParts[tmpl.machParts[i]];
+        }
+
+        // Update rScnParts part->machine multimap
+        for (std::size_t i = 0; i < tmpl.parts.size(); ++i)
+        {
+            uint32_t const machsFirst   = tmpl.partMachOffsets[i];
+            uint32_t const machsLast    = tmpl.partMachOffsets[i + 1];
+
+            MachinePair *pDstPairOut = rScnParts.partToMachines.emplace(dstParts[i], machsLast - machsFirst);
+
+            for (uint32_t j = machsFirst; j < machsLast; ++j)
+            {
+                uint32_t const  denseMach   = tmpl.partMachs[j];
+                MachAnyId const dstMach     = dstMachs[denseMach];
+
+                (*pDstPairOut) = { .local = rScnParts.machines.machToLocal[dstMach], .type = tmpl.machTypes[denseMach] };
+                std::advance(pDstPairOut, 1);
+            }
+        }
+    }
+}
+
+void SysVehicleSpawnVB::create_nodes(ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts)
+{
+    using namespace osp::link;
+
+    std::size_t const newVehicleCount   = rVehicleSpawn.new_vehicle_count();
+    std::size_t const nodeTypeCount     = NodeTypeReg_t::size();
+    ACtxVehicleSpawnVB &rVSVB = rVehicleSpawnVB;
+
+    rVSVB.remapNodeOffsets  .resize(newVehicleCount * nodeTypeCount);
+    rVSVB.spawnedNodeOffsets.resize(newVehicleCount * nodeTypeCount);
+    auto remapNodeOffsets2d = rVSVB.remap_node_offsets_2d();
+
+    // Calculate offsets for remaps and new NodeIds. New NodeIds are grouped by type, so all IDs
+    // of a type can be created at once.
+
+    std::size_t remapNodeTotal  = 0;
+    std::size_t nodeTotal       = 0;
+
+    std::vector<std::size_t> typeNodeOffsets(nodeTypeCount + 1, 0);
+    std::vector<std::size_t> typeJuncCount(nodeTypeCount, 0);
+    std::vector<std::size_t> typePortCount(nodeTypeCount, 0);
+
+    for (NodeTypeId nodeType = 0; nodeType < nodeTypeCount; ++nodeType)
+    {
+        for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
+        {
+            VehicleData const* pVData = rVSVB.dataVB[SpVehicleId{spVhInt}];
+            if (pVData == nullptr)
+            {
+                continue;
+            }
+
+            VehicleTemplate::NodeWiring const &wiring = pVData->m_template.nodePerType[nodeType];
+
+            remapNodeOffsets2d[spVhInt][nodeType] = remapNodeTotal;
+            remapNodeTotal += pVData->m_nodePerType[nodeType].nodeIds.capacity();
+
+            rVSVB.spawnedNodeOffsets[spVhInt * nodeTypeCount + nodeType] = nodeTotal;
+            nodeTotal += wiring.nodes.size();
+
+            typeJuncCount[nodeType] += wiring.nodeJuncMach.size();
+            typePortCount[nodeType] += wiring.machPortNode.size();
+        }
+        typeNodeOffsets[nodeType + 1] = nodeTotal;
+    }
+
+    rVSVB.remapNodes    .assign(remapNodeTotal, lgrn::id_null<NodeId>());
+    rVSVB.spawnedNodes  .resize(nodeTotal);
+
+    for (NodeTypeId nodeType = 0; nodeType < nodeTypeCount; ++nodeType)
+    {
+        Nodes &rDstNodes = rScnParts.nodePerType[nodeType];
+
+        auto const first = rVSVB.spawnedNodes.begin();
+        rDstNodes.nodeIds.create(first + std::ptrdiff_t(typeNodeOffsets[nodeType]),
+                                 first + std::ptrdiff_t(typeNodeOffsets[nodeType + 1]));
+
+        rDstNodes.nodeToMach.ids_reserve(rDstNodes.nodeIds.capacity());
+        rDstNodes.nodeToMach.data_reserve(rDstNodes.nodeToMach.data_size() + typeJuncCount[nodeType]);
+        rDstNodes.machToNode.ids_reserve(rScnParts.machines.ids.capacity());
+        rDstNodes.machToNode.data_reserve(rDstNodes.machToNode.data_size() + typePortCount[nodeType]);
+    }
+
+    // Connect new Nodes and Machines
+
+    for (uint32_t spVhInt = 0; spVhInt < newVehicleCount; ++spVhInt)
+    {
+        auto const spVhId = SpVehicleId{spVhInt};
+        VehicleData const* pVData = rVSVB.dataVB[spVhId];
+        if (pVData == nullptr)
+        {
+            continue;
+        }
+
+        VehicleTemplate const &tmpl = pVData->m_template;
+
+        auto const dstMachs = arrayView(rVehicleSpawn.spawnedMachs.data(), rVehicleSpawn.spawnedMachs.size())
+                                .sliceSize(rVehicleSpawn.spawnedMachOffsets[spVhId].value, tmpl.machs.size());
+
+        for (NodeTypeId nodeType = 0; nodeType < nodeTypeCount; ++nodeType)
+        {
+            VehicleTemplate::NodeWiring const   &wiring     = tmpl.nodePerType[nodeType];
+            Nodes                               &rDstNodes  = rScnParts.nodePerType[nodeType];
+
+            auto const dstNodes = arrayView(rVSVB.spawnedNodes)
+                                    .sliceSize(rVSVB.spawnedNodeOffsets[spVhInt * nodeTypeCount + nodeType], wiring.nodes.size());
+
+            // Populate map for "VehicleBuilder NodeId -> ACtxParts NodeId"
+            std::size_t const remapNodeOffset = remapNodeOffsets2d[spVhInt][nodeType];
+            for (std::size_t i = 0; i < wiring.nodes.size(); ++i)
+            {
+                rVSVB.remapNodes[remapNodeOffset + wiring.nodes[i]] = dstNodes[i];
+            }
+
+            // Node-to-Machine connections
+            for (std::size_t i = 0; i < wiring.nodes.size(); ++i)
+            {
+                uint32_t const juncFirst    = wiring.nodeJuncOffsets[i];
+                uint32_t const juncLast     = wiring.nodeJuncOffsets[i + 1];
+
+                Junction *pDstJuncOut = rDstNodes.nodeToMach.emplace(dstNodes[i], juncLast - juncFirst);
+
+                for (uint32_t j = juncFirst; j < juncLast; ++j)
+                {
+                    uint32_t const  denseMach   = wiring.nodeJuncMach[j];
+                    MachAnyId const dstMach     = dstMachs[denseMach];
+
+                    pDstJuncOut->local  = rScnParts.machines.machToLocal[dstMach];
+                    pDstJuncOut->type   = tmpl.machTypes[denseMach];
+                    pDstJuncOut->custom = wiring.nodeJuncCustom[j];
+                    std::advance(pDstJuncOut, 1);
+                }
+            }
+
+            // Machine-to-Node connections
+            for (std::size_t i = 0; i < tmpl.machs.size(); ++i)
+            {
+                uint32_t const portFirst    = wiring.machPortOffsets[i];
+                uint32_t const portLast     = wiring.machPortOffsets[i + 1];
+                if (portFirst == portLast)
+                {
+                    continue;
+                }
+
+                NodeId *pDstPortOut = rDstNodes.machToNode.emplace(dstMachs[i], portLast - portFirst);
+
+                for (uint32_t j = portFirst; j < portLast; ++j)
+                {
+                    uint32_t const denseNode = wiring.machPortNode[j];
+
+                    (*pDstPortOut) = (denseNode != lgrn::id_null<uint32_t>())
+                                   ? dstNodes[denseNode]
+                                   : lgrn::id_null<NodeId>();
+                    std::advance(pDstPortOut, 1);
+                }
+            }
+        }
+    }
+}
 
 } // namespace adera
@@ -71,6 +71,14 @@ struct ACtxVehicleSpawnVB
     // An offset can exist for each pair of [New Vehicle, Node Type]
     std::vector<osp::link::NodeId>          remapNodes;
     osp::KeyedVec<SpVehicleId, std::size_t> remapNodeOffsets;
+
+    // Newly created NodeIds in VehicleTemplate dense order, laid out the same way as remapNodes
+    // NodeId dstNode = spawnedNodes[spawnedNodeOffsets[newVehicleIndex * NodeTypeCount + nodeType] + denseNode];
+    std::vector<osp::link::NodeId>          spawnedNodes;
+    std::vector<std::size_t>                spawnedNodeOffsets;
+
+    // Scratch space for creating MachLocalIds of each type at once
+    std::vector<osp::link::MachLocalId>     tmpLocals;
 };
 
 class SysVehicleSpawnVB
@@ -83,6 +91,20 @@ public:
     static void create_parts_and_welds(ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts);
 
     static void request_prefabs(ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts, ACtxPrefabs& rPrefabs, Resources& rResources);
+
+    /**
+     * @brief Create MachAnyIds and MachLocalIds for vehicles to spawn
+     *
+     * IDs of each type are created with a single call for all new vehicles.
+     */
+    static void create_machines(ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts);
+
+    static void update_part_machine_maps(ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts);
+
+    /**
+     * @brief Create NodeIds for vehicles to spawn, and connect them to already created Machines
+     */
+    static void create_nodes(ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts);
 };
 
 
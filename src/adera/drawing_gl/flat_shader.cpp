@@ -24,9 +24,90 @@
  */
 #include "flat_shader.h"
 
+#include <osp/drawing/draw_commands_fn.h>
+
 using namespace osp;
 using namespace osp::draw;
 
+using adera::shader::ACtxDrawFlat;
+using adera::shader::FlatGL3D;
+
+static void bind_textures(FlatGL3D& rShader, ACtxDrawFlat& rData, DrawEnt const ent)
+{
+    if (rShader.flags() & FlatGL3D::Flag::Textured)
+    {
+        TexGlId const texGlId = (*rData.pDiffuseTexId)[ent].m_glId;
+        rShader.bindTexture(rData.pTexGl->get(texGlId));
+    }
+}
+
+static void bind_uniforms(FlatGL3D& rShader, ACtxDrawFlat& rData, std::size_t const chunk)
+{
+    using namespace Magnum::Shaders;
+
+    if ( ! SysRenderGL::claim_uniform_bindings(*rData.pRenderGl, &rData, chunk) )
+    {
+        return; // Already bound
+    }
+
+    rShader
+        .bindTransformationProjectionBuffer(
+                rData.transformBuffer,
+                SysRenderGL::draw_uniforms_offset<TransformationProjectionUniform3D>(chunk),
+                SysRenderGL::draw_uniforms_size<TransformationProjectionUniform3D>())
+        .bindDrawBuffer(rData.drawBuffer,
+                        SysRenderGL::draw_uniforms_offset<FlatDrawUniform>(chunk),
+                        SysRenderGL::draw_uniforms_size<FlatDrawUniform>())
+        .bindMaterialBuffer(rData.materialBuffer,
+                            SysRenderGL::draw_uniforms_offset<FlatMaterialUniform>(chunk),
+                            SysRenderGL::draw_uniforms_size<FlatMaterialUniform>());
+}
+
+void adera::shader::update_uniforms_flat(
+        ACtxDrawFlat&               rData,
+        ACtxDrawCommands const&     cmds,
+        ViewProjMatrix const&       viewProj)
+{
+    if ( ! (rData.shaderUntextured.flags() & FlatGL3D::Flag::UniformBuffers) )
+    {
+        return;
+    }
+
+    rData.transforms.clear();
+    rData.draws     .clear();
+    rData.materials .clear();
+    rData.drawSlot  .assign(cmds.entToCmd.size(), gc_noDrawSlot);
+
+    auto const add_draw = [&rData] (Matrix4 const& transformProj, Magnum::Color4 const& color)
+    {
+        auto const slot = uint32_t(rData.transforms.size());
+
+        rData.transforms.emplace_back()
+            .setTransformationProjectionMatrix(transformProj);
+        rData.draws.emplace_back()
+            .setMaterialId(slot % gc_drawUniformsPerChunk);
+        rData.materials.emplace_back()
+            .setColor(color);
+
+        return slot;
+    };
+
+    // Slot 0 is for instanced draws, which use view-relative transforms from the instance data
+    add_draw(viewProj.m_proj, Magnum::Color4{1.0f});
+
+    SysDrawCommands::for_each_with_material(cmds, rData.materialId, [&] (DrawCommand const& cmd)
+    {
+        Magnum::Color4 const color = (rData.pColor != nullptr) ? cmd.color : Magnum::Color4{1.0f};
+        rData.drawSlot[cmd.ent] = add_draw(viewProj.m_proj * cmd.modelView, color);
+    });
+
+    SysRenderGL::upload_draw_uniforms(rData.transformBuffer,  rData.transforms);
+    SysRenderGL::upload_draw_uniforms(rData.drawBuffer,       rData.draws);
+    SysRenderGL::upload_draw_uniforms(rData.materialBuffer,   rData.materials);
+
+    SysRenderGL::reset_uniform_bindings(*rData.pRenderGl);
+}
+
 void adera::shader::draw_ent_flat(
         DrawEnt                     ent,
         ViewProjMatrix const&       viewProj,
@@ -40,23 +121,88 @@ void adera::shader::draw_ent_flat(
     auto &rData   = *reinterpret_cast<ACtxDrawFlat*>(pData);
     auto &rShader = *reinterpret_cast<FlatGL3D*>(pShader);
 
-    // Collect uniform information
-    Matrix4 const &drawTf = (*rData.pDrawTf)[ent];
+    MeshGlId const      meshId = (*rData.pMeshId)[ent].m_glId;
+    Magnum::GL::Mesh    &rMesh = rData.pMeshGl->get(meshId);
 
-    if (rShader.flags() & FlatGL3D::Flag::Textured)
+    bind_textures(rShader, rData, ent);
+
+    if (rShader.flags() & FlatGL3D::Flag::UniformBuffers)
     {
-        TexGlId const texGlId = (*rData.pDiffuseTexId)[ent].m_glId;
-        rShader.bindTexture(rData.pTexGl->get(texGlId));
+        // Everything else was already written by update_uniforms_flat. Ents that weren't
+        // given a slot this pass have nothing current to draw with.
+        uint32_t const slot = rData.drawSlot[ent];
+        if (slot == gc_noDrawSlot)
+        {
+            return;
+        }
+        bind_uniforms(rShader, rData, slot / gc_drawUniformsPerChunk);
+        rShader.setDrawOffset(slot % gc_drawUniformsPerChunk)
+               .draw(rMesh);
+        return;
     }
 
+    // Collect uniform information, prefer what was already recorded
+    DrawCommand const *pCmd = (rData.pDrawCmds != nullptr)
+                            ? SysDrawCommands::find(*rData.pDrawCmds, ent) : nullptr;
+
     if (rData.pColor != nullptr)
     {
-        rShader.setColor((*rData.pColor)[ent]);
+        rShader.setColor((pCmd != nullptr) ? pCmd->color : (*rData.pColor)[ent]);
     }
 
-    MeshGlId const      meshId = (*rData.pMeshId)[ent].m_glId;
-    Magnum::GL::Mesh    &rMesh = rData.pMeshGl->get(meshId);
+    Matrix4 const transformProj = (pCmd != nullptr)
+                                ? viewProj.m_proj * pCmd->modelView
+                                : viewProj.m_viewProj * (*rData.pDrawTf)[ent];
 
-    rShader.setTransformationProjectionMatrix(viewProj.m_viewProj * drawTf)
+    rShader.setTransformationProjectionMatrix(transformProj)
            .draw(rMesh);
 }
+
+void adera::shader::draw_ents_flat_instanced(
+        DrawEnt const*              pEnts,
+        std::size_t const           count,
+        ViewProjMatrix const&       viewProj,
+        EntityToDraw::UserData_t    userData) noexcept
+{
+    void* const pData   = std::get<0>(userData);
+    void* const pShader = std::get<2>(userData);
+    assert(pData   != nullptr);
+    assert(pShader != nullptr);
+    assert(count != 0);
+
+    auto &rData   = *reinterpret_cast<ACtxDrawFlat*>(pData);
+    auto &rShader = *reinterpret_cast<FlatGL3D*>(pShader);
+    assert(rData.pDrawCmds != nullptr);
+
+    // All DrawEnts share the same mesh and texture
+    DrawEnt const firstEnt = pEnts[0];
+
+    bind_textures(rShader, rData, firstEnt);
+
+    std::vector<InstanceDataGL> &rInstances = rData.pRenderGl->m_instanceData;
+    rInstances.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        DrawCommand const &cmd = *SysDrawCommands::find(*rData.pDrawCmds, pEnts[i]);
+        rInstances[i] = {
+            cmd.modelView,
+            cmd.normalMatrix,
+            (rData.pColor != nullptr) ? cmd.color : Magnum::Color4{1.0f} };
+    }
+
+    MeshGlId const meshId = (*rData.pMeshId)[firstEnt].m_glId;
+
+    if (rShader.flags() & FlatGL3D::Flag::UniformBuffers)
+    {
+        bind_uniforms(rShader, rData, 0);
+        rShader.setDrawOffset(0);
+    }
+    else
+    {
+        // Instance transforms are already view-relative, only projection is left
+        rShader.setColor(Magnum::Color4{1.0f})
+               .setTransformationProjectionMatrix(viewProj.m_proj);
+    }
+
+    SysRenderGL::draw_instanced(*rData.pRenderGl, meshId, rShader);
+}
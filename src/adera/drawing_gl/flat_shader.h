@@ -24,9 +24,12 @@
  */
 #pragma once
 
+#include <osp/drawing/draw_commands.h>
 #include <osp/drawing_gl/rendergl.h>
 
+#include <Magnum/Shaders/Flat.h>
 #include <Magnum/Shaders/FlatGL.h>
+#include <Magnum/Shaders/Generic.h>
 
 namespace adera::shader
 {
@@ -39,6 +42,10 @@ struct ACtxDrawFlat
     FlatGL3D                    shaderUntextured    {Corrade::NoCreate};
     FlatGL3D                    shaderDiffuse       {Corrade::NoCreate};
 
+    // Same as above, but with InstancedTransformation and VertexColor flags
+    FlatGL3D                    shaderUntexturedInstanced   {Corrade::NoCreate};
+    FlatGL3D                    shaderDiffuseInstanced      {Corrade::NoCreate};
+
     osp::draw::DrawTransforms_t    *pDrawTf         {nullptr};
     osp::draw::DrawEntColors_t     *pColor          {nullptr};
     osp::draw::TexGlEntStorage_t   *pDiffuseTexId   {nullptr};
@@ -46,9 +53,33 @@ struct ACtxDrawFlat
 
     osp::draw::TexGlStorage_t      *pTexGl          {nullptr};
     osp::draw::MeshGlStorage_t     *pMeshGl         {nullptr};
+    osp::draw::RenderGL            *pRenderGl       {nullptr};
+
+    // Draw commands recorded this frame. Required for instanced draws. Without them, single draws
+    // calculate transforms from pDrawTf instead.
+    osp::draw::ACtxDrawCommands const *pDrawCmds    {nullptr};
 
     osp::draw::MaterialId materialId { lgrn::id_null<osp::draw::MaterialId>() };
 
+    // Uniform buffers, only used if shaders are created with the UniformBuffers flag.
+    // Written once per frame by update_uniforms_flat. Draw slot 0 is used by instanced draws.
+    Magnum::GL::Buffer          transformBuffer     {Corrade::NoCreate};
+    Magnum::GL::Buffer          drawBuffer          {Corrade::NoCreate};
+    Magnum::GL::Buffer          materialBuffer      {Corrade::NoCreate};
+
+    std::vector<Magnum::Shaders::TransformationProjectionUniform3D> transforms;
+    std::vector<Magnum::Shaders::FlatDrawUniform>                   draws;
+    std::vector<Magnum::Shaders::FlatMaterialUniform>               materials;
+
+    osp::KeyedVec<osp::draw::DrawEnt, uint32_t>                     drawSlot;
+
+    void create_uniform_buffers()
+    {
+        transformBuffer     = Magnum::GL::Buffer{};
+        drawBuffer          = Magnum::GL::Buffer{};
+        materialBuffer      = Magnum::GL::Buffer{};
+    }
+
     constexpr void assign_pointers(osp::draw::ACtxSceneRender&   rScnRender,
                                    osp::draw::ACtxSceneRenderGL& rScnRenderGl,
                                    osp::draw::RenderGL&          rRenderGl) noexcept
@@ -59,14 +90,34 @@ struct ACtxDrawFlat
         pMeshId         = &rScnRenderGl .m_meshId;
         pTexGl          = &rRenderGl    .m_texGl;
         pMeshGl         = &rRenderGl    .m_meshGl;
+        pRenderGl       = &rRenderGl;
     }
 };
 
+/**
+ * @brief Write per-draw uniform buffers for Flat shaders using UniformBuffers
+ *
+ * @param rData         [ref] Flat shader data
+ * @param cmds          [in] Draw commands recorded this frame, only ones using this shader's
+ *                           material are read
+ * @param viewProj      [in] View and projection matrix
+ */
+void update_uniforms_flat(
+        ACtxDrawFlat&                        rData,
+        osp::draw::ACtxDrawCommands const&   cmds,
+        osp::draw::ViewProjMatrix const&     viewProj);
+
 void draw_ent_flat(
         osp::draw::DrawEnt                   ent,
         osp::draw::ViewProjMatrix const&     viewProj,
         osp::draw::EntityToDraw::UserData_t  userData) noexcept;
 
+void draw_ents_flat_instanced(
+        osp::draw::DrawEnt const*            pEnts,
+        std::size_t                          count,
+        osp::draw::ViewProjMatrix const&     viewProj,
+        osp::draw::EntityToDraw::UserData_t  userData) noexcept;
+
 struct ArgsForSyncDrawEntFlat
 {
     osp::draw::DrawEntSet_t const&              hasMaterial;
@@ -90,10 +141,17 @@ inline void sync_drawent_flat(osp::draw::DrawEnt ent, ArgsForSyncDrawEntFlat con
                       ? &args.rData.shaderDiffuse
                       : &args.rData.shaderUntextured;
 
+    FlatGL3D *pShaderInstanced = hasTexture
+                               ? &args.rData.shaderDiffuseInstanced
+                               : &args.rData.shaderUntexturedInstanced;
+
+    osp::draw::EntityToDraw const toDraw{&draw_ent_flat, {&args.rData, pShader, pShaderInstanced},
+                                         &draw_ents_flat_instanced};
+
     if (args.pStorageTransparent != nullptr)
     {
         auto value = (hasMaterial && args.transparent.test(entInt))
-                   ? std::make_optional(osp::draw::EntityToDraw{&draw_ent_flat, {&args.rData, pShader}})
+                   ? std::make_optional(toDraw)
                    : std::nullopt;
 
         osp::storage_assign(*args.pStorageTransparent, ent, std::move(value));
@@ -102,7 +160,7 @@ inline void sync_drawent_flat(osp::draw::DrawEnt ent, ArgsForSyncDrawEntFlat con
     if (args.pStorageOpaque != nullptr)
     {
         auto value = (hasMaterial && args.opaque.test(entInt))
-                   ? std::make_optional(osp::draw::EntityToDraw{&draw_ent_flat, {&args.rData, pShader}})
+                   ? std::make_optional(toDraw)
                    : std::nullopt;
 
         osp::storage_assign(*args.pStorageOpaque, ent, std::move(value));
@@ -24,37 +24,57 @@
  */
 #include "phong_shader.h"
 
+#include <osp/drawing/draw_commands_fn.h>
+
 // for the 0xrrggbb_rgbf and angle literals
 using namespace Magnum::Math::Literals;
 
 using namespace osp;
 using namespace osp::draw;
 
-void adera::shader::draw_ent_phong(
-        DrawEnt                     ent,
-        ViewProjMatrix const&       viewProj,
-        EntityToDraw::UserData_t    userData) noexcept
+using adera::shader::ACtxDrawPhong;
+using adera::shader::PhongGL;
+
+// TODO: find a better way to deal with lights instead of hard-coding it
+static constexpr std::array<Magnum::Color3, 2> gc_lightColors
 {
-    using Flag = PhongGL::Flag;
+    0xddd4Cd_rgbf,
+    0x32354e_rgbf
+};
 
-    void* const pData   = std::get<0>(userData);
-    void* const pShader = std::get<1>(userData);
-    assert(pData   != nullptr);
-    assert(pShader != nullptr);
+static constexpr std::array<Magnum::Color3, 2> gc_lightSpecColors
+{
+    0xfff5ed_rgbf,
+    0x000000_rgbf
+};
 
-    auto &rData   = *reinterpret_cast<ACtxDrawPhong*>(pData);
-    auto &rShader = *reinterpret_cast<PhongGL*>(pShader);
+static constexpr Magnum::Color4 gc_ambientColor     = 0x1a1e29ff_rgbaf;
+static constexpr Magnum::Color4 gc_specularColor    = 0xffffff00_rgbaf;
 
-    // Collect uniform information
-    Matrix4 const &drawTf = (*rData.pDrawTf)[ent];
+static std::array<Vector4, 2> light_positions(ViewProjMatrix const& viewProj)
+{
+    // Lights with w=0.0f are directional lights
+    // Directonal lights are camera-relative, so we need 'viewProj.m_view *'
+    return
+    {
+        viewProj.m_view * Vector4{ Vector3{0.2f, 0.6f, 0.5f}.normalized(), 0.0f},
+        viewProj.m_view * Vector4{-Vector3{0.0f, 0.0f, 1.0f}, 0.0f}
+    };
+}
 
-    Magnum::Matrix4 entRelative = viewProj.m_view * drawTf;
+static void set_lights(PhongGL& rShader, ViewProjMatrix const& viewProj)
+{
+    rShader
+        .setAmbientColor(gc_ambientColor)
+        .setSpecularColor(gc_specularColor)
+        .setLightColors(gc_lightColors)
+        .setLightSpecularColors(gc_lightSpecColors)
+        .setLightPositions(light_positions(viewProj));
+}
 
-    /* 4th component indicates light type. A value of 0.0f indicates that the
-     * light is a direction light coming from the specified direction relative
-     * to the camera.
-     */
-    //Vector4 light = ;
+static void bind_textures(PhongGL& rShader, ACtxDrawPhong& rData, DrawEnt const ent)
+{
+    using Flag = PhongGL::Flag;
 
     if (rShader.flags() & Flag::DiffuseTexture)
     {
@@ -67,48 +87,211 @@ void adera::shader::draw_ent_phong(
             rShader.bindAmbientTexture(rTexture);
         }
     }
+}
 
-    if (rData.pColor != nullptr)
+static void bind_uniforms(PhongGL& rShader, ACtxDrawPhong& rData, std::size_t const chunk)
+{
+    using namespace Magnum::Shaders;
+
+    if ( ! SysRenderGL::claim_uniform_bindings(*rData.pRenderGl, &rData, chunk) )
     {
-        rShader.setDiffuseColor((*rData.pColor)[ent]);
+        return; // Already bound
     }
 
-    MeshGlId const      meshId = (*rData.pMeshId)[ent].m_glId;
-    Magnum::GL::Mesh    &rMesh = rData.pMeshGl->get(meshId);
+    rShader
+        .bindProjectionBuffer(rData.projectionBuffer)
+        .bindLightBuffer(rData.lightBuffer)
+        .bindTransformationBuffer(rData.transformBuffer,
+                                  SysRenderGL::draw_uniforms_offset<TransformationUniform3D>(chunk),
+                                  SysRenderGL::draw_uniforms_size<TransformationUniform3D>())
+        .bindDrawBuffer(rData.drawBuffer,
+                        SysRenderGL::draw_uniforms_offset<PhongDrawUniform>(chunk),
+                        SysRenderGL::draw_uniforms_size<PhongDrawUniform>())
+        .bindMaterialBuffer(rData.materialBuffer,
+                            SysRenderGL::draw_uniforms_offset<PhongMaterialUniform>(chunk),
+                            SysRenderGL::draw_uniforms_size<PhongMaterialUniform>());
+}
 
-    Matrix3 a{viewProj.m_view};
+void adera::shader::update_uniforms_phong(
+        ACtxDrawPhong&              rData,
+        ACtxDrawCommands const&     cmds,
+        ViewProjMatrix const&       viewProj)
+{
+    using namespace Magnum::Shaders;
+    using Magnum::GL::BufferUsage;
 
+    if ( ! (rData.shaderUntextured.flags() & PhongGL::Flag::UniformBuffers) )
+    {
+        return;
+    }
 
-    // Lights with w=0.0f are directional lights
-    // Directonal lights are camera-relative, so we need 'viewProj.m_view *'
-    auto const lightPositions =
+    // Per-frame uniforms
+    std::array<Vector4, 2> const lightPositions = light_positions(viewProj);
+    std::array<PhongLightUniform, 2> lights;
+    for (std::size_t i = 0; i < lights.size(); ++i)
     {
-        viewProj.m_view * Vector4{ Vector3{0.2f, 0.6f, 0.5f}.normalized(), 0.0f},
-        viewProj.m_view * Vector4{-Vector3{0.0f, 0.0f, 1.0f}, 0.0f}
-    };
+        lights[i]
+            .setPosition(lightPositions[i])
+            .setColor(gc_lightColors[i])
+            .setSpecularColor(gc_lightSpecColors[i]);
+    }
+    rData.lightBuffer.setData(Corrade::Containers::arrayView(lights), BufferUsage::StreamDraw);
+
+    ProjectionUniform3D projection;
+    projection.setProjectionMatrix(viewProj.m_proj);
+    rData.projectionBuffer.setData(Corrade::Containers::arrayView(&projection, 1),
+                                   BufferUsage::StreamDraw);
 
-    auto const lightColors =
+    // Per-draw uniforms
+    rData.transforms.clear();
+    rData.draws     .clear();
+    rData.materials .clear();
+    rData.drawSlot  .assign(cmds.entToCmd.size(), gc_noDrawSlot);
+
+    auto const add_draw = [&rData] (Matrix4 const& transform, Matrix3 const& normal,
+                                    Magnum::Color4 const& color)
     {
-        0xddd4Cd_rgbf,
-        0x32354e_rgbf
+        auto const slot = uint32_t(rData.transforms.size());
+
+        rData.transforms.emplace_back()
+            .setTransformationMatrix(transform);
+        rData.draws.emplace_back()
+            .setNormalMatrix(normal)
+            .setMaterialId(slot % gc_drawUniformsPerChunk)
+            .setLightOffsetCount(0, gc_lightColors.size());
+        rData.materials.emplace_back()
+            .setAmbientColor(gc_ambientColor)
+            .setDiffuseColor(color)
+            .setSpecularColor(gc_specularColor);
+
+        return slot;
     };
 
-    auto const lightSpecColors =
+    // Slot 0 is for instanced draws, which use view-relative transforms from the instance data
+    add_draw(Matrix4{}, Matrix3{}, 0xffffffff_rgbaf);
+
+    SysDrawCommands::for_each_with_material(cmds, rData.materialId, [&] (DrawCommand const& cmd)
     {
-        0xfff5ed_rgbf,
-        0x000000_rgbf
-    };
+        Magnum::Color4 const color = (rData.pColor != nullptr) ? cmd.color : 0xffffffff_rgbaf;
+        rData.drawSlot[cmd.ent] = add_draw(cmd.modelView, cmd.normalMatrix, color);
+    });
+
+    SysRenderGL::upload_draw_uniforms(rData.transformBuffer,  rData.transforms);
+    SysRenderGL::upload_draw_uniforms(rData.drawBuffer,       rData.draws);
+    SysRenderGL::upload_draw_uniforms(rData.materialBuffer,   rData.materials);
+
+    SysRenderGL::reset_uniform_bindings(*rData.pRenderGl);
+}
+
+void adera::shader::draw_ent_phong(
+        DrawEnt                     ent,
+        ViewProjMatrix const&       viewProj,
+        EntityToDraw::UserData_t    userData) noexcept
+{
+    void* const pData   = std::get<0>(userData);
+    void* const pShader = std::get<1>(userData);
+    assert(pData   != nullptr);
+    assert(pShader != nullptr);
+
+    auto &rData   = *reinterpret_cast<ACtxDrawPhong*>(pData);
+    auto &rShader = *reinterpret_cast<PhongGL*>(pShader);
+
+    MeshGlId const      meshId = (*rData.pMeshId)[ent].m_glId;
+    Magnum::GL::Mesh    &rMesh = rData.pMeshGl->get(meshId);
+
+    bind_textures(rShader, rData, ent);
+
+    if (rShader.flags() & PhongGL::Flag::UniformBuffers)
+    {
+        // Everything else was already written by update_uniforms_phong. Ents that weren't
+        // given a slot this pass have nothing current to draw with.
+        uint32_t const slot = rData.drawSlot[ent];
+        if (slot == gc_noDrawSlot)
+        {
+            return;
+        }
+        bind_uniforms(rShader, rData, slot / gc_drawUniformsPerChunk);
+        rShader.setDrawOffset(slot % gc_drawUniformsPerChunk)
+               .draw(rMesh);
+        return;
+    }
+
+    // Collect uniform information, prefer what was already recorded
+    DrawCommand const *pCmd = (rData.pDrawCmds != nullptr)
+                            ? SysDrawCommands::find(*rData.pDrawCmds, ent) : nullptr;
+    if (pCmd != nullptr)
+    {
+        rShader.setTransformationMatrix(pCmd->modelView)
+               .setNormalMatrix(pCmd->normalMatrix);
+    }
+    else
+    {
+        Matrix4 const entRelative = viewProj.m_view * (*rData.pDrawTf)[ent];
+        rShader.setTransformationMatrix(entRelative)
+               .setNormalMatrix(entRelative.normalMatrix());
+    }
+
+    if (rData.pColor != nullptr)
+    {
+        rShader.setDiffuseColor((pCmd != nullptr) ? pCmd->color : (*rData.pColor)[ent]);
+    }
+
+    set_lights(rShader, viewProj);
 
-    // TODO: find a better way to deal with lights instead of hard-coding it
     rShader
-        .setAmbientColor(0x1a1e29ff_rgbaf)
-        .setSpecularColor(0xffffff00_rgbaf)
-        .setLightColors(lightColors)
-        .setLightSpecularColors(lightSpecColors)
-        .setLightPositions(lightPositions)
-        .setTransformationMatrix(entRelative)
         .setProjectionMatrix(viewProj.m_proj)
-        .setNormalMatrix(entRelative.normalMatrix())
         .draw(rMesh);
 }
 
+void adera::shader::draw_ents_phong_instanced(
+        DrawEnt const*              pEnts,
+        std::size_t const           count,
+        ViewProjMatrix const&       viewProj,
+        EntityToDraw::UserData_t    userData) noexcept
+{
+    void* const pData   = std::get<0>(userData);
+    void* const pShader = std::get<2>(userData);
+    assert(pData   != nullptr);
+    assert(pShader != nullptr);
+    assert(count != 0);
+
+    auto &rData   = *reinterpret_cast<ACtxDrawPhong*>(pData);
+    auto &rShader = *reinterpret_cast<PhongGL*>(pShader);
+    assert(rData.pDrawCmds != nullptr);
+
+    // All DrawEnts share the same mesh and texture
+    DrawEnt const firstEnt = pEnts[0];
+
+    bind_textures(rShader, rData, firstEnt);
+
+    std::vector<InstanceDataGL> &rInstances = rData.pRenderGl->m_instanceData;
+    rInstances.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        DrawCommand const &cmd = *SysDrawCommands::find(*rData.pDrawCmds, pEnts[i]);
+        rInstances[i] = {
+            cmd.modelView,
+            cmd.normalMatrix,
+            (rData.pColor != nullptr) ? cmd.color : Magnum::Color4{1.0f} };
+    }
+
+    if (rShader.flags() & PhongGL::Flag::UniformBuffers)
+    {
+        bind_uniforms(rShader, rData, 0);
+        rShader.setDrawOffset(0);
+    }
+    else
+    {
+        set_lights(rShader, viewProj);
+
+        // Instance transforms are already view-relative
+        rShader
+            .setDiffuseColor(0xffffffff_rgbaf)
+            .setTransformationMatrix(Matrix4{})
+            .setProjectionMatrix(viewProj.m_proj)
+            .setNormalMatrix(Matrix3{});
+    }
+
+    MeshGlId const meshId = (*rData.pMeshId)[firstEnt].m_glId;
+    SysRenderGL::draw_instanced(*rData.pRenderGl, meshId, rShader);
+}
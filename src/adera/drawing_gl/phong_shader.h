@@ -24,8 +24,11 @@
  */
 #pragma once
 
+#include <osp/drawing/draw_commands.h>
 #include <osp/drawing_gl/rendergl.h>
 
+#include <Magnum/Shaders/Generic.h>
+#include <Magnum/Shaders/Phong.h>
 #include <Magnum/Shaders/PhongGL.h>
 
 namespace adera::shader
@@ -41,6 +44,10 @@ struct ACtxDrawPhong
     PhongGL                     shaderUntextured    {Corrade::NoCreate};
     PhongGL                     shaderDiffuse       {Corrade::NoCreate};
 
+    // Same as above, but with InstancedTransformation and VertexColor flags
+    PhongGL                     shaderUntexturedInstanced   {Corrade::NoCreate};
+    PhongGL                     shaderDiffuseInstanced      {Corrade::NoCreate};
+
     osp::draw::DrawTransforms_t    *pDrawTf         {nullptr};
     osp::draw::DrawEntColors_t     *pColor          {nullptr};
     osp::draw::TexGlEntStorage_t   *pDiffuseTexId   {nullptr};
@@ -48,9 +55,37 @@ struct ACtxDrawPhong
 
     osp::draw::TexGlStorage_t      *pTexGl          {nullptr};
     osp::draw::MeshGlStorage_t     *pMeshGl         {nullptr};
+    osp::draw::RenderGL            *pRenderGl       {nullptr};
+
+    // Draw commands recorded this frame. Required for instanced draws. Without them, single draws
+    // calculate transforms from pDrawTf instead.
+    osp::draw::ACtxDrawCommands const *pDrawCmds    {nullptr};
 
     osp::draw::MaterialId materialId { lgrn::id_null<osp::draw::MaterialId>() };
 
+    // Uniform buffers, only used if shaders are created with the UniformBuffers flag.
+    // Written once per frame by update_uniforms_phong. Draw slot 0 is used by instanced draws.
+    Magnum::GL::Buffer          projectionBuffer    {Corrade::NoCreate};
+    Magnum::GL::Buffer          lightBuffer         {Corrade::NoCreate};
+    Magnum::GL::Buffer          transformBuffer     {Corrade::NoCreate};
+    Magnum::GL::Buffer          drawBuffer          {Corrade::NoCreate};
+    Magnum::GL::Buffer          materialBuffer      {Corrade::NoCreate};
+
+    std::vector<Magnum::Shaders::TransformationUniform3D>   transforms;
+    std::vector<Magnum::Shaders::PhongDrawUniform>          draws;
+    std::vector<Magnum::Shaders::PhongMaterialUniform>      materials;
+
+    osp::KeyedVec<osp::draw::DrawEnt, uint32_t>             drawSlot;
+
+    void create_uniform_buffers()
+    {
+        projectionBuffer    = Magnum::GL::Buffer{};
+        lightBuffer         = Magnum::GL::Buffer{};
+        transformBuffer     = Magnum::GL::Buffer{};
+        drawBuffer          = Magnum::GL::Buffer{};
+        materialBuffer      = Magnum::GL::Buffer{};
+    }
+
     constexpr void assign_pointers(osp::draw::ACtxSceneRender&   rScnRender,
                                    osp::draw::ACtxSceneRenderGL& rScnRenderGl,
                                    osp::draw::RenderGL&          rRenderGl) noexcept
@@ -61,14 +96,37 @@ struct ACtxDrawPhong
         pMeshId         = &rScnRenderGl .m_meshId;
         pTexGl          = &rRenderGl    .m_texGl;
         pMeshGl         = &rRenderGl    .m_meshGl;
+        pRenderGl       = &rRenderGl;
     }
 };
 
+/**
+ * @brief Write per-frame and per-draw uniform buffers for Phong shaders using UniformBuffers
+ *
+ * Lights and projection are uploaded once, and each DrawEnt to draw this frame is assigned a
+ * slot in the per-draw buffers, avoiding setting uniforms for every draw.
+ *
+ * @param rData         [ref] Phong shader data
+ * @param cmds          [in] Draw commands recorded this frame, only ones using this shader's
+ *                           material are read
+ * @param viewProj      [in] View and projection matrix
+ */
+void update_uniforms_phong(
+        ACtxDrawPhong&                       rData,
+        osp::draw::ACtxDrawCommands const&   cmds,
+        osp::draw::ViewProjMatrix const&     viewProj);
+
 void draw_ent_phong(
         osp::draw::DrawEnt                   ent,
         osp::draw::ViewProjMatrix const&     viewProj,
         osp::draw::EntityToDraw::UserData_t  userData) noexcept;
 
+void draw_ents_phong_instanced(
+        osp::draw::DrawEnt const*            pEnts,
+        std::size_t                          count,
+        osp::draw::ViewProjMatrix const&     viewProj,
+        osp::draw::EntityToDraw::UserData_t  userData) noexcept;
+
 struct ArgsForSyncDrawEntPhong
 {
     osp::draw::DrawEntSet_t const&              hasMaterial;
@@ -91,10 +149,17 @@ inline void sync_drawent_phong(osp::draw::DrawEnt ent, ArgsForSyncDrawEntPhong c
                      ? &args.rData.shaderDiffuse
                      : &args.rData.shaderUntextured;
 
+    PhongGL *pShaderInstanced = hasTexture
+                              ? &args.rData.shaderDiffuseInstanced
+                              : &args.rData.shaderUntexturedInstanced;
+
+    osp::draw::EntityToDraw const toDraw{&draw_ent_phong, {&args.rData, pShader, pShaderInstanced},
+                                         &draw_ents_phong_instanced};
+
     if (args.pStorageTransparent != nullptr)
     {
         auto value = (hasMaterial && args.transparent.test(entInt))
-                   ? std::make_optional(osp::draw::EntityToDraw{&draw_ent_phong, {&args.rData, pShader}})
+                   ? std::make_optional(toDraw)
                    : std::nullopt;
 
         osp::storage_assign(*args.pStorageTransparent, ent, std::move(value));
@@ -103,7 +168,7 @@ inline void sync_drawent_phong(osp::draw::DrawEnt ent, ArgsForSyncDrawEntPhong c
     if (args.pStorageOpaque != nullptr)
     {
         auto value = (hasMaterial && args.opaque.test(entInt))
-                   ? std::make_optional(osp::draw::EntityToDraw{&draw_ent_phong, {&args.rData, pShader}})
+                   ? std::make_optional(toDraw)
                    : std::nullopt;
 
         osp::storage_assign(*args.pStorageOpaque, ent, std::move(value));
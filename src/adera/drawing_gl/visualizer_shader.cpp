@@ -25,6 +25,8 @@
 
 #include "visualizer_shader.h"
 
+#include <osp/drawing/draw_commands_fn.h>
+
 #include <Magnum/GL/DefaultFramebuffer.h>
 #include <Magnum/GL/Renderer.h>
 
@@ -34,6 +36,87 @@ using namespace Magnum::Math::Literals;
 using namespace osp;
 using namespace osp::draw;
 
+using adera::shader::ACtxDrawMeshVisualizer;
+using adera::shader::MeshVisualizer;
+
+static void bind_uniforms(
+        MeshVisualizer& rShader, ACtxDrawMeshVisualizer& rData, std::size_t const chunk)
+{
+    using namespace Magnum::Shaders;
+
+    if ( ! SysRenderGL::claim_uniform_bindings(*rData.m_pRenderGl, &rData, chunk) )
+    {
+        return; // Already bound
+    }
+
+    rShader
+        .bindProjectionBuffer(rData.m_projectionBuffer)
+        .bindMaterialBuffer(rData.m_materialBuffer)
+        .bindTransformationBuffer(rData.m_transformBuffer,
+                                  SysRenderGL::draw_uniforms_offset<TransformationUniform3D>(chunk),
+                                  SysRenderGL::draw_uniforms_size<TransformationUniform3D>())
+        .bindDrawBuffer(rData.m_drawBuffer,
+                        SysRenderGL::draw_uniforms_offset<MeshVisualizerDrawUniform3D>(chunk),
+                        SysRenderGL::draw_uniforms_size<MeshVisualizerDrawUniform3D>());
+}
+
+void adera::shader::update_uniforms_visualizer(
+        ACtxDrawMeshVisualizer&     rData,
+        ACtxDrawCommands const&     cmds,
+        ViewProjMatrix const&       viewProj)
+{
+    using namespace Magnum::Shaders;
+    using Magnum::GL::BufferUsage;
+
+    if ( ! (rData.m_shader.flags() & MeshVisualizer::Flag::UniformBuffers) )
+    {
+        return;
+    }
+
+    // Per-frame uniforms
+    ProjectionUniform3D projection;
+    projection.setProjectionMatrix(viewProj.m_proj);
+    rData.m_projectionBuffer.setData(Corrade::Containers::arrayView(&projection, 1),
+                                     BufferUsage::StreamDraw);
+
+    MeshVisualizerMaterialUniform material;
+    material.setColor(rData.m_wireframeOnly ? 0x00000000_rgbaf : rData.m_color)
+            .setWireframeColor(rData.m_wireframeColor);
+    rData.m_materialBuffer.setData(Corrade::Containers::arrayView(&material, 1),
+                                   BufferUsage::StreamDraw);
+
+    // Per-draw uniforms, all share material 0
+    rData.m_transforms  .clear();
+    rData.m_draws       .clear();
+    rData.m_drawSlot    .assign(cmds.entToCmd.size(), gc_noDrawSlot);
+
+    auto const add_draw = [&rData] (Matrix4 const& transform, Matrix3 const& normal)
+    {
+        auto const slot = uint32_t(rData.m_transforms.size());
+
+        rData.m_transforms.emplace_back()
+            .setTransformationMatrix(transform);
+        rData.m_draws.emplace_back()
+            .setNormalMatrix(normal)
+            .setMaterialId(0);
+
+        return slot;
+    };
+
+    // Slot 0 is for instanced draws, which use view-relative transforms from the instance data
+    add_draw(Matrix4{}, Matrix3{});
+
+    SysDrawCommands::for_each_with_material(cmds, rData.m_materialId, [&] (DrawCommand const& cmd)
+    {
+        rData.m_drawSlot[cmd.ent] = add_draw(cmd.modelView, cmd.normalMatrix);
+    });
+
+    SysRenderGL::upload_draw_uniforms(rData.m_transformBuffer,  rData.m_transforms);
+    SysRenderGL::upload_draw_uniforms(rData.m_drawBuffer,       rData.m_draws);
+
+    SysRenderGL::reset_uniform_bindings(*rData.m_pRenderGl);
+}
+
 void adera::shader::draw_ent_visualizer(
         DrawEnt                     ent,
         ViewProjMatrix const&       viewProj,
@@ -45,30 +128,116 @@ void adera::shader::draw_ent_visualizer(
     assert(pData != nullptr);
     auto &rData = *reinterpret_cast<ACtxDrawMeshVisualizer*>(pData);
 
-    Matrix4 const&  drawTf      = (*rData.m_pDrawTf)[ent];
-    Matrix4 const   entRelative = viewProj.m_view * drawTf;
-
     MeshVisualizer &rShader = rData.m_shader;
 
-    if (rShader.flags() & MeshVisualizer::Flag::NormalDirection)
+    MeshGlId const      meshId = (*rData.m_pMeshId)[ent].m_glId;
+    Magnum::GL::Mesh    &rMesh = rData.m_pMeshGl->get(meshId);
+
+    if (rData.m_wireframeOnly)
     {
-        rShader.setNormalMatrix(entRelative.normalMatrix());
+        Magnum::GL::Renderer::setDepthMask(GL_FALSE);
+    }
+
+    rShader.setViewportSize(Vector2{Magnum::GL::defaultFramebuffer.viewport().size()});
+
+    if (rShader.flags() & MeshVisualizer::Flag::UniformBuffers)
+    {
+        // Everything else was already written by update_uniforms_visualizer. Ents that weren't
+        // given a slot this pass have nothing current to draw with.
+        uint32_t const slot = rData.m_drawSlot[ent];
+        if (slot != gc_noDrawSlot)
+        {
+            bind_uniforms(rShader, rData, slot / gc_drawUniformsPerChunk);
+            rShader.setDrawOffset(slot % gc_drawUniformsPerChunk)
+                   .draw(rMesh);
+        }
+    }
+    else
+    {
+        // Prefer what was already recorded
+        DrawCommand const *pCmd = (rData.m_pDrawCmds != nullptr)
+                                ? SysDrawCommands::find(*rData.m_pDrawCmds, ent) : nullptr;
+
+        Matrix4 const entRelative = (pCmd != nullptr)
+                                  ? pCmd->modelView
+                                  : viewProj.m_view * (*rData.m_pDrawTf)[ent];
+
+        if (rShader.flags() & MeshVisualizer::Flag::NormalDirection)
+        {
+            rShader.setNormalMatrix((pCmd != nullptr) ? pCmd->normalMatrix : entRelative.normalMatrix());
+        }
+
+        if (rData.m_wireframeOnly)
+        {
+            rShader.setColor(0x00000000_rgbaf);
+        }
+
+        rShader
+            .setTransformationMatrix(entRelative)
+            .setProjectionMatrix(viewProj.m_proj)
+            .draw(rMesh);
+    }
+
+    if (rData.m_wireframeOnly)
+    {
+        Magnum::GL::Renderer::setDepthMask(GL_TRUE);
+    }
+}
+
+void adera::shader::draw_ents_visualizer_instanced(
+        DrawEnt const*              pEnts,
+        std::size_t const           count,
+        ViewProjMatrix const&       viewProj,
+        EntityToDraw::UserData_t    userData) noexcept
+{
+    void* const pData = std::get<0>(userData);
+    assert(pData != nullptr);
+    assert(count != 0);
+    auto &rData = *reinterpret_cast<ACtxDrawMeshVisualizer*>(pData);
+    assert(rData.m_pDrawCmds != nullptr);
+
+    MeshVisualizer &rShader = rData.m_shaderInstanced;
+
+    std::vector<InstanceDataGL> &rInstances = rData.m_pRenderGl->m_instanceData;
+    rInstances.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        DrawCommand const &cmd = *SysDrawCommands::find(*rData.m_pDrawCmds, pEnts[i]);
+        rInstances[i] = { cmd.modelView, cmd.normalMatrix, Magnum::Color4{1.0f} };
     }
 
     if (rData.m_wireframeOnly)
     {
-        rShader.setColor(0x00000000_rgbaf);
         Magnum::GL::Renderer::setDepthMask(GL_FALSE);
     }
 
-    MeshGlId const      meshId = (*rData.m_pMeshId)[ent].m_glId;
-    Magnum::GL::Mesh    &rMesh = rData.m_pMeshGl->get(meshId);
+    rShader.setViewportSize(Vector2{Magnum::GL::defaultFramebuffer.viewport().size()});
 
-    rShader
-        .setViewportSize(Vector2{Magnum::GL::defaultFramebuffer.viewport().size()})
-        .setTransformationMatrix(entRelative)
-        .setProjectionMatrix(viewProj.m_proj)
-        .draw(rMesh);
+    if (rShader.flags() & MeshVisualizer::Flag::UniformBuffers)
+    {
+        bind_uniforms(rShader, rData, 0);
+        rShader.setDrawOffset(0);
+    }
+    else
+    {
+        if (rShader.flags() & MeshVisualizer::Flag::NormalDirection)
+        {
+            rShader.setNormalMatrix(Matrix3{});
+        }
+
+        if (rData.m_wireframeOnly)
+        {
+            rShader.setColor(0x00000000_rgbaf);
+        }
+
+        // Instance transforms are already view-relative
+        rShader
+            .setTransformationMatrix(Matrix4{})
+            .setProjectionMatrix(viewProj.m_proj);
+    }
+
+    MeshGlId const meshId = (*rData.m_pMeshId)[pEnts[0]].m_glId;
+    SysRenderGL::draw_instanced(*rData.m_pRenderGl, meshId, rShader);
 
     if (rData.m_wireframeOnly)
     {
@@ -24,8 +24,11 @@
  */
 #pragma once
 
+#include <osp/drawing/draw_commands.h>
 #include <osp/drawing_gl/rendergl.h>
 
+#include <Magnum/Shaders/Generic.h>
+#include <Magnum/Shaders/MeshVisualizer.h>
 #include <Magnum/Shaders/MeshVisualizerGL.h>
 
 namespace adera::shader
@@ -37,14 +40,45 @@ struct ACtxDrawMeshVisualizer
 {
     MeshVisualizer m_shader{Corrade::NoCreate};
 
+    // Same as above, but with the InstancedTransformation flag
+    MeshVisualizer m_shaderInstanced{Corrade::NoCreate};
+
     osp::draw::DrawTransforms_t         *m_pDrawTf{nullptr};
     osp::draw::MeshGlEntStorage_t       *m_pMeshId{nullptr};
     osp::draw::MeshGlStorage_t          *m_pMeshGl{nullptr};
+    osp::draw::RenderGL                 *m_pRenderGl{nullptr};
+
+    // Draw commands recorded this frame. Required for instanced draws. Without them, single draws
+    // calculate transforms from m_pDrawTf instead.
+    osp::draw::ACtxDrawCommands const   *m_pDrawCmds{nullptr};
 
     osp::draw::MaterialId               m_materialId { lgrn::id_null<osp::draw::MaterialId>() };
 
     bool m_wireframeOnly{false};
 
+    Magnum::Color4 m_color          {0.2f, 0.1f, 0.5f, 1.0f};
+    Magnum::Color4 m_wireframeColor {0.7f, 0.5f, 0.7f, 1.0f};
+
+    // Uniform buffers, only used if shaders are created with the UniformBuffers flag.
+    // Written once per frame by update_uniforms_visualizer. Draw slot 0 is used by instanced draws.
+    Magnum::GL::Buffer m_projectionBuffer   {Corrade::NoCreate};
+    Magnum::GL::Buffer m_materialBuffer     {Corrade::NoCreate};
+    Magnum::GL::Buffer m_transformBuffer    {Corrade::NoCreate};
+    Magnum::GL::Buffer m_drawBuffer         {Corrade::NoCreate};
+
+    std::vector<Magnum::Shaders::TransformationUniform3D>       m_transforms;
+    std::vector<Magnum::Shaders::MeshVisualizerDrawUniform3D>   m_draws;
+
+    osp::KeyedVec<osp::draw::DrawEnt, uint32_t>                 m_drawSlot;
+
+    void create_uniform_buffers()
+    {
+        m_projectionBuffer  = Magnum::GL::Buffer{};
+        m_materialBuffer    = Magnum::GL::Buffer{};
+        m_transformBuffer   = Magnum::GL::Buffer{};
+        m_drawBuffer        = Magnum::GL::Buffer{};
+    }
+
 constexpr void assign_pointers(osp::draw::ACtxSceneRender&      rScnRender,
                                osp::draw::ACtxSceneRenderGL&    rScnRenderGl,
                                osp::draw::RenderGL&             rRenderGl) noexcept
@@ -52,14 +86,35 @@ constexpr void assign_pointers(osp::draw::ACtxSceneRender&      rScnRender,
         m_pDrawTf   = &rScnRender.m_drawTransform;
         m_pMeshId   = &rScnRenderGl.m_meshId;
         m_pMeshGl   = &rRenderGl.m_meshGl;
+        m_pRenderGl = &rRenderGl;
     }
 };
 
+/**
+ * @brief Write per-frame and per-draw uniform buffers for MeshVisualizer shaders using
+ *        UniformBuffers
+ *
+ * @param rData         [ref] MeshVisualizer shader data
+ * @param cmds          [in] Draw commands recorded this frame, only ones using this shader's
+ *                           material are read
+ * @param viewProj      [in] View and projection matrix
+ */
+void update_uniforms_visualizer(
+        ACtxDrawMeshVisualizer&             rData,
+        osp::draw::ACtxDrawCommands const&  cmds,
+        osp::draw::ViewProjMatrix const&    viewProj);
+
 void draw_ent_visualizer(
         osp::draw::DrawEnt                  ent,
         osp::draw::ViewProjMatrix const&    viewProj,
         osp::draw::EntityToDraw::UserData_t userData) noexcept;
 
+void draw_ents_visualizer_instanced(
+        osp::draw::DrawEnt const*           pEnts,
+        std::size_t                         count,
+        osp::draw::ViewProjMatrix const&    viewProj,
+        osp::draw::EntityToDraw::UserData_t userData) noexcept;
+
 inline void sync_drawent_visualizer(
         osp::draw::DrawEnt const            ent,
         osp::draw::DrawEntSet_t const&      hasMaterial,
@@ -71,7 +126,8 @@ inline void sync_drawent_visualizer(
     {
         if ( ! alreadyAdded)
         {
-            rStorage.emplace( ent, osp::draw::EntityToDraw{&draw_ent_visualizer, {&rData} } );
+            rStorage.emplace( ent, osp::draw::EntityToDraw{&draw_ent_visualizer, {&rData},
+                                                           &draw_ents_visualizer_instanced} );
         }
     }
     else
@@ -24,6 +24,10 @@
  */
 #include "links.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+
 using namespace osp;
 
 using osp::link::MachTypeReg_t;
@@ -63,5 +67,84 @@ float thruster_influence(Vector3 const pos, Vector3 const dir, Vector3 const cmd
     return std::clamp(influence, 0.0f, 1.0f);
 }
 
+void RcsDriverBatch::resize(std::size_t const size)
+{
+    locals  .resize(size);
+    thrNodes.resize(size);
+    for (std::vector<float>* pVec : {&posX, &posY, &posZ, &dirX, &dirY, &dirZ,
+                                     &cmdLinX, &cmdLinY, &cmdLinZ, &cmdAngX, &cmdAngY, &cmdAngZ,
+                                     &thrOut})
+    {
+        pVec->resize(size);
+    }
+}
+
+void thruster_influence_batch(RcsDriverBatch& rBatch) noexcept
+{
+    // Results are first written to a local block that can't alias the inputs, otherwise the
+    // compiler needs too many run-time alias checks to vectorize the loop
+    constexpr std::size_t blockSize = 64;
+
+    std::size_t const count = rBatch.locals.size();
+
+    float const* const pPosX    = rBatch.posX.data();
+    float const* const pPosY    = rBatch.posY.data();
+    float const* const pPosZ    = rBatch.posZ.data();
+    float const* const pDirX    = rBatch.dirX.data();
+    float const* const pDirY    = rBatch.dirY.data();
+    float const* const pDirZ    = rBatch.dirZ.data();
+    float const* const pCmdLinX = rBatch.cmdLinX.data();
+    float const* const pCmdLinY = rBatch.cmdLinY.data();
+    float const* const pCmdLinZ = rBatch.cmdLinZ.data();
+    float const* const pCmdAngX = rBatch.cmdAngX.data();
+    float const* const pCmdAngY = rBatch.cmdAngY.data();
+    float const* const pCmdAngZ = rBatch.cmdAngZ.data();
+
+    for (std::size_t first = 0; first < count; first += blockSize)
+    {
+        std::size_t const blockCount = std::min(blockSize, count - first);
+        std::array<float, blockSize> block;
+
+        for (std::size_t j = 0; j < blockCount; ++j)
+        {
+            std::size_t const i = first + j;
+
+            // torque = cross(pos, dir)
+            float const torqueX = pPosY[i] * pDirZ[i] - pPosZ[i] * pDirY[i];
+            float const torqueY = pPosZ[i] * pDirX[i] - pPosX[i] * pDirZ[i];
+            float const torqueZ = pPosX[i] * pDirY[i] - pPosY[i] * pDirX[i];
+
+            float const torqueSq = torqueX * torqueX + torqueY * torqueY + torqueZ * torqueZ;
+            float const cmdAngSq = pCmdAngX[i] * pCmdAngX[i] + pCmdAngY[i] * pCmdAngY[i] + pCmdAngZ[i] * pCmdAngZ[i];
+            float const cmdLinSq = pCmdLinX[i] * pCmdLinX[i] + pCmdLinY[i] * pCmdLinY[i] + pCmdLinZ[i] * pCmdLinZ[i];
+
+            bool const angActive = cmdAngSq > 0.0f;
+            bool const linActive = cmdLinSq > 0.0f;
+
+            // Normalizing a zero torque gives NaN in thruster_influence, which results in 0
+            bool const degenerate = angActive & ! (torqueSq > 0.0f);
+
+            // Divide unconditionally and select afterwards, so the loop has no branches. Squared
+            // lengths that would be zero are substituted with 1.
+            float const angDot = torqueX * pCmdAngX[i] + torqueY * pCmdAngY[i] + torqueZ * pCmdAngZ[i];
+            float const angLen = std::sqrt(torqueSq > 0.0f ? torqueSq : 1.0f)
+                               * std::sqrt(angActive ? cmdAngSq : 1.0f);
+            float const linDot = pDirX[i] * pCmdLinX[i] + pDirY[i] * pCmdLinY[i] + pDirZ[i] * pCmdLinZ[i];
+            float const linLen = std::sqrt(linActive ? cmdLinSq : 1.0f);
+
+            float const angInfluence = angDot / angLen;
+            float const linInfluence = linDot / linLen;
+            float const influence    = (angActive ? angInfluence : 0.0f) + (linActive ? linInfluence : 0.0f);
+
+            // Also rejects NaN, as comparisons with NaN are false
+            bool const significant = ! degenerate & (influence >= 0.01f);
+
+            block[j] = significant ? std::min(influence, 1.0f) : 0.0f;
+        }
+
+        std::copy_n(block.begin(), blockCount, rBatch.thrOut.begin() + first);
+    }
+}
+
 
 } // namespace adera
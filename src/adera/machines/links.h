@@ -29,6 +29,8 @@
 #include <osp/link/machines.h>
 #include <osp/link/signal.h>
 
+#include <vector>
+
 namespace adera
 {
 
@@ -76,4 +78,33 @@ PortEntry const gc_throttleOut      { gc_ntSigFloat, 12, gc_sigOut };
 
 float thruster_influence(osp::Vector3 pos, osp::Vector3 dir, osp::Vector3 cmdLin, osp::Vector3 cmdAng) noexcept;
 
+/**
+ * @brief Inputs of a batch of RCS Drivers, gathered into separate arrays (SoA)
+ *
+ * Element i of each array belongs to the Machine locals[i]. Only dirty Machines are gathered, so
+ * thruster_influence_batch can run over contiguous arrays.
+ */
+struct RcsDriverBatch
+{
+    void resize(std::size_t size);
+
+    std::vector<osp::link::MachLocalId> locals;
+    std::vector<osp::link::NodeId>      thrNodes;
+
+    std::vector<float> posX,    posY,       posZ;
+    std::vector<float> dirX,    dirY,       dirZ;
+    std::vector<float> cmdLinX, cmdLinY,    cmdLinZ;
+    std::vector<float> cmdAngX, cmdAngY,    cmdAngZ;
+
+    std::vector<float> thrOut;
+};
+
+/**
+ * @brief Calculate thruster_influence for each Machine in a batch, writing into thrOut
+ *
+ * Written without branches so the compiler can vectorize it. Gives the same results as
+ * thruster_influence. rBatch must be resized to the number of Machines in the batch.
+ */
+void thruster_influence_batch(RcsDriverBatch& rBatch) noexcept;
+
 } // namespace adera
@@ -26,11 +26,25 @@
 
 #include "../core/strong_id.h"
 
-#include <cstdint> // for std::uint32_t
+#include <longeron/id_management/null.hpp>
+
+#include <cstdint> // for std::uint32_t, std::uint16_t
 
 namespace osp::active
 {
 
 using ActiveEnt = StrongId<std::uint32_t, struct DummyForActiveEnt>;
 
+/**
+ * @brief ActiveEnt paired with the generation it was created in
+ *
+ * ActiveEnt Ids are reused after deletion; compare with SysActiveEnt::is_current to detect stale
+ * references held by other systems or threads.
+ */
+struct ActiveEntRef
+{
+    ActiveEnt       ent         {lgrn::id_null<ActiveEnt>()};
+    std::uint16_t   generation  {0};
+};
+
 } // namespace osp::active
@@ -92,6 +92,12 @@ struct ACtxBasic
 {
     lgrn::IdRegistryStl<ActiveEnt>      m_activeIds;
 
+    /// Incremented each time an ActiveEnt is removed
+    KeyedVec<ActiveEnt, uint16_t>       m_activeGeneration;
+
+    /// Removed ActiveEnts still taken in m_activeIds, so they aren't reused within the same frame
+    ActiveEntVec_t                      m_activeIdsPendingFree;
+
     ACtxSceneGraph                      m_scnGraph;
     ACompTransformStorage_t             m_transform;
 };
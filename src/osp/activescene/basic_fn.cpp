@@ -49,6 +49,23 @@ SubtreeBuilder SubtreeBuilder::add_child(ActiveEnt ent, uint32_t descendantCount
     return {m_rScnGraph, ent, childFirst, childLast};
 }
 
+void SubtreeBuilder::add_tree(ArrayView<ActiveEnt const> ents, ArrayView<uint32_t const> descendants)
+{
+    assert(ents.size() == descendants.size());
+
+    std::size_t i = 0;
+    while (i < ents.size())
+    {
+        std::size_t const childFirst    = i + 1;
+        std::size_t const childLast     = childFirst + descendants[i];
+
+        SubtreeBuilder bldChild = add_child(ents[i], descendants[i]);
+        bldChild.add_tree(ents.slice(childFirst, childLast), descendants.slice(childFirst, childLast));
+
+        i = childLast;
+    }
+}
+
 SubtreeBuilder SysSceneGraph::add_descendants(ACtxSceneGraph& rScnGraph, uint32_t descendantCount, ActiveEnt root)
 {
     TreePos_t const rootPos         = (root == lgrn::id_null<ActiveEnt>())
@@ -210,3 +227,32 @@ void SysSceneGraph::do_delete(ACtxSceneGraph& rScnGraph)
 
     rScnGraph.m_delete.clear();
 }
+
+void SysActiveEnt::remove(ACtxBasic& rBasic, ActiveEnt const ent)
+{
+    if ( ! rBasic.m_activeIds.exists(ent) )
+    {
+        return;
+    }
+
+    std::size_t const capacity = rBasic.m_activeIds.capacity();
+    if (rBasic.m_activeGeneration.size() < capacity)
+    {
+        rBasic.m_activeGeneration.resize(capacity, 0);
+    }
+
+    ++rBasic.m_activeGeneration[ent];
+    rBasic.m_activeIdsPendingFree.push_back(ent);
+}
+
+void SysActiveEnt::release_pending(ACtxBasic& rBasic)
+{
+    for (ActiveEnt const ent : rBasic.m_activeIdsPendingFree)
+    {
+        if (rBasic.m_activeIds.exists(ent)) // in case remove() was called twice
+        {
+            rBasic.m_activeIds.remove(ent);
+        }
+    }
+    rBasic.m_activeIdsPendingFree.clear();
+}
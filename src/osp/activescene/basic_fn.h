@@ -65,6 +65,14 @@ public:
         (void) add_child(ent, 0);
     }
 
+    /**
+     * @brief Add entities in tree order, given the number of descendants of each
+     *
+     * @param ents          [in] Entities to add. May hold multiple sibling subtrees
+     * @param descendants   [in] Descendant count of each entity in ents
+     */
+    void add_tree(ArrayView<ActiveEnt const> ents, ArrayView<uint32_t const> descendants);
+
     std::size_t remaining()
     {
         assert(m_last >= m_first);
@@ -124,6 +132,58 @@ private:
 
 using ChildRange_t = lgrn::IteratorPair<ChildIterator, ChildIterator>;
 
+/**
+ * @brief Deferred removal and generation checks for ActiveEnt Ids
+ *
+ * Removed ActiveEnts get their generation bumped right away, but their Ids are only released back
+ * to ACtxBasic::m_activeIds on the next call to release_pending. Ids deleted in one frame are never
+ * handed out again in that same frame, while other pipelines may still hold them.
+ */
+class SysActiveEnt
+{
+public:
+
+    /**
+     * @brief Mark an ActiveEnt as removed and queue its Id to be released
+     *
+     * Does nothing if the ActiveEnt doesn't exist.
+     */
+    static void remove(ACtxBasic& rBasic, ActiveEnt ent);
+
+    /**
+     * @brief Release Ids queued by remove() back to ACtxBasic::m_activeIds for reuse
+     *
+     * Call once per frame, only after everything that could have used the removed Ids is done.
+     */
+    static void release_pending(ACtxBasic& rBasic);
+
+    [[nodiscard]] static ActiveEntRef active_ent_ref(ACtxBasic const& basic, ActiveEnt ent) noexcept
+    {
+        return { ent, generation(basic, ent) };
+    }
+
+    /**
+     * @return true if ref's ActiveEnt exists and wasn't removed since the ref was made
+     */
+    [[nodiscard]] static bool is_current(ACtxBasic const& basic, ActiveEntRef ref) noexcept
+    {
+        return    ref.ent != lgrn::id_null<ActiveEnt>()
+               && basic.m_activeIds.exists(ref.ent)
+               && generation(basic, ref.ent) == ref.generation;
+    }
+
+private:
+
+    [[nodiscard]] static uint16_t generation(ACtxBasic const& basic, ActiveEnt const ent) noexcept
+    {
+        // m_activeGeneration is only resized when ActiveEnts are removed, as Ids past its end
+        // were never removed
+        return (std::size_t(ent) < basic.m_activeGeneration.size())
+             ? basic.m_activeGeneration[ent] : uint16_t(0);
+    }
+
+}; // class SysActiveEnt
+
 class SysSceneGraph
 {
 public:
@@ -31,26 +31,104 @@
 #include <Magnum/Trade/Trade.h>
 #include <Magnum/Trade/PbrMetallicRoughnessMaterialData.h>
 
+#include <Corrade/Containers/ArrayViewStl.h>
+
 using Corrade::Containers::ArrayView;
+using Corrade::Containers::arrayView;
 
 using osp::restypes::gc_importer;
 
 namespace osp::active
 {
 
+std::size_t SysPrefabInit::get_or_make_template(
+        ACtxPrefabs&                        rPrefabs,
+        Resources&                          rResources,
+        ResId const                         importer,
+        PrefabId const                      prefab)
+{
+    uint64_t const key = (uint64_t(importer) << 32) | uint64_t(prefab);
+
+    auto const [itIndex, inserted] = rPrefabs.templateIndex.try_emplace(key, rPrefabs.templates.size());
+    if ( ! inserted )
+    {
+        return itIndex->second;
+    }
+
+    auto const &rImportData = rResources.data_get<osp::ImporterData>(gc_importer, importer);
+    auto const &rPrefabData = rResources.data_get<osp::Prefabs>(gc_importer, importer);
+
+    auto const objects = rPrefabData.m_prefabs[prefab];
+    auto const parents = rPrefabData.m_prefabParents[prefab];
+    std::size_t const objCount = objects.size();
+
+    PrefabTemplate &rTmpl = rPrefabs.templates.emplace_back();
+    rTmpl.importer  = importer;
+    rTmpl.prefab    = prefab;
+    rTmpl.transforms    .resize(objCount);
+    rTmpl.parents       .assign(parents.begin(), parents.end());
+    rTmpl.descendants   .resize(objCount);
+    rTmpl.shapes        .resize(objCount);
+    rTmpl.masses        .resize(objCount);
+    rTmpl.inertias      .resize(objCount, Vector3{0.0f});
+    rTmpl.hasColliders  .resize(objCount, false);
+
+    for (std::size_t i = 0; i < objCount; ++i)
+    {
+        ObjId const obj = objects[i];
+
+        rTmpl.transforms[i]     = rImportData.m_objTransforms[obj];
+        rTmpl.descendants[i]    = uint32_t(rImportData.m_objDescendants[obj]);
+        rTmpl.shapes[i]         = rPrefabData.m_objShape[obj];
+        rTmpl.masses[i]         = rPrefabData.m_objMass[obj];
+
+        if (rTmpl.masses[i] != 0.0f)
+        {
+            Vector3 const scale = rTmpl.transforms[i].scaling();
+            rTmpl.inertias[i] = collider_inertia_tensor(rTmpl.shapes[i], scale, rTmpl.masses[i]);
+        }
+    }
+
+    // Parents always come before their children, so a single reverse pass propagates
+    // hasColliders to all ancestors
+    for (std::size_t i = objCount; i-- != 0; )
+    {
+        if ( (rTmpl.masses[i] != 0.0f) || (rTmpl.shapes[i] != EShape::None) )
+        {
+            rTmpl.hasColliders[i] = true;
+        }
+
+        if (rTmpl.hasColliders[i] && rTmpl.parents[i] != -1)
+        {
+            rTmpl.hasColliders[std::size_t(rTmpl.parents[i])] = true;
+        }
+    }
+
+    return itIndex->second;
+}
+
+void SysPrefabInit::clear_templates(ACtxPrefabs& rPrefabs) noexcept
+{
+    rPrefabs.templates.clear();
+    rPrefabs.templateIndex.clear();
+}
+
 void SysPrefabInit::create_activeents(
         ACtxPrefabs&                        rPrefabs,
         ACtxBasic&                          rBasic,
         Resources&                          rResources)
 {
-    // Count number of entities needed to be created
+    // Find templates and count number of entities needed to be created
+    rPrefabs.spawnedTemplates.resize(rPrefabs.spawnRequest.size());
+
     std::size_t totalEnts = 0;
-    for (TmpPrefabRequest const& rPfBasic : rPrefabs.spawnRequest)
+    for (std::size_t i = 0; i < rPrefabs.spawnRequest.size(); ++i)
     {
-        auto const& rPrefabData = rResources.data_get<Prefabs>(gc_importer, rPfBasic.m_importerRes);
-        auto const& objects     = rPrefabData.m_prefabs[rPfBasic.m_prefabId];
+        TmpPrefabRequest const& request = rPrefabs.spawnRequest[i];
+        std::size_t const tmplIndex = get_or_make_template(rPrefabs, rResources, request.m_importerRes, request.m_prefabId);
 
-        totalEnts += objects.size();
+        rPrefabs.spawnedTemplates[i] = tmplIndex;
+        totalEnts += rPrefabs.templates[tmplIndex].parents.size();
     }
 
     // Create entities
@@ -61,14 +139,13 @@ void SysPrefabInit::create_activeents(
     rPrefabs.spawnedEntsOffset.resize(rPrefabs.spawnRequest.size());
     auto itEntAvailable = std::begin(rPrefabs.newEnts);
     auto itPfEntSpanOut = std::begin(rPrefabs.spawnedEntsOffset);
-    for (TmpPrefabRequest& rPfBasic : rPrefabs.spawnRequest)
+    for (std::size_t const tmplIndex : rPrefabs.spawnedTemplates)
     {
-        auto const& rPrefabData = rResources.data_get<Prefabs>(gc_importer, rPfBasic.m_importerRes);
-        auto const& objects     = rPrefabData.m_prefabs[rPfBasic.m_prefabId];
+        std::size_t const objCount = rPrefabs.templates[tmplIndex].parents.size();
 
-        (*itPfEntSpanOut) = { &(*itEntAvailable), objects.size() };
+        (*itPfEntSpanOut) = { &(*itEntAvailable), objCount };
 
-        std::advance(itEntAvailable, objects.size());
+        std::advance(itEntAvailable, objCount);
         std::advance(itPfEntSpanOut, 1);
     }
 
@@ -76,193 +153,87 @@ void SysPrefabInit::create_activeents(
 }
 
 void SysPrefabInit::add_to_subtree(
-        TmpPrefabRequest const&             basic,
+        PrefabTemplate const&               tmpl,
         ArrayView<ActiveEnt const>          ents,
-        Resources const&                    rResources,
         SubtreeBuilder&                     bldPrefab) noexcept
 {
-    auto const &rImportData = rResources.data_get<osp::ImporterData const>(
-            gc_importer, basic.m_importerRes);
-    auto const &rPrefabData = rResources.data_get<osp::Prefabs const>(
-            gc_importer, basic.m_importerRes);
-
-    auto const& objs    = rPrefabData.m_prefabs[basic.m_prefabId];
-    auto const& parents = rPrefabData.m_prefabParents[basic.m_prefabId];
-
-    auto itObj      = std::begin(objs);
-    auto itEnt      = std::begin(ents);
-
-    auto const add_child_recurse
-            = [&rImportData, &itObj, &itEnt, &parents] (auto&& self, SubtreeBuilder& bldParent) -> void
-    {
-        std::size_t const descendants   = rImportData.m_objDescendants[*itObj];
-        auto bldChildren = bldParent.add_child(*itEnt, descendants);
-        auto children = rImportData.m_objChildren[*itObj];
-
-        std::advance(itObj, 1);
-        std::advance(itEnt, 1);
+    assert(ents.size() == tmpl.descendants.size());
 
-        for ([[maybe_unused]] ObjId const child : children)
-        {
-            self(self, bldChildren);
-        }
-    };
-
-    add_child_recurse(add_child_recurse, bldPrefab);
-
-    assert(itObj == std::end(objs));
-    assert(itEnt == std::end(ents));
+    bldPrefab.add_tree(ents, arrayView(tmpl.descendants));
 }
 
 void SysPrefabInit::init_transforms(
         ACtxPrefabs const&                  rPrefabs,
-        Resources const&                    rResources,
         ACompTransformStorage_t&            rTransform) noexcept
 {
-    auto itPfEnts = rPrefabs.spawnedEntsOffset.begin();
-
-    for (TmpPrefabRequest const& rPfBasic : rPrefabs.spawnRequest)
+    for (std::size_t i = 0; i < rPrefabs.spawnRequest.size(); ++i)
     {
-        auto const &rImportData = rResources.data_get<osp::ImporterData const>(
-                gc_importer, rPfBasic.m_importerRes);
-        auto const &rPrefabData = rResources.data_get<osp::Prefabs const>(
-                gc_importer, rPfBasic.m_importerRes);
+        TmpPrefabRequest const&     request = rPrefabs.spawnRequest[i];
+        PrefabTemplate const&       tmpl    = rPrefabs.templates[rPrefabs.spawnedTemplates[i]];
+        ArrayView<ActiveEnt const>  ents    = rPrefabs.spawnedEntsOffset[i];
 
-        auto const objects = rPrefabData.m_prefabs[rPfBasic.m_prefabId];
-        auto const parents = rPrefabData.m_prefabParents[rPfBasic.m_prefabId];
-
-        for (std::size_t i = 0; i < objects.size(); ++i)
+        for (std::size_t j = 0; j < ents.size(); ++j)
         {
-            Matrix4 const& transform = (parents[i] == -1)
-                    ? *rPfBasic.m_pTransform
-                    : rImportData.m_objTransforms[objects[i]];
-            ActiveEnt const ent = (*itPfEnts)[i];
-            rTransform.emplace(ent, transform);
+            Matrix4 const& transform = (tmpl.parents[j] == -1)
+                    ? *request.m_pTransform
+                    : tmpl.transforms[j];
+            rTransform.emplace(ents[j], transform);
         }
-
-        ++itPfEnts;
     }
 }
 
 void SysPrefabInit::init_info(
-            ACtxPrefabs&                    rPrefabs,
-            Resources const&                rResources) noexcept
+            ACtxPrefabs&                    rPrefabs) noexcept
 {
-    auto itPfEnts = rPrefabs.spawnedEntsOffset.begin();
-
-    for (TmpPrefabRequest const& rPfBasic : rPrefabs.spawnRequest)
+    for (std::size_t i = 0; i < rPrefabs.spawnRequest.size(); ++i)
     {
-        auto const &rImportData = rResources.data_get<osp::ImporterData const>(
-                gc_importer, rPfBasic.m_importerRes);
-        auto const &rPrefabData = rResources.data_get<osp::Prefabs const>(
-                gc_importer, rPfBasic.m_importerRes);
-
-        auto const ents     = ArrayView<ActiveEnt const>{*itPfEnts};
-        auto const objects = rPrefabData.m_prefabs[rPfBasic.m_prefabId];
-        auto const parents = rPrefabData.m_prefabParents[rPfBasic.m_prefabId];
+        TmpPrefabRequest const&     request = rPrefabs.spawnRequest[i];
+        PrefabTemplate const&       tmpl    = rPrefabs.templates[rPrefabs.spawnedTemplates[i]];
+        ArrayView<ActiveEnt const>  ents    = rPrefabs.spawnedEntsOffset[i];
 
-        for (std::size_t i = 0; i < objects.size(); ++i)
+        for (std::size_t j = 0; j < ents.size(); ++j)
         {
-            ActiveEnt const ent = ents[i];
+            ActiveEnt const ent = ents[j];
             PrefabInstanceInfo &rInfo = rPrefabs.instanceInfo[ent];
-            rInfo.importer  = rPfBasic.m_importerRes;
-            rInfo.prefab    = rPfBasic.m_prefabId;
-            rInfo.obj       = static_cast<ObjId>(i);
+            rInfo.importer  = request.m_importerRes;
+            rInfo.prefab    = request.m_prefabId;
+            rInfo.obj       = static_cast<ObjId>(j);
 
-            if (parents[i] == -1)
+            if (tmpl.parents[j] == -1)
             {
                 rPrefabs.roots.set(std::size_t(ent));
             }
         }
-
-        ++itPfEnts;
     }
 }
 
 void SysPrefabInit::init_physics(
             ACtxPrefabs const&              rPrefabs,
-            Resources const&                rResources,
             ACtxPhysics&                    rCtxPhys) noexcept
 {
-
-    auto itPfEnts = rPrefabs.spawnedEntsOffset.begin();
-
-    for (TmpPrefabRequest const& rPfBasic : rPrefabs.spawnRequest)
+    for (std::size_t i = 0; i < rPrefabs.spawnRequest.size(); ++i)
     {
-        auto const &rImportData = rResources.data_get<osp::ImporterData const>(
-                gc_importer, rPfBasic.m_importerRes);
-        auto const &rPrefabData = rResources.data_get<osp::Prefabs const>(
-                gc_importer, rPfBasic.m_importerRes);
-
-        auto const ents     = ArrayView<ActiveEnt const>{*itPfEnts};
-        auto const objects  = lgrn::Span<int const>     {rPrefabData.m_prefabs[rPfBasic.m_prefabId]};
-        auto const parents  = lgrn::Span<int const>     {rPrefabData.m_prefabParents[rPfBasic.m_prefabId]};
+        PrefabTemplate const&       tmpl    = rPrefabs.templates[rPrefabs.spawnedTemplates[i]];
+        ArrayView<ActiveEnt const>  ents    = rPrefabs.spawnedEntsOffset[i];
 
-#if 0
-        auto const assign_dyn_recurse = [&rCtxPhys, ents, objects, parents] (auto const& self, int objectId, ActiveEnt ent) -> void
+        for (std::size_t j = 0; j < ents.size(); ++j)
         {
-            int const parentId = parents[objectId];
-            if (parentId == -1)
-            {
-                return;
-            }
+            ActiveEnt const ent     = ents[j];
+            float const     mass    = tmpl.masses[j];
 
-            ActiveEnt const parentEnt = ents[parentId];
-
-            if ( ! rCtxPhys.m_totalDyn.contains(parentEnt) )
-            {
-                rCtxPhys.m_totalDyn.emplace(parentEnt);
-            }
-
-            self(self, parentId, parentEnt);
-        };
-#endif
-
-        auto const assign_collider_recurse
-                = [&rHasColliders = rCtxPhys.m_hasColliders, ents, objects, parents]
-                  (auto const& self, int objectId, ActiveEnt ent) -> void
-        {
-            if (rHasColliders.test(std::size_t(ent)))
-            {
-                return; // HasColliders bit already set, this means all ancestors have it set too
-            }
-            rHasColliders.set(std::size_t(ent));
-
-            int const parentId = parents[objectId];
-
-            if (parentId != -1)
-            {
-                self(self, parentId, ents[parentId]);
-            }
-        };
-
-        for (std::size_t i = 0; i < objects.size(); ++i)
-        {
-            ActiveEnt const ent         = ents[i];
-            int const       objectId    = objects[i];
-            float const     mass        = rPrefabData.m_objMass[objectId];
-            EShape const    shape       = rPrefabData.m_objShape[objectId];
-
-
-            rCtxPhys.m_shape[ent] = shape;
+            rCtxPhys.m_shape[ent] = tmpl.shapes[j];
 
             if (mass != 0.0f)
             {
-                Vector3 const scale = rImportData.m_objTransforms[objectId].scaling();
-                Vector3 const inertia = collider_inertia_tensor(shape, scale, mass);
                 Vector3 const offset{0.0f, 0.0f, 0.0f};
-                rCtxPhys.m_mass.emplace( ent, ACompMass{ offset, inertia, mass } );
-
-                //assign_dyn_recurse(assign_dyn_recurse, objectId, ent);
+                rCtxPhys.m_mass.emplace( ent, ACompMass{ offset, tmpl.inertias[j], mass } );
             }
 
-            if ( (mass != 0.0f) || (shape != EShape::None) )
+            if (tmpl.hasColliders[j])
             {
-                assign_collider_recurse(assign_collider_recurse, objectId, ent);
+                rCtxPhys.m_hasColliders.set(std::size_t(ent));
             }
         }
-
-        std::advance(itPfEnts, 1);
     }
 }
 
@@ -31,6 +31,8 @@
 #include "../core/resourcetypes.h"
 #include "../vehicles/prefabs.h"
 
+#include <entt/container/dense_map.hpp>
+
 #include <optional>
 #include <vector>
 
@@ -60,43 +62,93 @@ struct PrefabInstanceInfo
     ObjId       obj         { lgrn::id_null<ObjId>() };
 };
 
+/**
+ * @brief A prefab's objects flattened into arrays, made once and copied into every instance
+ *
+ * All arrays are in the same pre-order as Prefabs::m_prefabs, so index i of each refers to
+ * the same object.
+ */
+/**
+ * @brief Data copied out of an importer's prefab, ready to be spawned many times
+ *
+ * Templates don't own their importer; everything needed to spawn is copied in, so the importer
+ * may be unloaded afterwards. ResIds can be reused though, so ACtxPrefabs::templateIndex must be
+ * cleared with SysPrefabInit::clear_templates if an importer is unloaded mid-scene.
+ */
+struct PrefabTemplate
+{
+    ResId                   importer        {lgrn::id_null<ResId>()};   ///< Non-owning, only used as a key
+    PrefabId                prefab          {lgrn::id_null<PrefabId>()};
+
+    std::vector<Matrix4>    transforms;     ///< Relative to parent. Roots use the request's instead
+    std::vector<int32_t>    parents;        ///< Index of parent object, or -1 for root
+    std::vector<uint32_t>   descendants;
+    std::vector<EShape>     shapes;
+    std::vector<float>      masses;
+    std::vector<Vector3>    inertias;       ///< Only meaningful for objects with mass
+    std::vector<bool>       hasColliders;   ///< Object or any of its descendants has mass or shape
+};
+
 struct ACtxPrefabs
 {
     std::vector<TmpPrefabRequest>               spawnRequest;
     std::vector< ArrayView<ActiveEnt const> >   spawnedEntsOffset;
+    std::vector<std::size_t>                    spawnedTemplates;   ///< Index of template used by each spawnRequest
     std::vector<ActiveEnt>                      newEnts;
 
     osp::active::ActiveEntSet_t                 roots;
     KeyedVec<ActiveEnt, PrefabInstanceInfo>     instanceInfo;
+
+    std::vector<PrefabTemplate>                 templates;
+    entt::dense_map<uint64_t, std::size_t>      templateIndex;      ///< (ResId << 32 | PrefabId) -> templates index
 };
 
 class SysPrefabInit
 {
 public:
 
+    /**
+     * @brief Get the template of a prefab, making it from the importer's data if it doesn't
+     *        exist yet
+     *
+     * @return Index into ACtxPrefabs::templates
+     */
+    static std::size_t get_or_make_template(
+            ACtxPrefabs&                rPrefabs,
+            Resources&                  rResources,
+            ResId                       importer,
+            PrefabId                    prefab);
+
+    /**
+     * @brief Remove all templates, invalidating indices returned by get_or_make_template
+     */
+    static void clear_templates(ACtxPrefabs& rPrefabs) noexcept;
+
+    /**
+     * @brief Create ActiveEnts for all spawnRequests, and find their templates
+     *
+     * Entities of all requests are created in a single call. The following init_* functions
+     * only read templates found here, and don't need Resources.
+     */
     static void create_activeents(
             ACtxPrefabs&                rPrefabs,
             ACtxBasic&                  rBasic,
             Resources&                  rResources);
 
     static void add_to_subtree(
-            TmpPrefabRequest const&     basic,
+            PrefabTemplate const&       tmpl,
             ArrayView<ActiveEnt const>  ents,
-            Resources const&            rResources,
             SubtreeBuilder&             rSubtree) noexcept;
 
     static void init_transforms(
             ACtxPrefabs const&          rPrefabs,
-            Resources const&            rResources,
             ACompTransformStorage_t&    rTransform) noexcept;
 
     static void init_info(
-            ACtxPrefabs&                rPrefabs,
-            Resources const&            rResources) noexcept;
+            ACtxPrefabs&                rPrefabs) noexcept;
 
     static void init_physics(
             ACtxPrefabs const&          rPrefabs,
-            Resources const&            rResources,
             ACtxPhysics&                rCtxPhys) noexcept;
 
 };
@@ -47,6 +47,16 @@ struct ACtxParts
 {
     using MapPartToMachines_t = lgrn::IntArrayMultiMap<PartId, link::MachinePair>;
 
+    /**
+     * @brief Request to move parts out of their weld and into a new one, see SysParts::split_weld
+     */
+    struct WeldSplit
+    {
+        std::vector<PartId> parts;                              ///< All from the same weld
+        WeldId              oldWeld{lgrn::id_null<WeldId>()};   ///< Set once split
+        WeldId              newWeld{lgrn::id_null<WeldId>()};   ///< Set once split, null if nothing was split
+    };
+
     lgrn::IdRegistryStl<PartId>                     partIds;
     KeyedVec<PartId, PrefabPair>                    partPrefabs;
     KeyedVec<PartId, Matrix4>                       partTransformWeld;    ///< Part's transform relative to the weld it's part of
@@ -57,6 +67,7 @@ struct ACtxParts
 
     link::Machines                                  machines;
     KeyedVec<link::NodeTypeId, link::Nodes>         nodePerType;
+    KeyedVec<link::NodeTypeId, link::CompiledNodes> nodeCompiledPerType;  ///< Flat copy of nodePerType for update loops
 
     lgrn::IntArrayMultiMap<WeldId, PartId>          weldToParts;
     KeyedVec<PartId, WeldId>                        partToWeld;
@@ -64,10 +75,12 @@ struct ACtxParts
     MapPartToMachines_t                             partToMachines;
     KeyedVec<link::MachAnyId, PartId>               machineToPart;
 
-    KeyedVec<PartId, ActiveEnt>                     partToActive;
+    KeyedVec<PartId, ActiveEntRef>                  partToActive;   ///< Check with SysActiveEnt::is_current
     KeyedVec<ActiveEnt, PartId>                     activeToPart;
 
     KeyedVec<WeldId, ActiveEnt>                     weldToActive;
+
+    std::vector<WeldSplit>                          weldSplitRequest;
 };
 
 
@@ -104,6 +117,7 @@ struct ACtxVehicleSpawn
     KeyedVec<SpWeldId, ActiveEnt>           rootEnts;
 
     KeyedVec<SpMachAnyId, link::MachAnyId>  spawnedMachs;
+    KeyedVec<SpVehicleId, SpMachAnyId>      spawnedMachOffsets;
 };
 
 } // namespace osp::active
@@ -0,0 +1,138 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "vehicles_fn.h"
+#include "basic_fn.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using namespace osp;
+using namespace osp::active;
+
+using Corrade::Containers::arrayView;
+
+WeldId SysParts::split_weld(ACtxParts& rScnParts, ArrayView<PartId const> parts)
+{
+    if (parts.isEmpty())
+    {
+        return lgrn::id_null<WeldId>();
+    }
+
+    WeldId const oldWeld = rScnParts.partToWeld[parts.front()];
+
+    // Parts left behind in the old weld
+    std::vector<PartId> remaining;
+    remaining.reserve(rScnParts.weldToParts[oldWeld].size());
+    for (PartId const part : rScnParts.weldToParts[oldWeld])
+    {
+        if (std::find(parts.begin(), parts.end(), part) == parts.end())
+        {
+            remaining.push_back(part);
+        }
+    }
+
+    LGRN_ASSERTM(remaining.size() + parts.size() == rScnParts.weldToParts[oldWeld].size(),
+                 "Parts to split must all be from the same weld");
+
+    if (remaining.empty())
+    {
+        return lgrn::id_null<WeldId>(); // Weld would be left empty
+    }
+
+    WeldId const newWeld = rScnParts.weldIds.create();
+
+    std::size_t const maxWelds = rScnParts.weldIds.capacity();
+    rScnParts.weldToActive.resize(maxWelds, lgrn::id_null<ActiveEnt>());
+    rScnParts.weldToParts.ids_reserve(maxWelds);
+    rScnParts.weldToParts.data_reserve(rScnParts.weldToParts.data_size() + parts.size() + remaining.size());
+
+    rScnParts.weldToParts.erase(oldWeld);
+
+    PartId *pRemaining = rScnParts.weldToParts.emplace(oldWeld, remaining.size());
+    std::copy(remaining.begin(), remaining.end(), pRemaining);
+
+    PartId *pSplit = rScnParts.weldToParts.emplace(newWeld, parts.size());
+    std::copy(parts.begin(), parts.end(), pSplit);
+
+    for (PartId const part : parts)
+    {
+        rScnParts.partToWeld[part] = newWeld;
+    }
+
+    rScnParts.weldDirty.push_back(oldWeld);
+    rScnParts.weldDirty.push_back(newWeld);
+
+    return newWeld;
+}
+
+void SysParts::move_weld_to_new_root(ACtxParts& rScnParts, ACtxBasic& rBasic, WeldId weld, ActiveEnt oldRoot, ActiveEnt newRoot)
+{
+    ACtxSceneGraph &rScnGraph = rBasic.m_scnGraph;
+
+    auto const partEnts = [&rScnParts, &rBasic] (PartId const part)
+    {
+        ActiveEntRef const ref = rScnParts.partToActive[part];
+        LGRN_ASSERTM(SysActiveEnt::is_current(rBasic, ref), "Part's ActiveEnt was deleted");
+        return ref.ent;
+    };
+
+    auto const weldParts = rScnParts.weldToParts[weld];
+
+    // Copy subtrees of each part entity, including descendant counts, before they're cut
+    std::vector<ActiveEnt>  ents;
+    std::vector<uint32_t>   descendants;
+    for (PartId const part : weldParts)
+    {
+        TreePos_t const first = rScnGraph.m_entToTreePos[partEnts(part)];
+        TreePos_t const last  = first + 1 + rScnGraph.m_treeDescendants[first];
+
+        ents       .insert(ents.end(),        rScnGraph.m_treeToEnt.begin()       + first, rScnGraph.m_treeToEnt.begin()       + last);
+        descendants.insert(descendants.end(), rScnGraph.m_treeDescendants.begin() + first, rScnGraph.m_treeDescendants.begin() + last);
+    }
+
+    std::vector<ActiveEnt> roots;
+    roots.reserve(weldParts.size());
+    std::transform(weldParts.begin(), weldParts.end(), std::back_inserter(roots), partEnts);
+
+    SysSceneGraph::cut(rScnGraph, roots.begin(), roots.end());
+
+    // Re-add them under newRoot, which has the same transform as the old root. Part entity
+    // transforms are relative to their root, so they don't need to change.
+    Matrix4 const rootTf = rBasic.m_transform.get(oldRoot).m_transform;
+    rBasic.m_transform.emplace(newRoot, rootTf);
+
+    auto const entCount = uint32_t(ents.size());
+
+    SubtreeBuilder bldRoot = SysSceneGraph::add_descendants(rScnGraph, entCount + 1);
+    SubtreeBuilder bldWeld = bldRoot.add_child(newRoot, entCount);
+
+    bldWeld.add_tree(arrayView(std::as_const(ents)), arrayView(std::as_const(descendants)));
+
+    rScnParts.weldToActive[weld] = newRoot;
+}
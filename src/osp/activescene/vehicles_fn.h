@@ -0,0 +1,72 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "basic.h"
+#include "vehicles.h"
+
+#include "../core/array_view.h"
+
+namespace osp::active
+{
+
+class SysParts
+{
+public:
+
+    /**
+     * @brief Move parts out of their weld and into a newly created weld
+     *
+     * All parts must be from the same weld. Both welds are added to weldDirty. weldToActive of
+     * the new weld is left null, see move_weld_to_new_root.
+     *
+     * Nothing is changed if parts is empty, or if it holds every part of its weld (such as the
+     * only part of a single-part weld), as there would be nothing to split off.
+     *
+     * @param rScnParts [ref] Parts and welds to modify
+     * @param parts     [in] Parts to move into the new weld
+     *
+     * @return New WeldId, or null if nothing was split
+     */
+    static WeldId split_weld(ACtxParts& rScnParts, ArrayView<PartId const> parts);
+
+    /**
+     * @brief Move the part entities of a weld under a new root entity
+     *
+     * Part entities and their descendants are reused and keep their transforms, as newRoot is
+     * given the same transform as the weld's old root. Cost is linear to the number of moved
+     * entities and the size of the scene graph.
+     *
+     * @param rScnParts [ref] Parts, weldToActive[weld] is set to newRoot
+     * @param rBasic    [ref] Scene graph and transforms, must be resized to fit newRoot
+     * @param weld      [in] Weld to move, such as one returned by split_weld
+     * @param oldRoot   [in] Root entity that weld's part entities are currently children of
+     * @param newRoot   [in] New entity without a parent, children, or transform
+     */
+    static void move_weld_to_new_root(ACtxParts& rScnParts, ACtxBasic& rBasic, WeldId weld, ActiveEnt oldRoot, ActiveEnt newRoot);
+
+}; // class SysParts
+
+} // namespace osp::active
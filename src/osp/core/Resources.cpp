@@ -24,10 +24,14 @@
  */
 #include "Resources.h"
 
+#include <atomic>
+
 using namespace osp;
 
 ResId Resources::create(ResTypeId const typeId, PkgId const pkgId, SharedString name)
 {
+    assert( ! m_concurrentRead );
+
     // Create ResId associated to specified ResTypeId
     PerResType &rPerResType = get_type(typeId);
     ResId const newResId = rPerResType.m_resIds.create();
@@ -88,7 +92,11 @@ lgrn::IdRegistry<ResId> const& Resources::ids(ResTypeId const typeId) const noex
 ResIdOwner_t Resources::owner_create(ResTypeId const typeId, ResId const resId) noexcept
 {
     PerResType &rPerResType = get_type(typeId);
-    rPerResType.m_resRefs[std::size_t(resId)] ++;
+
+    // Atomic, as owners may be created by concurrent readers. Relaxed is enough, as the count
+    // is only acted on by the owning thread outside of concurrent read-only mode.
+    std::atomic_ref<int>{rPerResType.m_resRefs[std::size_t(resId)]}.fetch_add(1, std::memory_order_relaxed);
+
     ResIdOwner_t owner;
     owner.m_id = resId;
     return owner;
@@ -101,15 +109,40 @@ void Resources::owner_destroy(ResTypeId const typeId, ResIdOwner_t&& rOwner) noe
         return;
     }
     PerResType &rPerResType = get_type(typeId);
-    int &rCount = rPerResType.m_resRefs[std::size_t(rOwner.m_id)];
-    -- rCount;
+    std::atomic_ref<int>{rPerResType.m_resRefs[std::size_t(rOwner.m_id)]}.fetch_sub(1, std::memory_order_relaxed);
     rOwner.m_id = ResIdOwner_t{};
 }
 
 PkgId Resources::pkg_create()
 {
+    assert( ! m_concurrentRead );
+
     PkgId const newPkgId = m_pkgIds.create();
     m_pkgData.resize(m_pkgIds.capacity());
     m_pkgData[std::size_t(newPkgId)].m_resTypeOwn.resize(m_perResType.size());
     return newPkgId;
 }
+
+std::vector<ResId> Resources::commit(ResourceBatch &&rBatch)
+{
+    assert( ! m_concurrentRead );
+
+    std::vector<ResId> out;
+    out.reserve(rBatch.m_resources.size());
+
+    for (ResourceBatch::StagedRes &rStaged : rBatch.m_resources)
+    {
+        out.push_back(create(rStaged.m_typeId, rStaged.m_pkgId, std::move(rStaged.m_name)));
+    }
+
+    for (ResourceBatch::StagedData &rStaged : rBatch.m_data)
+    {
+        ResTypeId const typeId = rBatch.m_resources[rStaged.m_batchId].m_typeId;
+        rStaged.m_add(*this, typeId, out[rStaged.m_batchId], rStaged.m_data);
+    }
+
+    rBatch.m_resources.clear();
+    rBatch.m_data.clear();
+
+    return out;
+}
@@ -36,11 +36,101 @@
 #include <algorithm>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osp
 {
 
+class Resources;
+
+using BatchResId = uint32_t;
+
+/**
+ * @brief Resources and data staged to be added to Resources later by Resources::commit
+ *
+ * Lets a task running alongside concurrent readers prepare new resources without touching
+ * Resources itself. Each thread should fill its own batch; a ResourceBatch is not thread-safe.
+ */
+class ResourceBatch
+{
+public:
+
+    /**
+     * @brief Stage a new resource
+     *
+     * @param typeId    [in] Resource Type Id
+     * @param pkgId     [in] Package Id
+     * @param name      [in] String name identifier, must be unique within the package once committed
+     *
+     * @return Index of the staged resource, used as an index into the vector Resources::commit returns
+     */
+    BatchResId create(ResTypeId typeId, PkgId pkgId, SharedString name)
+    {
+        m_resources.push_back({typeId, pkgId, std::move(name)});
+        return BatchResId(m_resources.size() - 1);
+    }
+
+    /**
+     * @brief Stage data for a staged resource, constructed now and moved into Resources on commit
+     *
+     * T must be registered with Resources::data_register for the resource's type before commit.
+     *
+     * @param batchId   [in] Staged resource from create()
+     * @param args      [in] Arguments to pass to constructor
+     */
+    template<typename T, typename ... ARGS_T>
+    void data_add(BatchResId batchId, ARGS_T&& ... args)
+    {
+        assert(std::size_t(batchId) < m_resources.size());
+        m_data.push_back({ batchId,
+                           entt::any{std::in_place_type<T>, std::forward<ARGS_T>(args)...},
+                           &ResourceBatch::add_to<T> });
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_resources.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return m_resources.empty(); }
+
+private:
+
+    friend class Resources;
+
+    using AddFunc_t = void(*)(Resources&, ResTypeId, ResId, entt::any&);
+
+    struct StagedRes
+    {
+        ResTypeId       m_typeId;
+        PkgId           m_pkgId;
+        SharedString    m_name;
+    };
+
+    struct StagedData
+    {
+        BatchResId      m_batchId;
+        entt::any       m_data;
+        AddFunc_t       m_add;
+    };
+
+    template<typename T>
+    static void add_to(Resources &rResources, ResTypeId typeId, ResId resId, entt::any &rData);
+
+    std::vector<StagedRes>  m_resources;
+    std::vector<StagedData> m_data;
+};
+
+/**
+ * @brief Stores resources and their data, grouped by type and package
+ *
+ * Concurrency: Resources is single-threaded by default. Between concurrent_read_begin() and
+ * concurrent_read_end(), any number of threads may call find(), name(), ids(), data_get(),
+ * data_try_get(), owner_create(), and owner_destroy() without locking. Reference counts are
+ * atomic, and nothing that reallocates storage is allowed until concurrent_read_end(), which
+ * asserts in debug builds. Threads that produce new resources meanwhile stage them in their own
+ * ResourceBatch, to be published with commit() afterwards.
+ *
+ * Data returned by data_get() is only read-only between threads if the callers treat it that way.
+ */
 class Resources
 {
     using res_data_family_t = entt::family<struct ResourceType>;
@@ -77,6 +167,7 @@ public:
      */
     inline void resize_types(std::size_t n)
     {
+        assert( ! m_concurrentRead );
         m_perResType.resize(n);
     }
 
@@ -181,6 +272,42 @@ public:
      */
      [[nodiscard]] PkgId pkg_create();
 
+    /**
+     * @brief Enter concurrent read-only mode, see class description
+     *
+     * Call from the thread that owns Resources, before starting any concurrent readers.
+     */
+    void concurrent_read_begin() noexcept
+    {
+        assert( ! m_concurrentRead );
+        m_concurrentRead = true;
+    }
+
+    /**
+     * @brief Leave concurrent read-only mode
+     *
+     * Call from the thread that owns Resources, after all concurrent readers are done.
+     */
+    void concurrent_read_end() noexcept
+    {
+        assert(m_concurrentRead);
+        m_concurrentRead = false;
+    }
+
+    [[nodiscard]] bool is_concurrent_read() const noexcept { return m_concurrentRead; }
+
+    /**
+     * @brief Create all resources staged in a batch and move their data in
+     *
+     * Not allowed in concurrent read-only mode. Resources are created in the order they were
+     * staged, so the result is the same no matter which thread filled the batch.
+     *
+     * @param rBatch [ref] Batch to commit, left empty
+     *
+     * @return Created Resource Id for each BatchResId
+     */
+    std::vector<ResId> commit(ResourceBatch &&rBatch);
+
 private:
 
     PerResType const& get_type(ResTypeId typeId) const
@@ -204,11 +331,21 @@ private:
     std::vector<PerResType> m_perResType;
     lgrn::IdRegistry<PkgId> m_pkgIds;
     std::vector<PerPkg> m_pkgData;
+
+    bool m_concurrentRead{false};
 };
 
+template<typename T>
+void ResourceBatch::add_to(Resources &rResources, ResTypeId typeId, ResId resId, entt::any &rData)
+{
+    rResources.data_add<T>(typeId, resId, std::move(entt::any_cast<T&>(rData)));
+}
+
 template<typename T>
 void Resources::data_register(ResTypeId typeId)
 {
+    assert( ! m_concurrentRead );
+
     res_data_type_t const type = res_data_family_t::value<T>;
     PerResType &rPerResType = get_type(typeId);
 
@@ -224,6 +361,8 @@ void Resources::data_register(ResTypeId typeId)
 template<typename T, typename ... ARGS_T>
 T& Resources::data_add(ResTypeId typeId, ResId resId, ARGS_T&& ... args)
 {
+    assert( ! m_concurrentRead );
+
     PerResType &rPerResType = get_type(typeId);
 
     // Ensure resource ID exists
@@ -262,7 +401,7 @@ T const* Resources::data_try_get(ResTypeId typeId, ResId resId) const
     PerResType const &rPerResType = get_type(typeId);
 
     // Ensure resource ID exists
-    assert(rPerResType.m_resIds.capacity() > std::size_t(typeId));
+    assert(rPerResType.m_resIds.capacity() > std::size_t(resId));
     assert(rPerResType.m_resIds.exists(resId));
 
     res_container_t<NonConst_t> const &rContainer
@@ -0,0 +1,99 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace osp
+{
+
+/**
+ * @brief Stable LSD radix sort of items by a 64-bit key, 8 bits per pass
+ *
+ * Histograms for all passes are counted in a single read of the keys. Passes where all keys share
+ * the same byte are skipped, which is common for the high bits of small keys.
+ *
+ * @param rItems    [ref] Items to sort
+ * @param rScratch  [ref] Scratch space, swapped with rItems. Reuse to avoid reallocating
+ * @param getKey    [in] Function returning uint64_t sort key of an item
+ */
+template <typename T, typename KEY_FN_T>
+void radix_sort_u64(std::vector<T>& rItems, std::vector<T>& rScratch, KEY_FN_T const& getKey)
+{
+    constexpr int           smc_passes  = 8;
+    constexpr std::size_t   smc_buckets = 256;
+
+    std::size_t const size = rItems.size();
+    if (size < 2)
+    {
+        return;
+    }
+
+    std::array<std::array<std::size_t, smc_buckets>, smc_passes> counts{};
+
+    for (T const& item : rItems)
+    {
+        uint64_t const key = getKey(item);
+        for (int pass = 0; pass < smc_passes; ++pass)
+        {
+            ++counts[pass][(key >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    rScratch.resize(size);
+
+    for (int pass = 0; pass < smc_passes; ++pass)
+    {
+        std::array<std::size_t, smc_buckets> &rOffsets = counts[pass];
+        int const shift = pass * 8;
+
+        if (rOffsets[(getKey(rItems[0]) >> shift) & 0xFF] == size)
+        {
+            continue; // All keys are in the same bucket
+        }
+
+        // Counts to exclusive prefix sums
+        std::size_t sum = 0;
+        for (std::size_t &rOffset : rOffsets)
+        {
+            std::size_t const count = rOffset;
+            rOffset = sum;
+            sum += count;
+        }
+
+        for (T &rItem : rItems)
+        {
+            std::size_t const bucket = (getKey(rItem) >> shift) & 0xFF;
+            rScratch[rOffsets[bucket]++] = std::move(rItem);
+        }
+
+        std::swap(rItems, rScratch);
+    }
+}
+
+} // namespace osp
@@ -0,0 +1,183 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace osp
+{
+
+/**
+ * @brief Linear allocator for short-lived scratch memory
+ *
+ * Allocating bumps an offset into a block; nothing is freed individually. reset() makes all
+ * memory available again at once. If a run needed more than one block, reset() replaces them with
+ * a single block big enough for all of it, so steady-state use settles into one block and never
+ * touches the system allocator.
+ *
+ * Destructors are never called for what's stored in here; only keep trivially destructible data,
+ * or containers using ScratchAllocator that are destroyed before reset().
+ */
+class ScratchArena
+{
+public:
+
+    ScratchArena(std::size_t const blockSize = 64u * 1024u)
+     : m_blockSize{blockSize}
+    { }
+
+    ScratchArena(ScratchArena const& copy) = delete;
+    ScratchArena(ScratchArena&& move) = default;
+    ScratchArena& operator=(ScratchArena const& copy) = delete;
+    ScratchArena& operator=(ScratchArena&& move) = default;
+
+    /**
+     * @return Uninitialized memory of at least size bytes, valid until reset()
+     */
+    [[nodiscard]] void* allocate(std::size_t const size, std::size_t const align = alignof(std::max_align_t))
+    {
+        while (m_current < m_blocks.size())
+        {
+            Block const &rBlock = m_blocks[m_current];
+
+            auto const base     = reinterpret_cast<std::uintptr_t>(rBlock.data.get());
+            auto const aligned  = (base + m_offset + align - 1) & ~std::uintptr_t(align - 1);
+            auto const end      = aligned + size;
+
+            if (end <= base + rBlock.size)
+            {
+                m_offset = end - base;
+                m_used  += size;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // Doesn't fit, move on to the next block
+            ++m_current;
+            m_offset = 0;
+        }
+
+        std::size_t const blockSize = std::max(m_blockSize, size + align);
+        m_blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+        m_offset = 0;
+
+        return allocate(size, align);
+    }
+
+    /**
+     * @brief Make all allocated memory available again. Everything allocated before is invalid.
+     */
+    void reset()
+    {
+        if (m_blocks.size() > 1)
+        {
+            std::size_t total = 0;
+            for (Block const& block : m_blocks)
+            {
+                total += block.size;
+            }
+
+            m_blocks.clear();
+            m_blocks.push_back({std::make_unique<std::byte[]>(total), total});
+        }
+
+        m_current   = 0;
+        m_offset    = 0;
+        m_used      = 0;
+    }
+
+    /// Bytes handed out since the last reset(), not counting alignment padding
+    [[nodiscard]] std::size_t used() const noexcept { return m_used; }
+
+    /// Total size of all blocks owned
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        std::size_t total = 0;
+        for (Block const& block : m_blocks)
+        {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]>    data;
+        std::size_t                     size{0};
+    };
+
+    std::vector<Block>  m_blocks;
+    std::size_t         m_blockSize;
+    std::size_t         m_current   {0};
+    std::size_t         m_offset    {0};
+    std::size_t         m_used      {0};
+
+}; // class ScratchArena
+
+/**
+ * @brief Standard allocator that allocates from a ScratchArena; deallocate does nothing
+ */
+template <typename T>
+struct ScratchAllocator
+{
+    using value_type = T;
+
+    ScratchAllocator(ScratchArena& rArena) noexcept
+     : m_pArena{&rArena}
+    { }
+
+    template <typename U>
+    ScratchAllocator(ScratchAllocator<U> const& other) noexcept
+     : m_pArena{other.m_pArena}
+    { }
+
+    [[nodiscard]] T* allocate(std::size_t const count)
+    {
+        return static_cast<T*>(m_pArena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* /* ptr */, std::size_t /* count */) noexcept { }
+
+    template <typename U>
+    constexpr bool operator==(ScratchAllocator<U> const& rhs) const noexcept
+    {
+        return m_pArena == rhs.m_pArena;
+    }
+
+    ScratchArena *m_pArena;
+};
+
+/**
+ * @brief std::vector using memory from a ScratchArena. Must not outlive the arena's next reset().
+ */
+template <typename T>
+using ScratchVec_t = std::vector<T, ScratchAllocator<T>>;
+
+} // namespace osp
@@ -0,0 +1,204 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "array_view.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace osp
+{
+
+/**
+ * @brief Binary files made of a header, a table of FileSections, then the section contents
+ *
+ * Each section is a flat array of trivially copyable values aligned to gc_sectionAlign, so a
+ * memory-mapped file can be read through ArrayViews without any parsing. The header type is up
+ * to each file format, and must be trivially copyable.
+ */
+inline constexpr std::size_t gc_sectionAlign = 16;
+
+struct FileSection
+{
+    uint64_t offset;    ///< Bytes from start of file
+    uint64_t size;      ///< Size in bytes
+};
+
+constexpr std::size_t section_align_up(std::size_t const value) noexcept
+{
+    return (value + gc_sectionAlign - 1) / gc_sectionAlign * gc_sectionAlign;
+}
+
+/**
+ * @brief Accumulates aligned sections into one buffer
+ *
+ * Section offsets are relative to the start of the buffer until write_file adds the size of the
+ * header and section table.
+ */
+class SectionWriter
+{
+public:
+
+    SectionWriter(uint32_t const sectionCount)
+     : m_sections(sectionCount, FileSection{0, 0})
+    { }
+
+    template <typename T>
+    void add(uint32_t const index, ArrayView<T const> const values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        std::size_t const offset = section_align_up(m_data.size());
+        std::size_t const size   = values.size() * sizeof(T);
+
+        m_data.resize(offset + size, '\0');
+        if (size != 0)
+        {
+            std::memcpy(m_data.data() + offset, values.data(), size);
+        }
+        m_sections[index] = { offset, size };
+    }
+
+    template <typename T>
+    void add(uint32_t const index, std::vector<T> const& values)
+    {
+        add(index, arrayView(values));
+    }
+
+    template <typename HEADER_T>
+    bool write_file(HEADER_T const& header, std::string const& path) const
+    {
+        static_assert(std::is_trivially_copyable_v<HEADER_T>);
+
+        std::size_t const tableSize = sizeof(HEADER_T) + m_sections.size() * sizeof(FileSection);
+        std::size_t const dataStart = section_align_up(tableSize);
+
+        std::vector<FileSection> sections = m_sections;
+        for (FileSection &rSection : sections)
+        {
+            rSection.offset += dataStart;
+        }
+
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        if ( ! file.is_open())
+        {
+            return false;
+        }
+
+        std::array<char, gc_sectionAlign> const padding{};
+
+        file.write(reinterpret_cast<char const*>(&header), sizeof(HEADER_T));
+        file.write(reinterpret_cast<char const*>(sections.data()), std::streamsize(sections.size() * sizeof(FileSection)));
+        file.write(padding.data(), std::streamsize(dataStart - tableSize));
+        file.write(m_data.data(), std::streamsize(m_data.size()));
+
+        return file.good();
+    }
+
+private:
+    std::vector<FileSection>    m_sections;
+    std::vector<char>           m_data;
+};
+
+/**
+ * @return Section table of a file, placed right after a header of size headerSize
+ */
+inline ArrayView<FileSection const> file_sections(
+        ArrayView<char const> const file, std::size_t const headerSize, std::size_t const sectionCount) noexcept
+{
+    return { reinterpret_cast<FileSection const*>(file.data() + headerSize), sectionCount };
+}
+
+/**
+ * @return true if the section table fits in the file, and every section is aligned and in bounds
+ */
+inline bool file_sections_valid(
+        ArrayView<char const> const file, std::size_t const headerSize, std::size_t const sectionCount) noexcept
+{
+    std::size_t const fileSize = file.size();
+
+    if (fileSize < headerSize || (fileSize - headerSize) / sizeof(FileSection) < sectionCount)
+    {
+        return false;
+    }
+
+    for (FileSection const& section : file_sections(file, headerSize, sectionCount))
+    {
+        if (   section.offset % gc_sectionAlign != 0
+            || section.offset > fileSize
+            || section.size   > fileSize - section.offset)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @return Contents of a section viewed as an array of T, in place
+ */
+template <typename T>
+ArrayView<T const> file_section(ArrayView<char const> const file, FileSection const& section) noexcept
+{
+    return { reinterpret_cast<T const*>(file.data() + section.offset), std::size_t(section.size / sizeof(T)) };
+}
+
+/**
+ * @return true if [first, first + count) fits in an array of size elements
+ */
+constexpr bool in_range(std::size_t const first, std::size_t const count, std::size_t const size) noexcept
+{
+    return first <= size && count <= size - first;
+}
+
+/**
+ * @return true if offsets is a valid CSR offset array for idCount ids into data of dataSize
+ */
+inline bool csr_valid(ArrayView<uint32_t const> const offsets, std::size_t const idCount, std::size_t const dataSize) noexcept
+{
+    if (offsets.size() != idCount + 1 || offsets[0] != 0 || offsets[idCount] > dataSize)
+    {
+        return false;
+    }
+    for (std::size_t id = 0; id < idCount; ++id)
+    {
+        if (offsets[id] > offsets[id + 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace osp
@@ -0,0 +1,112 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace osp
+{
+
+/**
+ * @brief Fixed-capacity lock-free queue for exactly one producer thread and one consumer thread
+ *
+ * The producer only writes m_tail and the consumer only writes m_head, so neither side waits on
+ * the other. Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+
+    SpscQueue(std::size_t const capacity)
+     : m_mask       {std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1}
+     , m_slots      {std::make_unique<std::optional<T>[]>(m_mask + 1)}
+    { }
+
+    SpscQueue(SpscQueue const& copy) = delete;
+    SpscQueue(SpscQueue&& move) = delete;
+
+    /**
+     * @brief Add a value to the back of the queue. Producer thread only.
+     *
+     * @return false if the queue is full, rValue is left untouched
+     */
+    bool try_push(T&& rValue)
+    {
+        std::size_t const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+        {
+            return false;
+        }
+
+        m_slots[tail & m_mask].emplace(std::move(rValue));
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove a value from the front of the queue. Consumer thread only.
+     *
+     * @return Empty optional if the queue is empty
+     */
+    std::optional<T> try_pop()
+    {
+        std::size_t const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return std::nullopt;
+        }
+
+        std::optional<T> &rSlot = m_slots[head & m_mask];
+        std::optional<T> out{std::move(rSlot)};
+        rSlot.reset();
+        m_head.store(head + 1, std::memory_order_release);
+        return out;
+    }
+
+    /**
+     * @brief Approximate number of values in the queue, exact if called from either thread while
+     *        the other is idle
+     */
+    std::size_t size() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+
+    std::size_t                         m_mask;
+    std::unique_ptr<std::optional<T>[]> m_slots;
+
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+} // namespace osp
@@ -0,0 +1,92 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "drawing.h"
+
+#include <Magnum/Math/Range.h>
+
+#include <vector>
+
+namespace osp::draw
+{
+
+/**
+ * @brief Axis-aligned boxes stored as separate arrays of floats (SoA)
+ *
+ * Splitting up each component allows many boxes to be tested against a plane at once.
+ */
+struct BoxesSoA
+{
+    void resize(std::size_t const size)
+    {
+        centerX.resize(size, 0.0f);
+        centerY.resize(size, 0.0f);
+        centerZ.resize(size, 0.0f);
+        extentX.resize(size, 0.0f);
+        extentY.resize(size, 0.0f);
+        extentZ.resize(size, 0.0f);
+    }
+
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+
+    // Half-sizes
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+};
+
+/**
+ * @brief World-space bounds of DrawEnts, and the set of DrawEnts that survived frustum culling
+ *
+ * DrawEnts without a mesh or without known mesh bounds are never culled.
+ */
+struct ACtxCulling
+{
+    /// DrawEnts with valid bounds in drawBounds
+    DrawEntSet_t                    hasBounds;
+
+    /// World-space bounds of each DrawEnt, sized to a multiple of 64 DrawEnts
+    BoxesSoA                        drawBounds;
+
+    /// Bounds of each scene graph subtree, including all descendants. Indexed by TreePos_t
+    std::vector<Magnum::Range3D>    subtreeBounds;
+
+    /// Set of subtrees containing a DrawEnt without known bounds. Indexed by TreePos_t
+    BitVector_t                     subtreeUnbounded;
+
+    /// DrawEnts rejected early because their entire subtree is outside the frustum
+    DrawEntSet_t                    subtreeCulled;
+
+    /// ACtxSceneRender::m_visible with DrawEnts outside of the frustum removed
+    DrawEntSet_t                    visibleInView;
+
+    /// Test aggregated bounds of scene graph subtrees before testing individual DrawEnts
+    bool                            cullSubtrees    {true};
+};
+
+} // namespace osp::draw
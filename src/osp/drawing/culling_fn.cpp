@@ -0,0 +1,317 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "culling_fn.h"
+
+#include <Magnum/Math/Frustum.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+using namespace osp;
+using namespace osp::active;
+using namespace osp::draw;
+
+using Magnum::Range3D;
+
+namespace
+{
+
+constexpr float gc_inf = std::numeric_limits<float>::infinity();
+
+Range3D const gc_emptyRange{Vector3{gc_inf}, Vector3{-gc_inf}};
+
+bool is_empty(Range3D const& range) noexcept
+{
+    return range.min().x() > range.max().x();
+}
+
+void join(Range3D& rRange, Range3D const& other) noexcept
+{
+    rRange = {Magnum::Math::min(rRange.min(), other.min()),
+              Magnum::Math::max(rRange.max(), other.max())};
+}
+
+bool range_outside_frustum(Range3D const& range, Magnum::Frustum const& frustum) noexcept
+{
+    Vector3 const center = range.center();
+    Vector3 const extent = range.size() * 0.5f;
+
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        Vector4 const plane = frustum[i];
+        float const dist    = Magnum::Math::dot(plane.xyz(), center) + plane.w();
+        float const radius  = Magnum::Math::dot(Magnum::Math::abs(plane.xyz()), extent);
+        if (dist + radius < 0.0f)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Test 64 consecutive boxes against the frustum
+ *
+ * Loops are plane-major over contiguous floats so they can be vectorized by the compiler.
+ *
+ * @return Bitmask of boxes that are entirely outside of at least one plane
+ */
+uint64_t boxes_outside_frustum(
+        BoxesSoA const& boxes, std::size_t const first, Magnum::Frustum const& frustum) noexcept
+{
+    float const *pCX = &boxes.centerX[first];
+    float const *pCY = &boxes.centerY[first];
+    float const *pCZ = &boxes.centerZ[first];
+    float const *pEX = &boxes.extentX[first];
+    float const *pEY = &boxes.extentY[first];
+    float const *pEZ = &boxes.extentZ[first];
+
+    std::array<uint8_t, 64> outside{};
+
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        Vector4 const plane = frustum[i];
+        float const nx  = plane.x();
+        float const ny  = plane.y();
+        float const nz  = plane.z();
+        float const w   = plane.w();
+        float const anx = std::abs(nx);
+        float const any = std::abs(ny);
+        float const anz = std::abs(nz);
+
+        for (std::size_t j = 0; j < 64; ++j)
+        {
+            float const dist   = nx * pCX[j] + ny * pCY[j] + nz * pCZ[j] + w;
+            float const radius = anx * pEX[j] + any * pEY[j] + anz * pEZ[j];
+            outside[j] |= uint8_t(dist + radius < 0.0f);
+        }
+    }
+
+    uint64_t out = 0;
+    for (std::size_t j = 0; j < 64; ++j)
+    {
+        out |= uint64_t(outside[j]) << j;
+    }
+    return out;
+}
+
+} // namespace
+
+void SysCulling::resize(ACtxCulling& rCulling, ACtxSceneRender const& rScnRender)
+{
+    std::size_t const size = rScnRender.m_drawIds.capacity();
+
+    bitvector_resize(rCulling.hasBounds,        size);
+    bitvector_resize(rCulling.subtreeCulled,    size);
+    bitvector_resize(rCulling.visibleInView,    size);
+
+    // Boxes are tested 64 at a time, one for each bit of a bitset int
+    rCulling.drawBounds.resize(rCulling.hasBounds.ints().size() * 64);
+}
+
+void SysCulling::update_draw_bounds(
+        ACtxCulling&                    rCulling,
+        ACtxSceneRender const&          rScnRender,
+        ACtxDrawing const&              rDrawing)
+{
+    resize(rCulling, rScnRender);
+
+    BoxesSoA &rBoxes = rCulling.drawBounds;
+
+    std::fill(rCulling.hasBounds.ints().begin(), rCulling.hasBounds.ints().end(), 0u);
+
+    // Step through live DrawEnts only, skipping holes left by deleted ones
+    for (DrawEnt const drawEnt : rScnRender.m_drawPacked.ents)
+    {
+        auto const drawEntInt = std::size_t(drawEnt);
+        if ( ! rScnRender.m_visible.test(drawEntInt) )
+        {
+            continue;
+        }
+
+        MeshIdOwner_t const& meshOwner = rScnRender.m_mesh[drawEnt];
+        if ( ! meshOwner.has_value() )
+        {
+            continue;
+        }
+
+        auto const meshInt = std::size_t(meshOwner.value());
+        if (   meshInt >= rDrawing.m_meshHasBounds.size()
+            || ! rDrawing.m_meshHasBounds.test(meshInt) )
+        {
+            continue;
+        }
+
+        Range3D const& meshBounds = rDrawing.m_meshBounds[meshOwner.value()];
+        Matrix4 const& drawTf     = rScnRender.m_drawTransform[drawEnt];
+
+        // Transform the box's center, then project the rotated and scaled extents back onto the
+        // world axes. Gives a tight axis-aligned box containing the transformed box.
+        Vector3 const center = drawTf.transformPoint(meshBounds.center());
+        Vector3 const extent = meshBounds.size() * 0.5f;
+        Vector3 worldExtent;
+        for (int row = 0; row < 3; ++row)
+        {
+            worldExtent[row] = std::abs(drawTf[0][row]) * extent.x()
+                             + std::abs(drawTf[1][row]) * extent.y()
+                             + std::abs(drawTf[2][row]) * extent.z();
+        }
+
+        rBoxes.centerX[drawEntInt] = center.x();
+        rBoxes.centerY[drawEntInt] = center.y();
+        rBoxes.centerZ[drawEntInt] = center.z();
+        rBoxes.extentX[drawEntInt] = worldExtent.x();
+        rBoxes.extentY[drawEntInt] = worldExtent.y();
+        rBoxes.extentZ[drawEntInt] = worldExtent.z();
+
+        rCulling.hasBounds.set(drawEntInt);
+    }
+}
+
+void SysCulling::update_subtree_bounds(
+        ACtxCulling&                    rCulling,
+        ACtxSceneRender const&          rScnRender,
+        ACtxSceneGraph const&           rScnGraph)
+{
+    std::size_t const treeSize = rScnGraph.m_treeToEnt.size();
+
+    rCulling.subtreeBounds.assign(treeSize, gc_emptyRange);
+    rCulling.subtreeUnbounded.ints().assign(treeSize / 64 + (treeSize % 64 != 0), 0u);
+
+    BoxesSoA const &boxes = rCulling.drawBounds;
+
+    // Children are always positioned after their parent, so iterating backwards guarantees that
+    // a subtree is complete before it's joined into its parent. Position 0 is the root, which has
+    // no parent to join into.
+    for (std::size_t pos = treeSize; pos-- > 1; )
+    {
+        ActiveEnt const ent = rScnGraph.m_treeToEnt[TreePos_t(pos)];
+
+        DrawEnt const drawEnt = (std::size_t(ent) < rScnRender.m_activeToDraw.size())
+                              ? rScnRender.m_activeToDraw[ent] : lgrn::id_null<DrawEnt>();
+
+        if (drawEnt != lgrn::id_null<DrawEnt>())
+        {
+            auto const drawEntInt = std::size_t(drawEnt);
+            if (rCulling.hasBounds.test(drawEntInt))
+            {
+                Vector3 const center{boxes.centerX[drawEntInt],
+                                     boxes.centerY[drawEntInt],
+                                     boxes.centerZ[drawEntInt]};
+                Vector3 const extent{boxes.extentX[drawEntInt],
+                                     boxes.extentY[drawEntInt],
+                                     boxes.extentZ[drawEntInt]};
+                join(rCulling.subtreeBounds[pos], Range3D{center - extent, center + extent});
+            }
+            else if (rScnRender.m_visible.test(drawEntInt))
+            {
+                rCulling.subtreeUnbounded.set(pos);
+            }
+        }
+
+        ActiveEnt const parent        = rScnGraph.m_entParent[ent];
+        bool const      parentNotNull = (parent != lgrn::id_null<ActiveEnt>());
+        TreePos_t const parentPos     = parentNotNull ? rScnGraph.m_entToTreePos[parent] : 0;
+
+        if (parentPos != 0)
+        {
+            join(rCulling.subtreeBounds[parentPos], rCulling.subtreeBounds[pos]);
+            if (rCulling.subtreeUnbounded.test(pos))
+            {
+                rCulling.subtreeUnbounded.set(parentPos);
+            }
+        }
+    }
+}
+
+void SysCulling::cull(
+        ACtxCulling&                    rCulling,
+        ACtxSceneRender const&          rScnRender,
+        ACtxSceneGraph const&           rScnGraph,
+        ViewProjMatrix const&           viewProj)
+{
+    resize(rCulling, rScnRender);
+
+    Magnum::Frustum const frustum = Magnum::Frustum::fromMatrix(viewProj.m_viewProj);
+
+    auto &rCulledInts = rCulling.subtreeCulled.ints();
+    std::fill(rCulledInts.begin(), rCulledInts.end(), 0u);
+
+    // Reject entire subtrees first. Skip over descendants of subtrees that are fully outside,
+    // only marking their DrawEnts as culled.
+    if (rCulling.cullSubtrees && rCulling.subtreeBounds.size() == rScnGraph.m_treeToEnt.size())
+    {
+        std::size_t const treeSize = rScnGraph.m_treeToEnt.size();
+        std::size_t pos = 1;
+        while (pos < treeSize)
+        {
+            std::size_t const subtreeEnd = pos + 1 + rScnGraph.m_treeDescendants[TreePos_t(pos)];
+            Range3D const& bounds = rCulling.subtreeBounds[pos];
+
+            if (   rCulling.subtreeUnbounded.test(pos)
+                || is_empty(bounds)
+                || ! range_outside_frustum(bounds, frustum) )
+            {
+                ++pos; // Descend into children
+                continue;
+            }
+
+            for (; pos < subtreeEnd; ++pos)
+            {
+                ActiveEnt const ent = rScnGraph.m_treeToEnt[TreePos_t(pos)];
+                if (std::size_t(ent) >= rScnRender.m_activeToDraw.size())
+                {
+                    continue;
+                }
+                DrawEnt const drawEnt = rScnRender.m_activeToDraw[ent];
+                if (drawEnt != lgrn::id_null<DrawEnt>())
+                {
+                    rCulling.subtreeCulled.set(std::size_t(drawEnt));
+                }
+            }
+        }
+    }
+
+    // Test remaining DrawEnts individually, 64 at a time
+    auto const &visibleInts  = rScnRender.m_visible.ints();
+    auto const &boundedInts  = rCulling.hasBounds.ints();
+    auto       &rInViewInts  = rCulling.visibleInView.ints();
+
+    for (std::size_t i = 0; i < visibleInts.size(); ++i)
+    {
+        uint64_t const visible = visibleInts[i];
+        uint64_t const bounded = boundedInts[i];
+        uint64_t const toTest  = visible & bounded & ~rCulledInts[i];
+
+        uint64_t const outside = (toTest != 0)
+                               ? boxes_outside_frustum(rCulling.drawBounds, i * 64, frustum)
+                               : 0u;
+
+        // Keep DrawEnts without bounds, as there's no way to tell if they're in view
+        rInViewInts[i] = visible & (~bounded | (toTest & ~outside));
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "culling.h"
+#include "drawing_fn.h"
+
+namespace osp::draw
+{
+
+/**
+ * @brief Hierarchical view frustum culling of DrawEnts
+ *
+ * Culling is split into separate steps so each can be run once draw transforms are ready:
+ *
+ * 1. update_draw_bounds: World-space bounds of visible DrawEnts from mesh bounds and
+ *                        draw transforms
+ * 2. update_subtree_bounds: Aggregate bounds for each scene graph subtree
+ * 3. cull: Reject whole subtrees, then test the remaining DrawEnts 64 at a time
+ *
+ * The result is written to ACtxCulling::visibleInView. ACtxSceneRender::m_visible is not modified,
+ * as it is set intentionally by other systems to show or hide DrawEnts.
+ */
+class SysCulling
+{
+public:
+
+    static void resize(ACtxCulling& rCulling, ACtxSceneRender const& rScnRender);
+
+    /**
+     * @brief Calculate world-space axis-aligned bounds of visible DrawEnts
+     *
+     * @param rCulling      [ref] Culling data, drawBounds and hasBounds are written
+     * @param rScnRender    [in] DrawEnt meshes, draw transforms, and visibility
+     * @param rDrawing      [in] Object-space mesh bounds
+     */
+    static void update_draw_bounds(
+            ACtxCulling&                    rCulling,
+            ACtxSceneRender const&          rScnRender,
+            ACtxDrawing const&              rDrawing);
+
+    /**
+     * @brief Calculate bounds of each scene graph subtree, from the bounds of their DrawEnts
+     *
+     * Subtrees containing a visible DrawEnt without bounds are marked as unbounded and are never
+     * rejected as a whole.
+     */
+    static void update_subtree_bounds(
+            ACtxCulling&                    rCulling,
+            ACtxSceneRender const&          rScnRender,
+            active::ACtxSceneGraph const&   rScnGraph);
+
+    /**
+     * @brief Write visible DrawEnts that intersect the view frustum to ACtxCulling::visibleInView
+     *
+     * @param rCulling      [ref] Culling data with bounds already calculated
+     * @param rScnRender    [in] Visible DrawEnts
+     * @param rScnGraph     [in] Scene graph, used for rejecting subtrees
+     * @param viewProj      [in] View projection matrix to extract frustum planes from
+     */
+    static void cull(
+            ACtxCulling&                    rCulling,
+            ACtxSceneRender const&          rScnRender,
+            active::ACtxSceneGraph const&   rScnGraph,
+            ViewProjMatrix const&           viewProj);
+};
+
+} // namespace osp::draw
@@ -0,0 +1,75 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "drawing.h"
+
+#include <vector>
+
+namespace osp::draw
+{
+
+/**
+ * @brief Everything needed to draw a single DrawEnt, independent of graphics API
+ */
+struct DrawCommand
+{
+    Matrix4         modelView;      ///< View-relative transform
+    Matrix3         normalMatrix;   ///< Normal matrix of modelView
+    Magnum::Color4  color;
+    float           depth;          ///< Distance in front of the camera, for sorting draws
+    MaterialId      material;
+    DrawEnt         ent;
+};
+
+/**
+ * @brief Draw commands recorded for a range of DrawEnts
+ *
+ * Lists can be recorded in parallel, as each only reads from ACtxSceneRender and writes to itself.
+ * Commands are grouped by material.
+ */
+struct DrawCommandList
+{
+    std::vector<DrawCommand>    commands;
+};
+
+/**
+ * @brief Draw commands for a frame, split into separately recorded lists
+ *
+ * Once all lists are recorded, SysDrawCommands::index looks up commands by DrawEnt and by
+ * material so the GL side never has to search through the lists.
+ */
+struct ACtxDrawCommands
+{
+    std::vector<DrawCommandList>                            lists;
+
+    /// Command recorded for each DrawEnt this frame, or nullptr if it wasn't recorded
+    KeyedVec<DrawEnt, DrawCommand const*>                   entToCmd;
+
+    /// Commands recorded this frame for each material
+    KeyedVec<MaterialId, std::vector<DrawCommand const*>>   materialCmds;
+};
+
+} // namespace osp::draw
@@ -0,0 +1,96 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "draw_commands_fn.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace osp;
+using namespace osp::draw;
+
+void SysDrawCommands::record(
+        DrawCommandList&        rList,
+        std::size_t const       listIndex,
+        std::size_t const       listCount,
+        ACtxSceneRender const&  scnRender,
+        DrawEntSet_t const&     visible,
+        ViewProjMatrix const&   viewProj)
+{
+    rList.commands.clear();
+
+    auto const &visibleInts = visible.ints();
+
+    std::size_t const perList   = (visibleInts.size() + listCount - 1) / listCount;
+    std::size_t const firstInt  = std::min(listIndex * perList,  visibleInts.size());
+    std::size_t const lastInt   = std::min(firstInt + perList,   visibleInts.size());
+
+    for (std::size_t const matInt : scnRender.m_materialIds.bitview().zeros())
+    {
+        auto const          matId   = MaterialId(matInt);
+        Material const      &mat    = scnRender.m_materials[matId];
+        auto const          &matInts = mat.m_ents.ints();
+
+        for (std::size_t i = firstInt; i < std::min(lastInt, matInts.size()); ++i)
+        {
+            uint64_t bits = visibleInts[i] & matInts[i];
+            while (bits != 0)
+            {
+                auto const bit = std::size_t(std::countr_zero(bits));
+                bits &= bits - 1; // Clear lowest set bit
+
+                auto const  ent         = DrawEnt(i * 64 + bit);
+                Matrix4 const modelView = viewProj.m_view * scnRender.m_drawTransform[ent];
+
+                rList.commands.push_back({
+                    .modelView      = modelView,
+                    .normalMatrix   = modelView.normalMatrix(),
+                    .color          = scnRender.m_color[ent],
+                    .depth          = -modelView.translation().z(), // Camera looks towards -Z
+                    .material       = matId,
+                    .ent            = ent });
+            }
+        }
+    }
+}
+
+void SysDrawCommands::index(ACtxDrawCommands& rCmds, ACtxSceneRender const& scnRender)
+{
+    rCmds.entToCmd.assign(scnRender.m_drawIds.capacity(), nullptr);
+    rCmds.materialCmds.resize(scnRender.m_materialIds.capacity());
+
+    for (std::vector<DrawCommand const*> &rMatCmds : rCmds.materialCmds)
+    {
+        rMatCmds.clear();
+    }
+
+    for (DrawCommandList const& list : rCmds.lists)
+    {
+        for (DrawCommand const& cmd : list.commands)
+        {
+            rCmds.entToCmd[cmd.ent] = &cmd;
+            rCmds.materialCmds[cmd.material].push_back(&cmd);
+        }
+    }
+}
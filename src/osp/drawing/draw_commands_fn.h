@@ -0,0 +1,95 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "draw_commands.h"
+#include "drawing_fn.h"
+
+namespace osp::draw
+{
+
+class SysDrawCommands
+{
+public:
+
+    /**
+     * @brief Record draw commands for a part of the DrawEnts that are visible
+     *
+     * DrawEnts are split by bitset int (64 DrawEnts each). List [i] of [count] records its own
+     * contiguous part, so multiple lists can be recorded in parallel by different tasks.
+     *
+     * @param rList         [out] List to record into, previous commands are cleared
+     * @param listIndex     [in] Index of this list
+     * @param listCount     [in] Total number of lists the DrawEnts are split into
+     * @param scnRender     [in] DrawEnt transforms, colors, and materials
+     * @param visible       [in] DrawEnts to record
+     * @param viewProj      [in] View and projection matrix
+     */
+    static void record(
+            DrawCommandList&        rList,
+            std::size_t             listIndex,
+            std::size_t             listCount,
+            ACtxSceneRender const&  scnRender,
+            DrawEntSet_t const&     visible,
+            ViewProjMatrix const&   viewProj);
+
+    /**
+     * @brief Look up recorded commands by DrawEnt and by material, once all lists are recorded
+     *
+     * @param rCmds         [ref] Recorded lists, writes entToCmd and materialCmds
+     * @param scnRender     [in] DrawEnt and material capacities
+     */
+    static void index(ACtxDrawCommands& rCmds, ACtxSceneRender const& scnRender);
+
+    /**
+     * @return Command recorded for a DrawEnt this frame, or nullptr
+     */
+    [[nodiscard]] static DrawCommand const* find(ACtxDrawCommands const& cmds, DrawEnt const ent) noexcept
+    {
+        return (std::size_t(ent) < cmds.entToCmd.size()) ? cmds.entToCmd[ent] : nullptr;
+    }
+
+    /**
+     * @brief Call a function for each command in all lists that uses a certain material
+     *
+     * Requires index to be called after recording.
+     */
+    template <typename FUNC_T>
+    static void for_each_with_material(
+            ACtxDrawCommands const& cmds, MaterialId const material, FUNC_T&& func)
+    {
+        if (std::size_t(material) >= cmds.materialCmds.size())
+        {
+            return;
+        }
+
+        for (DrawCommand const *pCmd : cmds.materialCmds[material])
+        {
+            func(*pCmd);
+        }
+    }
+};
+
+} // namespace osp::draw
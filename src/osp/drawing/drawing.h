@@ -38,6 +38,7 @@
 
 #include <Magnum/Magnum.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/Range.h>
 
 #include <longeron/id_management/refcount.hpp>
 #include <longeron/id_management/registry_stl.hpp> // for lgrn::IdRegistryStl
@@ -69,6 +70,15 @@ enum class MeshId : uint32_t { };
 enum class TexId : uint32_t { };
 
 
+/**
+ * @brief Simplified versions of a mesh, see MeshLodChain
+ */
+struct MeshLods
+{
+    std::vector<MeshId>     levels;     ///< Most to least detailed, excluding the original
+    std::vector<float>      errors;     ///< Approximate deviation from the original per level
+};
+
 using MeshRefCount_t    = lgrn::IdRefCount<MeshId>;
 using MeshIdOwner_t     = MeshRefCount_t::Owner_t;
 
@@ -84,6 +94,13 @@ struct ACtxDrawing
     lgrn::IdRegistryStl<MeshId>             m_meshIds;
     MeshRefCount_t                          m_meshRefCounts;
 
+    // Object-space bounds of each mesh, only valid for MeshIds set in m_meshHasBounds
+    KeyedVec<MeshId, Magnum::Range3D>       m_meshBounds;
+    BitVector_t                             m_meshHasBounds;
+
+    // Simplified versions of meshes loaded with a MeshLodChain, empty for other meshes
+    KeyedVec<MeshId, MeshLods>              m_meshLods;
+
     // Scene-space Textures
     lgrn::IdRegistryStl<TexId>              m_texIds;
     TexRefCount_t                           m_texRefCounts;
@@ -113,6 +130,55 @@ using DrawEntColors_t = KeyedVec<DrawEnt, Magnum::Color4>;
 using DrawEntTextures_t = KeyedVec<DrawEnt, TexIdOwner_t>;
 using DrawTransforms_t = KeyedVec<DrawEnt, Matrix4>;
 
+/**
+ * @brief DrawEnt paired with the generation it was created in
+ *
+ * DrawEnt Ids are reused after deletion; compare with SysRender::is_current to detect stale
+ * references held by other systems.
+ */
+struct DrawEntRef
+{
+    DrawEnt     ent         {lgrn::id_null<DrawEnt>()};
+    uint16_t    generation  {0};
+};
+
+/**
+ * @brief Live DrawEnts packed contiguously
+ *
+ * DrawEnt Ids, and the per-DrawEnt KeyedVecs and bitsets indexed by them, are sparse and keep the
+ * holes left by deleted DrawEnts. This keeps a dense list of only the live ones, so passes over
+ * all DrawEnts don't have to step over holes. Removing swaps the last DrawEnt into the gap.
+ *
+ * Only modify through SysRender::create_draw_ent and SysRender::remove_draw_ent.
+ */
+struct DrawEntPacked
+{
+    static constexpr uint32_t   smc_null = ~uint32_t(0);
+
+    DrawEntVec_t                    ents;       ///< Live DrawEnts, in no particular order
+    KeyedVec<DrawEnt, uint32_t>     denseIndex; ///< Index of each DrawEnt in ents, or smc_null
+    KeyedVec<DrawEnt, uint16_t>     generation; ///< Incremented each time a DrawEnt is removed
+
+    std::size_t                     peakLive    {0};
+    std::size_t                     removed     {0};
+    std::size_t                     swapRemoved {0}; ///< Removals that moved another DrawEnt
+};
+
+/**
+ * @brief How well DrawEnt Ids are packed, see SysRender::draw_ent_stats
+ */
+struct DrawEntStats
+{
+    std::size_t live        {0};
+    std::size_t capacity    {0}; ///< Size of per-DrawEnt KeyedVecs and bitsets
+    std::size_t peakLive    {0};
+    std::size_t removed     {0};
+    std::size_t swapRemoved {0};
+
+    /// Fraction of per-DrawEnt storage that is live; low after heavy spawn/despawn churn
+    float       occupancy   {1.0f};
+};
+
 struct ACtxSceneRender
 {
     ACtxSceneRender() = default;
@@ -130,6 +196,7 @@ struct ACtxSceneRender
         m_color         .resize(size, {1.0f, 1.0f, 1.0f, 1.0f}); // Default white
         m_diffuseTex    .resize(size);
         m_mesh          .resize(size);
+        m_meshLod       .resize(size, 0);
 
         for (uint32_t matInt : m_materialIds.bitview().zeros())
         {
@@ -141,10 +208,13 @@ struct ACtxSceneRender
     {
         bitvector_resize(m_needDrawTf, size);
         m_activeToDraw      .resize(size, lgrn::id_null<DrawEnt>());
-        drawTfObserverEnable.resize(size, 0);
     }
 
     lgrn::IdRegistryStl<DrawEnt>            m_drawIds;
+    DrawEntPacked                           m_drawPacked;
+
+    /// Removed DrawEnts still taken in m_drawIds, see SysRender::release_pending_draw_ents
+    DrawEntVec_t                            m_drawIdsPendingFree;
 
     DrawEntSet_t                            m_opaque;
     DrawEntSet_t                            m_transparent;
@@ -154,7 +224,6 @@ struct ACtxSceneRender
     DrawEntSet_t                            m_needDrawTf;
     KeyedVec<active::ActiveEnt, DrawEnt>    m_activeToDraw;
 
-    KeyedVec<active::ActiveEnt, uint16_t>   drawTfObserverEnable;
     DrawTransforms_t                        m_drawTransform;
 
     // Meshes and textures assigned to DrawEnts
@@ -164,6 +233,9 @@ struct ACtxSceneRender
     KeyedVec<DrawEnt, MeshIdOwner_t>        m_mesh;
     DrawEntVec_t                            m_meshDirty;
 
+    // Level of detail to draw each DrawEnt's mesh with, 0 for the original. See MeshLods
+    KeyedVec<DrawEnt, uint8_t>              m_meshLod;
+
     lgrn::IdRegistryStl<MaterialId>         m_materialIds;
     KeyedVec<MaterialId, Material>          m_materials;
 };
@@ -27,10 +27,209 @@
 
 #include "../core/Resources.h"
 
+#include <Magnum/Trade/MeshData.h>
+
+#include <algorithm>
+#include <utility>
+
 using namespace osp;
 using namespace osp::active;
 using namespace osp::draw;
 
+static void calculate_mesh_bounds(
+        ACtxDrawing &rCtxDrawing, MeshId const meshId, Resources const &rResources, ResId const resId)
+{
+    using Magnum::Trade::MeshData;
+    using Magnum::Trade::MeshAttribute;
+
+    std::size_t const capacity = rCtxDrawing.m_meshIds.capacity();
+    rCtxDrawing.m_meshBounds.resize(capacity);
+    bitvector_resize(rCtxDrawing.m_meshHasBounds, capacity);
+
+    rCtxDrawing.m_meshHasBounds.reset(std::size_t(meshId));
+
+    auto const *pMeshData = rResources.data_try_get<MeshData const>(restypes::gc_mesh, resId);
+    if (pMeshData == nullptr || ! pMeshData->hasAttribute(MeshAttribute::Position))
+    {
+        return; // Bounds unknown, DrawEnts using this mesh won't be culled
+    }
+
+    auto const positions = pMeshData->positions3DAsArray();
+    if (positions.isEmpty())
+    {
+        return;
+    }
+
+    Vector3 min = positions[0];
+    Vector3 max = positions[0];
+    for (Vector3 const& pos : positions)
+    {
+        min = Magnum::Math::min(min, pos);
+        max = Magnum::Math::max(max, pos);
+    }
+
+    rCtxDrawing.m_meshBounds[meshId] = Magnum::Range3D{min, max};
+    rCtxDrawing.m_meshHasBounds.set(std::size_t(meshId));
+}
+
+DrawEnt SysRender::create_draw_ent(ACtxSceneRender& rCtxScnRdr)
+{
+    DrawEntPacked &rPacked = rCtxScnRdr.m_drawPacked;
+
+    DrawEnt const ent = rCtxScnRdr.m_drawIds.create();
+
+    std::size_t const capacity = rCtxScnRdr.m_drawIds.capacity();
+    if (rPacked.denseIndex.size() < capacity)
+    {
+        rPacked.denseIndex.resize(capacity, DrawEntPacked::smc_null);
+        rPacked.generation.resize(capacity, 0);
+    }
+
+    rPacked.denseIndex[ent] = uint32_t(rPacked.ents.size());
+    rPacked.ents.push_back(ent);
+    rPacked.peakLive = std::max(rPacked.peakLive, rPacked.ents.size());
+
+    return ent;
+}
+
+void SysRender::remove_draw_ent(ACtxSceneRender& rCtxScnRdr, DrawEnt const ent)
+{
+    if ( ! rCtxScnRdr.m_drawIds.exists(ent) )
+    {
+        return;
+    }
+
+    DrawEntPacked &rPacked = rCtxScnRdr.m_drawPacked;
+
+    LGRN_ASSERTM(std::size_t(ent) < rPacked.denseIndex.size(), "DrawEnt not created with create_draw_ent");
+
+    uint32_t const index = std::exchange(rPacked.denseIndex[ent], DrawEntPacked::smc_null);
+    if (index == DrawEntPacked::smc_null)
+    {
+        return; // Already removed, Id is waiting in m_drawIdsPendingFree
+    }
+
+    DrawEnt const last = rPacked.ents.back();
+    if (last != ent)
+    {
+        rPacked.ents[index]         = last;
+        rPacked.denseIndex[last]    = index;
+        ++rPacked.swapRemoved;
+    }
+    rPacked.ents.pop_back();
+
+    ++rPacked.generation[ent];
+    ++rPacked.removed;
+
+    rCtxScnRdr.m_drawIdsPendingFree.push_back(ent);
+}
+
+void SysRender::release_pending_draw_ents(ACtxSceneRender& rCtxScnRdr)
+{
+    for (DrawEnt const ent : rCtxScnRdr.m_drawIdsPendingFree)
+    {
+        rCtxScnRdr.m_drawIds.remove(ent);
+    }
+    rCtxScnRdr.m_drawIdsPendingFree.clear();
+}
+
+bool SysRender::is_current(ACtxSceneRender const& ctxScnRdr, DrawEntRef const ref) noexcept
+{
+    return    ref.ent != lgrn::id_null<DrawEnt>()
+           && ctxScnRdr.m_drawIds.exists(ref.ent)
+           && ctxScnRdr.m_drawPacked.generation[ref.ent] == ref.generation;
+}
+
+DrawEntStats SysRender::draw_ent_stats(ACtxSceneRender const& ctxScnRdr) noexcept
+{
+    DrawEntPacked const &packed = ctxScnRdr.m_drawPacked;
+
+    std::size_t const capacity = ctxScnRdr.m_drawIds.capacity();
+
+    return {
+        .live        = packed.ents.size(),
+        .capacity    = capacity,
+        .peakLive    = packed.peakLive,
+        .removed     = packed.removed,
+        .swapRemoved = packed.swapRemoved,
+        .occupancy   = (capacity == 0) ? 1.0f : float(packed.ents.size()) / float(capacity)
+    };
+}
+
+void SysRender::observe_draw_tf(DrawTfObservers& rObservers, std::size_t const observer, ActiveEnt const ent)
+{
+    auto const entInt = std::size_t(ent);
+
+    for (active::ActiveEntSet_t *pSet : {&rObservers.observers[observer].ents, &rObservers.anyObserved})
+    {
+        if (pSet->size() <= entInt)
+        {
+            bitvector_resize(*pSet, entInt + 1);
+        }
+        pSet->set(entInt);
+    }
+}
+
+void SysRender::unobserve_draw_tf(DrawTfObservers& rObservers, ActiveEnt const ent)
+{
+    auto const entInt = std::size_t(ent);
+
+    if (entInt >= rObservers.anyObserved.size() || ! rObservers.anyObserved.test(entInt))
+    {
+        return;
+    }
+
+    rObservers.anyObserved.reset(entInt);
+
+    for (DrawTfObservers::Observer &rObserver : rObservers.observers)
+    {
+        if (entInt < rObserver.ents.size())
+        {
+            rObserver.ents.reset(entInt);
+        }
+    }
+}
+
+void SysRender::dispatch_draw_tf(DrawTfObservers& rObservers, ACtxSceneRender& rCtxScnRdr)
+{
+    if (rObservers.batchEnts.empty())
+    {
+        return;
+    }
+
+    for (DrawTfObservers::Observer const &observer : rObservers.observers)
+    {
+        if (observer.func == nullptr)
+        {
+            continue;
+        }
+
+        rObservers.scratchEnts.clear();
+        rObservers.scratchTfs.clear();
+
+        for (std::size_t i = 0; i < rObservers.batchEnts.size(); ++i)
+        {
+            auto const entInt = std::size_t(rObservers.batchEnts[i]);
+            if (entInt < observer.ents.size() && observer.ents.test(entInt))
+            {
+                rObservers.scratchEnts.push_back(rObservers.batchEnts[i]);
+                rObservers.scratchTfs .push_back(rObservers.batchTfs[i]);
+            }
+        }
+
+        if ( ! rObservers.scratchEnts.empty() )
+        {
+            observer.func(rCtxScnRdr,
+                          {rObservers.scratchEnts.data(), rObservers.scratchEnts.size()},
+                          {rObservers.scratchTfs.data(),  rObservers.scratchTfs.size()},
+                          observer.data);
+        }
+    }
+
+    rObservers.batchEnts.clear();
+    rObservers.batchTfs.clear();
+}
+
 MeshId SysRender::own_mesh_resource(ACtxDrawing& rCtxDrawing, ACtxDrawingRes& rCtxDrawingRes, Resources &rResources, ResId const resId)
 {
     auto const& [it, success] = rCtxDrawingRes.m_resToMesh.try_emplace(resId);
@@ -40,11 +239,77 @@ MeshId SysRender::own_mesh_resource(ACtxDrawing& rCtxDrawing, ACtxDrawingRes& rC
         MeshId const meshId = rCtxDrawing.m_meshIds.create();
         rCtxDrawingRes.m_meshToRes.emplace(meshId, std::move(owner));
         it->second = meshId;
+        calculate_mesh_bounds(rCtxDrawing, meshId, rResources, resId);
+
+        // Also own simplified versions. Note that this may invalidate 'it'
+        if (auto const *pChain = rResources.data_try_get<MeshLodChain>(restypes::gc_mesh, resId);
+            pChain != nullptr)
+        {
+            MeshLods lods;
+            for (ResIdOwner_t const& levelRes : pChain->m_levels)
+            {
+                lods.levels.push_back(own_mesh_resource(rCtxDrawing, rCtxDrawingRes, rResources, levelRes));
+            }
+            lods.errors = pChain->m_errors;
+
+            rCtxDrawing.m_meshLods.resize(rCtxDrawing.m_meshIds.capacity());
+            rCtxDrawing.m_meshLods[meshId] = std::move(lods);
+        }
+
         return meshId;
     }
     return it->second;
 };
 
+void SysRender::select_mesh_lods(
+        ACtxSceneRender&        rCtxScnRdr,
+        ACtxDrawing const&      ctxDrawing,
+        DrawEntSet_t const&     visible,
+        Camera const&           camera,
+        float const             viewportHeight,
+        float const             maxErrorPx)
+{
+    Vector3 const camPos = camera.m_transform.translation();
+
+    // Pixels per unit of size at distance 1
+    float const projScale = viewportHeight / (2.0f * Magnum::Math::tan(Magnum::Rad{camera.m_fov} * 0.5f));
+
+    for (std::size_t const drawEntInt : visible.ones())
+    {
+        auto const              drawEnt = DrawEnt(drawEntInt);
+        MeshIdOwner_t const     &mesh   = rCtxScnRdr.m_mesh[drawEnt];
+        uint8_t                 &rLod   = rCtxScnRdr.m_meshLod[drawEnt];
+
+        rLod = 0;
+
+        if ( ! mesh.has_value() || std::size_t(mesh.value()) >= ctxDrawing.m_meshLods.size() )
+        {
+            continue;
+        }
+
+        MeshLods const &lods = ctxDrawing.m_meshLods[mesh.value()];
+        if (lods.levels.empty())
+        {
+            continue;
+        }
+
+        Matrix4 const   &drawTf   = rCtxScnRdr.m_drawTransform[drawEnt];
+        float const     distance  = std::max((drawTf.translation() - camPos).length(), camera.m_near);
+        float const     scale     = drawTf.scaling().max();
+        float const     pxPerUnit = projScale * scale / distance;
+
+        // Errors increase with each level
+        for (std::size_t level = 0; level < lods.errors.size(); ++level)
+        {
+            if (lods.errors[level] * pxPerUnit > maxErrorPx)
+            {
+                break;
+            }
+            rLod = uint8_t(level + 1);
+        }
+    }
+}
+
 TexId SysRender::own_texture_resource(ACtxDrawing& rCtxDrawing, ACtxDrawingRes& rCtxDrawingRes, Resources &rResources, ResId const resId)
 {
     auto const& [it, success] = rCtxDrawingRes.m_resToTex.try_emplace(resId);
@@ -26,6 +26,8 @@
 
 #include "drawing.h"
 
+#include "../core/array_view.h"
+
 #include "../activescene/basic.h"
 #include "../activescene/basic_fn.h"
 
@@ -44,22 +46,38 @@ namespace osp::draw
  * DrawTfObservers provides a way to tap into this procedure to call custom functions for other
  * systems.
  *
- * To use, write into DrawTfObservers::observers[i]
- * Enable per-DrawEnt by setting ACtxSceneRender::drawTfObserverEnable[drawEnt] bit [i]
- *
+ * To use, write into DrawTfObservers::observers[i], then register ActiveEnts with
+ * SysRender::observe_draw_tf. Draw transforms of observed ActiveEnts are gathered into a batch
+ * while propagating, then each observer is called once with only the ActiveEnts it registered.
+ * See SysRender::gather_draw_tf and SysRender::dispatch_draw_tf.
  */
 struct DrawTfObservers
 {
     using UserData_t = std::array<void*, 7>;
-    using Func_t = void(*)(ACtxSceneRender& rCtxScnRdr, Matrix4 const&, active::ActiveEnt, int, UserData_t) noexcept;
+    using Func_t = void(*)(
+            ACtxSceneRender&                        rCtxScnRdr,
+            ArrayView<active::ActiveEnt const>      ents,
+            ArrayView<Matrix4 const>                drawTfs,
+            UserData_t                              data) noexcept;
 
     struct Observer
     {
-        Func_t      func{nullptr};
-        UserData_t  data{};
+        Func_t                  func{nullptr};
+        UserData_t              data{};
+        active::ActiveEntSet_t  ents;   ///< ActiveEnts this observer receives draw transforms of
     };
 
-    std::array<Observer, 16> observers;
+    std::array<Observer, 16>        observers;
+
+    active::ActiveEntSet_t          anyObserved;    ///< Union of all Observer::ents
+
+    // Draw transforms of observed ActiveEnts, gathered during propagation
+    std::vector<active::ActiveEnt>  batchEnts;
+    std::vector<Matrix4>            batchTfs;
+
+    // Per-observer subset of the batch
+    std::vector<active::ActiveEnt>  scratchEnts;
+    std::vector<Matrix4>            scratchTfs;
 };
 
 /**
@@ -95,11 +113,27 @@ struct EntityToDraw
     using ShaderDrawFnc_t = void (*)(
             DrawEnt, ViewProjMatrix const&, UserData_t) noexcept;
 
+    /**
+     * @brief A function pointer to draw many entities at once with a single instanced draw
+     *
+     * All entities passed share the same mesh, texture, and user data.
+     *
+     * @param DrawEnt const*    [in] Entities being drawn
+     * @param std::size_t       [in] Number of entities
+     * @param ViewProjMatrix    [in] View and projection matrix
+     * @param UserData_t        [in] Non-owning user data
+     */
+    using ShaderDrawInstancedFnc_t = void (*)(
+            DrawEnt const*, std::size_t, ViewProjMatrix const&, UserData_t) noexcept;
+
     ShaderDrawFnc_t draw;
 
     // Non-owning user data passed to draw function, such as the shader
     UserData_t data;
 
+    // Optional, nullptr if the shader does not support instancing
+    ShaderDrawInstancedFnc_t drawInstanced{nullptr};
+
 }; // struct EntityToDraw
 
 /**
@@ -143,6 +177,62 @@ public:
             Resources& rResources,
             ResId resId);
 
+    /**
+     * @brief Select a level of detail for visible DrawEnts with meshes, by screen-space error
+     *
+     * The least detailed level that deviates from the original mesh by less than maxErrorPx
+     * pixels on screen is chosen. DrawEnts with meshes without LODs stay at level 0.
+     *
+     * @param rCtxScnRdr        [ref] Scene render data, writes m_meshLod
+     * @param ctxDrawing        [in] Drawing data with MeshLods
+     * @param visible           [in] DrawEnts to select LODs for
+     * @param camera            [in] Camera to measure distance and projected size from
+     * @param viewportHeight    [in] Viewport height in pixels
+     * @param maxErrorPx        [in] Allowed error in pixels
+     */
+    static void select_mesh_lods(
+            ACtxSceneRender&        rCtxScnRdr,
+            ACtxDrawing const&      ctxDrawing,
+            DrawEntSet_t const&     visible,
+            Camera const&           camera,
+            float                   viewportHeight,
+            float                   maxErrorPx = 1.0f);
+
+    /**
+     * @brief Create a DrawEnt, also adding it to ACtxSceneRender::m_drawPacked
+     *
+     * Call resize_draw afterwards before accessing per-DrawEnt data.
+     */
+    static DrawEnt create_draw_ent(ACtxSceneRender& rCtxScnRdr);
+
+    /**
+     * @brief Delete a DrawEnt, swap-removing it from ACtxSceneRender::m_drawPacked
+     *
+     * Bumps its generation so DrawEntRefs to it are no longer current. The Id itself stays taken
+     * until release_pending_draw_ents, so it isn't reused within the same frame. Does nothing if
+     * the DrawEnt doesn't exist or was already removed.
+     */
+    static void remove_draw_ent(ACtxSceneRender& rCtxScnRdr, DrawEnt ent);
+
+    /**
+     * @brief Release Ids of DrawEnts deleted by remove_draw_ent back to m_drawIds for reuse
+     *
+     * Call once per frame, only after everything that could have used the removed Ids is done.
+     */
+    static void release_pending_draw_ents(ACtxSceneRender& rCtxScnRdr);
+
+    [[nodiscard]] static DrawEntRef draw_ent_ref(ACtxSceneRender const& ctxScnRdr, DrawEnt ent) noexcept
+    {
+        return { ent, ctxScnRdr.m_drawPacked.generation[ent] };
+    }
+
+    /**
+     * @return true if ref's DrawEnt exists and wasn't deleted since the ref was made
+     */
+    [[nodiscard]] static bool is_current(ACtxSceneRender const& ctxScnRdr, DrawEntRef ref) noexcept;
+
+    [[nodiscard]] static DrawEntStats draw_ent_stats(ACtxSceneRender const& ctxScnRdr) noexcept;
+
     static TexId own_texture_resource(
             ACtxDrawing& rCtxDrawing,
             ACtxDrawingRes& rCtxDrawingRes,
@@ -185,6 +275,40 @@ public:
             ITB_T const&                last,
             FUNC_T                      func = {});
 
+    /**
+     * @brief Register an ActiveEnt to receive draw transforms of with an observer
+     *
+     * @param rObservers    [ref] Draw transform observers
+     * @param observer      [in] Index of DrawTfObservers::observers
+     * @param ent           [in] ActiveEnt to observe
+     */
+    static void observe_draw_tf(DrawTfObservers& rObservers, std::size_t observer, active::ActiveEnt ent);
+
+    /**
+     * @brief Unregister an ActiveEnt from all observers, such as when it's deleted
+     */
+    static void unobserve_draw_tf(DrawTfObservers& rObservers, active::ActiveEnt ent);
+
+    /**
+     * @brief Add an ActiveEnt's draw transform to the batch if any observer wants it
+     *
+     * Intended to be called from the function passed to update_draw_transforms.
+     */
+    static void gather_draw_tf(DrawTfObservers& rObservers, Matrix4 const& drawTf, active::ActiveEnt ent)
+    {
+        if (   std::size_t(ent) < rObservers.anyObserved.size()
+            && rObservers.anyObserved.test(std::size_t(ent)) )
+        {
+            rObservers.batchEnts.push_back(ent);
+            rObservers.batchTfs .push_back(drawTf);
+        }
+    }
+
+    /**
+     * @brief Call each observer once with the draw transforms gathered for it, then clear the batch
+     */
+    static void dispatch_draw_tf(DrawTfObservers& rObservers, ACtxSceneRender& rCtxScnRdr);
+
     template<typename IT_T>
     static void update_delete_drawing(
             ACtxSceneRender& rCtxScnRdr, ACtxDrawing& rCtxDrawing, IT_T const& first, IT_T const& last);
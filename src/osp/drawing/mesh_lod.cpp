@@ -0,0 +1,533 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "mesh_lod.h"
+#include "own_restypes.h"
+
+#include "../core/Resources.h"
+
+#include <Magnum/VertexFormat.h>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Containers/StridedArrayView.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+using namespace osp;
+using namespace osp::draw;
+
+using Magnum::Trade::MeshData;
+using Magnum::Trade::MeshAttributeData;
+using Magnum::Trade::MeshIndexData;
+using Magnum::MeshPrimitive;
+
+using Corrade::Containers::Array;
+using Corrade::Containers::ArrayView;
+using Corrade::Containers::Optional;
+using Corrade::Containers::StridedArrayView1D;
+
+namespace
+{
+
+// Open edges get this much more weight than surfaces, so outlines and seams are collapsed last
+constexpr double gc_borderWeight = 100.0;
+
+/**
+ * @brief Symmetric 4x4 matrix summing squared distances to a set of planes, plus total weight
+ */
+struct Quadric
+{
+    double a2{0}, ab{0}, ac{0}, ad{0};
+    double        b2{0}, bc{0}, bd{0};
+    double               c2{0}, cd{0};
+    double                      d2{0};
+    double weight{0};
+
+    static Quadric from_plane(Vector3 const& n, double const d, double const w) noexcept
+    {
+        double const a = n.x(), b = n.y(), c = n.z();
+        return { a*a*w, a*b*w, a*c*w, a*d*w,
+                        b*b*w, b*c*w, b*d*w,
+                               c*c*w, c*d*w,
+                                      d*d*w,
+                 w };
+    }
+
+    Quadric& operator+=(Quadric const& rhs) noexcept
+    {
+        a2 += rhs.a2; ab += rhs.ab; ac += rhs.ac; ad += rhs.ad;
+        b2 += rhs.b2; bc += rhs.bc; bd += rhs.bd;
+        c2 += rhs.c2; cd += rhs.cd;
+        d2 += rhs.d2;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    double eval(Vector3 const& p) const noexcept
+    {
+        double const x = p.x(), y = p.y(), z = p.z();
+        return   a2*x*x + 2*ab*x*y + 2*ac*x*z + 2*ad*x
+               + b2*y*y + 2*bc*y*z + 2*bd*y
+               + c2*z*z + 2*cd*z
+               + d2;
+    }
+};
+
+struct Collapse
+{
+    double      cost;
+    uint32_t    from;
+    uint32_t    to;
+    uint32_t    fromVersion;
+    uint32_t    toVersion;
+
+    constexpr bool operator>(Collapse const& rhs) const noexcept { return cost > rhs.cost; }
+};
+
+} // namespace
+
+float draw::simplify_triangles(
+        ArrayView<Vector3 const>    positions,
+        ArrayView<uint32_t const>   indices,
+        std::size_t const           targetTriangles,
+        std::vector<uint32_t>&      rIndicesOut)
+{
+    std::size_t const vrtxCount = positions.size();
+    std::size_t const triCount  = indices.size() / 3;
+
+    rIndicesOut.assign(indices.begin(), indices.begin() + triCount * 3);
+
+    std::vector<Quadric>                quadrics(vrtxCount);
+    std::vector<std::vector<uint32_t>>  vrtxTris(vrtxCount);
+    std::vector<uint32_t>               versions(vrtxCount, 0);
+    std::vector<bool>                   removed(vrtxCount, false);
+    std::vector<bool>                   triAlive(triCount, true);
+    std::size_t                         triAliveCount = triCount;
+
+    auto const edge_key = [] (uint32_t a, uint32_t b) -> uint64_t
+    {
+        return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+    };
+
+    struct EdgeUses
+    {
+        uint32_t count;
+        uint32_t lastTri;
+    };
+    std::unordered_map<uint64_t, EdgeUses> edgeUses;
+
+    auto const tri_normal = [&rIndicesOut, positions] (uint32_t const tri) -> Vector3
+    {
+        Vector3 const& p0 = positions[rIndicesOut[tri * 3 + 0]];
+        Vector3 const& p1 = positions[rIndicesOut[tri * 3 + 1]];
+        Vector3 const& p2 = positions[rIndicesOut[tri * 3 + 2]];
+        return Magnum::Math::cross(p1 - p0, p2 - p0);
+    };
+
+    // Face quadrics, weighted by area
+    for (uint32_t tri = 0; tri < triCount; ++tri)
+    {
+        Vector3 const   normal  = tri_normal(tri);
+        float const     length  = normal.length();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            uint32_t const a = rIndicesOut[tri * 3 + i];
+            uint32_t const b = rIndicesOut[tri * 3 + (i + 1) % 3];
+            vrtxTris[a].push_back(tri);
+
+            EdgeUses &rUses = edgeUses[edge_key(a, b)];
+            ++rUses.count;
+            rUses.lastTri = tri;
+        }
+
+        if (length > 0.0f)
+        {
+            Vector3 const   unit = normal / length;
+            double const    d    = -Magnum::Math::dot(unit, positions[rIndicesOut[tri * 3]]);
+            Quadric const   q    = Quadric::from_plane(unit, d, length * 0.5);
+            for (int i = 0; i < 3; ++i)
+            {
+                quadrics[rIndicesOut[tri * 3 + i]] += q;
+            }
+        }
+    }
+
+    // Border quadrics, planes perpendicular to faces along open edges
+    for (auto const& [key, uses] : edgeUses)
+    {
+        if (uses.count != 1)
+        {
+            continue;
+        }
+
+        auto const      a       = uint32_t(key >> 32);
+        auto const      b       = uint32_t(key & 0xFFFFFFFF);
+        Vector3 const   edge    = positions[b] - positions[a];
+        Vector3 const   normal  = Magnum::Math::cross(edge, tri_normal(uses.lastTri));
+        float const     length  = normal.length();
+
+        if (length > 0.0f)
+        {
+            Vector3 const   unit = normal / length;
+            double const    d    = -Magnum::Math::dot(unit, positions[a]);
+            Quadric const   q    = Quadric::from_plane(unit, d, edge.dot() * gc_borderWeight);
+            quadrics[a] += q;
+            quadrics[b] += q;
+        }
+    }
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+    auto const push_collapse = [&] (uint32_t const a, uint32_t const b)
+    {
+        Quadric sum = quadrics[a];
+        sum += quadrics[b];
+
+        // Collapse onto whichever vertex results in less error
+        double const costAtB = sum.eval(positions[b]);
+        double const costAtA = sum.eval(positions[a]);
+        uint32_t const from  = (costAtB <= costAtA) ? a : b;
+        uint32_t const to    = (costAtB <= costAtA) ? b : a;
+
+        // Normalize by weight, so cost is a mean squared distance
+        double const cost = std::max(0.0, std::min(costAtA, costAtB)) / std::max(sum.weight, 1e-12);
+
+        queue.push({cost, from, to, versions[from], versions[to]});
+    };
+
+    for (auto const& [key, uses] : edgeUses)
+    {
+        push_collapse(uint32_t(key >> 32), uint32_t(key & 0xFFFFFFFF));
+    }
+
+    double                  maxCost = 0.0;
+    std::vector<uint32_t>   neighbors;
+
+    while (triAliveCount > targetTriangles && ! queue.empty())
+    {
+        Collapse const collapse = queue.top();
+        queue.pop();
+
+        uint32_t const from = collapse.from;
+        uint32_t const to   = collapse.to;
+
+        if (   removed[from] || removed[to]
+            || versions[from] != collapse.fromVersion
+            || versions[to]   != collapse.toVersion)
+        {
+            continue; // Outdated
+        }
+
+        // Reject collapses that flip a triangle that isn't removed by it
+        bool flips = false;
+        for (uint32_t const tri : vrtxTris[from])
+        {
+            uint32_t *pTri = &rIndicesOut[tri * 3];
+            if ( ! triAlive[tri] || pTri[0] == to || pTri[1] == to || pTri[2] == to )
+            {
+                continue;
+            }
+
+            Vector3 const before = tri_normal(tri);
+            std::replace(pTri, pTri + 3, from, to);
+            Vector3 const after = tri_normal(tri);
+            std::replace(pTri, pTri + 3, to, from);
+
+            if (Magnum::Math::dot(before, after) <= 0.0f)
+            {
+                flips = true;
+                break;
+            }
+        }
+
+        if (flips)
+        {
+            continue; // Retried if a neighbor collapses and pushes this edge again
+        }
+
+        removed[from] = true;
+        quadrics[to] += quadrics[from];
+        maxCost = std::max(maxCost, collapse.cost);
+
+        for (uint32_t const tri : vrtxTris[from])
+        {
+            if ( ! triAlive[tri] )
+            {
+                continue;
+            }
+
+            uint32_t *pTri = &rIndicesOut[tri * 3];
+            std::replace(pTri, pTri + 3, from, to);
+
+            if (pTri[0] == pTri[1] || pTri[1] == pTri[2] || pTri[2] == pTri[0])
+            {
+                triAlive[tri] = false;
+                --triAliveCount;
+            }
+            else
+            {
+                vrtxTris[to].push_back(tri);
+            }
+        }
+        vrtxTris[from].clear();
+        vrtxTris[from].shrink_to_fit();
+
+        // Drop dead triangles, then requeue all edges around the merged vertex
+        std::vector<uint32_t> &rToTris = vrtxTris[to];
+        rToTris.erase(std::remove_if(rToTris.begin(), rToTris.end(),
+                                     [&triAlive] (uint32_t tri) { return ! triAlive[tri]; }),
+                      rToTris.end());
+
+        ++versions[to];
+
+        neighbors.clear();
+        for (uint32_t const tri : rToTris)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                uint32_t const vrtx = rIndicesOut[tri * 3 + i];
+                if (vrtx != to)
+                {
+                    neighbors.push_back(vrtx);
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        for (uint32_t const vrtx : neighbors)
+        {
+            push_collapse(to, vrtx);
+        }
+    }
+
+    // Write out remaining triangles
+    std::size_t out = 0;
+    for (uint32_t tri = 0; tri < triCount; ++tri)
+    {
+        if (triAlive[tri])
+        {
+            std::copy_n(&rIndicesOut[tri * 3], 3, &rIndicesOut[out * 3]);
+            ++out;
+        }
+    }
+    rIndicesOut.resize(out * 3);
+
+    return float(std::sqrt(maxCost));
+}
+
+Optional<MeshData> draw::create_mesh_lod(
+        MeshData const&     mesh,
+        std::size_t const   targetTriangles,
+        float&              rError)
+{
+    using Magnum::Trade::MeshAttribute;
+
+    if (   mesh.primitive() != MeshPrimitive::Triangles
+        || ! mesh.hasAttribute(MeshAttribute::Position))
+    {
+        return {};
+    }
+
+    for (Magnum::UnsignedInt i = 0; i < mesh.attributeCount(); ++i)
+    {
+        if (Magnum::isVertexFormatImplementationSpecific(mesh.attributeFormat(i)))
+        {
+            return {}; // Size unknown, can't copy
+        }
+    }
+
+    Array<Vector3> const positions = mesh.positions3DAsArray();
+
+    std::vector<uint32_t> indicesIn;
+    if (mesh.isIndexed())
+    {
+        Array<Magnum::UnsignedInt> const meshIndices = mesh.indicesAsArray();
+        indicesIn.assign(meshIndices.begin(), meshIndices.end());
+    }
+    else
+    {
+        indicesIn.resize(mesh.vertexCount());
+        for (uint32_t i = 0; i < indicesIn.size(); ++i)
+        {
+            indicesIn[i] = i;
+        }
+    }
+
+    std::vector<uint32_t> indicesOut;
+    rError = simplify_triangles(positions, indicesIn, targetTriangles, indicesOut);
+
+    if (indicesOut.empty())
+    {
+        return {};
+    }
+
+    // Keep only used vertices, numbered in order of first use
+    constexpr uint32_t  unused = ~uint32_t(0);
+    std::vector<uint32_t> newToOld;
+    std::vector<uint32_t> oldToNew(mesh.vertexCount(), unused);
+    for (uint32_t &rIndex : indicesOut)
+    {
+        if (oldToNew[rIndex] == unused)
+        {
+            oldToNew[rIndex] = uint32_t(newToOld.size());
+            newToOld.push_back(rIndex);
+        }
+        rIndex = oldToNew[rIndex];
+    }
+
+    // Interleave all attributes into a single vertex buffer
+    Magnum::UnsignedInt const attribCount = mesh.attributeCount();
+    std::vector<std::size_t> attribOffsets(attribCount);
+    std::vector<std::size_t> attribSizes(attribCount);
+    std::size_t stride = 0;
+    for (Magnum::UnsignedInt i = 0; i < attribCount; ++i)
+    {
+        attribOffsets[i] = stride;
+        attribSizes[i]   = Magnum::vertexFormatSize(mesh.attributeFormat(i))
+                         * std::max<std::size_t>(mesh.attributeArraySize(i), 1);
+        stride += attribSizes[i];
+    }
+
+    std::size_t const vrtxCount = newToOld.size();
+    Array<char> vertexData{Corrade::NoInit, vrtxCount * stride};
+    Array<MeshAttributeData> attributes{attribCount};
+
+    for (Magnum::UnsignedInt i = 0; i < attribCount; ++i)
+    {
+        auto const src = mesh.attribute(i);
+        for (std::size_t vrtx = 0; vrtx < vrtxCount; ++vrtx)
+        {
+            std::memcpy(vertexData.data() + vrtx * stride + attribOffsets[i],
+                        src[newToOld[vrtx]].data(), attribSizes[i]);
+        }
+
+        attributes[i] = MeshAttributeData{
+                mesh.attributeName(i), mesh.attributeFormat(i),
+                StridedArrayView1D<void const>{vertexData, vertexData.data() + attribOffsets[i],
+                                               vrtxCount, std::ptrdiff_t(stride)},
+                mesh.attributeArraySize(i)};
+    }
+
+    Array<char> indexData{Corrade::NoInit, indicesOut.size() * sizeof(Magnum::UnsignedInt)};
+    auto const indexView = Corrade::Containers::arrayCast<Magnum::UnsignedInt>(indexData);
+    std::copy(indicesOut.begin(), indicesOut.end(), indexView.begin());
+
+    return MeshData{MeshPrimitive::Triangles,
+                    std::move(indexData), MeshIndexData{indexView},
+                    std::move(vertexData), std::move(attributes),
+                    Magnum::UnsignedInt(vrtxCount)};
+}
+
+GeneratedMeshLods draw::compute_mesh_lods(
+        MeshData const& mesh,
+        int const       maxLevels,
+        float const     ratio)
+{
+    // Too few triangles to be worth another level
+    constexpr std::size_t minTriangles = 32;
+
+    GeneratedMeshLods out;
+
+    std::size_t const triangles = (mesh.isIndexed() ? mesh.indexCount()
+                                                    : mesh.vertexCount()) / 3;
+    std::size_t prevTriangles = triangles;
+    float       target        = float(triangles);
+
+    for (int level = 0; level < maxLevels; ++level)
+    {
+        target *= ratio;
+        if (target < float(minTriangles))
+        {
+            break;
+        }
+
+        float error = 0.0f;
+        Optional<MeshData> lod = create_mesh_lod(mesh, std::size_t(target), error);
+
+        // Stop if the simplifier got stuck, e.g. on a mesh made of many loose pieces
+        if ( ! lod || lod->indexCount() / 3 > prevTriangles * 9 / 10 )
+        {
+            break;
+        }
+
+        prevTriangles = lod->indexCount() / 3;
+        out.m_levels.push_back(std::move(*lod));
+        out.m_errors.push_back(error);
+    }
+
+    return out;
+}
+
+void draw::add_mesh_lods(
+        Resources&          rResources,
+        ResId const         meshRes,
+        PkgId const         pkg,
+        GeneratedMeshLods&& lods)
+{
+    if (lods.m_levels.empty())
+    {
+        return;
+    }
+
+    std::string const name{rResources.name(restypes::gc_mesh, meshRes)};
+
+    MeshLodChain chain;
+    for (std::size_t i = 0; i < lods.m_levels.size(); ++i)
+    {
+        ResId const lodRes = rResources.create(
+                restypes::gc_mesh, pkg,
+                SharedString::create_from_parts(name, ":lod", std::to_string(i + 1)));
+        rResources.data_add<MeshData>(restypes::gc_mesh, lodRes, std::move(lods.m_levels[i]));
+        chain.m_levels.push_back(rResources.owner_create(restypes::gc_mesh, lodRes));
+    }
+    chain.m_errors = std::move(lods.m_errors);
+
+    rResources.data_add<MeshLodChain>(restypes::gc_mesh, meshRes, std::move(chain));
+}
+
+void draw::generate_mesh_lods(
+        Resources&      rResources,
+        ResId const     meshRes,
+        PkgId const     pkg,
+        int const       maxLevels,
+        float const     ratio)
+{
+    // Generated first, as adding resources may move the original MeshData
+    auto const *pMesh = rResources.data_try_get<MeshData const>(restypes::gc_mesh, meshRes);
+    if (pMesh == nullptr)
+    {
+        return;
+    }
+
+    add_mesh_lods(rResources, meshRes, pkg, compute_mesh_lods(*pMesh, maxLevels, ratio));
+}
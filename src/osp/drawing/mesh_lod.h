@@ -0,0 +1,142 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../core/math_types.h"
+#include "../core/resourcetypes.h"
+
+#include <Magnum/Trade/MeshData.h>
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace osp
+{
+
+class Resources;
+
+namespace draw
+{
+
+/**
+ * @brief Reduce the triangle count of an indexed triangle list using quadric error metrics
+ *
+ * Edges are collapsed onto one of their vertices, cheapest first, so no new vertices are
+ * created. Open edges (including UV and normal seams) are weighted heavily to keep outlines and
+ * seams intact, and collapses that would flip a triangle are skipped.
+ *
+ * @param positions         [in] Vertex positions
+ * @param indices           [in] Triangle list indices into positions
+ * @param targetTriangles   [in] Stop once this many triangles are left
+ * @param rIndicesOut       [out] Indices of the remaining triangles, into the same positions
+ *
+ * @return Approximate max distance of the result from the original surface
+ */
+float simplify_triangles(
+        Corrade::Containers::ArrayView<Vector3 const>   positions,
+        Corrade::Containers::ArrayView<uint32_t const>  indices,
+        std::size_t                                     targetTriangles,
+        std::vector<uint32_t>&                          rIndicesOut);
+
+/**
+ * @brief Create a simplified copy of a triangle mesh
+ *
+ * Only vertices used by the remaining triangles are kept. All vertex attributes are copied,
+ * interleaved into a single buffer.
+ *
+ * @param mesh              [in] Mesh to simplify, must be a triangle mesh with positions
+ * @param targetTriangles   [in] Triangle count to aim for
+ * @param rError            [out] Approximate max distance from the original surface
+ *
+ * @return Simplified mesh, or NullOpt if the mesh can't be simplified
+ */
+Corrade::Containers::Optional<Magnum::Trade::MeshData> create_mesh_lod(
+        Magnum::Trade::MeshData const&  mesh,
+        std::size_t                     targetTriangles,
+        float&                          rError);
+
+/**
+ * @brief Simplified levels of a mesh, not yet added to any Resources
+ */
+struct GeneratedMeshLods
+{
+    std::vector<Magnum::Trade::MeshData>    m_levels;
+    std::vector<float>                      m_errors;
+};
+
+/**
+ * @brief Create a chain of simplified meshes, each with about [ratio] times the triangles of the
+ *        previous one
+ *
+ * Doesn't touch Resources, so can run on any thread.
+ *
+ * @param mesh          [in] Triangle mesh to simplify
+ * @param maxLevels     [in] Max number of simplified levels
+ * @param ratio         [in] Triangle count of each level relative to the previous
+ */
+GeneratedMeshLods compute_mesh_lods(
+        Magnum::Trade::MeshData const&  mesh,
+        int                             maxLevels   = 3,
+        float                           ratio       = 0.5f);
+
+/**
+ * @brief Add levels from compute_mesh_lods as new gc_mesh resources, listed in a MeshLodChain
+ *        added to meshRes
+ *
+ * @param rResources    [ref] Resources containing meshRes
+ * @param meshRes       [in] Mesh resource the levels were computed from
+ * @param pkg           [in] Package to create new resources in
+ * @param lods          [in] Levels to add
+ */
+void add_mesh_lods(
+        Resources&          rResources,
+        ResId               meshRes,
+        PkgId               pkg,
+        GeneratedMeshLods&& lods);
+
+/**
+ * @brief Generate a chain of simplified meshes for a gc_mesh resource
+ *
+ * Each level has about [ratio] times the triangles of the previous one. Levels are added as new
+ * gc_mesh resources in the same package, and are listed in a MeshLodChain added to meshRes.
+ *
+ * @param rResources    [ref] Resources containing meshRes
+ * @param meshRes       [in] Mesh resource with MeshData
+ * @param pkg           [in] Package to create new resources in
+ * @param maxLevels     [in] Max number of simplified levels
+ * @param ratio         [in] Triangle count of each level relative to the previous
+ */
+void generate_mesh_lods(
+        Resources&      rResources,
+        ResId           meshRes,
+        PkgId           pkg,
+        int             maxLevels   = 3,
+        float           ratio       = 0.5f);
+
+} // namespace draw
+} // namespace osp
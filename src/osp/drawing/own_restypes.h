@@ -26,6 +26,8 @@
 
 #include "../core/resourcetypes.h"
 
+#include <vector>
+
 namespace osp
 {
 
@@ -40,4 +42,16 @@ inline ResTypeId const gc_mesh          = ResTypeIdReg_t::create();
 
 struct TextureImgSource : public ResIdOwner_t { };
 
+/**
+ * @brief Simplified versions of a mesh resource, ordered from most to least detailed
+ *
+ * m_errors[i] is roughly how far m_levels[i] deviates from the original mesh, in the mesh's own
+ * units. Added to gc_mesh resources by generate_mesh_lods.
+ */
+struct MeshLodChain
+{
+    std::vector<ResIdOwner_t>   m_levels;
+    std::vector<float>          m_errors;
+};
+
 } // namespace osp
@@ -63,7 +63,7 @@ void SysPrefabDraw::init_drawents(
             }
 
             ActiveEnt const ent = ents[i];
-            rScnRender.m_activeToDraw[ent] = rScnRender.m_drawIds.create();
+            rScnRender.m_activeToDraw[ent] = SysRender::create_draw_ent(rScnRender);
         }
 
         ++itPfEnts;
@@ -101,7 +101,7 @@ void SysPrefabDraw::resync_drawents(
             }
 
             LGRN_ASSERT(rScnRender.m_activeToDraw[ent] == lgrn::id_null<DrawEnt>());
-            rScnRender.m_activeToDraw[ent] = rScnRender.m_drawIds.create();
+            rScnRender.m_activeToDraw[ent] = SysRender::create_draw_ent(rScnRender);
         }
     }
 }
@@ -27,17 +27,23 @@
 #include "FullscreenTriShader.h"
 
 #include "../core/Resources.h"
+#include "../core/radix_sort.h"
+#include "../drawing/draw_commands_fn.h"
 #include "../drawing/own_restypes.h"
 #include "../util/logging.h"
 
 #include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
 
 #include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/BufferImage.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/TextureFormat.h>
 #include <Magnum/GL/RenderbufferFormat.h>
 
+#include <Magnum/Shaders/GenericGL.h>
+
 #include <Corrade/Containers/ArrayViewStl.h>
 
 #include <Magnum/Trade/MeshData.h>
@@ -47,6 +53,10 @@
 #include <Magnum/Mesh.h>
 #include <Magnum/MeshTools/Compile.h>
 
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
 using Magnum::Trade::MeshData;
 using Magnum::Trade::TextureData;
 using Magnum::Trade::ImageData2D;
@@ -92,6 +102,9 @@ void SysRenderGL::setup_context(RenderGL& rCtxGl)
                 FullscreenTriShader::TextureCoordinates{});
     }
 
+    rCtxGl.m_instanceBuffer = GL::Buffer{};
+    rCtxGl.m_uploads.pixelUnpack = GL::BufferImage2D{Magnum::PixelFormat::RGBA8Unorm};
+
     /* Add an offscreen framebuffer */
     {
         Vector2i const viewSize = GL::defaultFramebuffer.viewport().size();
@@ -109,6 +122,21 @@ void SysRenderGL::setup_context(RenderGL& rCtxGl)
     }
 }
 
+static Magnum::GL::Texture2D make_placeholder_texture()
+{
+    using namespace Magnum;
+
+    Color4ub const white{255, 255, 255, 255};
+
+    GL::Texture2D tex;
+    tex.setMinificationFilter(GL::SamplerFilter::Nearest)
+       .setMagnificationFilter(GL::SamplerFilter::Nearest)
+       .setStorage(1, GL::TextureFormat::RGBA8, {1, 1})
+       .setSubImage(0, {}, ImageView2D{PixelFormat::RGBA8Unorm, {1, 1},
+                                       Corrade::Containers::arrayView(&white, 1)});
+    return tex;
+}
+
 void SysRenderGL::compile_resource_textures(
         ACtxDrawingRes const&   rCtxDrawRes,
         Resources&              rResources,
@@ -130,10 +158,6 @@ void SysRenderGL::compile_resource_textures(
         // New element emplaced, this means we've just found a resource that
         // isn't synchronized yet.
 
-        using Magnum::GL::SamplerWrapping;
-        using Magnum::GL::SamplerFilter;
-        using Magnum::GL::textureFormat;
-
         // Create new Texture GL Id
         TexGlId const newId = rRenderGl.m_texIds.create();
 
@@ -145,25 +169,9 @@ void SysRenderGL::compile_resource_textures(
         rRenderGl.m_texToRes.emplace(newId, std::move(renderOwner));
         it->second = newId;
 
-        ResId const imgRes = rResources.data_get<TextureImgSource>(restypes::gc_texture, texRes);
-        auto const &texData = rResources.data_get<TextureData>(restypes::gc_texture, texRes);
-        auto const &imgData = rResources.data_get<ImageData2D>(restypes::gc_image, imgRes);
-
-        if (texData.type() != Magnum::Trade::TextureType::Texture2D)
-        {
-
-            OSP_LOG_WARN("Unsupported texture type for texture resource: {}",
-                         rResources.name(restypes::gc_texture, texRes));
-            continue;
-        }
-
-        rRenderGl.m_texGl.emplace(newId)
-                .setMinificationFilter(texData.minificationFilter(),
-                                       texData.mipmapFilter())
-                .setMagnificationFilter(texData.magnificationFilter())
-                .setWrapping(texData.wrapping().xy())
-                .setStorage(1, textureFormat(imgData.format()), imgData.size())
-                .setSubImage(0, {}, imgData);
+        // Upload later, see process_uploads
+        rRenderGl.m_texGl.emplace(newId, make_placeholder_texture());
+        rRenderGl.m_uploads.textures.push_back(newId);
     }
 }
 
@@ -199,14 +207,105 @@ void SysRenderGL::compile_resource_meshes(
         rRenderGl.m_meshToRes.emplace(newId, std::move(renderOwner));
         it->second = newId;
 
-        // Get mesh data
-        auto const &meshData = rResources.data_get<MeshData>(restypes::gc_mesh, meshRes);
+        // Empty placeholder draws nothing until uploaded, see process_uploads
+        rRenderGl.m_meshGl.emplace(newId);
+        rRenderGl.m_uploads.meshes.push_back(newId);
 
-        // Compile and store mesh
-        rRenderGl.m_meshGl.emplace(newId, Magnum::MeshTools::compile(meshData));
+        auto const meshInt = std::size_t(newId);
+        if (rRenderGl.m_uploads.meshesPending.size() <= meshInt)
+        {
+            bitvector_resize(rRenderGl.m_uploads.meshesPending, meshInt + 1);
+        }
+        rRenderGl.m_uploads.meshesPending.set(meshInt);
     }
 }
 
+static std::size_t upload_mesh(Resources& rResources, RenderGL& rRenderGl, MeshGlId const meshId)
+{
+    ResId const meshRes     = rRenderGl.m_meshToRes.at(meshId).value();
+    auto const  &meshData   = rResources.data_get<MeshData>(restypes::gc_mesh, meshRes);
+
+    rRenderGl.m_meshGl.get(meshId) = Magnum::MeshTools::compile(meshData);
+    rRenderGl.m_uploads.meshesPending.reset(std::size_t(meshId));
+
+    // Instance buffer was attached to the placeholder, attach again to the new mesh if needed
+    if (std::size_t(meshId) < rRenderGl.m_meshHasInstances.size())
+    {
+        rRenderGl.m_meshHasInstances.reset(std::size_t(meshId));
+    }
+
+    return meshData.vertexData().size() + meshData.indexData().size();
+}
+
+static std::size_t upload_texture(Resources& rResources, RenderGL& rRenderGl, TexGlId const texId)
+{
+    using Magnum::GL::textureFormat;
+    using Magnum::GL::BufferUsage;
+
+    ResId const texRes  = rRenderGl.m_texToRes.at(texId).value();
+    ResId const imgRes  = rResources.data_get<TextureImgSource>(restypes::gc_texture, texRes);
+    auto const &texData = rResources.data_get<TextureData>(restypes::gc_texture, texRes);
+    auto const &imgData = rResources.data_get<ImageData2D>(restypes::gc_image, imgRes);
+
+    if (texData.type() != Magnum::Trade::TextureType::Texture2D)
+    {
+        OSP_LOG_WARN("Unsupported texture type for texture resource: {}",
+                     rResources.name(restypes::gc_texture, texRes));
+        return 0; // Keep the placeholder
+    }
+
+    // Copy into the pixel unpack buffer; the texture upload below reads from the buffer instead
+    // of client memory, so the driver doesn't need to block on it
+    Magnum::GL::BufferImage2D &rPixels = rRenderGl.m_uploads.pixelUnpack;
+    rPixels.setData(imgData.storage(), imgData.format(), imgData.size(), imgData.data(),
+                    BufferUsage::StreamDraw);
+
+    Magnum::GL::Texture2D &rTex = rRenderGl.m_texGl.get(texId);
+    rTex = Magnum::GL::Texture2D{}; // Storage is immutable, replace the placeholder
+    rTex.setMinificationFilter(texData.minificationFilter(), texData.mipmapFilter())
+        .setMagnificationFilter(texData.magnificationFilter())
+        .setWrapping(texData.wrapping().xy())
+        .setStorage(1, textureFormat(imgData.format()), imgData.size())
+        .setSubImage(0, {}, rPixels);
+
+    return imgData.data().size();
+}
+
+std::size_t SysRenderGL::process_uploads(Resources& rResources, RenderGL& rRenderGl)
+{
+    using Clock = std::chrono::steady_clock;
+
+    UploadQueueGL &rUploads = rRenderGl.m_uploads;
+
+    Clock::time_point const start   = Clock::now();
+    std::size_t             bytes   = 0;
+
+    auto const within_budget = [&rUploads, &bytes, start] () -> bool
+    {
+        return    bytes < rUploads.bytesPerFrame
+               && (Clock::now() - start) < rUploads.timePerFrame;
+    };
+
+    while ( ( ! rUploads.meshes.empty() || ! rUploads.textures.empty() ) && within_budget() )
+    {
+        bool const doTexture = rUploads.meshes.empty()
+                            || (rUploads.textureTurn && ! rUploads.textures.empty());
+        if (doTexture)
+        {
+            bytes += upload_texture(rResources, rRenderGl, rUploads.textures.front());
+            rUploads.textures.pop_front();
+        }
+        else
+        {
+            bytes += upload_mesh(rResources, rRenderGl, rUploads.meshes.front());
+            rUploads.meshes.pop_front();
+        }
+        rUploads.textureTurn = ! doTexture;
+    }
+
+    return rUploads.meshes.size() + rUploads.textures.size();
+}
+
 void SysRenderGL::sync_drawent_mesh(
         DrawEnt const                               ent,
         KeyedVec<DrawEnt, MeshIdOwner_t> const&     cmpMeshIds,
@@ -227,6 +326,7 @@ void SysRenderGL::sync_drawent_mesh(
         }
 
         rEntMeshGl.m_scnId = entMeshScnId;
+        rEntMeshGl.m_lod   = 0;
 
         // Check if MeshId is associated with a resource
         if (auto const& foundIt = meshToRes.find(entMeshScnId);
@@ -257,6 +357,61 @@ void SysRenderGL::sync_drawent_mesh(
     }
 }
 
+void SysRenderGL::apply_mesh_lods(
+        ACtxSceneRender const&                      scnRender,
+        DrawEntSet_t const&                         visible,
+        ACtxDrawing const&                          drawing,
+        ACtxDrawingRes const&                       drawingRes,
+        MeshGlEntStorage_t&                         rCmpMeshGl,
+        RenderGL const&                             renderGl)
+{
+    BitVector_t const &pending = renderGl.m_uploads.meshesPending;
+
+    for (std::size_t const drawEntInt : visible.ones())
+    {
+        auto const  drawEnt     = DrawEnt(drawEntInt);
+        ACompMeshGl &rEntMeshGl = rCmpMeshGl[drawEnt];
+        MeshId const scnId      = rEntMeshGl.m_scnId;
+
+        if (   scnId == lgrn::id_null<MeshId>()
+            || std::size_t(scnId) >= drawing.m_meshLods.size())
+        {
+            continue;
+        }
+
+        MeshLods const &lods    = drawing.m_meshLods[scnId];
+        uint8_t const   lod     = std::min<uint8_t>(scnRender.m_meshLod[drawEnt],
+                                                    uint8_t(lods.levels.size()));
+        if (lod == rEntMeshGl.m_lod)
+        {
+            continue;
+        }
+
+        MeshId const    lodScnId    = (lod == 0) ? scnId : lods.levels[lod - 1];
+        auto const      foundRes    = drawingRes.m_meshToRes.find(lodScnId);
+        if (foundRes == drawingRes.m_meshToRes.end())
+        {
+            continue;
+        }
+
+        auto const foundGl = renderGl.m_resToMesh.find(foundRes->second.value());
+        if (foundGl == renderGl.m_resToMesh.end())
+        {
+            continue; // Not compiled yet
+        }
+
+        MeshGlId const  glId    = foundGl->second;
+        auto const      glInt   = std::size_t(glId);
+        if (glInt < pending.size() && pending.test(glInt))
+        {
+            continue; // Keep drawing the previous level until this one is uploaded
+        }
+
+        rEntMeshGl.m_glId   = glId;
+        rEntMeshGl.m_lod    = lod;
+    }
+}
+
 void SysRenderGL::sync_drawent_texture(
         DrawEnt const                               ent,
         KeyedVec<DrawEnt, TexIdOwner_t> const&      cmpTexIds,
@@ -340,12 +495,16 @@ void SysRenderGL::clear_resource_owners(RenderGL& rRenderGl, Resources& rResourc
         rResources.owner_destroy(restypes::gc_mesh, std::move(rOwner));
     }
     rRenderGl.m_resToMesh.clear();
+
+    rRenderGl.m_uploads.meshes  .clear();
+    rRenderGl.m_uploads.textures.clear();
+
+    // Owners are released above, nothing is left to upload
+    auto &rPendingInts = rRenderGl.m_uploads.meshesPending.ints();
+    std::fill(rPendingInts.begin(), rPendingInts.end(), 0u);
 }
 
-void SysRenderGL::render_opaque(
-        RenderGroup const& group,
-        DrawEntSet_t const& visible,
-        ViewProjMatrix const& viewProj)
+static void set_opaque_state()
 {
     using Magnum::GL::Renderer;
 
@@ -353,14 +512,9 @@ void SysRenderGL::render_opaque(
     Renderer::enable(Renderer::Feature::FaceCulling);
     Renderer::disable(Renderer::Feature::Blending);
     Renderer::setDepthMask(GL_TRUE);
-
-    draw_group(group, visible, viewProj);
 }
 
-void SysRenderGL::render_transparent(
-        RenderGroup const& group,
-        DrawEntSet_t const& visible,
-        ViewProjMatrix const& viewProj)
+static void set_transparent_state()
 {
     using Magnum::GL::Renderer;
 
@@ -374,10 +528,46 @@ void SysRenderGL::render_transparent(
     // temporary: disabled depth writing makes the plumes look nice, but
     //            can mess up other transparent objects once added
     //Renderer::setDepthMask(GL_FALSE);
+}
 
+void SysRenderGL::render_opaque(
+        RenderGroup const& group,
+        DrawEntSet_t const& visible,
+        ViewProjMatrix const& viewProj)
+{
+    set_opaque_state();
+    draw_group(group, visible, viewProj);
+}
+
+void SysRenderGL::render_transparent(
+        RenderGroup const& group,
+        DrawEntSet_t const& visible,
+        ViewProjMatrix const& viewProj)
+{
+    set_transparent_state();
     draw_group(group, visible, viewProj);
 }
 
+void SysRenderGL::render_opaque(
+        RenderGroup const& group,
+        ViewProjMatrix const& viewProj,
+        ACtxDrawCommands const& cmds,
+        ACtxSceneRenderGL& rScnRenderGl)
+{
+    set_opaque_state();
+    draw_group_instanced(group, viewProj, cmds, rScnRenderGl, EDrawSort::FrontToBack);
+}
+
+void SysRenderGL::render_transparent(
+        RenderGroup const& group,
+        ViewProjMatrix const& viewProj,
+        ACtxDrawCommands const& cmds,
+        ACtxSceneRenderGL& rScnRenderGl)
+{
+    set_transparent_state();
+    draw_group_instanced(group, viewProj, cmds, rScnRenderGl, EDrawSort::BackToFront);
+}
+
 void SysRenderGL::draw_group(
         RenderGroup const& group,
         DrawEntSet_t const& visible,
@@ -391,3 +581,177 @@ void SysRenderGL::draw_group(
         }
     }
 }
+
+static uint64_t shader_index(DrawBatchesGL& rBatches, EntityToDraw::UserData_t const& data)
+{
+    // Only a handful of shaders are expected, a linear search is fine
+    auto const found = std::find(rBatches.shaders.begin(), rBatches.shaders.end(), data);
+    if (found != rBatches.shaders.end())
+    {
+        return std::distance(rBatches.shaders.begin(), found);
+    }
+    rBatches.shaders.push_back(data);
+    return rBatches.shaders.size() - 1;
+}
+
+/**
+ * @brief Quantize depth in front of the camera to 24 bits, preserving order
+ *
+ * Bit patterns of positive floats sort the same as their values; drop the lowest mantissa bits.
+ */
+static uint64_t depth_bits(float const depth)
+{
+    return std::bit_cast<uint32_t>(std::max(0.0f, depth)) >> 8;
+}
+
+static uint64_t make_sort_key(
+        uint64_t const  shader,
+        TexGlId const   texId,
+        MeshGlId const  meshId,
+        uint64_t const  depth,
+        EDrawSort const sort)
+{
+    // Ids beyond 16 bits only degrade sorting, batches are still compared by full Id
+    uint64_t const tex   = uint64_t(texId)  & 0xFFFF;
+    uint64_t const mesh  = uint64_t(meshId) & 0xFFFF;
+    uint64_t const shdr  = std::min<uint64_t>(shader, 0xFF);
+
+    switch (sort)
+    {
+    case EDrawSort::FrontToBack:
+        // [ shader:8 | texture:16 | mesh:16 | depth:24 ]
+        return (shdr << 56) | (tex << 40) | (mesh << 24) | depth;
+    case EDrawSort::BackToFront:
+    default:
+        // [ inverted depth:24 | shader:8 | texture:16 | mesh:16 ]
+        return ((~depth & 0xFFFFFF) << 40) | (shdr << 32) | (tex << 16) | mesh;
+    }
+}
+
+void SysRenderGL::draw_group_instanced(
+        RenderGroup const& group,
+        ViewProjMatrix const& viewProj,
+        ACtxDrawCommands const& cmds,
+        ACtxSceneRenderGL& rScnRenderGl,
+        EDrawSort const sort)
+{
+    using Entry = DrawBatchesGL::Entry;
+
+    DrawBatchesGL &rBatches = rScnRenderGl.m_batches;
+    rBatches.entries.clear();
+    rBatches.shaders.clear();
+
+    // Build render queue from DrawEnts with a command recorded this frame
+    for (auto const& [ent, toDraw] : entt::basic_view{group.entities}.each())
+    {
+        DrawCommand const *pCmd = SysDrawCommands::find(cmds, ent);
+        if (pCmd == nullptr)
+        {
+            continue; // Not visible, or culled
+        }
+
+        TexGlId const texId = (std::size_t(ent) < rScnRenderGl.m_diffuseTexId.size())
+                            ? rScnRenderGl.m_diffuseTexId[ent].m_glId
+                            : lgrn::id_null<TexGlId>();
+
+        MeshGlId const meshId = rScnRenderGl.m_meshId[ent].m_glId;
+
+        uint64_t const key = make_sort_key(shader_index(rBatches, toDraw.data), texId, meshId,
+                                           depth_bits(pCmd->depth), sort);
+
+        rBatches.entries.push_back({key, &toDraw, meshId, texId, ent});
+    }
+
+    radix_sort_u64(rBatches.entries, rBatches.entriesScratch,
+                   [] (Entry const& entry) -> uint64_t { return entry.key; });
+
+    auto const same_batch = [] (Entry const& lhs, Entry const& rhs) -> bool
+    {
+        return    lhs.meshId                 == rhs.meshId
+               && lhs.texId                  == rhs.texId
+               && lhs.pToDraw->drawInstanced == rhs.pToDraw->drawInstanced
+               && lhs.pToDraw->data          == rhs.pToDraw->data;
+    };
+
+    RenderStatsGL &rStats = rBatches.stats;
+    Entry const *pPrev = nullptr;
+
+    // Dispatch in sorted order, merging runs of compatible DrawEnts into instanced draws
+    auto first = rBatches.entries.begin();
+    while (first != rBatches.entries.end())
+    {
+        EntityToDraw const &toDraw = *first->pToDraw;
+
+        // Counts runs of entries sharing the same shader/texture/mesh, not actual GL binds
+        rStats.shaderRuns  += (pPrev == nullptr || pPrev->pToDraw->data != toDraw.data)  ? 1 : 0;
+        rStats.textureRuns += (pPrev == nullptr || pPrev->texId  != first->texId)  ? 1 : 0;
+        rStats.meshRuns    += (pPrev == nullptr || pPrev->meshId != first->meshId) ? 1 : 0;
+        pPrev = &*first;
+
+        auto last = std::next(first);
+        if (toDraw.drawInstanced != nullptr)
+        {
+            while (last != rBatches.entries.end() && same_batch(*first, *last))
+            {
+                ++last;
+            }
+        }
+
+        if (std::distance(first, last) == 1)
+        {
+            // Not worth uploading an instance buffer for a single DrawEnt
+            toDraw.draw(first->ent, viewProj, toDraw.data);
+        }
+        else
+        {
+            rBatches.batch.clear();
+            std::transform(first, last, std::back_inserter(rBatches.batch),
+                           [] (Entry const& entry) { return entry.ent; });
+
+            toDraw.drawInstanced(rBatches.batch.data(), rBatches.batch.size(),
+                                 viewProj, toDraw.data);
+
+            ++rStats.instancedDrawCalls;
+            rStats.instances += rBatches.batch.size();
+        }
+
+        ++rStats.drawCalls;
+
+        first = last;
+    }
+}
+
+Magnum::GL::Mesh& SysRenderGL::prepare_instanced_mesh(RenderGL& rRenderGl, MeshGlId const meshId)
+{
+    using Magnum::Shaders::GenericGL3D;
+
+    static_assert(sizeof(InstanceDataGL) == sizeof(float) * (16 + 9 + 4),
+                  "InstanceDataGL must be tightly packed to match vertex attributes");
+
+    Magnum::GL::Mesh &rMesh = rRenderGl.m_meshGl.get(meshId);
+
+    rRenderGl.m_instanceBuffer.setData(
+            Corrade::Containers::arrayView(rRenderGl.m_instanceData),
+            Magnum::GL::BufferUsage::StreamDraw);
+
+    auto const meshInt = std::size_t(meshId);
+    if (rRenderGl.m_meshHasInstances.size() <= meshInt)
+    {
+        bitvector_resize(rRenderGl.m_meshHasInstances, meshInt + 1);
+    }
+
+    // GL meshes are never deleted, so attaching the buffer only needs to be done once. Contents
+    // are replaced by the setData above.
+    if ( ! rRenderGl.m_meshHasInstances.test(meshInt) )
+    {
+        rMesh.addVertexBufferInstanced(rRenderGl.m_instanceBuffer, 1, 0,
+                                       GenericGL3D::TransformationMatrix{},
+                                       GenericGL3D::NormalMatrix{},
+                                       GenericGL3D::Color4{});
+        rRenderGl.m_meshHasInstances.set(meshInt);
+    }
+
+    rMesh.setInstanceCount(Magnum::Int(rRenderGl.m_instanceData.size()));
+
+    return rMesh;
+}
@@ -26,8 +26,11 @@
 
 #include "FullscreenTriShader.h"
 
+#include "../drawing/draw_commands.h"
 #include "../drawing/drawing_fn.h"
 
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/BufferImage.h>
 #include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/Framebuffer.h>
@@ -36,8 +39,14 @@
 #include <Magnum/Trade/MeshData.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include <Corrade/Containers/ArrayViewStl.h>
+
 #include <longeron/id_management/registry.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
 namespace osp::draw
 {
 
@@ -47,6 +56,87 @@ enum class MeshGlId : uint32_t { };
 using TexGlStorage_t    = Storage_t<TexGlId, Magnum::GL::Texture2D>;
 using MeshGlStorage_t   = Storage_t<MeshGlId, Magnum::GL::Mesh>;
 
+/**
+ * @brief Number of draws in each range of a per-draw uniform buffer
+ *
+ * Shaders with uniform buffers are created with this draw count. Per-draw uniform buffers are
+ * padded to a multiple of this, and bound one range at a time. 256 entries of 16-byte multiples
+ * keeps range offsets aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+ */
+constexpr std::size_t gc_drawUniformsPerChunk = 256;
+
+/**
+ * @brief Draw slot of a DrawEnt that has no per-draw uniforms written for the current pass
+ */
+constexpr uint32_t gc_noDrawSlot = ~uint32_t(0);
+
+/**
+ * @brief Per-instance attributes for instanced draws
+ *
+ * Layout matches GenericGL3D TransformationMatrix, NormalMatrix, and Color4 attributes.
+ * Shaders that don't need normals or colors simply ignore them.
+ */
+struct InstanceDataGL
+{
+    Matrix4         transformation;
+    Matrix3         normalMatrix;
+    Magnum::Color4  color;
+};
+
+/**
+ * @brief Meshes and textures waiting to be uploaded to the GPU
+ *
+ * Resources are assigned a GL Id and a placeholder right away, so DrawEnts can be synced and
+ * drawn immediately. The placeholder mesh is empty and draws nothing, and the placeholder
+ * texture is a single white pixel. These are replaced by the real data a few at a time, limited
+ * by a per-frame budget, so a burst of new resources doesn't stall a single frame.
+ */
+struct UploadQueueGL
+{
+    std::deque<MeshGlId>        meshes;
+    std::deque<TexGlId>         textures;
+    BitVector_t                 meshesPending;
+
+    // Meshes and textures take turns, so neither can starve the other. Kept across frames for
+    // when the budget only fits one upload per frame.
+    bool                        textureTurn     {false};
+
+    // At least one resource is uploaded per frame, even if it exceeds these
+    std::size_t                 bytesPerFrame   {8u * 1024u * 1024u};
+    std::chrono::microseconds   timePerFrame    {2000};
+
+    // Pixel buffer reused for texture uploads, lets the driver copy to the texture asynchronously
+    Magnum::GL::BufferImage2D   pixelUnpack     {Corrade::NoCreate};
+};
+
+/**
+ * @brief Draw calls counted while rendering, used for benchmarks
+ *
+ * The *Runs counters are the number of runs of consecutive sorted draw entries sharing the same
+ * shader, texture, or mesh. They measure how well draws are sorted, not how many GL binds were
+ * actually issued; shaders and Magnum may skip or repeat binds independently.
+ */
+struct RenderStatsGL
+{
+    std::size_t drawCalls           {0}; ///< Includes instanced draw calls
+    std::size_t instancedDrawCalls  {0};
+    std::size_t instances           {0}; ///< DrawEnts drawn through instanced draw calls
+    std::size_t shaderRuns          {0};
+    std::size_t textureRuns         {0};
+    std::size_t meshRuns            {0};
+
+    constexpr RenderStatsGL& operator+=(RenderStatsGL const& rhs) noexcept
+    {
+        drawCalls           += rhs.drawCalls;
+        instancedDrawCalls  += rhs.instancedDrawCalls;
+        instances           += rhs.instances;
+        shaderRuns          += rhs.shaderRuns;
+        textureRuns         += rhs.textureRuns;
+        meshRuns            += rhs.meshRuns;
+        return *this;
+    }
+};
+
 /**
  * @brief Main renderer state and essential GL resources
  *
@@ -63,6 +153,7 @@ struct RenderGL
     TexGlId                             m_fboColor;
     Magnum::GL::Renderbuffer            m_fboDepthStencil{Corrade::NoCreate};
     Magnum::GL::Framebuffer             m_fbo{Corrade::NoCreate};
+    bool                                m_displayFbo{true}; ///< False when rendering headless
 
     // Renderer-space GL Textures
     lgrn::IdRegistry<TexGlId>           m_texIds;
@@ -80,6 +171,20 @@ struct RenderGL
     IdMap_t<ResId, MeshGlId>            m_resToMesh;
     IdMap_t<MeshGlId, ResIdOwner_t>     m_meshToRes;
 
+    UploadQueueGL                       m_uploads;
+
+    // Instance buffer shared by all shaders, attached to meshes the first time they're instanced
+    Magnum::GL::Buffer                  m_instanceBuffer{Corrade::NoCreate};
+    std::vector<InstanceDataGL>         m_instanceData;
+    BitVector_t                         m_meshHasInstances;
+
+    // Uniform block binding points are shared by all shaders. Tracks which shader context and
+    // range of per-draw uniforms were bound last, to avoid rebinding buffers every draw.
+    void const                          *m_pUniformsBoundOwner{nullptr};
+    std::size_t                         m_uniformsBoundChunk{0};
+
+    // Counted by scene renderers each frame, reset by whoever reads them
+    RenderStatsGL                       m_stats;
 };
 
 struct ACompTexGl
@@ -92,11 +197,49 @@ struct ACompMeshGl
 {
     MeshId      m_scnId     {lgrn::id_null<MeshId>()};
     MeshGlId    m_glId      {lgrn::id_null<MeshGlId>()};
+    uint8_t     m_lod       {0}; ///< Level of detail m_glId is for, see apply_mesh_lods
 };
 
 using MeshGlEntStorage_t    = KeyedVec<DrawEnt, ACompMeshGl>;
 using TexGlEntStorage_t     = KeyedVec<DrawEnt, ACompTexGl>;
 
+/**
+ * @brief Order to draw DrawEnts in, by distance from the camera
+ */
+enum class EDrawSort : uint8_t
+{
+    FrontToBack,    ///< For opaque, sorted by state first then depth to reduce overdraw
+    BackToFront     ///< For transparent, sorted by depth first for correct blending
+};
+
+/**
+ * @brief Render queue used to sort visible DrawEnts and group them into instanced draw calls
+ *
+ * Each entry has a 64-bit key made of shader, texture, mesh, and depth. Sorting by key means
+ * consecutive draws share as much GL state as possible.
+ */
+struct DrawBatchesGL
+{
+    struct Entry
+    {
+        uint64_t            key;
+        EntityToDraw const  *pToDraw;
+        MeshGlId            meshId;
+        TexGlId             texId;
+        DrawEnt             ent;
+    };
+
+    std::vector<Entry>      entries;
+    std::vector<Entry>      entriesScratch;
+    std::vector<DrawEnt>    batch;
+
+    // Distinct draw function user data seen this frame, index is used as the shader part of keys
+    std::vector<EntityToDraw::UserData_t> shaders;
+
+    // Accumulated by draw_group_instanced, see RenderGL::m_stats
+    RenderStatsGL           stats;
+};
+
 /**
  * @brief OpenGL specific rendering components for rendering a scene
  */
@@ -104,6 +247,8 @@ struct ACtxSceneRenderGL
 {
     MeshGlEntStorage_t      m_meshId;
     TexGlEntStorage_t       m_diffuseTexId;
+
+    DrawBatchesGL           m_batches;
 };
 
 /**
@@ -137,6 +282,8 @@ public:
     /**
      * @brief Compile GPU-side TexGlIds for textures loaded from a Resource (TexId + ResId)
      *
+     * New textures are given a placeholder and queued, see process_uploads
+     *
      * @param rCtxDrawRes   [in] Resources used by the scene
      * @param rResources    [ref] Application Resources shared with the scene. New resource owners may be created.
      * @param rRenderGl     [ref] Renderer state
@@ -149,6 +296,8 @@ public:
     /**
      * @brief Compile GPU-side MeshGlIds for meshes loaded from a Resource (MeshId + ResId)
      *
+     * New meshes are given a placeholder and queued, see process_uploads
+     *
      * @param rCtxDrawRes   [in] Resources used by the scene
      * @param rResources    [ref] Application Resources shared with the scene. New resource owners may be created.
      * @param rRenderGl     [ref] Renderer state
@@ -158,6 +307,19 @@ public:
             Resources& rResources,
             RenderGL& rRenderGl);
 
+    /**
+     * @brief Upload queued meshes and textures, replacing their placeholders
+     *
+     * Meshes and textures are uploaded in turns. Stops once UploadQueueGL's byte or time budget
+     * is used up; the rest are left for following frames.
+     *
+     * @param rResources    [ref] Application Resources to read mesh and image data from
+     * @param rRenderGl     [ref] Renderer state
+     *
+     * @return Number of resources still waiting to be uploaded
+     */
+    static std::size_t process_uploads(Resources& rResources, RenderGL& rRenderGl);
+
     /**
      * @brief Synchronize an entity's MeshId component to an ACompMeshGl
      *
@@ -189,6 +351,26 @@ public:
         });
     }
 
+    /**
+     * @brief Switch DrawEnts' GL meshes to the levels of detail selected in ACtxSceneRender
+     *
+     * Levels that haven't been uploaded yet are skipped, keeping the previous mesh.
+     *
+     * @param scnRender     [in] Scene render data with selected m_meshLod
+     * @param visible       [in] DrawEnts to update
+     * @param drawing       [in] Drawing data with MeshLods
+     * @param drawingRes    [in] Scene's Mesh Id to Resource Id
+     * @param rCmpMeshGl    [ref] Renderer-side ACompMeshGl components
+     * @param renderGl      [in] Renderer state
+     */
+    static void apply_mesh_lods(
+            ACtxSceneRender const&                      scnRender,
+            DrawEntSet_t const&                         visible,
+            ACtxDrawing const&                          drawing,
+            ACtxDrawingRes const&                       drawingRes,
+            MeshGlEntStorage_t&                         rCmpMeshGl,
+            RenderGL const&                             renderGl);
+
     /**
      * @brief Synchronize entities with a TexId component to an ACompTexGl
      *
@@ -251,6 +433,132 @@ public:
             DrawEntSet_t const& visible,
             ViewProjMatrix const& viewProj);
 
+    /**
+     * @brief Call draw functions of a RenderGroup of opaque objects, using instanced draws where
+     *        possible
+     *
+     * @param group         [in] RenderGroup to draw
+     * @param viewProj      [in] View and projection matrix
+     * @param cmds          [in] Draw commands recorded this frame, only DrawEnts with one are drawn
+     * @param rScnRenderGl  [ref] GL mesh and texture Ids of DrawEnts, and render queue
+     */
+    static void render_opaque(
+            RenderGroup const& group,
+            ViewProjMatrix const& viewProj,
+            ACtxDrawCommands const& cmds,
+            ACtxSceneRenderGL& rScnRenderGl);
+
+    /**
+     * @brief Call draw functions of a RenderGroup of transparent objects, using instanced draws
+     *        where possible
+     *
+     * @param group         [in] RenderGroup to draw
+     * @param viewProj      [in] View and projection matrix
+     * @param cmds          [in] Draw commands recorded this frame, only DrawEnts with one are drawn
+     * @param rScnRenderGl  [ref] GL mesh and texture Ids of DrawEnts, and render queue
+     */
+    static void render_transparent(
+            RenderGroup const& group,
+            ViewProjMatrix const& viewProj,
+            ACtxDrawCommands const& cmds,
+            ACtxSceneRenderGL& rScnRenderGl);
+
+    /**
+     * @brief Draw a RenderGroup through a sorted render queue, grouping DrawEnts that share the
+     *        same mesh, texture, and draw function user data into a single instanced draw call
+     *
+     * Only DrawEnts with a command recorded this frame are drawn, sorted using the command's
+     * depth. DrawEnts without an EntityToDraw::drawInstanced function are drawn individually, but
+     * are still sorted. Draw calls and state changes are added to DrawBatchesGL::stats.
+     */
+    static void draw_group_instanced(
+            RenderGroup const& group,
+            ViewProjMatrix const& viewProj,
+            ACtxDrawCommands const& cmds,
+            ACtxSceneRenderGL& rScnRenderGl,
+            EDrawSort sort);
+
+    /**
+     * @brief Upload RenderGL::m_instanceData and prepare a mesh to draw them
+     *
+     * @return Mesh with the instance buffer attached and instance count set
+     */
+    static Magnum::GL::Mesh& prepare_instanced_mesh(RenderGL& rRenderGl, MeshGlId meshId);
+
+    /**
+     * @brief Check if a range of a shader context's per-draw uniform buffers needs to be bound
+     *
+     * @param rRenderGl [ref] Renderer state
+     * @param pOwner    [in] Shader context that owns the uniform buffers
+     * @param chunk     [in] Index of the range of gc_drawUniformsPerChunk draws
+     *
+     * @return true if the caller must bind its buffers; they're then recorded as bound
+     */
+    static bool claim_uniform_bindings(
+            RenderGL& rRenderGl, void const* pOwner, std::size_t chunk) noexcept
+    {
+        if (rRenderGl.m_pUniformsBoundOwner == pOwner && rRenderGl.m_uniformsBoundChunk == chunk)
+        {
+            return false;
+        }
+        rRenderGl.m_pUniformsBoundOwner = pOwner;
+        rRenderGl.m_uniformsBoundChunk  = chunk;
+        return true;
+    }
+
+    /**
+     * @brief Forget which uniform buffers are bound, call when they are reuploaded
+     */
+    static void reset_uniform_bindings(RenderGL& rRenderGl) noexcept
+    {
+        rRenderGl.m_pUniformsBoundOwner = nullptr;
+    }
+
+    /**
+     * @brief Pad per-draw uniforms to whole chunks and upload them to a uniform buffer
+     */
+    template <typename T>
+    static void upload_draw_uniforms(Magnum::GL::Buffer& rBuffer, std::vector<T>& rUniforms)
+    {
+        std::size_t const chunks
+                = (rUniforms.size() + gc_drawUniformsPerChunk - 1) / gc_drawUniformsPerChunk;
+        rUniforms.resize(std::max<std::size_t>(chunks, 1) * gc_drawUniformsPerChunk);
+        rBuffer.setData(Corrade::Containers::arrayView(rUniforms),
+                        Magnum::GL::BufferUsage::StreamDraw);
+    }
+
+    /**
+     * @brief Offset and size in bytes of a chunk of per-draw uniforms, for bind*Buffer functions
+     */
+    template <typename T>
+    static constexpr GLintptr draw_uniforms_offset(std::size_t const chunk) noexcept
+    {
+        return GLintptr(chunk * gc_drawUniformsPerChunk * sizeof(T));
+    }
+
+    template <typename T>
+    static constexpr GLsizeiptr draw_uniforms_size() noexcept
+    {
+        return GLsizeiptr(gc_drawUniformsPerChunk * sizeof(T));
+    }
+
+    /**
+     * @brief Draw a mesh once for each instance in RenderGL::m_instanceData
+     *
+     * @param rRenderGl [ref] Renderer state with instance data already written
+     * @param meshId    [in] Mesh to draw
+     * @param rShader   [ref] Shader with instanced transformation enabled
+     */
+    template <typename SHADER_T>
+    static void draw_instanced(RenderGL& rRenderGl, MeshGlId const meshId, SHADER_T& rShader)
+    {
+        Magnum::GL::Mesh &rMesh = prepare_instanced_mesh(rRenderGl, meshId);
+        rShader.draw(rMesh);
+
+        // Meshes are shared with non-instanced draws
+        rMesh.setInstanceCount(1);
+    }
+
 };
 
 } // namespace osp::draw
@@ -24,6 +24,8 @@
  */
 #include "machines.h"
 
+#include <algorithm>
+
 namespace osp::link
 {
 
@@ -97,4 +99,99 @@ void copy_nodes(
     }
 }
 
+/**
+ * @return One past the highest existing Id. Registry capacity can be larger, and Ids created
+ *         later below the capacity must still be seen as new by compile_nodes_update.
+ */
+static std::size_t id_end(lgrn::IdRegistryStl<uint32_t> const &ids) noexcept
+{
+    std::size_t end = ids.capacity();
+    while (end != 0 && ! ids.exists(uint32_t(end - 1)))
+    {
+        --end;
+    }
+    return end;
+}
+
+static bool compile_mach_ports(
+        Nodes const &nodes, Machines const &machines, MachTypeId const type, CompiledNodes::MachTypePorts &rOut)
+{
+    PerMachType const &rType = machines.perType[type];
+    std::size_t const localCount = id_end(rType.localIds);
+
+    // Find the stride needed for newly added Machines
+    std::size_t portCount = rOut.portCount;
+    for (MachLocalId local = MachLocalId(rOut.localCount); local < localCount; ++local)
+    {
+        MachAnyId const mach = rType.localToAny[local];
+        if (rType.localIds.exists(local) && nodes.machToNode.contains(mach))
+        {
+            portCount = std::max(portCount, nodes.machToNode[mach].size());
+        }
+    }
+
+    if (portCount != rOut.portCount && rOut.localCount != 0)
+    {
+        return false; // Stride changed, all existing Machines of this type need to move
+    }
+
+    rOut.portCount = portCount;
+    rOut.portNodes.resize(localCount * portCount, lgrn::id_null<NodeId>());
+
+    for (MachLocalId local = MachLocalId(rOut.localCount); local < localCount; ++local)
+    {
+        MachAnyId const mach = rType.localToAny[local];
+        if (rType.localIds.exists(local) && nodes.machToNode.contains(mach))
+        {
+            lgrn::Span<NodeId const> const ports = nodes.machToNode[mach];
+            std::copy(ports.begin(), ports.end(), rOut.portNodes.begin() + std::ptrdiff_t(local * portCount));
+        }
+    }
+
+    rOut.localCount = localCount;
+    return true;
+}
+
+static void compile_node_juncs(Nodes const &nodes, CompiledNodes &rOut)
+{
+    std::size_t const nodeCount = id_end(nodes.nodeIds);
+
+    for (NodeId node = NodeId(rOut.nodeJuncOffsets.size() - 1); node < nodeCount; ++node)
+    {
+        if (nodes.nodeIds.exists(node) && nodes.nodeToMach.contains(node))
+        {
+            lgrn::Span<Junction const> const juncs = nodes.nodeToMach[node];
+            rOut.nodeJuncs.insert(rOut.nodeJuncs.end(), juncs.begin(), juncs.end());
+        }
+        rOut.nodeJuncOffsets.push_back(uint32_t(rOut.nodeJuncs.size()));
+    }
+}
+
+void compile_nodes(Nodes const &nodes, Machines const &machines, CompiledNodes &rOut)
+{
+    rOut.perMachType.clear();
+    rOut.nodeJuncOffsets.assign(1, 0);
+    rOut.nodeJuncs.clear();
+
+    compile_nodes_update(nodes, machines, rOut);
+}
+
+void compile_nodes_update(Nodes const &nodes, Machines const &machines, CompiledNodes &rOut)
+{
+    rOut.perMachType.resize(machines.perType.size());
+
+    for (MachTypeId type = 0; type < machines.perType.size(); ++type)
+    {
+        if ( ! compile_mach_ports(nodes, machines, type, rOut.perMachType[type]) )
+        {
+            // Stride changed, existing Machines would all need to move. Rare enough (a new
+            // Machine with more ports than any before it) that rebuilding everything is fine.
+            compile_nodes(nodes, machines, rOut);
+            return;
+        }
+    }
+
+    compile_node_juncs(nodes, rOut);
+}
+
 } // namespace osp::link
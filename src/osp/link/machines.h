@@ -33,6 +33,8 @@
 #include <longeron/containers/bit_view.hpp>
 #include <longeron/id_management/registry_stl.hpp>
 
+#include <Corrade/Containers/ArrayViewStl.h>
+
 #include <atomic>
 #include <vector>
 
@@ -54,6 +56,8 @@ using MachTypeReg_t = GlobalIdReg<MachTypeId>;
 using NodeTypeReg_t = GlobalIdReg<NodeTypeId>;
 
 inline NodeTypeId const gc_ntSigFloat = NodeTypeReg_t::create();
+inline NodeTypeId const gc_ntSigInt   = NodeTypeReg_t::create();
+inline NodeTypeId const gc_ntSigBool  = NodeTypeReg_t::create();
 
 /**
  * @brief Keeps track of Machines of a certain type that exists
@@ -133,6 +137,50 @@ inline NodeId connected_node(lgrn::Span<NodeId const> portSpan, PortId port) noe
     return (portSpan.size() > port) ? portSpan[port] : lgrn::id_null<NodeId>();
 }
 
+inline NodeId connected_node(ArrayView<NodeId const> ports, PortId port) noexcept
+{
+    return (ports.size() > port) ? ports[port] : lgrn::id_null<NodeId>();
+}
+
+/**
+ * @brief Flattened copy of a Nodes' connections, laid out for reading in update loops
+ *
+ * Ports of each Machine type are stored in a single array with a fixed stride (the largest port
+ * count of any Machine of that type), so a Machine's ports can be found without going through
+ * the IntArrayMultiMap. Node-to-Machine connections are stored as offsets into one array (CSR).
+ *
+ * Kept up to date with compile_nodes_update as Machines and Nodes are added. Use compile_nodes
+ * to rebuild everything after existing connections are changed or removed.
+ */
+struct CompiledNodes
+{
+    struct MachTypePorts
+    {
+        ArrayView<NodeId const> ports(MachLocalId const local) const noexcept
+        {
+            return (std::size_t(local + 1) * portCount <= portNodes.size())
+                 ? arrayView(portNodes).sliceSize(std::size_t(local) * portCount, portCount)
+                 : ArrayView<NodeId const>{};
+        }
+
+        /// [local * portCount + PortId] -> NodeId, or null if not connected
+        std::vector<NodeId>     portNodes;
+        std::size_t             portCount{0};
+        std::size_t             localCount{0};
+    };
+
+    ArrayView<Junction const> node_junctions(NodeId const node) const noexcept
+    {
+        return arrayView(nodeJuncs).slice(nodeJuncOffsets[node], nodeJuncOffsets[node + 1]);
+    }
+
+    KeyedVec<MachTypeId, MachTypePorts>     perMachType;
+
+    /// nodeJuncs[nodeJuncOffsets[node] .. nodeJuncOffsets[node + 1]] are connected to node
+    std::vector<uint32_t>                   nodeJuncOffsets{0};
+    std::vector<Junction>                   nodeJuncs;
+};
+
 void copy_machines(
         Machines const &rSrc,
         Machines &rDst,
@@ -146,5 +194,19 @@ void copy_nodes(
         Machines &rDstMach,
         ArrayView<NodeId> remapNodeOut);
 
+/**
+ * @brief Rebuild all of rOut from Nodes
+ */
+void compile_nodes(Nodes const &nodes, Machines const &machines, CompiledNodes &rOut);
+
+/**
+ * @brief Add Machines and Nodes created since rOut was last compiled
+ *
+ * Only Node IDs and Machine local IDs past the highest ones already compiled are added, and
+ * connections of existing Nodes and Machines are assumed unchanged. Falls back to compile_nodes
+ * if the ports of a Machine type no longer fit its stride.
+ */
+void compile_nodes_update(Nodes const &nodes, Machines const &machines, CompiledNodes &rOut);
+
 
 } // namespace osp::wire
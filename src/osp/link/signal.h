@@ -26,12 +26,40 @@
 
 #include "machines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
 namespace osp::link
 {
 
 constexpr JuncCustom gc_sigIn  = 0;
 constexpr JuncCustom gc_sigOut = 1;
 
+/**
+ * @brief Node type used for signals of VALUE_T
+ *
+ * Specialized for each supported signal type. Other trivially copyable types (eg. vectors or
+ * fixed-size arrays) can be added by registering a NodeTypeId and adding a specialization.
+ */
+template <typename VALUE_T>
+NodeTypeId signal_node_type() noexcept = delete;
+
+template <>
+inline NodeTypeId signal_node_type<float>() noexcept { return gc_ntSigFloat; }
+
+template <>
+inline NodeTypeId signal_node_type<int32_t>() noexcept { return gc_ntSigInt; }
+
+template <>
+inline NodeTypeId signal_node_type<bool>() noexcept { return gc_ntSigBool; }
+
+/**
+ * @brief Current value of each Node, indexed by NodeId
+ *
+ * Note that SignalValues_t<bool> is std::vector<bool>, which is stored as a packed bitset.
+ */
 template <typename VALUE_T>
 using SignalValues_t = std::vector<VALUE_T>;
 
@@ -51,13 +79,103 @@ struct UpdateNodes
     }
 };
 
+/**
+ * @brief New Node values written by multiple threads in parallel, eg. by Machine update tasks
+ *        of different types running on separate workers
+ *
+ * Each worker appends to its own buffer, and marks Nodes dirty in a shared bitset using atomic
+ * fetch-or. merge_into() moves everything into a regular UpdateNodes; it and resize() must not
+ * run at the same time as assign().
+ *
+ * If multiple workers write to the same Node, the one with the highest worker index wins.
+ */
+template <typename VALUE_T>
+struct UpdateNodesConcurrent
+{
+    struct alignas(64) PerWorker
+    {
+        std::vector<NodeId>     nodes;
+        SignalValues_t<VALUE_T> values;
+    };
+
+    void resize(std::size_t const nodeCapacity, std::size_t const workerCount)
+    {
+        std::size_t const wordCount = nodeCapacity / 64 + (nodeCapacity % 64 != 0);
+        if (wordCount > dirtyWordCount)
+        {
+            // std::atomic is not movable, so it can't be kept in an std::vector
+            auto newWords = std::make_unique<std::atomic<bitint_t>[]>(wordCount);
+            for (std::size_t i = 0; i < dirtyWordCount; ++i)
+            {
+                newWords[i].store(dirtyWords[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            dirtyWords      = std::move(newWords);
+            dirtyWordCount  = wordCount;
+        }
+
+        perWorker.resize(std::max<std::size_t>(perWorker.size(), workerCount));
+    }
+
+    void assign(std::size_t const worker, NodeId const node, VALUE_T value)
+    {
+        LGRN_ASSERTMV(worker < perWorker.size() && node / 64 < dirtyWordCount,
+                      "UpdateNodesConcurrent not resized to fit", worker, node);
+
+        PerWorker &rWorker = perWorker[worker];
+        rWorker.nodes .push_back(node);
+        rWorker.values.push_back(std::move(value));
+
+        dirtyWords[node / 64].fetch_or(bitint_t(1) << (node % 64), std::memory_order_relaxed);
+        dirty.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Move all written values into rDst, and clear this
+     *
+     * @return true if anything was written
+     */
+    bool merge_into(UpdateNodes<VALUE_T>& rDst)
+    {
+        if ( ! dirty.exchange(false, std::memory_order_acquire) )
+        {
+            return false;
+        }
+
+        auto &rDstInts = rDst.nodeDirty.ints();
+        for (std::size_t i = 0; i < std::min(dirtyWordCount, rDstInts.size()); ++i)
+        {
+            rDstInts[i] |= dirtyWords[i].exchange(0, std::memory_order_relaxed);
+        }
+
+        for (PerWorker &rWorker : perWorker)
+        {
+            for (std::size_t i = 0; i < rWorker.nodes.size(); ++i)
+            {
+                rDst.nodeNewValues[rWorker.nodes[i]] = rWorker.values[i];
+            }
+            rWorker.nodes .clear();
+            rWorker.values.clear();
+        }
+
+        rDst.dirty = true;
+        return true;
+    }
+
+    std::unique_ptr<std::atomic<bitint_t>[]>    dirtyWords;
+    std::size_t                                 dirtyWordCount{0};
+
+    std::vector<PerWorker>                      perWorker;
+
+    alignas(64) std::atomic<bool>               dirty{false};
+};
+
 template <typename VALUE_T, typename RANGE_T>
 bool update_signal_nodes(
         RANGE_T const&                  toUpdate,
-        Nodes::NodeToMach_t const&      nodeToMach,
+        CompiledNodes const&            compiled,
         Machines const&                 machines,
-        ArrayView<VALUE_T const>        newValues,
-        ArrayView<VALUE_T>              currentValues,
+        SignalValues_t<VALUE_T> const&  newValues,
+        SignalValues_t<VALUE_T>&        currentValues,
         MachineUpdater&                 rUpdMach)
 {
     bool somethingNotified = false;
@@ -68,7 +186,7 @@ bool update_signal_nodes(
         currentValues[node] = newValues[node];
 
         // Notify connected inputs
-        for (Junction junc : nodeToMach[node])
+        for (Junction const junc : compiled.node_junctions(node))
         {
             if (junc.custom == gc_sigIn)
             {
@@ -0,0 +1,140 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "signal_propagation.h"
+
+#include <algorithm>
+
+namespace osp::link
+{
+
+void SysSignalGraph::build(SignalGraph& rGraph, CompiledNodes const& compiled, Machines const& machines)
+{
+    std::size_t const machCapacity = machines.ids.capacity();
+
+    auto const any_id = [&machines] (Junction const& junc) -> MachAnyId
+    {
+        return machines.perType[junc.type].localToAny[junc.local];
+    };
+
+    auto const for_each_edge = [&compiled, &any_id] (auto&& func)
+    {
+        for (NodeId node = 0; node + 1 < compiled.nodeJuncOffsets.size(); ++node)
+        {
+            ArrayView<Junction const> const juncs = compiled.node_junctions(node);
+            for (Junction const& writer : juncs)
+            {
+                if (writer.custom != gc_sigOut)
+                {
+                    continue;
+                }
+                for (Junction const& reader : juncs)
+                {
+                    if (reader.custom == gc_sigIn)
+                    {
+                        func(any_id(writer), any_id(reader));
+                    }
+                }
+            }
+        }
+    };
+
+    // Count edges per Machine, then fill them in (CSR)
+    rGraph.edgeOffsets.assign(machCapacity + 1, 0);
+    for_each_edge([&rGraph] (MachAnyId const from, MachAnyId)
+    {
+        ++rGraph.edgeOffsets[from + 1];
+    });
+    for (std::size_t i = 0; i < machCapacity; ++i)
+    {
+        rGraph.edgeOffsets[i + 1] += rGraph.edgeOffsets[i];
+    }
+
+    rGraph.edges.resize(rGraph.edgeOffsets.back());
+
+    std::vector<uint32_t> fill{rGraph.edgeOffsets.begin(), rGraph.edgeOffsets.end() - 1};
+    std::vector<uint32_t> inDegree(machCapacity, 0);
+    for_each_edge([&rGraph, &fill, &inDegree] (MachAnyId const from, MachAnyId const to)
+    {
+        rGraph.edges[fill[from]++] = to;
+        ++inDegree[to];
+    });
+
+    auto const by_type = [&machines] (MachAnyId const lhs, MachAnyId const rhs)
+    {
+        return machines.machTypes[lhs] < machines.machTypes[rhs];
+    };
+
+    // Kahn's algorithm, one level at a time
+    rGraph.order.clear();
+    rGraph.levelOffsets.assign(1, 0);
+    rGraph.cyclic.clear();
+
+    for (MachAnyId const mach : machines.ids.bitview().zeros())
+    {
+        if (inDegree[mach] == 0)
+        {
+            rGraph.order.push_back(mach);
+        }
+    }
+
+    std::size_t levelFirst = 0;
+    while (levelFirst != rGraph.order.size())
+    {
+        std::size_t const levelLast = rGraph.order.size();
+        rGraph.levelOffsets.push_back(uint32_t(levelLast));
+
+        for (std::size_t i = levelFirst; i < levelLast; ++i)
+        {
+            MachAnyId const from = rGraph.order[i];
+            for (uint32_t e = rGraph.edgeOffsets[from]; e < rGraph.edgeOffsets[from + 1]; ++e)
+            {
+                MachAnyId const to = rGraph.edges[e];
+                if (--inDegree[to] == 0)
+                {
+                    rGraph.order.push_back(to);
+                }
+            }
+        }
+
+        // Group Machines of the same type together, so they're updated as one batch
+        std::sort(rGraph.order.begin() + levelFirst, rGraph.order.begin() + levelLast, by_type);
+
+        levelFirst = levelLast;
+    }
+
+    // Anything left still has an unresolved input, so it's in or after a cycle
+    for (MachAnyId const mach : machines.ids.bitview().zeros())
+    {
+        if (inDegree[mach] != 0)
+        {
+            rGraph.cyclic.push_back(mach);
+        }
+    }
+    std::stable_sort(rGraph.cyclic.begin(), rGraph.cyclic.end(), by_type);
+
+    rGraph.dirty = false;
+}
+
+} // namespace osp::link
@@ -0,0 +1,206 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "signal.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace osp::link
+{
+
+/**
+ * @brief Machines connected by signal Nodes, sorted in dependency order
+ *
+ * A Machine depends on another if one of its inputs (gc_sigIn) is connected to a Node that the
+ * other Machine outputs to (gc_sigOut). Machines are grouped in levels; a Machine only depends on
+ * Machines in lower levels, so each level can be updated in a single pass once the levels before
+ * it are done. Machines that are part of, or depend on, a cycle can't be ordered and are kept
+ * separately in cyclic.
+ *
+ * Machines within each level (and within cyclic) are sorted by type, so Machines of the same
+ * type can be updated together as one batch.
+ *
+ * Built by SysSignalGraph::build, for one type of Node.
+ */
+struct SignalGraph
+{
+    std::vector<MachAnyId>      order;          ///< Acyclic Machines, sorted by level
+    std::vector<uint32_t>       levelOffsets;   ///< order[levelOffsets[i] .. levelOffsets[i+1]] is level i
+    std::vector<MachAnyId>      cyclic;
+
+    // Machine-to-Machine dependency edges in CSR form, [edgeOffsets[m] .. edgeOffsets[m+1]]
+    std::vector<uint32_t>       edgeOffsets;
+    std::vector<MachAnyId>      edges;
+
+    bool                        dirty{true};    ///< Set when connections change to rebuild
+};
+
+/**
+ * @brief Per-Machine-type update functions run by propagate_signals
+ *
+ * Machine types with a function here are updated directly while signals propagate, instead of by
+ * a task in a following link loop iteration. Functions are called with a batch of dirty Machines
+ * of their type, read their input Nodes, and write output changes into UpdateNodes as usual.
+ */
+struct MachineUpdateFuncs
+{
+    using UserData_t = std::array<void*, 4>;
+    using Func_t = void(*)(ArrayView<MachLocalId const> locals, UserData_t data) noexcept;
+
+    struct Entry
+    {
+        Func_t      func{nullptr};
+        UserData_t  data{};
+    };
+
+    KeyedVec<MachTypeId, Entry> perType;
+
+    std::vector<MachLocalId>    batch;  ///< Scratch for the Machines passed to a Func_t
+};
+
+class SysSignalGraph
+{
+public:
+
+    /**
+     * @brief Sort Machines connected by a type of Node into dependency levels
+     *
+     * @param rGraph    [out] Graph to rebuild, reuses its allocations
+     * @param compiled  [in] Connections of Nodes of a single type
+     * @param machines  [in] All Machines
+     */
+    static void build(SignalGraph& rGraph, CompiledNodes const& compiled, Machines const& machines);
+};
+
+/**
+ * @brief Apply node value changes, then update dirty Machines in dependency order until all
+ *        changes have propagated
+ *
+ * Machines with a MachineUpdateFuncs entry are updated level by level, applying Node changes
+ * between levels, so chains of Machines settle in one call. Cyclic Machines are iterated up to
+ * maxCycleIterations times. Other Machine types are left marked in rUpdMach for their tasks.
+ *
+ * @return true if cycles haven't settled and rUpdNodes still holds changes for another link
+ *         loop iteration
+ */
+template <typename VALUE_T>
+bool propagate_signals(
+        SignalGraph const&              graph,
+        MachineUpdateFuncs&             rFuncs,
+        CompiledNodes const&            compiled,
+        Machines const&                 machines,
+        UpdateNodes<VALUE_T>&           rUpdNodes,
+        SignalValues_t<VALUE_T>&        rValues,
+        MachineUpdater&                 rUpdMach,
+        int                             maxCycleIterations = 8)
+{
+    auto const apply_node_changes = [&] ()
+    {
+        if (rUpdNodes.dirty)
+        {
+            update_signal_nodes<VALUE_T>(rUpdNodes.nodeDirty.ones(), compiled, machines,
+                                         rUpdNodes.nodeNewValues, rValues, rUpdMach);
+            rUpdNodes.nodeDirty.reset();
+            rUpdNodes.dirty = false;
+        }
+    };
+
+    // Run update functions for dirty Machines in machs, which is sorted by type. Consecutive
+    // Machines of the same type are passed as one batch. Returns true if any were updated.
+    auto const update_machines = [&rFuncs, &machines, &rUpdMach] (ArrayView<MachAnyId const> machs) -> bool
+    {
+        bool anyUpdated = false;
+
+        auto runFirst = machs.begin();
+        while (runFirst != machs.end())
+        {
+            MachTypeId const type = machines.machTypes[*runFirst];
+            auto const runLast = std::find_if(runFirst, machs.end(), [&machines, type] (MachAnyId const mach)
+            {
+                return machines.machTypes[mach] != type;
+            });
+
+            if (   std::size_t(type) < rFuncs.perType.size()
+                && rFuncs.perType[type].func != nullptr
+                && rUpdMach.machTypesDirty.test(type))
+            {
+                BitVector_t &rLocalDirty = rUpdMach.localDirty[type];
+
+                rFuncs.batch.clear();
+                for (auto it = runFirst; it != runLast; ++it)
+                {
+                    MachLocalId const local = machines.machToLocal[*it];
+                    if (local < rLocalDirty.size() && rLocalDirty.test(local))
+                    {
+                        rLocalDirty.reset(local);
+                        rFuncs.batch.push_back(local);
+                    }
+                }
+
+                if ( ! rFuncs.batch.empty() )
+                {
+                    MachineUpdateFuncs::Entry const &entry = rFuncs.perType[type];
+                    entry.func(arrayView(std::as_const(rFuncs.batch)), entry.data);
+                    anyUpdated = true;
+                }
+            }
+
+            runFirst = runLast;
+        }
+
+        return anyUpdated;
+    };
+
+    apply_node_changes();
+
+    for (std::size_t level = 0; level + 1 < graph.levelOffsets.size(); ++level)
+    {
+        auto const levelMachs = arrayView(graph.order).slice(graph.levelOffsets[level],
+                                                             graph.levelOffsets[level + 1]);
+        if (update_machines(levelMachs))
+        {
+            apply_node_changes();
+        }
+    }
+
+    for (int iteration = 0; iteration < maxCycleIterations; ++iteration)
+    {
+        if ( ! update_machines(arrayView(graph.cyclic)) )
+        {
+            return false; // Settled
+        }
+
+        apply_node_changes();
+    }
+
+    // Cycle hasn't settled. Run cyclic Machines once more, but leave their outputs in rUpdNodes
+    // to be applied by the next link loop iteration.
+    return update_machines(arrayView(graph.cyclic)) && rUpdNodes.dirty;
+}
+
+} // namespace osp::link
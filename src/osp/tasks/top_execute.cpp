@@ -75,6 +75,11 @@ void top_run_blocking(Tasks const& tasks, TaskGraph const& graph, TopTaskDataVec
 
         exec_update(tasks, graph, rExec);
     }
+
+    if (worker.pScratch != nullptr)
+    {
+        worker.pScratch->reset();
+    }
 }
 
 static void write_task_requirements(std::ostream &rStream, Tasks const& tasks, TaskGraph const& graph, ExecContext const& exec, TaskId const task)
@@ -27,6 +27,7 @@
 #include "worker.h"
 
 #include "../core/array_view.h"
+#include "../core/scratch_arena.h"
 
 #include <entt/core/fwd.hpp>
 
@@ -46,6 +47,13 @@ struct Reserved {};
 struct WorkerContext
 {
     //DependOnDirty_t m_dependOnDirty;
+
+    /// Index of the thread running the task, from 0 to the executor's worker count
+    uint32_t workerIndex{0};
+
+    /// Per-worker scratch memory for temporaries within a task, reset once the executor runs out
+    /// of tasks to run. Null if the executor doesn't provide one.
+    ScratchArena *pScratch{nullptr};
 };
 
 using TopTaskFunc_t = TaskActions(*)(WorkerContext, ArrayView<entt::any>) noexcept;
@@ -0,0 +1,1060 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "gltf_cache.h"
+#include "ImporterData.h"
+
+#include "../core/Resources.h"
+#include "../core/section_file.h"
+#include "../drawing/own_restypes.h"
+#include "../util/logging.h"
+
+#include <Magnum/Mesh.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/VertexFormat.h>
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Trade/MaterialData.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/TextureData.h>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Containers/StringStlView.h>
+#include <Corrade/Utility/Path.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+using namespace osp;
+
+using Magnum::Trade::ImageData2D;
+using Magnum::Trade::MaterialAttributeData;
+using Magnum::Trade::MaterialAttributeType;
+using Magnum::Trade::MaterialData;
+using Magnum::Trade::MeshAttributeData;
+using Magnum::Trade::MeshData;
+using Magnum::Trade::MeshIndexData;
+using Magnum::Trade::TextureData;
+
+using Corrade::Containers::Array;
+using Corrade::Containers::StringView;
+
+namespace Path = Corrade::Utility::Path;
+
+namespace
+{
+
+using MappedFile_t      = Corrade::Containers::Array<char const, Path::MapDeleter>;
+using TextureType_t     = decltype(std::declval<TextureData const&>().type());
+
+constexpr uint32_t sec(EGltfCacheSection const section) noexcept
+{
+    return gltf_cache_section(section);
+}
+
+constexpr uint32_t section_count(uint32_t const imageCount, uint32_t const meshCount) noexcept
+{
+    return gltf_cache_index_section(imageCount, meshCount);
+}
+
+/**
+ * @brief Collects strings into one buffer, referred to by index
+ */
+struct StringPool
+{
+    uint32_t add(std::string_view const str)
+    {
+        m_chars.insert(m_chars.end(), str.begin(), str.end());
+        m_offsets.push_back(uint32_t(m_chars.size()));
+        return uint32_t(m_offsets.size() - 2);
+    }
+
+    std::vector<uint32_t>   m_offsets{0};
+    std::vector<char>       m_chars;
+};
+
+/**
+ * @brief Mapped cache file, with bounds-checked access to its sections
+ */
+struct CacheReader
+{
+    template <typename T>
+    [[nodiscard]] ArrayView<T const> get(uint32_t const index) const noexcept
+    {
+        return file_section<T>(file, sections[index]);
+    }
+
+    template <typename T>
+    [[nodiscard]] ArrayView<T const> get(EGltfCacheSection const section) const noexcept
+    {
+        return get<T>(sec(section));
+    }
+
+    [[nodiscard]] std::string_view string(uint32_t const index) const noexcept
+    {
+        if (   std::size_t(index) + 1 >= stringOffsets.size()
+            || stringOffsets[index] > stringOffsets[index + 1]
+            || stringOffsets[index + 1] > stringChars.size())
+        {
+            return {};
+        }
+        return { stringChars.data() + stringOffsets[index], stringOffsets[index + 1] - stringOffsets[index] };
+    }
+
+    ArrayView<char const>           file;
+    ArrayView<FileSection const>    sections;
+    ArrayView<uint32_t const>       stringOffsets;
+    ArrayView<char const>           stringChars;
+};
+
+/**
+ * @brief Write a multimap with int keys from 0 to idCount as CSR offsets and data
+ */
+template <typename ID_T, typename DATA_T>
+void add_multimap(
+        SectionWriter&                                  rWriter,
+        EGltfCacheSection const                         offsetSection,
+        EGltfCacheSection const                         dataSection,
+        lgrn::IntArrayMultiMap<ID_T, DATA_T> const&     map,
+        std::size_t const                               idCount)
+{
+    std::vector<uint32_t>   offsets(idCount + 1, 0);
+    std::vector<DATA_T>     data;
+
+    for (std::size_t id = 0; id < idCount; ++id)
+    {
+        if (map.contains(ID_T(id)))
+        {
+            auto const span = map[ID_T(id)];
+            data.insert(data.end(), span.begin(), span.end());
+        }
+        offsets[id + 1] = uint32_t(data.size());
+    }
+
+    rWriter.add(sec(offsetSection), offsets);
+    rWriter.add(sec(dataSection),   data);
+}
+
+/**
+ * @param emplaceEmpty [in] Also add ids with no data, otherwise they are left out of the map
+ */
+template <typename ID_T, typename DATA_T>
+void load_multimap(
+        lgrn::IntArrayMultiMap<ID_T, DATA_T>&   rMap,
+        ArrayView<uint32_t const> const         offsets,
+        ArrayView<DATA_T const> const           data,
+        bool const                              emplaceEmpty)
+{
+    std::size_t const idCount = offsets.size() - 1;
+
+    rMap.ids_reserve(idCount);
+    rMap.data_reserve(data.size());
+
+    for (std::size_t id = 0; id < idCount; ++id)
+    {
+        uint32_t const first = offsets[id];
+        uint32_t const last  = offsets[id + 1];
+
+        if (first == last && ! emplaceEmpty)
+        {
+            continue;
+        }
+
+        DATA_T *pOut = rMap.emplace(ID_T(id), last - first);
+        std::copy(data.begin() + first, data.begin() + last, pOut);
+    }
+}
+
+/**
+ * @brief Resource name with the glTF file path in front removed, so a cache file still works if
+ *        the same file is loaded from a different path
+ */
+std::string_view name_suffix(SharedString const& name, std::string_view const sourcePath)
+{
+    std::string_view const view{name};
+    return view.starts_with(sourcePath) ? view.substr(sourcePath.size()) : view;
+}
+
+Array<char> copy_array(ArrayView<char const> const data)
+{
+    Array<char> out{Corrade::NoInit, data.size()};
+    if ( ! data.isEmpty() )
+    {
+        std::memcpy(out.data(), data.data(), data.size());
+    }
+    return out;
+}
+
+MeshData load_mesh(
+        CacheReader const&                      reader,
+        GltfCacheMesh const&                    mesh,
+        ArrayView<GltfCacheMeshAttribute const> attributes,
+        uint32_t const                          imageCount,
+        uint32_t const                          meshIndex)
+{
+    Array<MeshAttributeData> attribData(attributes.size());
+    for (std::size_t i = 0; i < attributes.size(); ++i)
+    {
+        GltfCacheMeshAttribute const &attrib = attributes[i];
+        attribData[i] = MeshAttributeData{Magnum::Trade::MeshAttribute(attrib.name),
+                                          Magnum::VertexFormat(attrib.format),
+                                          std::size_t(attrib.offset),
+                                          mesh.vertexCount,
+                                          std::ptrdiff_t(attrib.stride),
+                                          Magnum::UnsignedShort(attrib.arraySize)};
+    }
+
+    auto const primitive  = Magnum::MeshPrimitive(mesh.primitive);
+    Array<char> vertexData = copy_array(reader.get<char>(gltf_cache_vertex_section(imageCount, meshIndex)));
+
+    if (mesh.indexType == 0)
+    {
+        return MeshData{primitive, std::move(vertexData), std::move(attribData), mesh.vertexCount};
+    }
+
+    auto const  indexType   = Magnum::MeshIndexType(mesh.indexType);
+    Array<char> indexData   = copy_array(reader.get<char>(gltf_cache_index_section(imageCount, meshIndex)));
+    auto const  indexView   = indexData.slice(std::size_t(mesh.indexOffset),
+                                              std::size_t(mesh.indexOffset) + mesh.indexCount * Magnum::meshIndexTypeSize(indexType));
+
+    return MeshData{primitive,
+                    std::move(indexData), MeshIndexData{indexType, indexView},
+                    std::move(vertexData), std::move(attribData),
+                    mesh.vertexCount};
+}
+
+} // namespace
+
+std::optional<uint64_t> osp::hash_file(std::string const& path)
+{
+    Corrade::Containers::Optional<MappedFile_t> mapped = Path::mapRead(path);
+    if ( ! mapped )
+    {
+        return std::nullopt;
+    }
+
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char const c : *mapped)
+    {
+        hash ^= uint8_t(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string osp::gltf_cache_path(std::string_view const cacheDir, uint64_t const sourceHash)
+{
+    static constexpr char const digits[] = "0123456789abcdef";
+
+    std::string name(16, '0');
+    for (int i = 0; i < 16; ++i)
+    {
+        name[15 - i] = digits[(sourceHash >> (i * 4)) & 0xF];
+    }
+
+    return Path::join(cacheDir, name + ".ospcook");
+}
+
+bool osp::write_gltf_cache(Resources const& rResources, ResId const importer, std::string const& sourcePath, std::string_view const cacheDir)
+{
+    using namespace restypes;
+
+    auto const *pImportData = rResources.data_try_get<ImporterData const>(gc_importer, importer);
+    auto const *pPrefabs    = rResources.data_try_get<Prefabs const>(gc_importer, importer);
+    auto const *pDeps       = rResources.data_try_get<GltfDependencies const>(gc_importer, importer);
+
+    if (pImportData == nullptr || pPrefabs == nullptr || pDeps == nullptr)
+    {
+        return false;
+    }
+
+    ImporterData const  &importData = *pImportData;
+    Prefabs const       &prefabs    = *pPrefabs;
+
+    std::optional<uint64_t> const sourceHash = hash_file(sourcePath);
+    if ( ! sourceHash.has_value() )
+    {
+        return false;
+    }
+
+    StringPool strings;
+
+    // Dependencies, hashed now so a change to any of them invalidates the cache
+    std::vector<GltfCacheDependency> dependencies;
+    std::string const sourceDir = Path::split(sourcePath).first();
+    for (std::string const& uri : pDeps->m_uris)
+    {
+        std::optional<uint64_t> const hash = hash_file(Path::join(sourceDir, uri));
+        if ( ! hash.has_value() )
+        {
+            return false;
+        }
+        dependencies.push_back({*hash, strings.add(uri), 0});
+    }
+
+    // List meshes to write, LODs after all imported meshes
+    std::vector<MeshData const*>    meshes(importData.m_meshes.size(), nullptr);
+    std::vector<GltfCacheMesh>      meshInfo(importData.m_meshes.size(), GltfCacheMesh{});
+    std::vector<float>              lodErrors(importData.m_meshes.size(), 0.0f);
+
+    for (std::size_t i = 0; i < importData.m_meshes.size(); ++i)
+    {
+        ResIdOwner_t const &meshOwner = importData.m_meshes[i];
+        if ( ! meshOwner.has_value() )
+        {
+            continue;
+        }
+
+        meshes[i]           = rResources.data_try_get<MeshData const>(gc_mesh, meshOwner);
+        meshInfo[i].name    = strings.add(name_suffix(rResources.name(gc_mesh, meshOwner), sourcePath));
+
+        auto const *pChain = rResources.data_try_get<MeshLodChain const>(gc_mesh, meshOwner);
+        if (pChain == nullptr)
+        {
+            continue;
+        }
+
+        meshInfo[i].lodFirst = uint32_t(meshes.size());
+        meshInfo[i].lodCount = uint32_t(pChain->m_levels.size());
+        for (std::size_t lvl = 0; lvl < pChain->m_levels.size(); ++lvl)
+        {
+            ResId const lodRes = pChain->m_levels[lvl];
+            meshes.push_back(rResources.data_try_get<MeshData const>(gc_mesh, lodRes));
+            meshInfo.push_back({ .name = strings.add(name_suffix(rResources.name(gc_mesh, lodRes), sourcePath)) });
+            lodErrors.push_back(pChain->m_errors.at(lvl));
+        }
+    }
+
+    auto const imageCount = uint32_t(importData.m_images.size());
+    auto const meshCount  = uint32_t(meshes.size());
+
+    SectionWriter writer{section_count(imageCount, meshCount)};
+
+    // Images
+    std::vector<GltfCacheImage> images(imageCount, GltfCacheImage{});
+    for (uint32_t i = 0; i < imageCount; ++i)
+    {
+        ResIdOwner_t const &imgOwner = importData.m_images[i];
+        ImageData2D const *pImg = imgOwner.has_value() ? rResources.data_try_get<ImageData2D const>(gc_image, imgOwner) : nullptr;
+        if (pImg == nullptr)
+        {
+            continue;
+        }
+
+        Magnum::PixelStorage const storage = pImg->storage();
+        if (   pImg->isCompressed()
+            || Magnum::isPixelFormatImplementationSpecific(pImg->format())
+            || storage.rowLength()   != 0
+            || storage.imageHeight() != 0
+            || storage.skip()        != Magnum::Vector3i{})
+        {
+            return false;
+        }
+
+        images[i] = {
+            .name       = strings.add(name_suffix(rResources.name(gc_image, imgOwner), sourcePath)),
+            .present    = 1,
+            .format     = uint32_t(pImg->format()),
+            .alignment  = uint32_t(storage.alignment()),
+            .size       = { pImg->size().x(), pImg->size().y() }
+        };
+        writer.add(gltf_cache_image_section(i), pImg->data());
+    }
+
+    // Textures
+    std::vector<GltfCacheTexture> textures(importData.m_textures.size(), GltfCacheTexture{});
+    for (std::size_t i = 0; i < textures.size(); ++i)
+    {
+        ResIdOwner_t const &texOwner = importData.m_textures[i];
+        TextureData const *pTex = texOwner.has_value() ? rResources.data_try_get<TextureData const>(gc_texture, texOwner) : nullptr;
+        if (pTex == nullptr)
+        {
+            continue;
+        }
+
+        textures[i] = {
+            .name       = strings.add(name_suffix(rResources.name(gc_texture, texOwner), sourcePath)),
+            .present    = 1,
+            .type       = uint32_t(pTex->type()),
+            .minFilter  = uint32_t(pTex->minificationFilter()),
+            .magFilter  = uint32_t(pTex->magnificationFilter()),
+            .mipmap     = uint32_t(pTex->mipmapFilter()),
+            .wrapping   = { uint32_t(pTex->wrapping()[0]), uint32_t(pTex->wrapping()[1]), uint32_t(pTex->wrapping()[2]) },
+            .image      = pTex->image()
+        };
+    }
+
+    // Meshes
+    std::vector<GltfCacheMeshAttribute> meshAttribs;
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        MeshData const *pMesh = meshes[i];
+        if (pMesh == nullptr)
+        {
+            continue;
+        }
+
+        GltfCacheMesh &rInfo = meshInfo[i];
+        rInfo.present       = 1;
+        rInfo.primitive     = uint32_t(pMesh->primitive());
+        rInfo.vertexCount   = pMesh->vertexCount();
+        rInfo.attribFirst   = uint32_t(meshAttribs.size());
+        rInfo.attribCount   = pMesh->attributeCount();
+
+        if (pMesh->isIndexed())
+        {
+            rInfo.indexType     = uint32_t(pMesh->indexType());
+            rInfo.indexOffset   = pMesh->indexOffset();
+            rInfo.indexCount    = pMesh->indexCount();
+            writer.add(gltf_cache_index_section(imageCount, i), pMesh->indexData());
+        }
+
+        for (Magnum::UnsignedInt attrib = 0; attrib < pMesh->attributeCount(); ++attrib)
+        {
+            if (Magnum::isVertexFormatImplementationSpecific(pMesh->attributeFormat(attrib)))
+            {
+                return false;
+            }
+
+            meshAttribs.push_back({
+                .name       = uint32_t(pMesh->attributeName(attrib)),
+                .format     = uint32_t(pMesh->attributeFormat(attrib)),
+                .offset     = pMesh->attributeOffset(attrib),
+                .stride     = pMesh->attributeStride(attrib),
+                .arraySize  = pMesh->attributeArraySize(attrib),
+                .reserved   = 0
+            });
+        }
+
+        writer.add(gltf_cache_vertex_section(imageCount, i), pMesh->vertexData());
+    }
+
+    // Materials. Pointer attributes can't be stored and are left out.
+    std::vector<GltfCacheMaterial>          materials(importData.m_materials.size(), GltfCacheMaterial{});
+    std::vector<uint32_t>                   matLayers;
+    std::vector<GltfCacheMaterialAttribute> matAttribs;
+    std::vector<char>                       matValues;
+    for (std::size_t i = 0; i < materials.size(); ++i)
+    {
+        if ( ! importData.m_materials[i] )
+        {
+            continue;
+        }
+
+        MaterialData const &mat = *importData.m_materials[i];
+
+        GltfCacheMaterial &rInfo = materials[i];
+        rInfo.present       = 1;
+        rInfo.types         = Magnum::UnsignedInt(mat.types());
+        rInfo.layerFirst    = uint32_t(matLayers.size());
+        rInfo.layerCount    = mat.layerCount();
+        rInfo.attribFirst   = uint32_t(matAttribs.size());
+
+        for (Magnum::UnsignedInt layer = 0; layer < mat.layerCount(); ++layer)
+        {
+            for (Magnum::UnsignedInt j = mat.attributeDataOffset(layer); j < mat.attributeDataOffset(layer + 1); ++j)
+            {
+                MaterialAttributeData const &attrib = mat.attributeData()[j];
+                MaterialAttributeType const type    = attrib.type();
+
+                if (type == MaterialAttributeType::Pointer || type == MaterialAttributeType::MutablePointer)
+                {
+                    continue;
+                }
+
+                std::string_view const value = (type == MaterialAttributeType::String)
+                        ? std::string_view{attrib.value<StringView>()}
+                        : std::string_view{static_cast<char const*>(attrib.value()),
+                                           Magnum::Trade::materialAttributeTypeSize(type)};
+
+                matAttribs.push_back({
+                    .name           = strings.add(attrib.name()),
+                    .type           = uint32_t(type),
+                    .valueOffset    = uint32_t(matValues.size()),
+                    .valueSize      = uint32_t(value.size())
+                });
+                matValues.insert(matValues.end(), value.begin(), value.end());
+            }
+            matLayers.push_back(uint32_t(matAttribs.size()) - rInfo.attribFirst);
+        }
+
+        rInfo.attribCount = uint32_t(matAttribs.size()) - rInfo.attribFirst;
+    }
+
+    // Objects
+    std::size_t const objCount = importData.m_objParents.size();
+
+    std::vector<uint64_t> objDescendants(importData.m_objDescendants.begin(), importData.m_objDescendants.end());
+    std::vector<uint32_t> objNames;
+    objNames.reserve(objCount);
+    for (Corrade::Containers::String const& name : importData.m_objNames)
+    {
+        objNames.push_back(strings.add(name));
+    }
+
+    // Prefabs
+    std::size_t const prefabCount = prefabs.m_prefabNames.size();
+
+    std::vector<uint32_t> prefabNameStart(prefabCount, 0);
+    for (std::size_t i = 0; i < prefabCount; ++i)
+    {
+        ObjId const root = prefabs.m_prefabs[PrefabId(i)][0];
+        prefabNameStart[i] = uint32_t(prefabs.m_prefabNames[i].data() - importData.m_objNames[root].data());
+    }
+
+    writer.add(sec(EGltfCacheSection::Dependencies),        dependencies);
+    writer.add(sec(EGltfCacheSection::Images),              images);
+    writer.add(sec(EGltfCacheSection::Textures),            textures);
+    writer.add(sec(EGltfCacheSection::Meshes),              meshInfo);
+    writer.add(sec(EGltfCacheSection::MeshAttributes),      meshAttribs);
+    writer.add(sec(EGltfCacheSection::MeshLodErrors),       lodErrors);
+    writer.add(sec(EGltfCacheSection::Materials),           materials);
+    writer.add(sec(EGltfCacheSection::MaterialLayers),      matLayers);
+    writer.add(sec(EGltfCacheSection::MaterialAttributes),  matAttribs);
+    writer.add(sec(EGltfCacheSection::MaterialValues),      matValues);
+
+    add_multimap(writer, EGltfCacheSection::ScnTopLevelOffsets, EGltfCacheSection::ScnTopLevel,
+                 importData.m_scnTopLevel, importData.m_scnTopLevel.ids_count());
+    add_multimap(writer, EGltfCacheSection::ObjChildrenOffsets, EGltfCacheSection::ObjChildren,
+                 importData.m_objChildren, objCount);
+
+    writer.add(sec(EGltfCacheSection::ObjParents),          importData.m_objParents);
+    writer.add(sec(EGltfCacheSection::ObjDescendants),      objDescendants);
+    writer.add(sec(EGltfCacheSection::ObjNames),            objNames);
+    writer.add(sec(EGltfCacheSection::ObjTransforms),       importData.m_objTransforms);
+    writer.add(sec(EGltfCacheSection::ObjMeshes),           importData.m_objMeshes);
+    writer.add(sec(EGltfCacheSection::ObjMaterials),        importData.m_objMaterials);
+
+    add_multimap(writer, EGltfCacheSection::PrefabOffsets, EGltfCacheSection::PrefabObjs,
+                 prefabs.m_prefabs, prefabCount);
+    {
+        // m_prefabParents has the same shape as m_prefabs, so only its data is needed
+        std::vector<int32_t> parents;
+        for (std::size_t i = 0; i < prefabCount; ++i)
+        {
+            auto const span = prefabs.m_prefabParents[PrefabId(i)];
+            parents.insert(parents.end(), span.begin(), span.end());
+        }
+        writer.add(sec(EGltfCacheSection::PrefabParents),   parents);
+    }
+    writer.add(sec(EGltfCacheSection::PrefabNameStart),     prefabNameStart);
+    writer.add(sec(EGltfCacheSection::ObjShapes),           prefabs.m_objShape);
+    writer.add(sec(EGltfCacheSection::ObjMasses),           prefabs.m_objMass);
+
+    // Strings last, everything above adds to them
+    writer.add(sec(EGltfCacheSection::StringOffsets),       strings.m_offsets);
+    writer.add(sec(EGltfCacheSection::StringChars),         strings.m_chars);
+
+    GltfCacheHeader const header
+    {
+        .magic              = gc_gcMagic,
+        .version            = gc_gcVersion,
+        .byteOrder          = gc_gcByteOrder,
+        .sourceHash         = *sourceHash,
+        .imageCount         = imageCount,
+        .meshCount          = meshCount,
+        .importedMeshCount  = uint32_t(importData.m_meshes.size()),
+        .sectionCount       = section_count(imageCount, meshCount)
+    };
+
+    if ( ! Path::make(cacheDir) )
+    {
+        return false;
+    }
+
+    return writer.write_file(header, gltf_cache_path(cacheDir, *sourceHash));
+}
+
+ResId osp::load_gltf_cache(std::string const& sourcePath, std::string_view const cacheDir, Resources& rResources, PkgId const pkg)
+{
+    using namespace restypes;
+
+    std::optional<uint64_t> const sourceHash = hash_file(sourcePath);
+    if ( ! sourceHash.has_value() )
+    {
+        return lgrn::id_null<ResId>();
+    }
+
+    std::string const cachePath = gltf_cache_path(cacheDir, *sourceHash);
+    if ( ! Path::exists(cachePath) )
+    {
+        return lgrn::id_null<ResId>();
+    }
+
+    Corrade::Containers::Optional<MappedFile_t> mapped = Path::mapRead(cachePath);
+    if ( ! mapped || mapped->size() < sizeof(GltfCacheHeader) )
+    {
+        return lgrn::id_null<ResId>();
+    }
+
+    GltfCacheHeader header;
+    std::memcpy(&header, mapped->data(), sizeof(GltfCacheHeader));
+
+    if (   header.magic             != gc_gcMagic
+        || header.version           != gc_gcVersion
+        || header.byteOrder         != gc_gcByteOrder
+        || header.sourceHash        != *sourceHash
+        || header.importedMeshCount >  header.meshCount
+        || header.sectionCount      != section_count(header.imageCount, header.meshCount)
+        || ! file_sections_valid(*mapped, sizeof(GltfCacheHeader), header.sectionCount) )
+    {
+        OSP_LOG_INFO("Ignoring incompatible cache file {} for {}", cachePath, sourcePath);
+        return lgrn::id_null<ResId>();
+    }
+
+    CacheReader reader{ .file = *mapped, .sections = file_sections(*mapped, sizeof(GltfCacheHeader), header.sectionCount) };
+    reader.stringOffsets    = reader.get<uint32_t>(EGltfCacheSection::StringOffsets);
+    reader.stringChars      = reader.get<char>(EGltfCacheSection::StringChars);
+
+    // Make sure no file the glTF refers to has changed
+    std::string const sourceDir = Path::split(sourcePath).first();
+    for (GltfCacheDependency const& dep : reader.get<GltfCacheDependency>(EGltfCacheSection::Dependencies))
+    {
+        std::optional<uint64_t> const hash = hash_file(Path::join(sourceDir, reader.string(dep.uri)));
+        if ( ! hash.has_value() || *hash != dep.hash )
+        {
+            OSP_LOG_INFO("Cache file {} is out of date for {}", cachePath, sourcePath);
+            return lgrn::id_null<ResId>();
+        }
+    }
+
+    auto const images           = reader.get<GltfCacheImage>            (EGltfCacheSection::Images);
+    auto const textures         = reader.get<GltfCacheTexture>          (EGltfCacheSection::Textures);
+    auto const meshes           = reader.get<GltfCacheMesh>             (EGltfCacheSection::Meshes);
+    auto const meshAttribs      = reader.get<GltfCacheMeshAttribute>    (EGltfCacheSection::MeshAttributes);
+    auto const lodErrors        = reader.get<float>                     (EGltfCacheSection::MeshLodErrors);
+    auto const materials        = reader.get<GltfCacheMaterial>         (EGltfCacheSection::Materials);
+    auto const matLayers        = reader.get<uint32_t>                  (EGltfCacheSection::MaterialLayers);
+    auto const matAttribs       = reader.get<GltfCacheMaterialAttribute>(EGltfCacheSection::MaterialAttributes);
+    auto const matValues        = reader.get<char>                      (EGltfCacheSection::MaterialValues);
+    auto const scnOffsets       = reader.get<uint32_t>                  (EGltfCacheSection::ScnTopLevelOffsets);
+    auto const scnTopLevel      = reader.get<ObjId>                     (EGltfCacheSection::ScnTopLevel);
+    auto const objParents       = reader.get<ObjId>                     (EGltfCacheSection::ObjParents);
+    auto const childOffsets     = reader.get<uint32_t>                  (EGltfCacheSection::ObjChildrenOffsets);
+    auto const objChildren      = reader.get<ObjId>                     (EGltfCacheSection::ObjChildren);
+    auto const objDescendants   = reader.get<uint64_t>                  (EGltfCacheSection::ObjDescendants);
+    auto const objNames         = reader.get<uint32_t>                  (EGltfCacheSection::ObjNames);
+    auto const objTransforms    = reader.get<Matrix4>                   (EGltfCacheSection::ObjTransforms);
+    auto const objMeshes        = reader.get<int32_t>                   (EGltfCacheSection::ObjMeshes);
+    auto const objMaterials     = reader.get<int32_t>                   (EGltfCacheSection::ObjMaterials);
+    auto const prefabOffsets    = reader.get<uint32_t>                  (EGltfCacheSection::PrefabOffsets);
+    auto const prefabObjs       = reader.get<ObjId>                     (EGltfCacheSection::PrefabObjs);
+    auto const prefabParents    = reader.get<int32_t>                   (EGltfCacheSection::PrefabParents);
+    auto const prefabNameStart  = reader.get<uint32_t>                  (EGltfCacheSection::PrefabNameStart);
+    auto const objShapes        = reader.get<EShape>                    (EGltfCacheSection::ObjShapes);
+    auto const objMasses        = reader.get<float>                     (EGltfCacheSection::ObjMasses);
+
+    std::size_t const objCount      = objParents.size();
+    std::size_t const prefabCount   = prefabNameStart.size();
+
+    bool valid =    images.size()           == header.imageCount
+                 && meshes.size()           == header.meshCount
+                 && lodErrors.size()        == header.meshCount
+                 && objDescendants.size()   == objCount
+                 && objNames.size()         == objCount
+                 && objTransforms.size()    == objCount
+                 && objMeshes.size()        == objCount
+                 && objMaterials.size()     == objCount
+                 && objShapes.size()        == objCount
+                 && objMasses.size()        == objCount
+                 && prefabParents.size()    == prefabObjs.size()
+                 && ! scnOffsets.isEmpty()
+                 && csr_valid(scnOffsets,    scnOffsets.size() - 1, scnTopLevel.size())
+                 && csr_valid(childOffsets,  objCount,              objChildren.size())
+                 && csr_valid(prefabOffsets, prefabCount,           prefabObjs.size());
+
+    if ( ! valid )
+    {
+        OSP_LOG_INFO("Ignoring corrupt cache file {} for {}", cachePath, sourcePath);
+        return lgrn::id_null<ResId>();
+    }
+
+    for (uint32_t i = 0; i < images.size(); ++i)
+    {
+        GltfCacheImage const &img = images[i];
+        if ( ! img.present )
+        {
+            continue;
+        }
+
+        bool const alignValid = img.alignment == 1 || img.alignment == 2 || img.alignment == 4 || img.alignment == 8;
+        valid =    valid
+                && alignValid
+                && ! Magnum::isPixelFormatImplementationSpecific(Magnum::PixelFormat(img.format))
+                && img.size[0] >= 0 && img.size[1] >= 0;
+        if (valid)
+        {
+            std::size_t const rowSize = std::size_t(img.size[0]) * Magnum::pixelFormatSize(Magnum::PixelFormat(img.format));
+            std::size_t const stride  = (rowSize + img.alignment - 1) / img.alignment * img.alignment;
+            valid = reader.get<char>(gltf_cache_image_section(i)).size() >= stride * std::size_t(img.size[1]);
+        }
+    }
+
+    for (GltfCacheTexture const& tex : textures)
+    {
+        valid = valid && ( ! tex.present || tex.image < images.size() );
+    }
+    for (std::size_t i = 0; i < meshes.size(); ++i)
+    {
+        GltfCacheMesh const &mesh = meshes[i];
+        valid =    valid
+                && in_range(mesh.attribFirst, mesh.attribCount, meshAttribs.size())
+                && ( i < header.importedMeshCount || mesh.lodCount == 0 )
+                && ( mesh.lodCount == 0 || (mesh.lodFirst >= header.importedMeshCount
+                                            && in_range(mesh.lodFirst, mesh.lodCount, meshes.size())) )
+                && ( mesh.indexType == 0 || in_range(mesh.indexOffset,
+                                                     std::size_t(mesh.indexCount) * Magnum::meshIndexTypeSize(Magnum::MeshIndexType(mesh.indexType)),
+                                                     reader.get<char>(gltf_cache_index_section(header.imageCount, uint32_t(i))).size()) );
+
+        std::size_t const vertexSize = reader.get<char>(gltf_cache_vertex_section(header.imageCount, uint32_t(i))).size();
+        for (std::size_t j = 0; valid && mesh.present && j < mesh.attribCount; ++j)
+        {
+            GltfCacheMeshAttribute const &attrib = meshAttribs[mesh.attribFirst + j];
+            auto const      format  = Magnum::VertexFormat(attrib.format);
+            std::size_t     last    = 0;
+            valid = ! Magnum::isVertexFormatImplementationSpecific(format);
+            if (valid)
+            {
+                last = mesh.vertexCount == 0 ? 0 : std::size_t(attrib.offset)
+                       + std::size_t(mesh.vertexCount - 1) * std::size_t(attrib.stride < 0 ? 0 : attrib.stride)
+                       + Magnum::vertexFormatSize(format) * std::max<std::size_t>(attrib.arraySize, 1);
+                valid = attrib.stride >= 0 && last <= vertexSize;
+            }
+        }
+    }
+    for (GltfCacheMaterial const& mat : materials)
+    {
+        valid = valid && in_range(mat.layerFirst, mat.layerCount, matLayers.size())
+                      && in_range(mat.attribFirst, mat.attribCount, matAttribs.size());
+    }
+    for (GltfCacheMaterialAttribute const& attrib : matAttribs)
+    {
+        valid = valid && in_range(attrib.valueOffset, attrib.valueSize, matValues.size());
+    }
+
+    // ObjIds are used as indices once loaded. -1 is only allowed where the importer writes it for
+    // 'none': root parents, objects without a mesh or material, and prefab roots.
+    auto const obj_in_range = [objCount] (ObjId const obj) noexcept
+    {
+        return obj >= 0 && std::size_t(obj) < objCount;
+    };
+    auto const none_or_below = [] (int32_t const value, std::size_t const count) noexcept
+    {
+        return value == -1 || (value >= 0 && std::size_t(value) < count);
+    };
+
+    for (ArrayView<ObjId const> const objs : {scnTopLevel, objChildren, prefabObjs})
+    {
+        valid = valid && std::all_of(objs.begin(), objs.end(), obj_in_range);
+    }
+    for (std::size_t i = 0; i < objCount; ++i)
+    {
+        valid =    valid
+                && none_or_below(objParents[i],   objCount)
+                && none_or_below(objMeshes[i],    header.importedMeshCount)
+                && none_or_below(objMaterials[i], materials.size());
+    }
+
+    for (std::size_t i = 0; i < prefabCount; ++i)
+    {
+        // Parents are indices within the same prefab, and always come before their children
+        for (std::size_t j = prefabOffsets[i]; valid && j < prefabOffsets[i + 1]; ++j)
+        {
+            valid = none_or_below(prefabParents[j], j - prefabOffsets[i]);
+        }
+
+        valid =    valid
+                && prefabOffsets[i] != prefabOffsets[i + 1]
+                && std::size_t(prefabObjs[prefabOffsets[i]]) < objCount
+                && prefabNameStart[i] <= reader.string(objNames[prefabObjs[prefabOffsets[i]]]).size();
+    }
+
+    if ( ! valid )
+    {
+        OSP_LOG_INFO("Ignoring corrupt cache file {} for {}", cachePath, sourcePath);
+        return lgrn::id_null<ResId>();
+    }
+
+    auto const res_name = [&sourcePath, &reader] (uint32_t const name)
+    {
+        return SharedString::create_from_parts(std::string_view{sourcePath}, reader.string(name));
+    };
+
+    ResId const res = rResources.create(gc_importer, pkg, SharedString::create(sourcePath));
+
+    ImporterData importData;
+    importData.m_images     .resize(images.size());
+    importData.m_textures   .resize(textures.size());
+    importData.m_meshes     .resize(header.importedMeshCount);
+    importData.m_materials  .resize(materials.size());
+
+    // Images
+    for (uint32_t i = 0; i < images.size(); ++i)
+    {
+        GltfCacheImage const &img = images[i];
+        if ( ! img.present )
+        {
+            continue;
+        }
+
+        ResId const imgRes = rResources.create(gc_image, pkg, res_name(img.name));
+        importData.m_images[i] = rResources.owner_create(gc_image, imgRes);
+
+        rResources.data_add<ImageData2D>(gc_image, imgRes,
+                Magnum::PixelStorage{}.setAlignment(Magnum::Int(img.alignment)),
+                Magnum::PixelFormat(img.format),
+                Magnum::Vector2i{img.size[0], img.size[1]},
+                copy_array(reader.get<char>(gltf_cache_image_section(i))));
+    }
+
+    // Textures
+    for (std::size_t i = 0; i < textures.size(); ++i)
+    {
+        GltfCacheTexture const &tex = textures[i];
+        if ( ! tex.present )
+        {
+            continue;
+        }
+
+        ResId const texRes = rResources.create(gc_texture, pkg, res_name(tex.name));
+        importData.m_textures[i] = rResources.owner_create(gc_texture, texRes);
+
+        rResources.data_add<TextureData>(gc_texture, texRes,
+                TextureType_t(tex.type),
+                Magnum::SamplerFilter(tex.minFilter),
+                Magnum::SamplerFilter(tex.magFilter),
+                Magnum::SamplerMipmap(tex.mipmap),
+                Magnum::Math::Vector3<Magnum::SamplerWrapping>{Magnum::SamplerWrapping(tex.wrapping[0]),
+                                                              Magnum::SamplerWrapping(tex.wrapping[1]),
+                                                              Magnum::SamplerWrapping(tex.wrapping[2])},
+                tex.image);
+
+        if (ResIdOwner_t const& imgRes = importData.m_images[tex.image];
+            imgRes.has_value())
+        {
+            ResIdOwner_t imgOwner = rResources.owner_create(gc_image, imgRes);
+            rResources.data_add<TextureImgSource>(gc_texture, texRes, TextureImgSource{std::move(imgOwner)} );
+        }
+    }
+
+    // Meshes, each followed by its LODs
+    for (uint32_t i = 0; i < header.importedMeshCount; ++i)
+    {
+        GltfCacheMesh const &mesh = meshes[i];
+        if ( ! mesh.present )
+        {
+            continue;
+        }
+
+        ResId const meshRes = rResources.create(gc_mesh, pkg, res_name(mesh.name));
+        rResources.data_add<MeshData>(gc_mesh, meshRes,
+                load_mesh(reader, mesh, meshAttribs.sliceSize(mesh.attribFirst, mesh.attribCount), header.imageCount, i));
+        importData.m_meshes[i] = rResources.owner_create(gc_mesh, meshRes);
+
+        MeshLodChain chain;
+        for (uint32_t lod = mesh.lodFirst; lod < mesh.lodFirst + mesh.lodCount; ++lod)
+        {
+            GltfCacheMesh const &lodMesh = meshes[lod];
+            if ( ! lodMesh.present )
+            {
+                continue;
+            }
+
+            ResId const lodRes = rResources.create(gc_mesh, pkg, res_name(lodMesh.name));
+            rResources.data_add<MeshData>(gc_mesh, lodRes,
+                    load_mesh(reader, lodMesh, meshAttribs.sliceSize(lodMesh.attribFirst, lodMesh.attribCount), header.imageCount, lod));
+            chain.m_levels.push_back(rResources.owner_create(gc_mesh, lodRes));
+            chain.m_errors.push_back(lodErrors[lod]);
+        }
+
+        if ( ! chain.m_levels.empty() )
+        {
+            rResources.data_add<MeshLodChain>(gc_mesh, meshRes, std::move(chain));
+        }
+    }
+
+    // Materials
+    for (std::size_t i = 0; i < materials.size(); ++i)
+    {
+        GltfCacheMaterial const &mat = materials[i];
+        if ( ! mat.present )
+        {
+            continue;
+        }
+
+        Array<MaterialAttributeData> attribData(mat.attribCount);
+        for (uint32_t j = 0; j < mat.attribCount; ++j)
+        {
+            GltfCacheMaterialAttribute const &attrib = matAttribs[mat.attribFirst + j];
+            auto const          type    = MaterialAttributeType(attrib.type);
+            char const* const   pValue  = matValues.data() + attrib.valueOffset;
+            StringView const    name    = reader.string(attrib.name);
+
+            if (type == MaterialAttributeType::String)
+            {
+                StringView const value{pValue, attrib.valueSize};
+                attribData[j] = MaterialAttributeData{name, type, &value};
+            }
+            else
+            {
+                attribData[j] = MaterialAttributeData{name, type, pValue};
+            }
+        }
+
+        Array<Magnum::UnsignedInt> layerData(mat.layerCount);
+        std::copy_n(matLayers.begin() + mat.layerFirst, mat.layerCount, layerData.begin());
+
+        importData.m_materials[i].emplace(Magnum::Trade::MaterialTypes{Magnum::Trade::MaterialType(mat.types)},
+                                          std::move(attribData), std::move(layerData));
+    }
+
+    // Objects
+    load_multimap(importData.m_scnTopLevel, scnOffsets,   scnTopLevel, true);
+    load_multimap(importData.m_objChildren, childOffsets, objChildren, false);
+
+    importData.m_objParents     .assign(objParents      .begin(), objParents    .end());
+    importData.m_objDescendants .assign(objDescendants  .begin(), objDescendants.end());
+    importData.m_objTransforms  .assign(objTransforms   .begin(), objTransforms .end());
+    importData.m_objMeshes      .assign(objMeshes       .begin(), objMeshes     .end());
+    importData.m_objMaterials   .assign(objMaterials    .begin(), objMaterials  .end());
+
+    importData.m_objNames.reserve(objCount);
+    for (uint32_t const name : objNames)
+    {
+        importData.m_objNames.emplace_back(StringView{reader.string(name)});
+    }
+
+    auto const &rImportData = rResources.data_add<ImporterData>(gc_importer, res, std::move(importData));
+
+    // Prefabs, after ImporterData is added, as prefab names point into its object names
+    Prefabs prefabs;
+    load_multimap(prefabs.m_prefabs,        prefabOffsets, prefabObjs,    true);
+    load_multimap(prefabs.m_prefabParents,  prefabOffsets, prefabParents, true);
+
+    prefabs.m_prefabNames.reserve(prefabCount);
+    for (std::size_t i = 0; i < prefabCount; ++i)
+    {
+        ObjId const root = prefabObjs[prefabOffsets[i]];
+        prefabs.m_prefabNames.emplace_back(std::string_view{rImportData.m_objNames[root]}.substr(prefabNameStart[i]));
+    }
+
+    prefabs.m_objShape  .assign(objShapes.begin(), objShapes.end());
+    prefabs.m_objMass   .assign(objMasses.begin(), objMasses.end());
+
+    rResources.data_add<Prefabs>(gc_importer, res, std::move(prefabs));
+
+    // Keep dependencies so the cache can be written again from what's loaded
+    GltfDependencies deps;
+    for (GltfCacheDependency const& dep : reader.get<GltfCacheDependency>(EGltfCacheSection::Dependencies))
+    {
+        deps.m_uris.emplace_back(reader.string(dep.uri));
+    }
+    rResources.data_add<GltfDependencies>(gc_importer, res, std::move(deps));
+
+    return res;
+}
+
+std::vector<ResId> osp::load_tinygltf_files_cached(
+        ArrayView<std::string const>    filepaths,
+        std::string_view const          cacheDir,
+        Resources&                      rResources,
+        PkgId const                     pkg,
+        unsigned int const              threadCount,
+        GltfLoadProgressFunc_t const    progressFunc,
+        void* const                     pUserData)
+{
+    std::vector<ResId> out(filepaths.size(), lgrn::id_null<ResId>());
+
+    std::vector<std::string>    misses;
+    std::vector<std::size_t>    missIndices;
+
+    // Cache hits are only a few bulk copies each, not worth any threads
+    for (std::size_t i = 0; i < filepaths.size(); ++i)
+    {
+        ResId const res = load_gltf_cache(filepaths[i], cacheDir, rResources, pkg);
+        if (res == lgrn::id_null<ResId>())
+        {
+            misses.push_back(filepaths[i]);
+            missIndices.push_back(i);
+            continue;
+        }
+
+        out[i] = res;
+        if (progressFunc != nullptr)
+        {
+            progressFunc({i + 1 - misses.size(), filepaths.size(), filepaths[i], res}, pUserData);
+        }
+    }
+
+    if (misses.empty())
+    {
+        return out;
+    }
+
+    // Offset progress of misses to count the cache hits before them
+    struct ProgressOffset
+    {
+        std::size_t             loadedBefore;
+        std::size_t             total;
+        GltfLoadProgressFunc_t  func;
+        void                    *pUserData;
+    };
+
+    ProgressOffset progressOffset{filepaths.size() - misses.size(), filepaths.size(), progressFunc, pUserData};
+
+    auto const offset_progress = [] (GltfLoadProgress const& progress, void* pOffsetData)
+    {
+        auto const &offset = *static_cast<ProgressOffset const*>(pOffsetData);
+        offset.func({offset.loadedBefore + progress.loaded, offset.total, progress.filepath, progress.res}, offset.pUserData);
+    };
+
+    std::vector<ResId> const loaded = load_tinygltf_files(
+            misses, rResources, pkg, threadCount,
+            (progressFunc != nullptr) ? static_cast<GltfLoadProgressFunc_t>(offset_progress) : nullptr,
+            &progressOffset);
+
+    for (std::size_t i = 0; i < misses.size(); ++i)
+    {
+        ResId const res = loaded[i];
+        out[missIndices[i]] = res;
+
+        if (res == lgrn::id_null<ResId>())
+        {
+            continue;
+        }
+
+        assigns_prefabs_tinygltf(rResources, res);
+
+        if ( ! write_gltf_cache(rResources, res, misses[i], cacheDir) )
+        {
+            OSP_LOG_INFO("Could not write cache for {}", misses[i]);
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,254 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "load_tinygltf.h"
+
+#include "../core/array_view.h"
+#include "../core/resourcetypes.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace osp
+{
+
+/**
+ * @brief Cooked glTF cache file layout
+ *
+ * Holds everything load_tinygltf_file and assigns_prefabs_tinygltf add to Resources for one glTF
+ * file: decoded images, textures, meshes and their LODs, ImporterData, and Prefabs. Uses the
+ * section layout from osp/core/section_file.h, so a mapped file is read with one bulk copy per
+ * buffer and no parsing or decoding.
+ *
+ * Cache files are named after a hash of the glTF file's contents. The hash of each file it refers
+ * to (GltfDependencies) is stored too, and checked before the cache is used.
+ *
+ * Sections after the fixed ones hold raw buffers: one per image, then an index and vertex buffer
+ * pair per mesh (LODs included).
+ */
+inline constexpr std::array<char, 8>    gc_gcMagic      {'O', 'S', 'P', 'C', 'O', 'O', 'K', '\0'};
+inline constexpr uint32_t               gc_gcVersion    = 1;
+inline constexpr uint32_t               gc_gcByteOrder  = 0x01020304;
+
+struct GltfCacheHeader
+{
+    std::array<char, 8> magic;
+    uint32_t            version;
+    uint32_t            byteOrder;
+    uint64_t            sourceHash;
+    uint32_t            imageCount;
+    uint32_t            meshCount;          ///< Including LODs
+    uint32_t            importedMeshCount;  ///< Meshes in ImporterData::m_meshes, LODs come after
+    uint32_t            sectionCount;
+};
+
+enum class EGltfCacheSection : uint32_t
+{
+    StringOffsets,      ///< uint32_t [string + 1], all strings below are indices into these
+    StringChars,        ///< char, strings are not null-terminated
+
+    Dependencies,       ///< GltfCacheDependency
+
+    Images,             ///< GltfCacheImage [ImporterData::m_images]
+    Textures,           ///< GltfCacheTexture [ImporterData::m_textures]
+    Meshes,             ///< GltfCacheMesh, ImporterData::m_meshes first, then LODs
+    MeshAttributes,     ///< GltfCacheMeshAttribute
+    MeshLodErrors,      ///< float [mesh]
+
+    Materials,          ///< GltfCacheMaterial [ImporterData::m_materials]
+    MaterialLayers,     ///< uint32_t, end offset of each layer into the material's attributes
+    MaterialAttributes, ///< GltfCacheMaterialAttribute
+    MaterialValues,     ///< char, attribute values, strings are not null-terminated
+
+    ScnTopLevelOffsets, ///< uint32_t [scene + 1]
+    ScnTopLevel,        ///< ObjId
+    ObjParents,         ///< ObjId [obj]
+    ObjChildrenOffsets, ///< uint32_t [obj + 1]
+    ObjChildren,        ///< ObjId
+    ObjDescendants,     ///< uint64_t [obj]
+    ObjNames,           ///< uint32_t [obj] -> string
+    ObjTransforms,      ///< Matrix4 [obj]
+    ObjMeshes,          ///< int32_t [obj]
+    ObjMaterials,       ///< int32_t [obj]
+
+    PrefabOffsets,      ///< uint32_t [prefab + 1], shared by PrefabObjs and PrefabParents
+    PrefabObjs,         ///< ObjId
+    PrefabParents,      ///< int32_t
+    PrefabNameStart,    ///< uint32_t [prefab], prefab name is its root's ObjName from here on
+    ObjShapes,          ///< EShape [obj]
+    ObjMasses,          ///< float [obj]
+
+    Count
+};
+
+struct GltfCacheDependency
+{
+    uint64_t hash;
+    uint32_t uri;       ///< string
+    uint32_t reserved;
+};
+
+struct GltfCacheImage
+{
+    uint32_t name;      ///< string, resource name after the glTF file path
+    uint32_t present;
+    uint32_t format;    ///< Magnum::PixelFormat
+    uint32_t alignment;
+    int32_t  size[2];
+};
+
+struct GltfCacheTexture
+{
+    uint32_t name;
+    uint32_t present;
+    uint32_t type;      ///< Magnum::Trade::TextureType
+    uint32_t minFilter;
+    uint32_t magFilter;
+    uint32_t mipmap;
+    uint32_t wrapping[3];
+    uint32_t image;
+};
+
+struct GltfCacheMesh
+{
+    uint32_t name;
+    uint32_t present;
+    uint32_t primitive;     ///< Magnum::MeshPrimitive
+    uint32_t indexType;     ///< Magnum::MeshIndexType, 0 if not indexed
+    uint64_t indexOffset;   ///< Bytes into the mesh's index buffer
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    uint32_t attribFirst;
+    uint32_t attribCount;
+    uint32_t lodFirst;      ///< Index of first LOD in Meshes
+    uint32_t lodCount;
+};
+
+struct GltfCacheMeshAttribute
+{
+    uint32_t name;          ///< Magnum::Trade::MeshAttribute
+    uint32_t format;        ///< Magnum::VertexFormat
+    uint64_t offset;
+    int64_t  stride;
+    uint32_t arraySize;
+    uint32_t reserved;
+};
+
+struct GltfCacheMaterial
+{
+    uint32_t present;
+    uint32_t types;         ///< Magnum::Trade::MaterialTypes
+    uint32_t layerFirst;
+    uint32_t layerCount;
+    uint32_t attribFirst;
+    uint32_t attribCount;
+};
+
+struct GltfCacheMaterialAttribute
+{
+    uint32_t name;          ///< string
+    uint32_t type;          ///< Magnum::Trade::MaterialAttributeType
+    uint32_t valueOffset;   ///< Bytes into MaterialValues
+    uint32_t valueSize;
+};
+
+constexpr uint32_t gltf_cache_section(EGltfCacheSection const section) noexcept
+{
+    return uint32_t(section);
+}
+
+constexpr uint32_t gltf_cache_image_section(uint32_t const image) noexcept
+{
+    return uint32_t(EGltfCacheSection::Count) + image;
+}
+
+constexpr uint32_t gltf_cache_index_section(uint32_t const imageCount, uint32_t const mesh) noexcept
+{
+    return uint32_t(EGltfCacheSection::Count) + imageCount + mesh * 2;
+}
+
+constexpr uint32_t gltf_cache_vertex_section(uint32_t const imageCount, uint32_t const mesh) noexcept
+{
+    return gltf_cache_index_section(imageCount, mesh) + 1;
+}
+
+/**
+ * @return 64-bit FNV-1a hash of a file's contents, or empty if it can't be read
+ */
+std::optional<uint64_t> hash_file(std::string const& path);
+
+/**
+ * @return Path to the cache file for a glTF file with the given hash
+ */
+std::string gltf_cache_path(std::string_view cacheDir, uint64_t sourceHash);
+
+/**
+ * @brief Write a cache file for an importer loaded by load_tinygltf_file(s)
+ *
+ * Prefabs must already be assigned with assigns_prefabs_tinygltf.
+ *
+ * @param rResources    [in] Resources containing importer and everything it owns
+ * @param importer      [in] gc_importer resource with ImporterData, Prefabs, and GltfDependencies
+ * @param sourcePath    [in] glTF file the importer was loaded from
+ * @param cacheDir      [in] Directory to write the cache file in, created if it doesn't exist
+ *
+ * @return true if the cache file was written. Files with compressed images or
+ *         implementation-specific formats are not cached.
+ */
+bool write_gltf_cache(Resources const& rResources, ResId importer, std::string const& sourcePath, std::string_view cacheDir);
+
+/**
+ * @brief Load a glTF file from its cache file, if there's one and it's up to date
+ *
+ * Adds the same resources and data as load_tinygltf_file followed by assigns_prefabs_tinygltf,
+ * except for TinyGltf node extras, which are only needed to assign Prefabs.
+ *
+ * @return gc_importer resource, or null if there's no usable cache file
+ */
+ResId load_gltf_cache(std::string const& sourcePath, std::string_view cacheDir, Resources& rResources, PkgId pkg);
+
+/**
+ * @brief Load glTF files and assign their Prefabs, using and updating cooked cache files
+ *
+ * Files with an up to date cache are loaded from it. The rest are loaded in parallel with
+ * load_tinygltf_files, given Prefabs, then cached for next time.
+ *
+ * @return Importer resource for each file, or null for files that failed to load
+ */
+std::vector<ResId> load_tinygltf_files_cached(
+        ArrayView<std::string const>    filepaths,
+        std::string_view                cacheDir,
+        Resources&                      rResources,
+        PkgId                           pkg,
+        unsigned int                    threadCount,
+        GltfLoadProgressFunc_t          progressFunc    = nullptr,
+        void*                           pUserData       = nullptr);
+
+} // namespace osp
@@ -27,6 +27,7 @@
 #include "ImporterData.h"
 
 #include "../core/Resources.h"
+#include "../drawing/mesh_lod.h"
 #include "../drawing/own_restypes.h"
 #include "../util/logging.h"
 
@@ -43,6 +44,14 @@
 #include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/PairStl.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace osp;
 
 using Magnum::Trade::TinyGltfImporter;
@@ -69,31 +78,47 @@ using TinyGltfNodeExtras_t = std::vector<tinygltf::Value>;
 void osp::register_tinygltf_resources(Resources &rResources)
 {
     rResources.data_register<TinyGltfNodeExtras_t>(restypes::gc_importer);
+    rResources.data_register<GltfDependencies>(restypes::gc_importer);
 }
 
-static void load_gltf(TinyGltfImporter &rImporter, ResId res, std::string_view name, Resources &rResources, PkgId pkg)
+namespace
 {
-    using namespace restypes;
 
-    // Combine resource names. Maybe make this customizable
-    // ie: name = "dir/file.gltf" and resName = "mytexture"
-    // "dir/file.gltf:mytexture"
-    // "unnamed-[id]" is used as the resource name if it's empty
-    auto format_name = [name](std::string_view resName, UnsignedInt id)
-    {
-        if ( ! resName.empty())
-        {
-            return SharedString::create_from_parts(name, ":", resName);
-        }
-        else
-        {
-            // i don't like std::to_string but screw it, fix it later
-            return SharedString::create_from_parts(name, ":unnamed-", std::to_string(id));
-        }
-    };
+/**
+ * @brief Everything read from a glTF file, not yet added to any Resources
+ *
+ * Filled in by decode_gltf on any thread, then added to Resources by commit_gltf.
+ */
+struct GltfDecoded
+{
+    std::vector< Optional<ImageData2D> >    images;
+    std::vector<std::string>                imageNames;
+
+    std::vector< Optional<TextureData> >    textures;
+    std::vector<std::string>                textureNames;
 
-    auto &rImportData = rResources.data_add<ImporterData>(restypes::gc_importer, res);
-    auto &rNodeExtras = rResources.data_add<TinyGltfNodeExtras_t>(restypes::gc_importer, res);
+    std::vector< Optional<MeshData> >       meshes;
+    std::vector<std::string>                meshNames;
+    std::vector<draw::GeneratedMeshLods>    meshLods;
+
+    // Resource owners are left empty, set by commit_gltf
+    ImporterData                            importData;
+    TinyGltfNodeExtras_t                    nodeExtras;
+    GltfDependencies                        dependencies;
+};
+
+} // namespace
+
+/**
+ * @brief Read and decode all images, meshes, and objects of an opened glTF file
+ *
+ * Does not touch Resources; different importers can decode in parallel.
+ */
+static GltfDecoded decode_gltf(TinyGltfImporter &rImporter)
+{
+    GltfDecoded out;
+    ImporterData &rImportData = out.importData;
+    TinyGltfNodeExtras_t &rNodeExtras = out.nodeExtras;
 
     // Allocate various data
     rImportData.m_images        .resize(rImporter.image2DCount());
@@ -119,63 +144,37 @@ static void load_gltf(TinyGltfImporter &rImporter, ResId res, std::string_view n
     rImportData.m_scnTopLevel.ids_reserve(rImporter.sceneCount());
     rImportData.m_scnTopLevel.data_reserve(rImporter.objectCount());
 
-    // Store images
+    // Decode images
+    out.images      .reserve(rImporter.image2DCount());
+    out.imageNames  .reserve(rImporter.image2DCount());
     for (UnsignedInt i = 0; i < rImporter.image2DCount(); i ++)
     {
-        Optional<ImageData2D> img = rImporter.image2D(i);
-
-        if ( ! bool(img) )
-        {
-            continue;
-        }
-
-        // Create and keep track of resource Id
-        ResId const imgRes = rResources.create(gc_image, pkg, format_name(rImporter.image2DName(i), i));
-        rImportData.m_images[i] = rResources.owner_create(gc_image, imgRes);
-
-        // Add image data to resource
-        rResources.data_add<ImageData2D>(gc_image, imgRes, std::move(*img));
+        out.images      .push_back(rImporter.image2D(i));
+        out.imageNames  .emplace_back(rImporter.image2DName(i));
     }
 
-    // Store textures
+    // Read textures
+    out.textures    .reserve(rImporter.textureCount());
+    out.textureNames.reserve(rImporter.textureCount());
     for (UnsignedInt i = 0; i < rImporter.textureCount(); i ++)
     {
-        Optional<TextureData> tex = rImporter.texture(i);
-
-        if ( ! bool(tex) )
-        {
-            continue;
-        }
-
-        // Create and keep track of resource Id
-        ResId const texRes = rResources.create(gc_texture, pkg, format_name(rImporter.textureName(i), i));
-        rImportData.m_textures[i] = rResources.owner_create(gc_texture, texRes);
-
-        // Add data to resource
-        rResources.data_add<TextureData>(gc_texture, texRes, std::move(*tex));
-
-        // Keep track of which image this texture uses
-        if (ResIdOwner_t const& imgRes = rImportData.m_images.at(tex->image());
-            imgRes.has_value())
-        {
-            ResIdOwner_t imgOwner = rResources.owner_create(gc_image, imgRes);
-            rResources.data_add<TextureImgSource>(gc_texture, texRes, TextureImgSource{std::move(imgOwner)} );
-        }
+        out.textures    .push_back(rImporter.texture(i));
+        out.textureNames.emplace_back(rImporter.textureName(i));
     }
 
-    // Store meshes
+    // Decode meshes and generate their LODs
+    out.meshes      .reserve(rImporter.meshCount());
+    out.meshNames   .reserve(rImporter.meshCount());
+    out.meshLods    .resize(rImporter.meshCount());
     for (UnsignedInt i = 0; i < rImporter.meshCount(); i ++)
     {
-        Optional<MeshData> mesh = rImporter.mesh(i);
+        Optional<MeshData> &rMesh = out.meshes.emplace_back(rImporter.mesh(i));
+        out.meshNames.emplace_back(rImporter.meshName(i));
 
-        if ( ! bool(mesh) )
+        if (bool(rMesh))
         {
-            continue;
+            out.meshLods[i] = draw::compute_mesh_lods(*rMesh);
         }
-
-        ResId const meshRes = rResources.create(gc_mesh, pkg, format_name(rImporter.meshName(i), i));
-        rResources.data_add<MeshData>(gc_mesh, meshRes, std::move(*mesh));
-        rImportData.m_meshes[i] = rResources.owner_create(gc_mesh, meshRes);
     }
 
     // Store materials
@@ -184,6 +183,28 @@ static void load_gltf(TinyGltfImporter &rImporter, ResId res, std::string_view n
         rImportData.m_materials[i] = rImporter.material(i);
     }
 
+    // Keep track of external files, for anything that needs to know if this one is out of date
+    {
+        tinygltf::Model const *pModel = rImporter.importerState();
+
+        auto const add_uri = [&rUris = out.dependencies.m_uris] (std::string const& uri)
+        {
+            if ( ! uri.empty() && uri.rfind("data:", 0) != 0 )
+            {
+                rUris.push_back(uri);
+            }
+        };
+
+        for (tinygltf::Buffer const& buffer : pModel->buffers)
+        {
+            add_uri(buffer.uri);
+        }
+        for (tinygltf::Image const& image : pModel->images)
+        {
+            add_uri(image.uri);
+        }
+    }
+
     // Iterate objects to store names and custom properties
     for (UnsignedInt obj = 0; obj < rImporter.objectCount(); obj ++)
     {
@@ -322,6 +343,100 @@ static void load_gltf(TinyGltfImporter &rImporter, ResId res, std::string_view n
             *pSpot = obj; // add self to parent's children
         }
     }
+
+    return out;
+}
+
+/**
+ * @brief Add everything decoded by decode_gltf to Resources, owned by importer resource res
+ */
+static void commit_gltf(GltfDecoded &&rDecoded, ResId res, std::string_view name, Resources &rResources, PkgId pkg)
+{
+    using namespace restypes;
+
+    // Combine resource names. Maybe make this customizable
+    // ie: name = "dir/file.gltf" and resName = "mytexture"
+    // "dir/file.gltf:mytexture"
+    // "unnamed-[id]" is used as the resource name if it's empty
+    auto format_name = [name](std::string_view resName, UnsignedInt id)
+    {
+        if ( ! resName.empty())
+        {
+            return SharedString::create_from_parts(name, ":", resName);
+        }
+        else
+        {
+            // i don't like std::to_string but screw it, fix it later
+            return SharedString::create_from_parts(name, ":unnamed-", std::to_string(id));
+        }
+    };
+
+    auto &rImportData = rResources.data_add<ImporterData>(gc_importer, res, std::move(rDecoded.importData));
+    rResources.data_add<TinyGltfNodeExtras_t>(gc_importer, res, std::move(rDecoded.nodeExtras));
+    rResources.data_add<GltfDependencies>(gc_importer, res, std::move(rDecoded.dependencies));
+
+    // Store images
+    for (UnsignedInt i = 0; i < rDecoded.images.size(); i ++)
+    {
+        Optional<ImageData2D> &rImg = rDecoded.images[i];
+
+        if ( ! bool(rImg) )
+        {
+            continue;
+        }
+
+        // Create and keep track of resource Id
+        ResId const imgRes = rResources.create(gc_image, pkg, format_name(rDecoded.imageNames[i], i));
+        rImportData.m_images[i] = rResources.owner_create(gc_image, imgRes);
+
+        // Add image data to resource
+        rResources.data_add<ImageData2D>(gc_image, imgRes, std::move(*rImg));
+    }
+
+    // Store textures
+    for (UnsignedInt i = 0; i < rDecoded.textures.size(); i ++)
+    {
+        Optional<TextureData> &rTex = rDecoded.textures[i];
+
+        if ( ! bool(rTex) )
+        {
+            continue;
+        }
+
+        UnsignedInt const image = rTex->image();
+
+        // Create and keep track of resource Id
+        ResId const texRes = rResources.create(gc_texture, pkg, format_name(rDecoded.textureNames[i], i));
+        rImportData.m_textures[i] = rResources.owner_create(gc_texture, texRes);
+
+        // Add data to resource
+        rResources.data_add<TextureData>(gc_texture, texRes, std::move(*rTex));
+
+        // Keep track of which image this texture uses
+        if (ResIdOwner_t const& imgRes = rImportData.m_images.at(image);
+            imgRes.has_value())
+        {
+            ResIdOwner_t imgOwner = rResources.owner_create(gc_image, imgRes);
+            rResources.data_add<TextureImgSource>(gc_texture, texRes, TextureImgSource{std::move(imgOwner)} );
+        }
+    }
+
+    // Store meshes, along with the LODs generated by decode_gltf
+    for (UnsignedInt i = 0; i < rDecoded.meshes.size(); i ++)
+    {
+        Optional<MeshData> &rMesh = rDecoded.meshes[i];
+
+        if ( ! bool(rMesh) )
+        {
+            continue;
+        }
+
+        ResId const meshRes = rResources.create(gc_mesh, pkg, format_name(rDecoded.meshNames[i], i));
+        rResources.data_add<MeshData>(gc_mesh, meshRes, std::move(*rMesh));
+        rImportData.m_meshes[i] = rResources.owner_create(gc_mesh, meshRes);
+
+        draw::add_mesh_lods(rResources, meshRes, pkg, std::move(rDecoded.meshLods[i]));
+    }
 }
 
 
@@ -343,13 +458,95 @@ ResId osp::load_tinygltf_file(std::string_view filepath, Resources &rResources,
         return lgrn::id_null<ResId>();
     }
 
-    load_gltf(importer, res, filepath, rResources, pkg);
+    commit_gltf(decode_gltf(importer), res, filepath, rResources, pkg);
 
     importer.close();
 
     return res;
 }
 
+std::vector<ResId> osp::load_tinygltf_files(
+        ArrayView<std::string const>    filepaths,
+        Resources&                      rResources,
+        PkgId const                     pkg,
+        unsigned int const              threadCount,
+        GltfLoadProgressFunc_t const    progressFunc,
+        void* const                     pUserData)
+{
+    struct Slot
+    {
+        std::optional<GltfDecoded>  decoded;
+        std::atomic<bool>           done{false};
+    };
+
+    std::size_t const fileCount = filepaths.size();
+    if (fileCount == 0)
+    {
+        return {};
+    }
+
+    auto const slots = std::make_unique<Slot[]>(fileCount);
+    std::atomic<std::size_t> nextFile{0};
+
+    // Workers take files in order, so commits below rarely wait on anything but the oldest file
+    auto const decode_files = [filepaths, fileCount, &slots, &nextFile] ()
+    {
+        PluginManager pluginManager;
+
+        for (std::size_t i = nextFile++; i < fileCount; i = nextFile++)
+        {
+            TinyGltfImporter importer{pluginManager};
+            importer.openFile(filepaths[i]);
+
+            if (importer.isOpened() && importer.defaultScene() != -1)
+            {
+                slots[i].decoded.emplace(decode_gltf(importer));
+            }
+            importer.close();
+
+            slots[i].done.store(true, std::memory_order_release);
+            slots[i].done.notify_one();
+        }
+    };
+
+    std::vector<ResId> out(fileCount, lgrn::id_null<ResId>());
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(std::max(threadCount, 1u));
+        for (unsigned int i = 0; i < std::max(threadCount, 1u); ++i)
+        {
+            workers.emplace_back(decode_files);
+        }
+
+        // Commit serially in the order given, overlapping with later files still being decoded
+        for (std::size_t i = 0; i < fileCount; ++i)
+        {
+            slots[i].done.wait(false, std::memory_order_acquire);
+
+            std::string_view const filepath = filepaths[i];
+
+            if (slots[i].decoded.has_value())
+            {
+                out[i] = rResources.create(restypes::gc_importer, pkg, SharedString::create(filepath));
+                commit_gltf(std::move(*slots[i].decoded), out[i], filepath, rResources, pkg);
+                slots[i].decoded.reset();
+            }
+            else
+            {
+                OSP_LOG_ERROR("Could not open file {}", filepath);
+            }
+
+            if (progressFunc != nullptr)
+            {
+                progressFunc({i + 1, fileCount, filepath, out[i]}, pUserData);
+            }
+        }
+    } // join workers
+
+    return out;
+}
+
 static EShape shape_from_name(std::string_view name) noexcept
 {
     if (name == "cube")             { return EShape::Box; }
@@ -361,6 +558,10 @@ static EShape shape_from_name(std::string_view name) noexcept
 
 void osp::assigns_prefabs_tinygltf(Resources &rResources, ResId importer)
 {
+    if (rResources.data_try_get<Prefabs>(restypes::gc_importer, importer) != nullptr)
+    {
+        return; // Already assigned, such as when loaded from a cache file
+    }
 
     auto const *pImportData = rResources.data_try_get<ImporterData>(restypes::gc_importer, importer);
     auto const *pNodeExtras = rResources.data_try_get<TinyGltfNodeExtras_t>(restypes::gc_importer, importer);
@@ -24,16 +24,68 @@
  */
 #pragma once
 
+#include "../core/array_view.h"
 #include "../core/resourcetypes.h"
 
+#include <cstddef>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace osp
 {
 
+/**
+ * @brief Files a glTF file refers to, such as buffers and images, as written in the file
+ *
+ * Added to gc_importer resources loaded by load_tinygltf_file(s). URIs are relative to the glTF
+ * file's directory; embedded data URIs are not included.
+ */
+struct GltfDependencies
+{
+    std::vector<std::string> m_uris;
+};
+
 void register_tinygltf_resources(Resources &rResources);
 ResId load_tinygltf_file(std::string_view filepath, Resources &rResources, PkgId pkg);
 
+/**
+ * @brief Reported by load_tinygltf_files each time a file is added to Resources
+ */
+struct GltfLoadProgress
+{
+    std::size_t         loaded;     ///< Files done so far, including this one
+    std::size_t         total;
+    std::string_view    filepath;
+    ResId               res;        ///< Importer resource, or null if the file failed to load
+};
+
+using GltfLoadProgressFunc_t = void(*)(GltfLoadProgress const& progress, void* pUserData);
+
+/**
+ * @brief Load multiple glTF files, reading and decoding them in parallel
+ *
+ * Files are opened, and their images and meshes decoded (and mesh LODs generated), on
+ * [threadCount] worker threads. Decoded files are added to rResources on the calling thread only,
+ * in the order given, while later files are still being decoded. Returns once all files are added.
+ *
+ * @param filepaths     [in] Files to load
+ * @param rResources    [ref] Resources to add importers, images, textures, and meshes to
+ * @param pkg           [in] Package to create new resources in
+ * @param threadCount   [in] Number of worker threads to decode with
+ * @param progressFunc  [in] Optional, called on the calling thread after each file is added
+ * @param pUserData     [in] Passed to progressFunc
+ *
+ * @return Importer resource for each file, or null for files that failed to load
+ */
+std::vector<ResId> load_tinygltf_files(
+        ArrayView<std::string const>    filepaths,
+        Resources&                      rResources,
+        PkgId                           pkg,
+        unsigned int                    threadCount,
+        GltfLoadProgressFunc_t          progressFunc    = nullptr,
+        void*                           pUserData       = nullptr);
+
 /**
  * @brief Assign prefabs (potentially Parts) and add physical properties to an
  *        ImporterData loaded from tinygltf
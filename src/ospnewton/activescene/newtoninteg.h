@@ -95,14 +95,14 @@ struct ACtxNwtWorld
     std::vector<ForceFactors_t>                     m_bodyFactors;
     osp::BitVector_t                                m_bodyDirty;
 
-    std::vector<osp::active::ActiveEnt>             m_bodyToEnt;
+    std::vector<osp::active::ActiveEntRef>          m_bodyToEnt;
     osp::IdMap_t<osp::active::ActiveEnt, BodyId>    m_entToBody;
 
     std::vector<ForceFactorFunc>                    m_factors;
 
     ColliderStorage_t                               m_colliders;
 
-    osp::active::ACompTransformStorage_t            *m_pTransform;
+    osp::active::ACtxBasic                          *m_pBasic{nullptr};
 };
 
 
@@ -42,8 +42,11 @@ using namespace Magnum::Math::Literals;
 
 using osp::EShape;
 
+using osp::active::ACtxBasic;
 using osp::active::ActiveEnt;
+using osp::active::ActiveEntRef;
 using osp::active::ACtxPhysics;
+using osp::active::SysActiveEnt;
 using osp::active::SysSceneGraph;
 
 using osp::Matrix3;
@@ -79,9 +82,13 @@ void SysNewton::cb_set_transform(
     ACtxNwtWorld &rWorldCtx = SysNewton::context_from_nwtbody(pBody);
     BodyId const bodyId     = SysNewton::get_userdata_bodyid(pBody);
 
-    ActiveEnt const ent = rWorldCtx.m_bodyToEnt[bodyId];
+    ACtxBasic &rBasic               = *rWorldCtx.m_pBasic;
+    ActiveEntRef const entRef       = rWorldCtx.m_bodyToEnt[bodyId];
 
-    NewtonBodyGetMatrix(pBody, rWorldCtx.m_pTransform->get(ent).m_transform.data());
+    LGRN_ASSERTM(SysActiveEnt::is_current(rBasic, entRef),
+                 "Newton body's ActiveEnt was deleted without removing the body");
+
+    NewtonBodyGetMatrix(pBody, rBasic.m_transform.get(entRef.ent).m_transform.data());
 } // cb_set_transform()
 
 
@@ -172,21 +179,21 @@ void SysNewton::update_world(
         ACtxPhysics&                rCtxPhys,
         ACtxNwtWorld&               rCtxWorld,
         float                       timestep,
-        ACtxSceneGraph const&       rScnGraph,
-        ACompTransformStorage_t&    rTf) noexcept
+        ACtxBasic&                  rBasic) noexcept
 {
     NewtonWorld const* pNwtWorld = rCtxWorld.m_world.get();
 
     // Apply changed velocities
-    for (auto const& [ent, vel] : std::exchange(rCtxPhys.m_setVelocity, {}))
+    for (auto const& [ent, vel] : rCtxPhys.m_setVelocity)
     {
         BodyId const bodyId     = rCtxWorld.m_entToBody.at(ent);
         NewtonBody const *pBody = rCtxWorld.m_bodyPtrs[bodyId].get();
 
         NewtonBodySetVelocity(pBody, vel.data());
     }
+    rCtxPhys.m_setVelocity.clear(); // keep capacity for next frame
 
-    rCtxWorld.m_pTransform = std::addressof(rTf);
+    rCtxWorld.m_pBasic = std::addressof(rBasic);
 
     // Update the world
     NewtonUpdate(pNwtWorld, timestep);
@@ -200,7 +207,7 @@ void SysNewton::remove_components(ACtxNwtWorld& rCtxWorld, ActiveEnt ent) noexce
     {
         BodyId const bodyId = itBodyId->second;
         rCtxWorld.m_bodyPtrs[bodyId].reset();
-        rCtxWorld.m_bodyToEnt[bodyId] = lgrn::id_null<ActiveEnt>();
+        rCtxWorld.m_bodyToEnt[bodyId] = {};
         rCtxWorld.m_entToBody.erase(itBodyId);
     }
 
@@ -97,18 +97,13 @@ public:
      * @param rCtxPhys      [ref] Generic Physics context. Updates linear and angular velocity.
      * @param rCtxWorld     [ref] Newton world to update
      * @param timestep      [in] Time to step world, passed to Newton update
-     * @param inputs        [ref] Physics inputs (from different threads)
-     * @param rHier         [in] Storage for Hierarchy components
-     * @param rTf           [ref] Relative transforms used by rigid bodies
-     * @param rTfControlled [ref] Flags for controlled transforms
-     * @param rTfMutable    [ref] Flags for mutable transforms
+     * @param rBasic        [ref] Transforms written by rigid bodies, and ActiveEnt generations
      */
     static void update_world(
             ACtxPhysics&                            rCtxPhys,
             ACtxNwtWorld&                           rCtxWorld,
             float                                   timestep,
-            ACtxSceneGraph const&                   rScnGraph,
-            osp::active::ACompTransformStorage_t&   rTf) noexcept;
+            osp::active::ACtxBasic&                 rBasic) noexcept;
 
     static void remove_components(
             ACtxNwtWorld& rCtxWorld, ActiveEnt ent) noexcept;
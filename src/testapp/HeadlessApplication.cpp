@@ -0,0 +1,185 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "HeadlessApplication.h"
+
+#include <osp/drawing_gl/rendergl.h>
+#include <osp/util/logging.h>
+
+#include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/GL/Renderer.h>
+
+#ifdef OSP_WITH_HEADLESS
+    #include <Magnum/Platform/GLContext.h>
+    #include <Magnum/Platform/WindowlessEglApplication.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+namespace testapp
+{
+
+#ifdef OSP_WITH_HEADLESS
+
+struct HeadlessApplication::Context
+{
+    Magnum::Platform::WindowlessGLContext   m_windowless{Magnum::Platform::WindowlessGLContext::Configuration{}};
+    Magnum::Platform::GLContext             m_gl{Corrade::NoCreate};
+    bool                                    m_created{false};
+};
+
+HeadlessApplication::HeadlessApplication(Arguments const& args)
+ : m_pContext{std::make_unique<Context>()}
+{
+    Context &rCtx = *m_pContext;
+
+    if ( ! rCtx.m_windowless.isCreated() || ! rCtx.m_windowless.makeCurrent() )
+    {
+        OSP_LOG_ERROR("Failed to create windowless OpenGL context");
+        return;
+    }
+
+    if ( ! rCtx.m_gl.tryCreate() )
+    {
+        OSP_LOG_ERROR("Failed to initialize OpenGL for windowless context");
+        return;
+    }
+
+    rCtx.m_created = true;
+
+    // There's no window, but SysRenderGL::setup_context sizes the offscreen framebuffer and
+    // cameras get their aspect ratio from the default framebuffer's viewport
+    Magnum::GL::defaultFramebuffer.setViewport({{}, args.size});
+}
+
+bool HeadlessApplication::is_supported() noexcept
+{
+    return true;
+}
+
+bool HeadlessApplication::has_context() const noexcept
+{
+    return m_pContext != nullptr && m_pContext->m_created;
+}
+
+#else // OSP_WITH_HEADLESS
+
+struct HeadlessApplication::Context { };
+
+HeadlessApplication::HeadlessApplication(Arguments const& args)
+{
+    OSP_LOG_ERROR("Headless rendering is not supported by this build (configure with -DOSP_HEADLESS=ON)");
+}
+
+bool HeadlessApplication::is_supported() noexcept
+{
+    return false;
+}
+
+bool HeadlessApplication::has_context() const noexcept
+{
+    return false;
+}
+
+#endif // OSP_WITH_HEADLESS
+
+HeadlessApplication::HeadlessApplication(HeadlessApplication&& move) noexcept = default;
+HeadlessApplication& HeadlessApplication::operator=(HeadlessApplication&& move) noexcept = default;
+
+HeadlessApplication::~HeadlessApplication()
+{
+    // Draw function may own GL resources, destroy it while the context is still alive
+    m_ospApp.reset(nullptr);
+}
+
+HeadlessFrameReport HeadlessApplication::run_frames(
+        std::size_t const frames, float const delta, osp::draw::RenderGL& rRenderGl)
+{
+    using Clock_t = std::chrono::steady_clock;
+
+    HeadlessFrameReport report;
+
+    if ( ! has_context() || m_ospApp == nullptr || frames == 0 )
+    {
+        return report;
+    }
+
+    std::vector<float> frameMs;
+    frameMs.reserve(frames);
+
+    osp::draw::RenderStatsGL total;
+
+    m_ospApp->run();
+
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        rRenderGl.m_stats = {};
+
+        Clock_t::time_point const start = Clock_t::now();
+
+        m_ospApp->draw(delta);
+
+        // Make sure the GPU actually did the work, instead of only timing command submission
+        Magnum::GL::Renderer::finish();
+
+        Clock_t::time_point const end = Clock_t::now();
+
+        frameMs.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+        total += rRenderGl.m_stats;
+    }
+
+    m_ospApp->exit();
+
+    auto const perFrame = [frames] (std::size_t const count) -> float
+    {
+        return float(count) / float(frames);
+    };
+
+    report.frames           = frames;
+    report.avgMs            = std::accumulate(frameMs.begin(), frameMs.end(), 0.0f) / float(frames);
+    report.drawCalls        = perFrame(total.drawCalls);
+    report.instances        = perFrame(total.instances);
+    report.shaderRuns       = perFrame(total.shaderRuns);
+    report.textureRuns      = perFrame(total.textureRuns);
+    report.meshRuns         = perFrame(total.meshRuns);
+
+    std::sort(frameMs.begin(), frameMs.end());
+    report.minMs            = frameMs.front();
+    report.maxMs            = frameMs.back();
+    report.p95Ms            = frameMs[std::min(frames - 1, (frames * 95) / 100)];
+
+    OSP_LOG_INFO("Headless benchmark: {} frames, avg {:.3f} ms, min {:.3f} ms, max {:.3f} ms, p95 {:.3f} ms",
+                 report.frames, report.avgMs, report.minMs, report.maxMs, report.p95Ms);
+    OSP_LOG_INFO("Per frame: {:.1f} draw calls, {:.1f} instances, {:.1f} shader runs, "
+                 "{:.1f} texture runs, {:.1f} mesh runs",
+                 report.drawCalls, report.instances, report.shaderRuns,
+                 report.textureRuns, report.meshRuns);
+
+    return report;
+}
+
+} // namespace testapp
@@ -0,0 +1,117 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "IOspApplication.h"
+
+#include <osp/core/math_types.h>
+
+#include <memory>
+
+namespace osp::draw { struct RenderGL; }
+
+namespace testapp
+{
+
+/**
+ * @brief Frame timings and GL usage measured by HeadlessApplication::run_frames
+ */
+struct HeadlessFrameReport
+{
+    std::size_t frames          {0};
+
+    float       avgMs           {0.0f};
+    float       minMs           {0.0f};
+    float       maxMs           {0.0f};
+    float       p95Ms           {0.0f};
+
+    // Per-frame averages of osp::draw::RenderStatsGL
+    float       drawCalls       {0.0f};
+    float       instances       {0.0f};
+    float       shaderRuns      {0.0f};
+    float       textureRuns     {0.0f};
+    float       meshRuns        {0.0f};
+};
+
+/**
+ * @brief A Magnum application without a window, rendering only to an offscreen framebuffer
+ *
+ * Creates a windowless OpenGL context (EGL, works with software drivers such as llvmpipe), then
+ * drives the same IOspApplication as MagnumApplication for a fixed number of frames. Intended for
+ * automated render benchmarks.
+ *
+ * Only available in builds configured with -DOSP_HEADLESS=ON, see is_supported().
+ */
+class HeadlessApplication
+{
+public:
+
+    struct Arguments
+    {
+        osp::Vector2i   size    {1280, 720};
+    };
+
+    explicit HeadlessApplication(Arguments const& args);
+
+    HeadlessApplication(HeadlessApplication&& move) noexcept;
+    HeadlessApplication& operator=(HeadlessApplication&& move) noexcept;
+
+    ~HeadlessApplication();
+
+    /**
+     * @return true if this build can create headless OpenGL contexts
+     */
+    static bool is_supported() noexcept;
+
+    /**
+     * @return true if the OpenGL context was created successfully
+     */
+    bool has_context() const noexcept;
+
+    void set_osp_app(OspAppPtr_t ospApp)
+    {
+        m_ospApp = std::move(ospApp);
+    }
+
+    /**
+     * @brief Run the IOspApplication for a fixed number of frames, then log and return results
+     *
+     * Each frame waits for the GPU to finish (glFinish) so frame times include GPU work.
+     *
+     * @param frames    [in] Number of frames to draw
+     * @param delta     [in] Fixed time step passed to IOspApplication::draw, in seconds
+     * @param rRenderGl [ref] Renderer to collect RenderStatsGL from
+     */
+    HeadlessFrameReport run_frames(std::size_t frames, float delta, osp::draw::RenderGL& rRenderGl);
+
+private:
+
+    struct Context;
+
+    std::unique_ptr<Context>    m_pContext;
+    OspAppPtr_t                 m_ospApp;
+};
+
+} // namespace testapp
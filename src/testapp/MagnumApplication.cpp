@@ -69,7 +69,7 @@ void MagnumApplication::drawEvent()
 
     if (m_ospApp != nullptr)
     {
-        m_ospApp->draw(*this, m_timeline.previousFrameDuration());
+        m_ospApp->draw(m_timeline.previousFrameDuration());
     }
 
     m_rUserInput.clear_events();
@@ -24,6 +24,7 @@
  */
 #pragma once
 
+#include "IOspApplication.h"
 #include "scenarios.h"
 
 #include <osp/util/UserInputHandler.h>
@@ -38,18 +39,6 @@
 namespace testapp
 {
 
-class MagnumApplication;
-
-class IOspApplication
-{
-public:
-    virtual ~IOspApplication() = default;
-
-    virtual void run(MagnumApplication& rApp) = 0;
-    virtual void draw(MagnumApplication& rApp, float delta) = 0;
-    virtual void exit(MagnumApplication& rApp) = 0;
-};
-
 /**
  * @brief An interactive Magnum application
  *
@@ -59,7 +48,7 @@ class MagnumApplication : public Magnum::Platform::Application
 {
 public:
 
-    using AppPtr_t = std::unique_ptr<IOspApplication>;
+    using AppPtr_t = OspAppPtr_t;
 
     explicit MagnumApplication(
             const Magnum::Platform::Application::Arguments& arguments,
@@ -77,9 +66,9 @@ public:
 
     void exec()
     {
-        m_ospApp->run(*this);
+        m_ospApp->run();
         Magnum::Platform::Application::exec();
-        m_ospApp->exit(*this);
+        m_ospApp->exit();
     }
 
     void exit()
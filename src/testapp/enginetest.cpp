@@ -129,7 +129,7 @@ entt::any setup_scene(osp::Resources& rResources, osp::PkgId const pkg)
 
     // Make a cube
     ActiveEnt const cubeEnt = rScene.m_activeIds.create();
-    DrawEnt const   cubeDraw = rScene.m_scnRdr.m_drawIds.create();
+    DrawEnt const   cubeDraw = SysRender::create_draw_ent(rScene.m_scnRdr);
 
     // Resize some containers to fit all existing entities
     std::size_t const maxEnts = rScene.m_activeIds.vec().capacity();
@@ -254,6 +254,9 @@ void sync_test_scene(
     SysRenderGL::compile_resource_meshes  (rScene.m_drawingRes, *rScene.m_pResources, rRenderGl);
     SysRenderGL::compile_resource_textures(rScene.m_drawingRes, *rScene.m_pResources, rRenderGl);
 
+    // Everything is loaded up front, so don't spread uploads across frames
+    while (SysRenderGL::process_uploads(*rScene.m_pResources, rRenderGl) != 0) { }
+
     // Assign GL meshes to entities with a mesh component
     SysRenderGL::sync_drawent_mesh(
             rScene.m_scnRdr.m_meshDirty.begin(),
@@ -336,10 +339,10 @@ public:
      , m_rRenderGl  {rRenderGl}
     { }
 
-    void run(MagnumApplication& rApp) override
+    void run() override
     { }
 
-    void draw(MagnumApplication& rApp, float delta) override
+    void draw(float delta) override
     {
         update_test_scene(m_rScene, delta);
 
@@ -352,7 +355,7 @@ public:
         render_test_scene(m_rRenderGl, m_rScene, m_renderer);
     }
 
-    void exit(MagnumApplication& rApp) override
+    void exit() override
     {
         osp::draw::SysRenderGL::clear_resource_owners(m_rRenderGl, *m_rScene.m_pResources);
         m_rRenderGl = {}; // clear all GPU resources
@@ -364,7 +367,7 @@ public:
     RenderGL            &m_rRenderGl;
 };
 
-MagnumApplication::AppPtr_t generate_osp_magnum_app(EngineTestScene& rScene, MagnumApplication &rApp, RenderGL& rRenderGl, UserInputHandler& rUserInput)
+OspAppPtr_t generate_osp_magnum_app(EngineTestScene& rScene, RenderGL& rRenderGl, UserInputHandler& rUserInput)
 {
     using namespace osp::active;
     using namespace osp::draw;
@@ -387,10 +390,8 @@ MagnumApplication::AppPtr_t generate_osp_magnum_app(EngineTestScene& rScene, Mag
 
     // Set all drawing stuff dirty then sync with renderer.
     // This allows clean re-openning of the scene
-    for (std::size_t const drawEntInt : rScene.m_scnRdr.m_drawIds.bitview().zeros())
+    for (DrawEnt const drawEnt : rScene.m_scnRdr.m_drawPacked.ents)
     {
-        auto const drawEnt = DrawEnt(drawEntInt);
-
         // Set all meshs dirty
         if (rScene.m_scnRdr.m_mesh[drawEnt] != lgrn::id_null<MeshId>())
         {
@@ -46,7 +46,7 @@ entt::any setup_scene(osp::Resources& rResources, osp::PkgId pkg);
 /**
  * @brief Generate IOspApplication for MagnumApplication
  */
-MagnumApplication::AppPtr_t generate_osp_magnum_app(EngineTestScene& rScene, MagnumApplication& rApp, osp::draw::RenderGL& rRenderGl, osp::input::UserInputHandler& rUserInput);
+OspAppPtr_t generate_osp_magnum_app(EngineTestScene& rScene, osp::draw::RenderGL& rRenderGl, osp::input::UserInputHandler& rUserInput);
 
 
 } // namespace testapp::enginetest
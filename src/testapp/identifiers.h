@@ -229,6 +229,7 @@ struct PlParts
 
     PipelineDef<EStgCont> weldIds           {"weldIds           - ACtxParts::weldIds"};
     PipelineDef<EStgIntr> weldDirty         {"weldDirty         - ACtxParts::weldDirty"};
+    PipelineDef<EStgIntr> weldSplit         {"weldSplit         - ACtxParts::weldSplitRequest"};
 
     PipelineDef<EStgCont> machIds           {"machIds           - ACtxParts::machines.ids"};
     PipelineDef<EStgCont> nodeIds           {"nodeIds           - ACtxParts::nodePerType[*].nodeIds"};
@@ -277,15 +278,26 @@ struct PlVehicleSpawnVB
 
 
 
-#define TESTAPP_DATA_SIGNALS_FLOAT 2, \
-    idSigValFloat,      idSigUpdFloat
-struct PlSignalsFloat
+#define TESTAPP_DATA_VEHICLE_BUILD 1, \
+    idVehicleBuild
+
+
+
+#define TESTAPP_DATA_SIGNALS 5, \
+    idSigVal,           idSigUpd,           idSigGraph,         idSigMachFuncs,     idSigUpdConc
+template <typename VALUE_T>
+struct PlSignals
 {
-    PipelineDef<EStgCont> sigFloatValues    {"sigFloatValues    -"};
-    PipelineDef<EStgCont> sigFloatUpdExtIn  {"sigFloatUpdExtIn  -"};
-    PipelineDef<EStgCont> sigFloatUpdLoop   {"sigFloatUpdLoop   -"};
+    PipelineDef<EStgCont> sigValues         {"sigValues         - SignalValues_t<VALUE_T>"};
+    PipelineDef<EStgCont> sigUpdExtIn       {"sigUpdExtIn       - UpdateNodes<VALUE_T> from outside the link loop"};
+    PipelineDef<EStgCont> sigUpdLoop        {"sigUpdLoop        - UpdateNodes<VALUE_T> from within the link loop"};
 };
 
+// Same as TESTAPP_DATA_SIGNALS, for sessions made by setup_signals<float>
+#define TESTAPP_DATA_SIGNALS_FLOAT 5, \
+    idSigValFloat,      idSigUpdFloat,      idSigGraphFloat,    idSigMachFuncs,     idSigUpdConcFloat
+using PlSignalsFloat = PlSignals<float>;
+
 
 
 #define TESTAPP_DATA_NEWTON 1, \
@@ -366,6 +378,7 @@ struct PlSceneRenderer
     PipelineDef<EStgIntr> materialDirty     {"materialDirty"};
 
     PipelineDef<EStgIntr> drawTransforms    {"drawTransforms"};
+    PipelineDef<EStgCont> drawTfObservers   {"drawTfObservers   - ActiveEnts registered with DrawTfObservers"};
 
     PipelineDef<EStgCont> group             {"group"};
     PipelineDef<EStgCont> groupEnts         {"groupEnts"};
@@ -394,13 +407,17 @@ struct PlMagnum
 
 
 
-#define TESTAPP_DATA_MAGNUM_SCENE 3, \
-    idScnRenderGl, idGroupFwd, idCamera
+#define TESTAPP_DATA_MAGNUM_SCENE 5, \
+    idScnRenderGl, idGroupFwd, idCamera, idCulling, idDrawCmds
 struct PlMagnumScene
 {
     PipelineDef<EStgFBO>  fbo               {"fboRender"};
 
     PipelineDef<EStgCont> camera            {"camera"};
+    PipelineDef<EStgCont> culling           {"culling           - DrawEnts visible in camera frustum"};
+    PipelineDef<EStgCont> meshLod           {"meshLod           - DrawEnt GL meshes switched to selected level of detail"};
+    PipelineDef<EStgCont> drawCommands      {"drawCommands      - API-agnostic draw commands for visible DrawEnts"};
+    PipelineDef<EStgCont> frameUniforms     {"frameUniforms     - Per-frame shader uniform buffers"};
 
 };
 
@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 
+#include "HeadlessApplication.h"
 #include "MagnumApplication.h"
 #include "testapp.h"
 #include "scenarios.h"
@@ -33,8 +34,10 @@
 #include <osp/core/Resources.h>
 #include <osp/core/string_concat.h>
 #include <osp/drawing/own_restypes.h>
+#include <osp/drawing_gl/rendergl.h>
 #include <osp/tasks/top_execute.h>
 #include <osp/util/logging.h>
+#include <osp/vehicles/gltf_cache.h>
 #include <osp/vehicles/ImporterData.h>
 #include <osp/vehicles/load_tinygltf.h>
 
@@ -55,10 +58,13 @@
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
@@ -81,6 +87,16 @@ void cli_loop(int argc, char** argv);
  */
 void start_magnum_async(int argc, char** argv);
 
+/**
+ * @brief Render the loaded scene without a window for a fixed number of frames, then close
+ *
+ * Runs on the calling thread. Frame times, draw calls, and state changes are logged, see
+ * HeadlessApplication::run_frames
+ *
+ * @return Exit code for main
+ */
+int run_headless(std::size_t frames);
+
 /**
  * @brief As the name implies
  *
@@ -91,6 +107,14 @@ void start_magnum_async(int argc, char** argv);
  */
 void load_a_bunch_of_stuff();
 
+/**
+ * @brief Directory to keep cooked glTF cache files in, outside of the source tree
+ *
+ * $XDG_CACHE_HOME/osp-magnum or ~/.cache/osp-magnum, or %LOCALAPPDATA%/osp-magnum on Windows.
+ * Falls back to OSPData/cooked (ignored by git) if none of these are set.
+ */
+std::string cooked_cache_dir();
+
 // called only from commands to display information
 void print_help();
 void print_resources();
@@ -115,6 +139,8 @@ int main(int argc, char** argv)
         .addOption("config")                .setHelp("config",      "path to configuration file to use")
         .addBooleanOption("norepl")         .setHelp("norepl",      "don't enter read, evaluate, print, loop.")
         .addBooleanOption("log-exec")       .setHelp("log-exec",    "Log Task/Pipeline Execution (Extremely chatty!)")
+        .addBooleanOption("headless")       .setHelp("headless",    "render --scene offscreen without a window, log frame times, then exit")
+        .addOption("frames", "600")         .setHelp("frames",      "number of frames to render with --headless")
         // TODO .addBooleanOption('v', "verbose")   .setHelp("verbose",     "log verbosely")
         .setGlobalHelp("Helptext goes here.")
         .parse(argc, argv);
@@ -151,8 +177,22 @@ int main(int argc, char** argv)
 
         g_testApp.m_rendererSetup = it->second.m_setup(g_testApp);
 
+        if (args.isSet("headless"))
+        {
+            int const status = run_headless(args.value<std::size_t>("frames"));
+            g_testApp.clear_resource_owners();
+            spdlog::shutdown();
+            return status;
+        }
+
         start_magnum_async(argc, argv);
     }
+    else if (args.isSet("headless"))
+    {
+        OSP_LOG_ERROR("--headless requires a --scene");
+        g_testApp.clear_resource_owners();
+        return 1;
+    }
 
     if( ! args.isSet("norepl"))
     {
@@ -302,6 +342,48 @@ void start_magnum_async(int argc, char** argv)
     g_magnumThread.swap(t);
 }
 
+int run_headless(std::size_t const frames)
+{
+    // Create the OpenGL context first, there's nothing to clean up if this fails
+    HeadlessApplication app{HeadlessApplication::Arguments{}};
+    if ( ! app.has_context() )
+    {
+        return 1;
+    }
+
+    osp::TopTaskBuilder builder{g_testApp.m_tasks, g_testApp.m_renderer.m_edges, g_testApp.m_taskData};
+
+    g_testApp.m_windowApp   = scenes::setup_window_app      (builder, g_testApp.m_topData, g_testApp.m_application);
+    g_testApp.m_magnum      = scenes::setup_magnum_headless (builder, g_testApp.m_topData, g_testApp.m_application, g_testApp.m_windowApp, std::move(app));
+
+    OSP_DECLARE_GET_DATA_IDS(g_testApp.m_magnum, TESTAPP_DATA_MAGNUM); // declares idActiveApp
+    auto &rActiveApp = osp::top_get<HeadlessApplication>(g_testApp.m_topData, idActiveApp);
+    auto &rRenderGl  = osp::top_get<osp::draw::RenderGL>(g_testApp.m_topData, idRenderGl);
+
+    g_testApp.m_rendererSetup(g_testApp);
+
+    g_testApp.m_graph = osp::make_exec_graph(g_testApp.m_tasks, {&g_testApp.m_renderer.m_edges, &g_testApp.m_scene.m_edges});
+    g_executor.load(g_testApp);
+
+    // Fixed 60fps time step, same as MagnumApplication
+    rActiveApp.run_frames(frames, 1.0f / 60.0f, rRenderGl);
+
+    rActiveApp.set_osp_app({});
+
+    // Same clean up as start_magnum_async
+    g_testApp.m_pExecutor->run(g_testApp, g_testApp.m_windowApp.m_cleanup);
+    g_testApp.close_sessions(g_testApp.m_renderer.m_sessions);
+    g_testApp.m_renderer.m_sessions.clear();
+    g_testApp.m_renderer.m_edges.m_syncWith.clear();
+
+    g_testApp.close_session(g_testApp.m_magnum);
+    g_testApp.close_session(g_testApp.m_windowApp);
+
+    OSP_LOG_INFO("Closed headless application");
+
+    return 0;
+}
+
 void load_a_bunch_of_stuff()
 {
     using namespace osp::restypes;
@@ -346,6 +428,7 @@ void load_a_bunch_of_stuff()
     rResources.data_register<Trade::TextureData>(gc_texture);
     rResources.data_register<osp::TextureImgSource>(gc_texture);
     rResources.data_register<Trade::MeshData>(gc_mesh);
+    rResources.data_register<osp::MeshLodChain>(gc_mesh);
     rResources.data_register<osp::ImporterData>(gc_importer);
     rResources.data_register<osp::Prefabs>(gc_importer);
     osp::register_tinygltf_resources(rResources);
@@ -365,14 +448,29 @@ void load_a_bunch_of_stuff()
         //"ph_rcs_plume.sturdy.gltf"
     };
 
-    // TODO: Make new gltf loader. This will read gltf files and dump meshes,
-    //       images, textures, and other relevant data into osp::Resources
+    std::vector<std::string> filepaths;
+    filepaths.reserve(meshes.size());
     for (auto const& meshName : meshes)
     {
-        osp::ResId res = osp::load_tinygltf_file(osp::string_concat(datapath, meshName), rResources, g_testApp.m_defaultPkg);
-        osp::assigns_prefabs_tinygltf(rResources, res);
+        filepaths.push_back(osp::string_concat(datapath, meshName));
     }
 
+    // Files with an up to date cache in cooked_cache_dir() are loaded from it. The rest are decoded
+    // in parallel, then added to rResources here one by one and cached for next time.
+    // No more threads than files. hardware_concurrency() may return 0 if unknown
+    unsigned int const threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u),
+                                              unsigned(filepaths.size()));
+
+    auto const log_progress = [] (osp::GltfLoadProgress const& progress, void* /* pUserData */)
+    {
+        OSP_LOG_INFO("Loaded {}/{}: {}", progress.loaded, progress.total, progress.filepath);
+    };
+
+    std::string const cacheDir = cooked_cache_dir();
+    OSP_LOG_INFO("Cooked glTF cache: {}", cacheDir);
+
+    osp::load_tinygltf_files_cached(filepaths, cacheDir, rResources, g_testApp.m_defaultPkg, threadCount, log_progress);
+
     // Add a default primitives
     auto const add_mesh_quick = [&rResources = rResources] (std::string_view const name, Trade::MeshData&& data)
     {
@@ -393,6 +491,33 @@ void load_a_bunch_of_stuff()
     OSP_LOG_INFO("Resource loading complete");
 }
 
+std::string cooked_cache_dir()
+{
+    auto const env = [] (char const* name) -> std::string_view
+    {
+        char const* value = std::getenv(name);
+        return (value != nullptr) ? value : "";
+    };
+
+#ifdef _WIN32
+    if (std::string_view const localAppData = env("LOCALAPPDATA"); ! localAppData.empty())
+    {
+        return osp::string_concat(localAppData, "/osp-magnum/cooked");
+    }
+#else
+    if (std::string_view const xdgCache = env("XDG_CACHE_HOME"); ! xdgCache.empty())
+    {
+        return osp::string_concat(xdgCache, "/osp-magnum/cooked");
+    }
+    if (std::string_view const home = env("HOME"); ! home.empty())
+    {
+        return osp::string_concat(home, "/.cache/osp-magnum/cooked");
+    }
+#endif
+
+    return "OSPData/cooked";
+}
+
 //-----------------------------------------------------------------------------
 
 void print_help()
@@ -38,8 +38,10 @@
 #include "sessions/vehicles_machines.h"
 #include "sessions/vehicles_prebuilt.h"
 
+#include "HeadlessApplication.h"
 #include "MagnumApplication.h"
 
+#include <adera/activescene/VehicleBuildService.h>
 #include <adera/activescene/vehicles_vb_fn.h>
 
 #include <osp/activescene/basic.h>
@@ -60,6 +62,12 @@ namespace testapp
 
 static void setup_magnum_draw(TestApp& rTestApp, Session const& scene, Session const& sceneRenderer, Session const& magnumScene);
 
+/**
+ * @brief Set the IOspApplication of idActiveApp, which is either a MagnumApplication or a
+ *        HeadlessApplication
+ */
+static void set_active_osp_app(TestApp& rTestApp, OspAppPtr_t ospApp);
+
 // MaterialIds hints which shaders should be used to draw a DrawEnt
 // DrawEnts can be assigned to multiple materials
 static constexpr auto   sc_matVisualizer    = draw::MaterialId(0);
@@ -113,12 +121,11 @@ static ScenarioMap_t make_scenarios()
 
             OSP_DECLARE_GET_DATA_IDS(rTestApp.m_magnum,     TESTAPP_DATA_MAGNUM);
             OSP_DECLARE_GET_DATA_IDS(rTestApp.m_windowApp,  TESTAPP_DATA_WINDOW_APP);
-            auto &rActiveApp    = top_get< MagnumApplication >      (rTestApp.m_topData, idActiveApp);
             auto &rRenderGl     = top_get< draw::RenderGL >         (rTestApp.m_topData, idRenderGl);
             auto &rUserInput    = top_get< input::UserInputHandler >(rTestApp.m_topData, idUserInput);
 
             // This creates the renderer actually updates and draws the scene.
-            rActiveApp.set_osp_app(enginetest::generate_osp_magnum_app(rScene, rActiveApp, rRenderGl, rUserInput));
+            set_active_osp_app(rTestApp, enginetest::generate_osp_magnum_app(rScene, rRenderGl, rUserInput));
         };
 
         return setup_renderer;
@@ -198,7 +205,7 @@ static ScenarioMap_t make_scenarios()
         #define SCENE_SESSIONS      scene, commonScene, physics, physShapes, droppers, bounds, newton, nwtGravSet, nwtGrav, physShapesNwt, \
                                     prefabs, parts, vehicleSpawn, signalsFloat, \
                                     vehicleSpawnVB, vehicleSpawnRgd, vehicleSpawnNwt, \
-                                    testVehicles, machRocket, machRcsDriver, nwtRocketSet, rocketsNwt
+                                    testVehicles, vehicleBuild, machRocket, machRcsDriver, nwtRocketSet, rocketsNwt
         #define RENDERER_SESSIONS   sceneRenderer, magnumScene, cameraCtrl, shVisual, shFlat, shPhong, camThrow, shapeDraw, cursor, \
                                     prefabDraw, vehicleDraw, vehicleCtrl, cameraVehicle, thrustIndicator
 
@@ -210,7 +217,7 @@ static ScenarioMap_t make_scenarios()
 
         TopTaskBuilder builder{rTestApp.m_tasks, rTestApp.m_scene.m_edges, rTestApp.m_taskData};
 
-        auto & [SCENE_SESSIONS] = resize_then_unpack<22>(rTestApp.m_scene.m_sessions);
+        auto & [SCENE_SESSIONS] = resize_then_unpack<23>(rTestApp.m_scene.m_sessions);
 
         scene           = setup_scene               (builder, rTopData, application);
         commonScene     = setup_common_scene        (builder, rTopData, scene, application, defaultPkg);
@@ -221,10 +228,11 @@ static ScenarioMap_t make_scenarios()
 
         prefabs         = setup_prefabs             (builder, rTopData, application, scene, commonScene, physics);
         parts           = setup_parts               (builder, rTopData, application, scene);
-        signalsFloat    = setup_signals_float       (builder, rTopData, scene, parts);
         vehicleSpawn    = setup_vehicle_spawn       (builder, rTopData, scene);
-        vehicleSpawnVB  = setup_vehicle_spawn_vb    (builder, rTopData, application, scene, commonScene, prefabs, parts, vehicleSpawn, signalsFloat);
+        vehicleSpawnVB  = setup_vehicle_spawn_vb    (builder, rTopData, application, scene, commonScene, prefabs, parts, vehicleSpawn);
+        signalsFloat    = setup_signals<float>      (builder, rTopData, scene, parts, vehicleSpawn, vehicleSpawnVB);
         testVehicles    = setup_prebuilt_vehicles   (builder, rTopData, application, scene);
+        vehicleBuild    = setup_vehicle_build       (builder, rTopData, application, scene, vehicleSpawn, vehicleSpawnVB);
 
         machRocket      = setup_mach_rocket         (builder, rTopData, scene, parts, signalsFloat);
         machRcsDriver   = setup_mach_rcsdriver      (builder, rTopData, scene, parts, signalsFloat);
@@ -237,23 +245,33 @@ static ScenarioMap_t make_scenarios()
         nwtRocketSet    = setup_newton_factors      (builder, rTopData);
         rocketsNwt      = setup_rocket_thrust_newton(builder, rTopData, scene, commonScene, physics, prefabs, parts, signalsFloat, newton, nwtRocketSet);
 
-        OSP_DECLARE_GET_DATA_IDS(vehicleSpawn,   TESTAPP_DATA_VEHICLE_SPAWN);
-        OSP_DECLARE_GET_DATA_IDS(vehicleSpawnVB, TESTAPP_DATA_VEHICLE_SPAWN_VB);
-        OSP_DECLARE_GET_DATA_IDS(testVehicles,   TESTAPP_DATA_TEST_VEHICLES);
+        OSP_DECLARE_GET_DATA_IDS(vehicleBuild,   TESTAPP_DATA_VEHICLE_BUILD);
 
-        auto &rVehicleSpawn     = top_get<ACtxVehicleSpawn>     (rTopData, idVehicleSpawn);
-        auto &rVehicleSpawnVB   = top_get<ACtxVehicleSpawnVB>   (rTopData, idVehicleSpawnVB);
-        auto &rPrebuiltVehicles = top_get<PrebuiltVehicles>     (rTopData, idPrebuiltVehicles);
+        auto &rVehicleBuild     = top_get<ACtxVehicleBuild>     (rTopData, idVehicleBuild);
 
-        for (int i = 0; i < 10; ++i)
+        // Built on VehicleBuildService workers, spawned once they're done
+        constexpr int sc_buildCount = 10;
+        for (int i = 0; i < sc_buildCount; ++i)
         {
-            rVehicleSpawn.spawnRequest.push_back(
+            bool const queued = rVehicleBuild.pService->submit(
             {
-               .position = {float(i - 2) * 8.0f, 30.0f, 10.0f},
-               .velocity = {0.0, 0.0f, 50.0f * float(i)},
-               .rotation = {}
+                .func = [] (VehicleBuilder& rBuilder, entt::any const&)
+                {
+                    build_simple_command_service_module(rBuilder);
+                },
+                .spawn =
+                {
+                   .position = {float(i - 2) * 8.0f, 30.0f, 10.0f},
+                   .velocity = {0.0, 0.0f, 50.0f * float(i)},
+                   .rotation = {}
+                }
             });
-            rVehicleSpawnVB.dataVB.push_back(rPrebuiltVehicles[gc_pbvSimpleCommandServiceModule].get());
+
+            if ( ! queued )
+            {
+                OSP_LOG_WARN("VehicleBuildService queues are full, {} vehicles not built", sc_buildCount - i);
+                break;
+            }
         }
 
         add_floor(rTopData, physShapes, sc_matVisualizer, defaultPkg, 4);
@@ -268,7 +286,7 @@ static ScenarioMap_t make_scenarios()
 
             TopTaskBuilder builder{rTestApp.m_tasks, rTestApp.m_renderer.m_edges, rTestApp.m_taskData};
 
-            auto & [SCENE_SESSIONS] = unpack<22>(rTestApp.m_scene.m_sessions);
+            auto & [SCENE_SESSIONS] = unpack<23>(rTestApp.m_scene.m_sessions);
             auto & [RENDERER_SESSIONS] = resize_then_unpack<14>(rTestApp.m_renderer.m_sessions);
 
             sceneRenderer   = setup_scene_renderer      (builder, rTopData, application, windowApp, commonScene);
@@ -283,7 +301,7 @@ static ScenarioMap_t make_scenarios()
             shapeDraw       = setup_phys_shapes_draw    (builder, rTopData, windowApp, sceneRenderer, commonScene, physics, physShapes);
             cursor          = setup_cursor              (builder, rTopData, application, sceneRenderer, cameraCtrl, commonScene, sc_matFlat, rTestApp.m_defaultPkg);
             prefabDraw      = setup_prefab_draw         (builder, rTopData, application, windowApp, sceneRenderer, commonScene, prefabs, sc_matPhong);
-            vehicleDraw     = setup_vehicle_spawn_draw  (builder, rTopData, sceneRenderer, vehicleSpawn);
+            vehicleDraw     = setup_vehicle_spawn_draw  (builder, rTopData, sceneRenderer, commonScene, parts, vehicleSpawn);
             vehicleCtrl     = setup_vehicle_control     (builder, rTopData, windowApp, scene, parts, signalsFloat);
             cameraVehicle   = setup_camera_vehicle      (builder, rTopData, windowApp, scene, sceneRenderer, commonScene, physics, parts, cameraCtrl, vehicleCtrl);
             thrustIndicator = setup_thrust_indicators   (builder, rTopData, application, windowApp, commonScene, parts, signalsFloat, sceneRenderer, defaultPkg, sc_matFlat);
@@ -405,7 +423,7 @@ public:
      , m_signals        { signals }
     { }
 
-    void run(MagnumApplication& rApp) override
+    void run() override
     {
         // Start the main loop
 
@@ -426,7 +444,7 @@ public:
         m_rTestApp.m_pExecutor->wait(m_rTestApp);
     }
 
-    void draw(MagnumApplication& rApp, float delta) override
+    void draw(float delta) override
     {
         // Magnum Application's main loop calls this
 
@@ -442,7 +460,7 @@ public:
         m_rTestApp.m_pExecutor->wait(m_rTestApp);
     }
 
-    void exit(MagnumApplication& rApp) override
+    void exit() override
     {
         m_rMainLoopCtrl = MainLoopControl{
             .doUpdate = false,
@@ -489,7 +507,6 @@ void setup_magnum_draw(TestApp& rTestApp, Session const& scene, Session const& s
     OSP_DECLARE_GET_DATA_IDS(magnumScene,               TESTAPP_DATA_MAGNUM_SCENE);
 
     auto &rMainLoopCtrl = top_get<MainLoopControl>  (rTestApp.m_topData, idMainLoopCtrl);
-    auto &rActiveApp    = top_get<MagnumApplication>(rTestApp.m_topData, idActiveApp);
     auto &rCamera       = top_get<draw::Camera>     (rTestApp.m_topData, idCamera);
 
     rCamera.set_aspect_ratio(Vector2{Magnum::GL::defaultFramebuffer.viewport().size()});
@@ -504,7 +521,23 @@ void setup_magnum_draw(TestApp& rTestApp, Session const& scene, Session const& s
         .sceneRender  = sceneRenderer          .get_pipelines<PlSceneRenderer>() .render,
     };
 
-    rActiveApp.set_osp_app( std::make_unique<CommonMagnumApp>(rTestApp, rMainLoopCtrl, signals) );
+    set_active_osp_app(rTestApp, std::make_unique<CommonMagnumApp>(rTestApp, rMainLoopCtrl, signals));
+}
+
+void set_active_osp_app(TestApp& rTestApp, OspAppPtr_t ospApp)
+{
+    OSP_DECLARE_GET_DATA_IDS(rTestApp.m_magnum, TESTAPP_DATA_MAGNUM);
+
+    entt::any &rActiveApp = rTestApp.m_topData[idActiveApp];
+
+    if (auto *pHeadless = entt::any_cast<HeadlessApplication>(&rActiveApp))
+    {
+        pHeadless->set_osp_app(std::move(ospApp));
+    }
+    else
+    {
+        entt::any_cast<MagnumApplication&>(rActiveApp).set_osp_app(std::move(ospApp));
+    }
 }
 
 } // namespace testapp
@@ -116,6 +116,18 @@ Session setup_common_scene(
         return rActiveEntDel.empty() ? TaskAction::Cancel : TaskActions{};
     });
 
+    rBuilder.task()
+        .name       ("Release ActiveEnt IDs deleted last frame")
+        .run_on     ({tgScn.update(Run)})
+        .sync_with  ({tgCS.activeEnt(Prev)})
+        .push_to    (out.m_tasks)
+        .args       ({      idBasic })
+        .func([] (ACtxBasic& rBasic) noexcept
+    {
+        // IDs removed last frame are no longer in use by anything, and are safe to reuse now
+        SysActiveEnt::release_pending(rBasic);
+    });
+
     rBuilder.task()
         .name       ("Delete ActiveEnt IDs")
         .run_on     ({tgCS.activeEntDelete(EStgIntr::UseOrRun)})
@@ -126,10 +138,7 @@ Session setup_common_scene(
     {
         for (ActiveEnt const ent : rActiveEntDel)
         {
-            if (rBasic.m_activeIds.exists(ent))
-            {
-                rBasic.m_activeIds.remove(ent);
-            }
+            SysActiveEnt::remove(rBasic, ent);
         }
     });
 
@@ -274,6 +283,7 @@ Session setup_scene_renderer(
     rBuilder.pipeline(tgScnRdr.entTextureDirty) .parent(tgWin.sync);
     rBuilder.pipeline(tgScnRdr.entMeshDirty)    .parent(tgWin.sync);
     rBuilder.pipeline(tgScnRdr.drawTransforms)  .parent(tgScnRdr.render);
+    rBuilder.pipeline(tgScnRdr.drawTfObservers) .parent(tgWin.sync);
     rBuilder.pipeline(tgScnRdr.material)        .parent(tgWin.sync);
     rBuilder.pipeline(tgScnRdr.materialDirty)   .parent(tgWin.sync);
     rBuilder.pipeline(tgScnRdr.group)           .parent(tgWin.sync);
@@ -347,7 +357,7 @@ Session setup_scene_renderer(
     rBuilder.task()
         .name       ("Calculate draw transforms")
         .run_on     ({tgScnRdr.render(Run)})
-        .sync_with  ({tgCS.hierarchy(Ready), tgCS.transform(Ready), tgCS.activeEnt(Ready), tgScnRdr.drawTransforms(Modify_), tgScnRdr.drawEnt(Ready), tgScnRdr.drawEntResized(Done), tgCS.activeEntResized(Done)})
+        .sync_with  ({tgCS.hierarchy(Ready), tgCS.transform(Ready), tgCS.activeEnt(Ready), tgScnRdr.drawTransforms(Modify_), tgScnRdr.drawEnt(Ready), tgScnRdr.drawEntResized(Done), tgCS.activeEntResized(Done), tgScnRdr.drawTfObservers(Ready)})
         .push_to    (out.m_tasks)
         .args       ({            idBasic,                   idDrawing,                 idScnRender,                 idDrawTfObservers })
         .func([] (ACtxBasic const& rBasic, ACtxDrawing const& rDrawing, ACtxSceneRender& rScnRender, DrawTfObservers &rDrawTfObservers) noexcept
@@ -363,29 +373,26 @@ Session setup_scene_renderer(
                 },
                 rootChildren.begin(),
                 rootChildren.end(),
-                [&rDrawTfObservers, &rScnRender] (Matrix4 const& transform, active::ActiveEnt ent, int depth)
+                [&rDrawTfObservers] (Matrix4 const& transform, active::ActiveEnt ent, int depth)
         {
-            auto const enableInt  = std::array{rScnRender.drawTfObserverEnable[ent]};
-            auto const enableBits = lgrn::bit_view(enableInt);
-
-            for (std::size_t idx : enableBits.ones())
-            {
-                DrawTfObservers::Observer const &rObserver = rDrawTfObservers.observers[idx];
-                rObserver.func(rScnRender, transform, ent, depth, rObserver.data);
-            }
+            SysRender::gather_draw_tf(rDrawTfObservers, transform, ent);
         });
+
+        SysRender::dispatch_draw_tf(rDrawTfObservers, rScnRender);
     });
 
     rBuilder.task()
         .name       ("Delete DrawEntity of deleted ActiveEnts")
         .run_on     ({tgCS.activeEntDelete(UseOrRun)})
-        .sync_with  ({tgScnRdr.drawEntDelete(Modify_)})
+        .sync_with  ({tgScnRdr.drawEntDelete(Modify_), tgScnRdr.drawTfObservers(Delete)})
         .push_to    (out.m_tasks)
-        .args       ({            idScnRender,                      idActiveEntDel,              idDrawEntDel })
-        .func([] (ACtxSceneRender& rScnRender, ActiveEntVec_t const& rActiveEntDel, DrawEntVec_t& rDrawEntDel) noexcept
+        .args       ({            idScnRender,                      idActiveEntDel,              idDrawEntDel,                 idDrawTfObservers })
+        .func([] (ACtxSceneRender& rScnRender, ActiveEntVec_t const& rActiveEntDel, DrawEntVec_t& rDrawEntDel, DrawTfObservers& rDrawTfObservers) noexcept
     {
         for (ActiveEnt const ent : rActiveEntDel)
         {
+            SysRender::unobserve_draw_tf(rDrawTfObservers, ent);
+
             if (rScnRender.m_activeToDraw.size() < std::size_t(ent))
             {
                 continue;
@@ -409,6 +416,18 @@ Session setup_scene_renderer(
         SysRender::update_delete_drawing(rScnRender, rDrawing, rDrawEntDel.cbegin(), rDrawEntDel.cend());
     });
 
+    rBuilder.task()
+        .name       ("Release DrawEntity IDs deleted last frame")
+        .run_on     ({tgWin.sync(Run)})
+        .sync_with  ({tgScnRdr.drawEnt(Prev)})
+        .push_to    (out.m_tasks)
+        .args       ({            idScnRender })
+        .func([] (ACtxSceneRender& rScnRender) noexcept
+    {
+        // IDs removed last frame are no longer in use by anything, and are safe to reuse now
+        SysRender::release_pending_draw_ents(rScnRender);
+    });
+
     rBuilder.task()
         .name       ("Delete DrawEntity IDs")
         .run_on     ({tgScnRdr.drawEntDelete(UseOrRun)})
@@ -419,10 +438,7 @@ Session setup_scene_renderer(
     {
         for (DrawEnt const drawEnt : rDrawEntDel)
         {
-            if (rScnRender.m_drawIds.exists(drawEnt))
-            {
-                rScnRender.m_drawIds.remove(drawEnt);
-            }
+            SysRender::remove_draw_ent(rScnRender, drawEnt);
         }
     });
 
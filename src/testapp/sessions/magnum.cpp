@@ -25,6 +25,7 @@
 #include "magnum.h"
 #include "common.h"
 
+#include "../HeadlessApplication.h"
 #include "../MagnumApplication.h"
 
 #include <Magnum/GL/DefaultFramebuffer.h>
@@ -35,6 +36,8 @@
 #include <adera/drawing_gl/phong_shader.h>
 #include <adera/drawing_gl/visualizer_shader.h>
 #include <osp/activescene/basic_fn.h>
+#include <osp/drawing/culling_fn.h>
+#include <osp/drawing/draw_commands_fn.h>
 #include <osp/drawing/drawing.h>
 #include <osp/drawing_gl/rendergl.h>
 #include <osp/universe/coordinates.h>
@@ -60,13 +63,28 @@ using Magnum::GL::Mesh;
 namespace testapp::scenes
 {
 
+/**
+ * @brief Number of lists draw commands are split into, each recorded by a separate task
+ */
+constexpr std::size_t gc_drawCommandLists = 4;
 
-Session setup_magnum(
+
+/**
+ * @brief Shared part of setup_magnum and setup_magnum_headless
+ *
+ * @param emplace_app   [in] Called with idActiveApp to create the application, which must start
+ *                      an OpenGL context
+ * @param displayFbo    [in] Display the offscreen framebuffer to the default framebuffer each
+ *                      frame, see RenderGL::m_displayFbo
+ */
+template <typename EMPLACE_APP_T>
+static Session setup_magnum_common(
         TopTaskBuilder&                 rBuilder,
         ArrayView<entt::any> const      topData,
         Session const&                  application,
         Session const&                  windowApp,
-        MagnumApplication::Arguments    args)
+        bool const                      displayFbo,
+        EMPLACE_APP_T&&                 emplace_app)
 {
     OSP_DECLARE_GET_DATA_IDS(application, TESTAPP_DATA_APPLICATION);
     OSP_DECLARE_GET_DATA_IDS(windowApp,   TESTAPP_DATA_WINDOW_APP);
@@ -84,11 +102,23 @@ Session setup_magnum(
     rBuilder.pipeline(tgMgn.entMeshGL)      .parent(tgWin.sync);
     rBuilder.pipeline(tgMgn.entTextureGL)   .parent(tgWin.sync);
 
-    // Order-dependent; MagnumApplication construction starts OpenGL context, needed by RenderGL
-    /* unused */      top_emplace<MagnumApplication>(topData, idActiveApp, args, rUserInput);
+    // Order-dependent; application construction starts OpenGL context, needed by RenderGL
+    emplace_app(idActiveApp, rUserInput);
     auto &rRenderGl = top_emplace<RenderGL>         (topData, idRenderGl);
 
     SysRenderGL::setup_context(rRenderGl);
+    rRenderGl.m_displayFbo = displayFbo;
+
+    rBuilder.task()
+        .name       ("Upload queued meshes and textures to GL within per-frame budget")
+        .run_on     ({tgWin.sync(Run)})
+        .sync_with  ({tgMgn.meshGL(Modify), tgMgn.textureGL(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({      idResources,          idRenderGl})
+        .func([] (Resources& rResources, RenderGL& rRenderGl) noexcept
+    {
+        SysRenderGL::process_uploads(rResources, rRenderGl);
+    });
 
     rBuilder.task()
         .name       ("Clean up Magnum renderer")
@@ -102,10 +132,82 @@ Session setup_magnum(
     });
 
     return out;
+} // setup_magnum_common
+
+Session setup_magnum(
+        TopTaskBuilder&                 rBuilder,
+        ArrayView<entt::any> const      topData,
+        Session const&                  application,
+        Session const&                  windowApp,
+        MagnumApplication::Arguments    args)
+{
+    return setup_magnum_common(rBuilder, topData, application, windowApp, true,
+                               [topData, &args] (TopDataId const idActiveApp, UserInputHandler& rUserInput)
+    {
+        top_emplace<MagnumApplication>(topData, idActiveApp, args, rUserInput);
+    });
 } // setup_magnum
 
+Session setup_magnum_headless(
+        TopTaskBuilder&                 rBuilder,
+        ArrayView<entt::any> const      topData,
+        Session const&                  application,
+        Session const&                  windowApp,
+        HeadlessApplication&&           rrApp)
+{
+    // No window to display to, skip the final blit to the default framebuffer
+    return setup_magnum_common(rBuilder, topData, application, windowApp, false,
+                               [topData, &rrApp] (TopDataId const idActiveApp, UserInputHandler& rUserInput)
+    {
+        top_emplace<HeadlessApplication>(topData, idActiveApp, std::move(rrApp));
+    });
+} // setup_magnum_headless
+
+
 
 
+template <std::size_t LIST_I>
+static void add_task_record_draw_commands(
+        TopTaskBuilder&             rBuilder,
+        Session&                    rOut,
+        PlSceneRenderer const&      tgScnRdr,
+        PlMagnumScene const&        tgMgnScn,
+        TopDataId const             idScnRender,
+        TopDataId const             idCulling,
+        TopDataId const             idCamera,
+        TopDataId const             idDrawCmds)
+{
+    // Each task only writes to its own list, and none of them touch GL
+    rBuilder.task()
+        .name       ("Record draw commands for visible DrawEnts")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgMgnScn.camera(Ready), tgScnRdr.drawTransforms(UseOrRun), tgScnRdr.drawEnt(Ready), tgMgnScn.culling(Ready), tgMgnScn.drawCommands(New)})
+        .push_to    (rOut.m_tasks)
+        .args       ({                  idScnRender,                   idCulling,              idCamera,                  idDrawCmds })
+        .func([] (ACtxSceneRender const& rScnRender, ACtxCulling const& rCulling, Camera const& rCamera, ACtxDrawCommands& rDrawCmds) noexcept
+    {
+        ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
+
+        SysDrawCommands::record(rDrawCmds.lists[LIST_I], LIST_I, rDrawCmds.lists.size(),
+                                rScnRender, rCulling.visibleInView, viewProj);
+    });
+}
+
+template <std::size_t ... LIST_I>
+static void add_tasks_record_draw_commands(
+        std::index_sequence<LIST_I...>,
+        TopTaskBuilder&             rBuilder,
+        Session&                    rOut,
+        PlSceneRenderer const&      tgScnRdr,
+        PlMagnumScene const&        tgMgnScn,
+        TopDataId const             idScnRender,
+        TopDataId const             idCulling,
+        TopDataId const             idCamera,
+        TopDataId const             idDrawCmds)
+{
+    ( add_task_record_draw_commands<LIST_I>(rBuilder, rOut, tgScnRdr, tgMgnScn,
+                                            idScnRender, idCulling, idCamera, idDrawCmds), ... );
+}
 
 Session setup_magnum_scene(
         TopTaskBuilder&             rBuilder,
@@ -124,6 +226,7 @@ Session setup_magnum_scene(
     OSP_DECLARE_GET_DATA_IDS(magnum,        TESTAPP_DATA_MAGNUM);
 
     auto const tgWin    = windowApp     .get_pipelines< PlWindowApp >();
+    auto const tgCS     = commonScene   .get_pipelines< PlCommonScene >();
     auto const tgMgn    = magnum        .get_pipelines< PlMagnum >();
     auto const tgScnRdr = sceneRenderer .get_pipelines< PlSceneRenderer >();
 
@@ -133,9 +236,17 @@ Session setup_magnum_scene(
 
     rBuilder.pipeline(tgMgnScn.fbo)             .parent(tgScnRdr.render);
     rBuilder.pipeline(tgMgnScn.camera)          .parent(tgScnRdr.render);
+    rBuilder.pipeline(tgMgnScn.culling)         .parent(tgScnRdr.render);
+    rBuilder.pipeline(tgMgnScn.meshLod)         .parent(tgScnRdr.render);
+    rBuilder.pipeline(tgMgnScn.drawCommands)    .parent(tgScnRdr.render);
+    rBuilder.pipeline(tgMgnScn.frameUniforms)   .parent(tgScnRdr.render);
 
     top_emplace< ACtxSceneRenderGL >    (topData, idScnRenderGl);
     top_emplace< RenderGroup >          (topData, idGroupFwd);
+    top_emplace< ACtxCulling >          (topData, idCulling);
+
+    auto &rDrawCmds = top_emplace< ACtxDrawCommands >(topData, idDrawCmds);
+    rDrawCmds.lists.resize(gc_drawCommandLists);
 
     auto &rCamera = top_emplace< Camera >(topData, idCamera);
 
@@ -203,15 +314,14 @@ Session setup_magnum_scene(
         .args       ({           idDrawingRes,                 idScnRender,                   idScnRenderGl,          idRenderGl })
         .func([] (ACtxDrawingRes& rDrawingRes, ACtxSceneRender& rScnRender, ACtxSceneRenderGL& rScnRenderGl, RenderGL& rRenderGl) noexcept
     {
-        for (auto const drawEntInt : rScnRender.m_drawIds.bitview().zeros())
-        {
-            SysRenderGL::sync_drawent_texture(
-                    DrawEnt(drawEntInt),
-                    rScnRender.m_diffuseTex,
-                    rDrawingRes.m_texToRes,
-                    rScnRenderGl.m_diffuseTexId,
-                    rRenderGl);
-        }
+        DrawEntVec_t const &liveEnts = rScnRender.m_drawPacked.ents;
+        SysRenderGL::sync_drawent_texture(
+                liveEnts.cbegin(),
+                liveEnts.cend(),
+                rScnRender.m_diffuseTex,
+                rDrawingRes.m_texToRes,
+                rScnRenderGl.m_diffuseTexId,
+                rRenderGl);
     });
 
     rBuilder.task()
@@ -239,15 +349,14 @@ Session setup_magnum_scene(
         .args       ({           idDrawingRes,                 idScnRender,                   idScnRenderGl,          idRenderGl })
         .func([] (ACtxDrawingRes& rDrawingRes, ACtxSceneRender& rScnRender, ACtxSceneRenderGL& rScnRenderGl, RenderGL& rRenderGl) noexcept
     {
-        for (auto const drawEntInt : rScnRender.m_drawIds.bitview().zeros())
-        {
-            SysRenderGL::sync_drawent_mesh(
-                    DrawEnt(drawEntInt),
-                    rScnRender.m_mesh,
-                    rDrawingRes.m_meshToRes,
-                    rScnRenderGl.m_meshId,
-                    rRenderGl);
-        }
+        DrawEntVec_t const &liveEnts = rScnRender.m_drawPacked.ents;
+        SysRenderGL::sync_drawent_mesh(
+                liveEnts.cbegin(),
+                liveEnts.cend(),
+                rScnRender.m_mesh,
+                rDrawingRes.m_meshToRes,
+                rScnRenderGl.m_meshId,
+                rRenderGl);
     });
 
     rBuilder.task()
@@ -264,27 +373,78 @@ Session setup_magnum_scene(
         Framebuffer &rFbo = rRenderGl.m_fbo;
         rFbo.bind();
 
-        Magnum::GL::Texture2D &rFboColor = rRenderGl.m_texGl.get(rRenderGl.m_fboColor);
-        SysRenderGL::display_texture(rRenderGl, rFboColor);
+        if (rRenderGl.m_displayFbo)
+        {
+            Magnum::GL::Texture2D &rFboColor = rRenderGl.m_texGl.get(rRenderGl.m_fboColor);
+            SysRenderGL::display_texture(rRenderGl, rFboColor);
+        }
 
         rFbo.clear(   FramebufferClear::Color | FramebufferClear::Depth
                     | FramebufferClear::Stencil);
     });
 
+    rBuilder.task()
+        .name       ("Cull DrawEnts outside of camera frustum")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgMgnScn.camera(Ready), tgScnRdr.drawTransforms(UseOrRun), tgScnRdr.drawEnt(Ready), tgScnRdr.entMesh(Ready), tgScnRdr.mesh(Ready),
+                      tgCS.hierarchy(Ready), tgMgnScn.culling(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({            idBasic,                   idDrawing,                       idScnRender,             idCulling,              idCamera })
+        .func([] (ACtxBasic const& rBasic, ACtxDrawing const& rDrawing, ACtxSceneRender const& rScnRender, ACtxCulling& rCulling, Camera const& rCamera) noexcept
+    {
+        ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
+
+        SysCulling::update_draw_bounds(rCulling, rScnRender, rDrawing);
+        SysCulling::update_subtree_bounds(rCulling, rScnRender, rBasic.m_scnGraph);
+        SysCulling::cull(rCulling, rScnRender, rBasic.m_scnGraph, viewProj);
+    });
+
+    rBuilder.task()
+        .name       ("Select mesh levels of detail by screen-space error")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgMgnScn.camera(Ready), tgScnRdr.drawTransforms(UseOrRun), tgScnRdr.entMesh(Ready), tgMgn.entMeshGL(Ready), tgMgn.meshGL(Ready),
+                      tgMgnScn.culling(Ready), tgMgnScn.meshLod(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({              idDrawing,                      idDrawingRes,                 idScnRender,                   idScnRenderGl,                idRenderGl,                   idCulling,              idCamera })
+        .func([] (ACtxDrawing const& rDrawing, ACtxDrawingRes const& rDrawingRes, ACtxSceneRender& rScnRender, ACtxSceneRenderGL& rScnRenderGl, RenderGL const& rRenderGl, ACtxCulling const& rCulling, Camera const& rCamera) noexcept
+    {
+        auto const viewportHeight = float(Magnum::GL::defaultFramebuffer.viewport().sizeY());
+
+        SysRender::select_mesh_lods(rScnRender, rDrawing, rCulling.visibleInView, rCamera, viewportHeight);
+        SysRenderGL::apply_mesh_lods(rScnRender, rCulling.visibleInView, rDrawing, rDrawingRes, rScnRenderGl.m_meshId, rRenderGl);
+    });
+
+    add_tasks_record_draw_commands(std::make_index_sequence<gc_drawCommandLists>{},
+                                   rBuilder, out, tgScnRdr, tgMgnScn,
+                                   idScnRender, idCulling, idCamera, idDrawCmds);
+
+    rBuilder.task()
+        .name       ("Index recorded draw commands by DrawEnt and material")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgScnRdr.drawEnt(Ready), tgMgnScn.drawCommands(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({                  idScnRender,                  idDrawCmds })
+        .func([] (ACtxSceneRender const& rScnRender, ACtxDrawCommands& rDrawCmds) noexcept
+    {
+        SysDrawCommands::index(rDrawCmds, rScnRender);
+    });
+
     rBuilder.task()
         .name       ("Render Entities")
         .run_on     ({tgScnRdr.render(Run)})
         .sync_with  ({tgScnRdr.group(Ready), tgScnRdr.groupEnts(Ready), tgMgnScn.camera(Ready), tgScnRdr.drawTransforms(UseOrRun), tgScnRdr.entMesh(Ready), tgScnRdr.entTexture(Ready),
                       tgMgn.entMeshGL(Ready), tgMgn.entTextureGL(Ready),
-                      tgScnRdr.drawEnt(Ready)})
+                      tgScnRdr.drawEnt(Ready), tgMgnScn.culling(Ready), tgMgnScn.meshLod(Ready), tgMgnScn.drawCommands(Ready), tgMgnScn.frameUniforms(Ready)})
         .push_to    (out.m_tasks)
-        .args       ({            idScnRender,          idRenderGl,                   idGroupFwd,              idCamera })
-        .func([] (ACtxSceneRender& rScnRender, RenderGL& rRenderGl, RenderGroup const& rGroupFwd, Camera const& rCamera, WorkerContext ctx) noexcept
+        .args       ({              idScnRenderGl,          idRenderGl,                   idGroupFwd,              idCamera,                        idDrawCmds })
+        .func([] (ACtxSceneRenderGL& rScnRenderGl, RenderGL& rRenderGl, RenderGroup const& rGroupFwd, Camera const& rCamera, ACtxDrawCommands const& rDrawCmds, WorkerContext ctx) noexcept
     {
         ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
 
-        // Forward Render fwd_opaque group to FBO
-        SysRenderGL::render_opaque(rGroupFwd, rScnRender.m_visible, viewProj);
+        // Forward Render fwd_opaque group to FBO, only DrawEnts recorded as visible this frame
+        SysRenderGL::render_opaque(rGroupFwd, viewProj, rDrawCmds, rScnRenderGl);
+
+        rRenderGl.m_stats += std::exchange(rScnRenderGl.m_batches.stats, {});
     });
 
     rBuilder.task()
@@ -321,6 +481,7 @@ Session setup_shader_visualizer(
     OSP_DECLARE_GET_DATA_IDS(magnum,        TESTAPP_DATA_MAGNUM);
     auto const tgWin    = windowApp     .get_pipelines< PlWindowApp >();
     auto const tgScnRdr = sceneRenderer .get_pipelines< PlSceneRenderer >();
+    auto const tgMgnScn = magnumScene   .get_pipelines< PlMagnumScene >();
 
     auto &rScnRender    = top_get< ACtxSceneRender >    (topData, idScnRender);
     auto &rScnRenderGl  = top_get< ACtxSceneRenderGL >  (topData, idScnRenderGl);
@@ -331,19 +492,33 @@ Session setup_shader_visualizer(
 
     auto &rDrawVisual = top_emplace< ACtxDrawMeshVisualizer >(topData, idDrawShVisual);
 
+    auto const uboConfig = MeshVisualizer::Configuration{}.setMaterialCount(1).setDrawCount(gc_drawUniformsPerChunk);
+    auto const flags     = MeshVisualizer::Flag::Wireframe | MeshVisualizer::Flag::UniformBuffers;
+
     rDrawVisual.m_materialId = materialId;
-    rDrawVisual.m_shader = MeshVisualizer{ MeshVisualizer::Configuration{}.setFlags(MeshVisualizer::Flag::Wireframe) };
+    rDrawVisual.m_shader = MeshVisualizer{ MeshVisualizer::Configuration{uboConfig}.setFlags(flags) };
+    rDrawVisual.m_shaderInstanced = MeshVisualizer{ MeshVisualizer::Configuration{uboConfig}.setFlags(flags | MeshVisualizer::Flag::InstancedTransformation) };
+    rDrawVisual.create_uniform_buffers();
     rDrawVisual.assign_pointers(rScnRender, rScnRenderGl, rRenderGl);
-
-    // Default colors
-    rDrawVisual.m_shader.setWireframeColor({0.7f, 0.5f, 0.7f, 1.0f});
-    rDrawVisual.m_shader.setColor({0.2f, 0.1f, 0.5f, 1.0f});
+    rDrawVisual.m_pDrawCmds = &top_get< ACtxDrawCommands >(topData, idDrawCmds);
 
     if (materialId == lgrn::id_null<MaterialId>())
     {
         return out;
     }
 
+    rBuilder.task()
+        .name       ("Update MeshVisualizer shader uniform buffers")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgScnRdr.groupEnts(Ready), tgMgnScn.camera(Ready), tgMgnScn.drawCommands(Ready), tgMgnScn.frameUniforms(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({                   idDrawCmds,              idCamera,                        idDrawShVisual })
+        .func([] (ACtxDrawCommands const& rDrawCmds, Camera const& rCamera, ACtxDrawMeshVisualizer& rDrawShVisual) noexcept
+    {
+        ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
+        update_uniforms_visualizer(rDrawShVisual, rDrawCmds, viewProj);
+    });
+
     rBuilder.task()
         .name       ("Sync MeshVisualizer shader DrawEnts")
         .run_on     ({tgWin.sync(Run)})
@@ -391,6 +566,7 @@ Session setup_shader_flat(
     OSP_DECLARE_GET_DATA_IDS(magnum,        TESTAPP_DATA_MAGNUM);
     auto const tgWin    = windowApp     .get_pipelines< PlWindowApp >();
     auto const tgScnRdr = sceneRenderer .get_pipelines< PlSceneRenderer >();
+    auto const tgMgnScn = magnumScene   .get_pipelines< PlMagnumScene >();
 
     auto &rScnRender    = top_get< ACtxSceneRender >    (topData, idScnRender);
     auto &rScnRenderGl  = top_get< ACtxSceneRenderGL >  (topData, idScnRenderGl);
@@ -400,16 +576,35 @@ Session setup_shader_flat(
     OSP_DECLARE_CREATE_DATA_IDS(out, topData, TESTAPP_DATA_SHADER_FLAT)
     auto &rDrawFlat = top_emplace< ACtxDrawFlat >(topData, idDrawShFlat);
 
-    rDrawFlat.shaderDiffuse       = FlatGL3D{FlatGL3D::Configuration{}.setFlags(FlatGL3D::Flag::Textured)};
-    rDrawFlat.shaderUntextured    = FlatGL3D{FlatGL3D::Configuration{}};
+    auto const uboConfig          = FlatGL3D::Configuration{}.setMaterialCount(gc_drawUniformsPerChunk).setDrawCount(gc_drawUniformsPerChunk);
+    auto const uboFlag            = FlatGL3D::Flag::UniformBuffers;
+    auto const instancedFlags     = FlatGL3D::Flag::InstancedTransformation | FlatGL3D::Flag::VertexColor;
+    rDrawFlat.shaderDiffuse       = FlatGL3D{FlatGL3D::Configuration{uboConfig}.setFlags(FlatGL3D::Flag::Textured | uboFlag)};
+    rDrawFlat.shaderUntextured    = FlatGL3D{FlatGL3D::Configuration{uboConfig}.setFlags(uboFlag)};
+    rDrawFlat.shaderDiffuseInstanced      = FlatGL3D{FlatGL3D::Configuration{uboConfig}.setFlags(FlatGL3D::Flag::Textured | uboFlag | instancedFlags)};
+    rDrawFlat.shaderUntexturedInstanced   = FlatGL3D{FlatGL3D::Configuration{uboConfig}.setFlags(uboFlag | instancedFlags)};
     rDrawFlat.materialId          = materialId;
+    rDrawFlat.create_uniform_buffers();
     rDrawFlat.assign_pointers(rScnRender, rScnRenderGl, rRenderGl);
+    rDrawFlat.pDrawCmds = &top_get< ACtxDrawCommands >(topData, idDrawCmds);
 
     if (materialId == lgrn::id_null<MaterialId>())
     {
         return out;
     }
 
+    rBuilder.task()
+        .name       ("Update Flat shader uniform buffers")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgScnRdr.groupEnts(Ready), tgMgnScn.camera(Ready), tgMgnScn.drawCommands(Ready), tgMgnScn.frameUniforms(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({                   idDrawCmds,              idCamera,              idDrawShFlat })
+        .func([] (ACtxDrawCommands const& rDrawCmds, Camera const& rCamera, ACtxDrawFlat& rDrawShFlat) noexcept
+    {
+        ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
+        update_uniforms_flat(rDrawShFlat, rDrawCmds, viewProj);
+    });
+
     rBuilder.task()
         .name       ("Sync Flat shader DrawEnts")
         .run_on     ({tgWin.sync(Run)})
@@ -475,6 +670,7 @@ Session setup_shader_phong(
     OSP_DECLARE_GET_DATA_IDS(magnum,        TESTAPP_DATA_MAGNUM);
     auto const tgWin    = windowApp     .get_pipelines< PlWindowApp >();
     auto const tgScnRdr = sceneRenderer .get_pipelines< PlSceneRenderer >();
+    auto const tgMgnScn = magnumScene   .get_pipelines< PlMagnumScene >();
 
     auto &rScnRender    = top_get< ACtxSceneRender >    (topData, idScnRender);
     auto &rScnRenderGl  = top_get< ACtxSceneRenderGL >  (topData, idScnRenderGl);
@@ -485,16 +681,35 @@ Session setup_shader_phong(
     auto &rDrawPhong = top_emplace< ACtxDrawPhong >(topData, idDrawShPhong);
 
     auto const texturedFlags    = PhongGL::Flag::DiffuseTexture | PhongGL::Flag::AlphaMask | PhongGL::Flag::AmbientTexture;
-    rDrawPhong.shaderDiffuse    = PhongGL{PhongGL::Configuration{}.setFlags(texturedFlags).setLightCount(2)};
-    rDrawPhong.shaderUntextured = PhongGL{PhongGL::Configuration{}.setLightCount(2)};
+    auto const uboConfig        = PhongGL::Configuration{}.setLightCount(2).setMaterialCount(gc_drawUniformsPerChunk).setDrawCount(gc_drawUniformsPerChunk);
+    auto const uboFlag          = PhongGL::Flag::UniformBuffers;
+    auto const instancedFlags   = PhongGL::Flag::InstancedTransformation | PhongGL::Flag::VertexColor;
+    rDrawPhong.shaderDiffuse    = PhongGL{PhongGL::Configuration{uboConfig}.setFlags(texturedFlags | uboFlag)};
+    rDrawPhong.shaderUntextured = PhongGL{PhongGL::Configuration{uboConfig}.setFlags(uboFlag)};
+    rDrawPhong.shaderDiffuseInstanced    = PhongGL{PhongGL::Configuration{uboConfig}.setFlags(texturedFlags | uboFlag | instancedFlags)};
+    rDrawPhong.shaderUntexturedInstanced = PhongGL{PhongGL::Configuration{uboConfig}.setFlags(uboFlag | instancedFlags)};
     rDrawPhong.materialId       = materialId;
+    rDrawPhong.create_uniform_buffers();
     rDrawPhong.assign_pointers(rScnRender, rScnRenderGl, rRenderGl);
+    rDrawPhong.pDrawCmds = &top_get< ACtxDrawCommands >(topData, idDrawCmds);
 
     if (materialId == lgrn::id_null<MaterialId>())
     {
         return out;
     }
 
+    rBuilder.task()
+        .name       ("Update Phong shader uniform buffers")
+        .run_on     ({tgScnRdr.render(Run)})
+        .sync_with  ({tgScnRdr.groupEnts(Ready), tgMgnScn.camera(Ready), tgMgnScn.drawCommands(Ready), tgMgnScn.frameUniforms(Modify)})
+        .push_to    (out.m_tasks)
+        .args       ({                   idDrawCmds,              idCamera,               idDrawShPhong })
+        .func([] (ACtxDrawCommands const& rDrawCmds, Camera const& rCamera, ACtxDrawPhong& rDrawShPhong) noexcept
+    {
+        ViewProjMatrix viewProj{rCamera.m_transform.inverted(), rCamera.perspective()};
+        update_uniforms_phong(rDrawShPhong, rDrawCmds, viewProj);
+    });
+
     rBuilder.task()
         .name       ("Sync Phong shader DrawEnts")
         .run_on     ({tgWin.sync(Run)})
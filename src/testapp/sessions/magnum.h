@@ -25,6 +25,7 @@
 #pragma once
 
 #include "../scenarios.h"
+#include "../HeadlessApplication.h"
 #include "../MagnumApplication.h"
 
 #include <osp/activescene/basic.h>
@@ -40,6 +41,18 @@ osp::Session setup_magnum(
         osp::Session const&             windowApp,
         MagnumApplication::Arguments    args);
 
+/**
+ * @brief Same as setup_magnum, but with a HeadlessApplication as idActiveApp instead of a window
+ *
+ * @param rrApp     [in] Application with a current OpenGL context, see HeadlessApplication::has_context
+ */
+osp::Session setup_magnum_headless(
+        osp::TopTaskBuilder&            rBuilder,
+        osp::ArrayView<entt::any>       topData,
+        osp::Session const&             application,
+        osp::Session const&             windowApp,
+        HeadlessApplication&&           rrApp);
+
 /**
  * @brief stuff needed to render a scene using Magnum
  */
@@ -162,7 +162,7 @@ Session setup_cursor(
     Session out;
     auto const [idCursorEnt] = out.acquire_data<1>(topData);
 
-    auto const cursorEnt = top_emplace<DrawEnt>(topData, idCursorEnt, rScnRender.m_drawIds.create());
+    auto const cursorEnt = top_emplace<DrawEnt>(topData, idCursorEnt, SysRender::create_draw_ent(rScnRender));
     rScnRender.resize_draw();
 
     rScnRender.m_mesh[cursorEnt] = SysRender::add_drawable_mesh(rDrawing, rDrawingRes, rResources, pkg, "cubewire");
@@ -30,6 +30,7 @@
 #include <osp/activescene/physics_fn.h>
 #include <osp/activescene/prefab_fn.h>
 #include <osp/activescene/vehicles.h>
+#include <osp/activescene/vehicles_fn.h>
 #include <osp/core/Resources.h>
 #include <osp/drawing/drawing.h>
 #include <osp/vehicles/ImporterData.h>
@@ -94,7 +95,7 @@ Session setup_newton(
         .args({             idBasic,             idPhys,              idNwt,           idDeltaTimeIn })
         .func([] (ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxNwtWorld& rNwt, float const deltaTimeIn, WorkerContext ctx) noexcept
     {
-        SysNewton::update_world(rPhys, rNwt, deltaTimeIn, rBasic.m_scnGraph, rBasic.m_transform);
+        SysNewton::update_world(rPhys, rNwt, deltaTimeIn, rBasic);
     });
 
     top_emplace< ACtxNwtWorld >(topData, idNwt, 2);
@@ -213,7 +214,7 @@ Session setup_phys_shapes_newton(
 
             rNwt.m_bodyPtrs[bodyId].reset(pBody);
 
-            rNwt.m_bodyToEnt[bodyId]    = root;
+            rNwt.m_bodyToEnt[bodyId]    = SysActiveEnt::active_ent_ref(rBasic, root);
             rNwt.m_bodyFactors[bodyId]  = nwtFactors;
             rNwt.m_entToBody.emplace(root, bodyId);
 
@@ -281,6 +282,61 @@ void compound_collect_recurse(
 }
 
 
+/**
+ * @brief Create a Newton body for a weld's root entity, without any collision or mass yet
+ */
+static NewtonBody* weld_body_create(ACtxBasic const& rBasic, ACtxNwtWorld& rNwt, ActiveEnt const weldEnt, Matrix4 const& transform)
+{
+    NwtColliderPtr_t pNull{ NewtonCreateNull(rNwt.m_world.get()) };
+    NewtonBody *pBody = NewtonCreateDynamicBody(rNwt.m_world.get(), pNull.get(), transform.data());
+
+    BodyId const bodyId = rNwt.m_bodyIds.create();
+    SysNewton::resize_body_data(rNwt);
+
+    rNwt.m_bodyPtrs[bodyId].reset(pBody);
+    rNwt.m_bodyToEnt[bodyId] = SysActiveEnt::active_ent_ref(rBasic, weldEnt);
+    rNwt.m_bodyFactors[bodyId] = {1}; // TODO: temporary
+    rNwt.m_entToBody.emplace(weldEnt, bodyId);
+
+    NewtonBodySetGyroscopicTorque       (pBody, 1);
+    NewtonBodySetLinearDamping          (pBody, 0.0f);
+    NewtonBodySetAngularDamping         (pBody, Vector3{0.0f}.data());
+    NewtonBodySetForceAndTorqueCallback (pBody, &SysNewton::cb_force_torque);
+    NewtonBodySetTransformCallback      (pBody, &SysNewton::cb_set_transform);
+    SysNewton::set_userdata_bodyid      (pBody, bodyId);
+
+    return pBody;
+}
+
+/**
+ * @brief Set a weld body's collision and mass properties from all colliders and masses in its
+ *        root entity's subtree
+ */
+static void weld_body_update_shape(ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxNwtWorld& rNwt, ActiveEnt const weldEnt, NewtonBody* pBody)
+{
+    NwtColliderPtr_t pCompound{ NewtonCreateCompoundCollision(rNwt.m_world.get(), 0) };
+
+    // Collect all colliders from hierarchy.
+    NewtonCompoundCollisionBeginAddRemove(pCompound.get());
+    compound_collect_recurse( rPhys, rNwt, rBasic, weldEnt, Matrix4{}, pCompound.get() );
+    NewtonCompoundCollisionEndAddRemove(pCompound.get());
+
+    NewtonBodySetCollision(pBody, pCompound.get());
+
+    float   totalMass = 0.0f;
+    Vector3 massPos{0.0f};
+    SysPhysics::calculate_subtree_mass_center(rBasic.m_transform, rPhys, rBasic.m_scnGraph, weldEnt, massPos, totalMass);
+
+    Vector3 const com = massPos / totalMass;
+    auto const comToOrigin = Matrix4::translation( - com );
+
+    Matrix3 inertiaTensor{0.0f};
+    SysPhysics::calculate_subtree_mass_inertia(rBasic.m_transform, rPhys, rBasic.m_scnGraph, weldEnt, inertiaTensor, comToOrigin);
+
+    Matrix4 const inertiaTensorMat4{inertiaTensor};
+    NewtonBodySetFullMassMatrix         (pBody, totalMass, inertiaTensorMat4.data());
+    NewtonBodySetCentreOfMass           (pBody, com.data());
+}
 
 Session setup_vehicle_spawn_newton(
         TopTaskBuilder&             rBuilder,
@@ -336,8 +392,8 @@ Session setup_vehicle_spawn_newton(
         .run_on     ({tgVhSp.spawnRequest(UseOrRun)})
         .sync_with  ({tgVhSp.rootEnts(UseOrRun), tgParts.mapWeldActive(Ready), tgPf.spawnedEnts(UseOrRun), tgPf.spawnRequest(UseOrRun), tgPf.inSubtree(Run), tgCS.transform(Ready), tgCS.hierarchy(Modify)})
         .push_to    (out.m_tasks)
-        .args       ({      idBasic,                        idVehicleSpawn,           idScnParts,             idPrefabs,            idResources})
-        .func([] (ACtxBasic& rBasic, ACtxVehicleSpawn const& rVehicleSpawn, ACtxParts& rScnParts, ACtxPrefabs& rPrefabs, Resources& rResources) noexcept
+        .args       ({      idBasic,                        idVehicleSpawn,           idScnParts,                   idPrefabs})
+        .func([] (ACtxBasic& rBasic, ACtxVehicleSpawn const& rVehicleSpawn, ACtxParts& rScnParts, ACtxPrefabs const& rPrefabs) noexcept
     {
         LGRN_ASSERT(rVehicleSpawn.new_vehicle_count() != 0);
 
@@ -359,7 +415,7 @@ Session setup_vehicle_spawn_newton(
 
             std::for_each(itWeldsFirst + std::ptrdiff_t{*itWeldOffsets},
                           itWeldsFirst + std::ptrdiff_t{weldOffsetNext},
-                          [&rBasic, &rScnParts, &rVehicleSpawn, &rPrefabs, &rResources, &toInit] (WeldId const weld)
+                          [&rBasic, &rScnParts, &rVehicleSpawn, &rPrefabs, &toInit] (WeldId const weld)
             {
                 // Count parts in this weld first
                 std::size_t entCount = 0;
@@ -381,10 +437,10 @@ Session setup_vehicle_spawn_newton(
                 {
                     SpPartId const newPart      = rVehicleSpawn.partToSpawned[part];
                     uint32_t const prefabInit   = rVehicleSpawn.spawnedPrefabs[newPart];
-                    auto const& basic           = rPrefabs.spawnRequest[prefabInit];
+                    auto const& tmpl            = rPrefabs.templates[rPrefabs.spawnedTemplates[prefabInit]];
                     auto const& ents            = rPrefabs.spawnedEntsOffset[prefabInit];
 
-                    SysPrefabInit::add_to_subtree(basic, ents, rResources, bldWeld);
+                    SysPrefabInit::add_to_subtree(tmpl, ents, bldWeld);
                 }
             });
 
@@ -422,52 +478,92 @@ Session setup_vehicle_spawn_newton(
                 ActiveEnt const weldEnt = rScnParts.weldToActive[weld];
 
                 auto const transform = Matrix4::from(toInit.rotation.toMatrix(), toInit.position);
-                NwtColliderPtr_t pCompound{ NewtonCreateCompoundCollision(rNwt.m_world.get(), 0) };
 
                 rPhys.m_hasColliders.set(std::size_t(weldEnt));
 
-                // Collect all colliders from hierarchy.
-                NewtonCompoundCollisionBeginAddRemove(pCompound.get());
-                compound_collect_recurse( rPhys, rNwt, rBasic, weldEnt, Matrix4{}, pCompound.get() );
-                NewtonCompoundCollisionEndAddRemove(pCompound.get());
-
-                NewtonBody *pBody = NewtonCreateDynamicBody(rNwt.m_world.get(), pCompound.get(), Matrix4{}.data());
+                NewtonBody *pBody = weld_body_create(rBasic, rNwt, weldEnt, transform);
+                weld_body_update_shape(rBasic, rPhys, rNwt, weldEnt, pBody);
 
-                BodyId const bodyId = rNwt.m_bodyIds.create();
-                SysNewton::resize_body_data(rNwt);
+                rPhys.m_setVelocity.emplace_back(weldEnt, toInit.velocity);
+            });
 
+            itWeldOffsets = itWeldOffsetsNext;
+        }
+    });
 
-                rNwt.m_bodyPtrs[bodyId].reset(pBody);
-                rNwt.m_bodyToEnt[bodyId] = weldEnt;
-                rNwt.m_bodyFactors[bodyId] = {1}; // TODO: temporary
-                rNwt.m_entToBody.emplace(weldEnt, bodyId);
+    rBuilder.task()
+        .name       ("Split Welds and move their parts under new root ActiveEnts")
+        .run_on     ({tgParts.weldSplit(UseOrRun)})
+        .sync_with  ({tgCS.activeEnt(New), tgCS.activeEntResized(Schedule), tgCS.transform(New), tgCS.hierarchy(Modify), tgParts.weldIds(New), tgParts.mapWeldPart(Modify), tgParts.mapWeldActive(Modify), tgParts.weldDirty(Modify_)})
+        .push_to    (out.m_tasks)
+        .args       ({      idBasic,           idScnParts})
+        .func([] (ACtxBasic& rBasic, ACtxParts& rScnParts) noexcept
+    {
+        for (ACtxParts::WeldSplit &rSplit : rScnParts.weldSplitRequest)
+        {
+            rSplit.oldWeld = rScnParts.partToWeld[rSplit.parts.front()];
+            rSplit.newWeld = SysParts::split_weld(rScnParts, arrayView(std::as_const(rSplit.parts)));
+            if (rSplit.newWeld == lgrn::id_null<WeldId>())
+            {
+                continue; // Nothing left to split off, such as a second request for the same part
+            }
 
-                float   totalMass = 0.0f;
-                Vector3 massPos{0.0f};
-                SysPhysics::calculate_subtree_mass_center(rBasic.m_transform, rPhys, rBasic.m_scnGraph, weldEnt, massPos, totalMass);
+            ActiveEnt const newRoot = rBasic.m_activeIds.create();
+            rBasic.m_scnGraph.resize(rBasic.m_activeIds.capacity());
 
-                Vector3 const com = massPos / totalMass;
-                auto const comToOrigin = Matrix4::translation( - com );
+            SysParts::move_weld_to_new_root(rScnParts, rBasic, rSplit.newWeld, rScnParts.weldToActive[rSplit.oldWeld], newRoot);
+        }
+    });
 
-                Matrix3 inertiaTensor{0.0f};
-                SysPhysics::calculate_subtree_mass_inertia(rBasic.m_transform, rPhys, rBasic.m_scnGraph, weldEnt, inertiaTensor, comToOrigin);
+    rBuilder.task()
+        .name       ("Give split Welds their own Newton bodies")
+        .run_on     ({tgParts.weldSplit(UseOrRun)})
+        .sync_with  ({tgCS.transform(Ready), tgCS.hierarchy(Ready), tgParts.mapWeldActive(Ready), tgPhy.physBody(Ready), tgNwt.nwtBody(New), tgPhy.physUpdate(Done)})
+        .push_to    (out.m_tasks)
+        .args       ({      idBasic,             idPhys,              idNwt,                 idScnParts})
+        .func([] (ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxNwtWorld& rNwt, ACtxParts const& rScnParts) noexcept
+    {
+        rPhys.m_hasColliders.ints().resize(rBasic.m_activeIds.vec().capacity());
 
-                Matrix4 const inertiaTensorMat4{inertiaTensor};
-                //NewtonBodySetMassMatrix(pBody, 0.0f, 1.0f, 1.0f, 1.0f);
-                NewtonBodySetFullMassMatrix         (pBody, totalMass, inertiaTensorMat4.data());
-                NewtonBodySetCentreOfMass           (pBody, com.data());
-                NewtonBodySetGyroscopicTorque       (pBody, 1);
-                NewtonBodySetMatrix                 (pBody, transform.data());
-                NewtonBodySetLinearDamping          (pBody, 0.0f);
-                NewtonBodySetAngularDamping         (pBody, Vector3{0.0f}.data());
-                NewtonBodySetForceAndTorqueCallback (pBody, &SysNewton::cb_force_torque);
-                NewtonBodySetTransformCallback      (pBody, &SysNewton::cb_set_transform);
-                SysNewton::set_userdata_bodyid      (pBody, bodyId);
+        for (ACtxParts::WeldSplit const& split : rScnParts.weldSplitRequest)
+        {
+            if (split.newWeld == lgrn::id_null<WeldId>())
+            {
+                continue;
+            }
 
-                rPhys.m_setVelocity.emplace_back(weldEnt, toInit.velocity);
-            });
+            ActiveEnt const oldEnt  = rScnParts.weldToActive[split.oldWeld];
+            ActiveEnt const newEnt  = rScnParts.weldToActive[split.newWeld];
+            NewtonBody *pOldBody    = rNwt.m_bodyPtrs[rNwt.m_entToBody.at(oldEnt)].get();
+
+            // Record motion of the old body before its center of mass changes
+            Matrix4 transform;
+            Vector3 oldCom;
+            Vector3 velocity;
+            Vector3 omega;
+            NewtonBodyGetMatrix         (pOldBody, transform.data());
+            NewtonBodyGetCentreOfMass   (pOldBody, oldCom.data());
+            NewtonBodyGetVelocity       (pOldBody, velocity.data());
+            NewtonBodyGetOmega          (pOldBody, omega.data());
+            Vector3 const oldComWorld = transform.transformPoint(oldCom);
+
+            rPhys.m_hasColliders.set(std::size_t(newEnt));
+
+            NewtonBody *pNewBody = weld_body_create(rBasic, rNwt, newEnt, transform);
+            weld_body_update_shape(rBasic, rPhys, rNwt, oldEnt, pOldBody);
+            weld_body_update_shape(rBasic, rPhys, rNwt, newEnt, pNewBody);
+
+            // Both halves keep moving like they were still attached: velocity at each new
+            // center of mass is the old velocity plus rotation around the old center of mass
+            for (NewtonBody *pBody : {pOldBody, pNewBody})
+            {
+                Vector3 com;
+                NewtonBodyGetCentreOfMass(pBody, com.data());
+                Vector3 const comVelocity = velocity + Magnum::Math::cross(omega, transform.transformPoint(com) - oldComWorld);
 
-            itWeldOffsets = itWeldOffsetsNext;
+                NewtonBodySetVelocity   (pBody, comVelocity.data());
+                NewtonBodySetOmega      (pBody, omega.data());
+            }
         }
     });
 
@@ -501,7 +597,7 @@ static void assign_rockets(
         PerMachType const&          machtypeRocket,
         ForceFactors_t const&       rNwtFactors,
         WeldId const                weld,
-        std::vector<BodyRocket>&    rTemp)
+        ScratchVec_t<BodyRocket>&   rTemp)
 {
     using adera::gc_mtMagicRocket;
     using adera::ports_magicrocket::gc_throttleIn;
@@ -550,7 +646,7 @@ static void assign_rockets(
 
         // calculate transform relative to body root
         // start from part, then walk parents up
-        ActiveEnt const partEnt = rScnParts.partToActive[part];
+        ActiveEnt const partEnt = rScnParts.partToActive[part].ent;
 
         Matrix4     transform   = rBasic.m_transform.get(partEnt).m_transform;
         ActiveEnt   parent      = rBasic.m_scnGraph.m_entParent[partEnt];
@@ -669,7 +765,7 @@ Session setup_rocket_thrust_newton(
         .sync_with  ({tgParts.weldIds(Ready), tgNwt.nwtBody(Ready), tgParts.connect(Ready)})
         .push_to    (out.m_tasks)
         .args       ({      idBasic,             idPhys,              idNwt,                 idScnParts,                idRocketsNwt,                      idNwtFactors})
-        .func([] (ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxNwtWorld& rNwt, ACtxParts const& rScnParts, ACtxRocketsNwt& rRocketsNwt, ForceFactors_t const& rNwtFactors) noexcept
+        .func([] (ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxNwtWorld& rNwt, ACtxParts const& rScnParts, ACtxRocketsNwt& rRocketsNwt, ForceFactors_t const& rNwtFactors, WorkerContext ctx) noexcept
     {
         using adera::gc_mtMagicRocket;
 
@@ -679,7 +775,10 @@ Session setup_rocket_thrust_newton(
         rRocketsNwt.m_bodyRockets.ids_reserve(rNwt.m_bodyIds.size());
         rRocketsNwt.m_bodyRockets.data_reserve(rScnParts.machines.perType[gc_mtMagicRocket].localIds.capacity());
 
-        std::vector<BodyRocket> temp;
+        // Executors aren't required to provide scratch memory, fall back to a local arena that
+        // only allocates if used
+        ScratchArena fallback;
+        ScratchVec_t<BodyRocket> temp{(ctx.pScratch != nullptr) ? *ctx.pScratch : fallback};
 
         for (WeldId const weld : rScnParts.weldDirty)
         {
@@ -104,6 +104,8 @@ Session setup_prefabs(
     OSP_DECLARE_CREATE_DATA_IDS(out, topData,  TESTAPP_DATA_PREFABS);
     auto const tgPf = out.create_pipelines<PlPrefabs>(rBuilder);
 
+    out.m_cleanup = tgScn.cleanup;
+
     rBuilder.pipeline(tgPf.spawnRequest).parent(tgScn.update);
     rBuilder.pipeline(tgPf.spawnedEnts) .parent(tgScn.update);
     rBuilder.pipeline(tgPf.ownedEnts)   .parent(tgScn.update);
@@ -139,10 +141,10 @@ Session setup_prefabs(
         .run_on     ({tgPf.spawnRequest(UseOrRun)})
         .sync_with  ({tgPf.spawnedEnts(UseOrRun), tgCS.transform(New)})
         .push_to    (out.m_tasks)
-        .args       ({      idBasic,           idResources,             idPrefabs})
-        .func([] (ACtxBasic& rBasic, Resources& rResources, ACtxPrefabs& rPrefabs) noexcept
+        .args       ({      idBasic,                   idPrefabs})
+        .func([] (ACtxBasic& rBasic, ACtxPrefabs const& rPrefabs) noexcept
     {
-        SysPrefabInit::init_transforms(rPrefabs, rResources, rBasic.m_transform);
+        SysPrefabInit::init_transforms(rPrefabs, rBasic.m_transform);
     });
 
     rBuilder.task()
@@ -150,12 +152,12 @@ Session setup_prefabs(
         .run_on     ({tgPf.spawnRequest(UseOrRun)})
         .sync_with  ({tgPf.spawnedEnts(UseOrRun), tgPf.instanceInfo(Modify)})
         .push_to    (out.m_tasks)
-        .args       ({      idBasic,           idResources,             idPrefabs})
-        .func([] (ACtxBasic& rBasic, Resources& rResources, ACtxPrefabs& rPrefabs) noexcept
+        .args       ({      idBasic,             idPrefabs})
+        .func([] (ACtxBasic& rBasic, ACtxPrefabs& rPrefabs) noexcept
     {
         rPrefabs.instanceInfo.resize(rBasic.m_activeIds.capacity(), PrefabInstanceInfo{.prefab = lgrn::id_null<PrefabId>()});
         osp::bitvector_resize(rPrefabs.roots, rBasic.m_activeIds.capacity());
-        SysPrefabInit::init_info(rPrefabs, rResources);
+        SysPrefabInit::init_info(rPrefabs);
     });
 
     rBuilder.task()
@@ -163,13 +165,13 @@ Session setup_prefabs(
         .run_on     ({tgPf.spawnRequest(UseOrRun)})
         .sync_with  ({tgPf.spawnedEnts(UseOrRun), tgPhy.physBody(Modify), tgPhy.physUpdate(Done)})
         .push_to    (out.m_tasks)
-        .args       ({      idBasic,           idResources,             idPhys,             idPrefabs})
-        .func([] (ACtxBasic& rBasic, Resources& rResources, ACtxPhysics& rPhys, ACtxPrefabs& rPrefabs) noexcept
+        .args       ({      idBasic,             idPhys,                   idPrefabs})
+        .func([] (ACtxBasic& rBasic, ACtxPhysics& rPhys, ACtxPrefabs const& rPrefabs) noexcept
     {
         rPhys.m_hasColliders.ints().resize(rBasic.m_activeIds.vec().capacity());
         //rPhys.m_massDirty.ints().resize(rActiveIds.vec().capacity());
         rPhys.m_shape.resize(rBasic.m_activeIds.capacity());
-        SysPrefabInit::init_physics(rPrefabs, rResources, rPhys);
+        SysPrefabInit::init_physics(rPrefabs, rPhys);
     });
 
     rBuilder.task()
@@ -182,6 +184,16 @@ Session setup_prefabs(
         rPrefabs.spawnRequest.clear();
     });
 
+    rBuilder.task()
+        .name       ("Clear Prefab templates")
+        .run_on     ({tgScn.cleanup(Run_)})
+        .push_to    (out.m_tasks)
+        .args       ({        idPrefabs})
+        .func([] (ACtxPrefabs& rPrefabs) noexcept
+    {
+        SysPrefabInit::clear_templates(rPrefabs);
+    });
+
     return out;
 } // setup_prefabs
 
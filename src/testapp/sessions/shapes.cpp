@@ -248,7 +248,7 @@ Session setup_phys_shapes_draw(
         for (std::size_t i = 0; i < rPhysShapes.m_spawnRequest.size(); ++i)
         {
             ActiveEnt const child            = rPhysShapes.m_ents[i * 2 + 1];
-            rScnRender.m_activeToDraw[child] = rScnRender.m_drawIds.create();
+            rScnRender.m_activeToDraw[child] = SysRender::create_draw_ent(rScnRender);
         }
     });
 
@@ -300,7 +300,7 @@ Session setup_phys_shapes_draw(
             ActiveEnt const root = ActiveEnt(entInt);
             ActiveEnt const child = *SysSceneGraph::children(rBasic.m_scnGraph, root).begin();
 
-            rScnRender.m_activeToDraw[child] = rScnRender.m_drawIds.create();
+            rScnRender.m_activeToDraw[child] = SysRender::create_draw_ent(rScnRender);
         }
     });
 
@@ -30,6 +30,7 @@
 
 #include <osp/core/math_2pow.h>
 #include <osp/drawing/drawing.h>
+#include <osp/drawing/drawing_fn.h>
 #include <osp/universe/coordinates.h>
 #include <osp/universe/universe.h>
 #include <osp/util/logging.h>
@@ -397,9 +398,15 @@ Session setup_testplanets_draw(
 
         rPlanetDraw.drawEnts.resize(rMainSpace.m_satCount, lgrn::id_null<DrawEnt>());
 
-        rScnRender.m_drawIds.create(rPlanetDraw.drawEnts   .begin(), rPlanetDraw.drawEnts   .end());
-        rScnRender.m_drawIds.create(rPlanetDraw.axis       .begin(), rPlanetDraw.axis       .end());
-        rPlanetDraw.attractor = rScnRender.m_drawIds.create();
+        for (DrawEnt &rDrawEnt : rPlanetDraw.drawEnts)
+        {
+            rDrawEnt = SysRender::create_draw_ent(rScnRender);
+        }
+        for (DrawEnt &rDrawEnt : rPlanetDraw.axis)
+        {
+            rDrawEnt = SysRender::create_draw_ent(rScnRender);
+        }
+        rPlanetDraw.attractor = SysRender::create_draw_ent(rScnRender);
     });
 
     rBuilder.task()
@@ -24,6 +24,7 @@
  */
 #include "vehicles.h"
 
+#include <adera/activescene/VehicleBuildService.h>
 #include <adera/activescene/vehicles_vb_fn.h>
 #include <adera/drawing/CameraController.h>
 #include <adera/machines/links.h>
@@ -33,8 +34,11 @@
 #include <osp/activescene/prefab_fn.h>
 #include <osp/core/Resources.h>
 #include <osp/drawing/drawing.h>
+#include <osp/link/signal_propagation.h>
 #include <osp/util/UserInputHandler.h>
 
+#include <thread>
+
 using namespace adera;
 
 using namespace osp::active;
@@ -71,6 +75,7 @@ Session setup_parts(
     rBuilder.pipeline(tgParts.partDirty)        .parent(tgScn.update);
     rBuilder.pipeline(tgParts.weldIds)          .parent(tgScn.update);
     rBuilder.pipeline(tgParts.weldDirty)        .parent(tgScn.update);
+    rBuilder.pipeline(tgParts.weldSplit)        .parent(tgScn.update);
     rBuilder.pipeline(tgParts.machIds)          .parent(tgScn.update);
     rBuilder.pipeline(tgParts.nodeIds)          .parent(tgScn.update);
     rBuilder.pipeline(tgParts.connect)          .parent(tgScn.update);
@@ -90,6 +95,7 @@ Session setup_parts(
     rUpdMach.localDirty       .resize(MachTypeReg_t::size());
     rScnParts.machines.perType.resize(MachTypeReg_t::size());
     rScnParts.nodePerType     .resize(NodeTypeReg_t::size());
+    rScnParts.nodeCompiledPerType.resize(NodeTypeReg_t::size());
 
     rBuilder.task()
         .name       ("Clear Resource owners")
@@ -124,6 +130,27 @@ Session setup_parts(
         rScnParts.weldDirty.clear();
     });
 
+    rBuilder.task()
+        .name       ("Schedule Weld split")
+        .schedules  ({tgParts.weldSplit(Schedule_)})
+        .sync_with  ({tgScn.update(Run)})
+        .push_to    (out.m_tasks)
+        .args       ({            idScnParts})
+        .func([] (ACtxParts const& rScnParts) noexcept -> TaskActions
+    {
+        return rScnParts.weldSplitRequest.empty() ? TaskAction::Cancel : TaskActions{};
+    });
+
+    rBuilder.task()
+        .name       ("Clear Weld split vector after use")
+        .run_on     ({tgParts.weldSplit(Clear)})
+        .push_to    (out.m_tasks)
+        .args       ({      idScnParts})
+        .func([] (ACtxParts& rScnParts) noexcept
+    {
+        rScnParts.weldSplitRequest.clear();
+    });
+
     rBuilder.task()
         .name       ("Schedule Link update")
         .schedules  ({tgParts.linkLoop(ScheduleLink)})
@@ -197,19 +224,16 @@ Session setup_vehicle_spawn_vb(
         Session const&              commonScene,
         Session const&              prefabs,
         Session const&              parts,
-        Session const&              vehicleSpawn,
-        Session const&              signalsFloat)
+        Session const&              vehicleSpawn)
 {
     OSP_DECLARE_GET_DATA_IDS(application,   TESTAPP_DATA_APPLICATION);
     OSP_DECLARE_GET_DATA_IDS(commonScene,   TESTAPP_DATA_COMMON_SCENE);
     OSP_DECLARE_GET_DATA_IDS(parts,         TESTAPP_DATA_PARTS);
     OSP_DECLARE_GET_DATA_IDS(prefabs,       TESTAPP_DATA_PREFABS);
-    OSP_DECLARE_GET_DATA_IDS(signalsFloat,  TESTAPP_DATA_SIGNALS_FLOAT);
     OSP_DECLARE_GET_DATA_IDS(vehicleSpawn,  TESTAPP_DATA_VEHICLE_SPAWN);
     auto const tgPf     = prefabs       .get_pipelines<PlPrefabs>();
     auto const tgScn    = scene         .get_pipelines<PlScene>();
     auto const tgParts  = parts         .get_pipelines<PlParts>();
-    auto const tgSgFlt  = signalsFloat  .get_pipelines<PlSignalsFloat>();
     auto const tgVhSp   = vehicleSpawn  .get_pipelines<PlVehicleSpawn>();
 
     Session out;
@@ -254,90 +278,7 @@ Session setup_vehicle_spawn_vb(
         .args       ({             idVehicleSpawn,                    idVehicleSpawnVB,           idScnParts})
         .func([] (ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts) noexcept
     {
-        std::size_t const newVehicleCount = rVehicleSpawn.new_vehicle_count();
-        ACtxVehicleSpawnVB &rVSVB = rVehicleSpawnVB;
-
-        // Count total machines, and calculate offsets for remaps.
-
-        std::size_t machTotal = 0;
-        std::size_t remapMachTotal = 0;
-
-        rVSVB.machtypeCount.clear();
-        rVSVB.machtypeCount.resize(MachTypeReg_t::size(), 0);
-
-        rVSVB.remapMachOffsets.resize(newVehicleCount);
-
-        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
-        {
-            VehicleData const* pVData = rVSVB.dataVB[vhId];
-            if (pVData == nullptr)
-            {
-                continue;
-            }
-
-            Machines const &srcMachines = pVData->m_machines;
-            std::size_t const bounds = srcMachines.ids.capacity();
-
-            rVSVB.remapMachOffsets[vhId] = remapMachTotal;
-
-            remapMachTotal += bounds;
-            machTotal += srcMachines.ids.size();
-
-            for (MachTypeId type = 0; type < MachTypeReg_t::largest(); ++type)
-            {
-                rVSVB.machtypeCount[type] += srcMachines.perType[type].localIds.size();
-            }
-        }
-
-        rVehicleSpawn.spawnedMachs.resize(machTotal);
-        rVSVB.remapMachs.resize(remapMachTotal);
-
-        // Create ACtxParts MachAny/LocalIDs and populate remaps
-
-        // MachAnyIDs created here
-        rScnParts.machines.ids.create(rVehicleSpawn.spawnedMachs.begin(),
-                                      rVehicleSpawn.spawnedMachs.end());
-
-        rScnParts.machines.machToLocal.resize(rScnParts.machines.ids.capacity());
-
-        auto itDstMachIds = rVehicleSpawn.spawnedMachs.cbegin();
-
-        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
-        {
-            VehicleData const* pVData = rVSVB.dataVB[vhId];
-            if (pVData == nullptr)
-            {
-                continue;
-            }
-
-            Machines const &srcMachines = pVData->m_machines;
-
-            std::size_t const remapMachOffset = rVSVB.remapMachOffsets[vhId];
-
-            for (MachAnyId const srcMach : srcMachines.ids.bitview().zeros())
-            {
-                MachAnyId const dstMach = *itDstMachIds;
-                ++itDstMachIds;
-
-                // Populate map for "VehicleBuilder MachAnyId -> ACtxParts MachAnyId"
-                rVSVB.remapMachs[remapMachOffset + srcMach] = dstMach;
-
-                // Create ACtxParts MachLocalIds
-                // MachLocalIds don't need a remap, since they can be obtained
-                // from a MachAnyId.
-                // TODO: This can be optimized later, where all local IDs are
-                //       created at once with ids.create(first, last), and make
-                //       resize(..) called once per type too
-                MachTypeId const    type            = srcMachines.machTypes[srcMach];
-                PerMachType&        rDstPerType     = rScnParts.machines.perType[type];
-
-                MachLocalId const dstLocal = rDstPerType.localIds.create();
-                rDstPerType.localToAny.resize(rDstPerType.localIds.capacity());
-
-                rDstPerType.localToAny[dstLocal] = dstMach;
-                rScnParts.machines.machToLocal[dstMach] = dstLocal;
-            }
-        }
+        SysVehicleSpawnVB::create_machines(rVehicleSpawn, rVehicleSpawnVB, rScnParts);
     });
 
     rBuilder.task()
@@ -345,60 +286,10 @@ Session setup_vehicle_spawn_vb(
         .run_on     ({tgVhSp.spawnRequest(UseOrRun)})
         .sync_with  ({tgVhSpVB.dataVB(UseOrRun), tgVhSpVB.remapMachs(UseOrRun), tgVhSpVB.remapParts(UseOrRun), tgParts.mapPartMach(New)})
         .push_to    (out.m_tasks)
-        .args       ({             idVehicleSpawn,                          idVehicleSpawnVB,           idScnParts,             idPrefabs,           idResources})
-        .func([] (ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts, ACtxPrefabs& rPrefabs, Resources& rResources) noexcept
+        .args       ({                   idVehicleSpawn,                          idVehicleSpawnVB,           idScnParts})
+        .func([] (ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts) noexcept
     {
-        std::size_t const newVehicleCount = rVehicleSpawn.new_vehicle_count();
-        ACtxVehicleSpawnVB const& rVSVB = rVehicleSpawnVB;
-
-        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
-        {
-            VehicleData const* pVData = rVSVB.dataVB[vhId];
-            if (pVData == nullptr)
-            {
-                continue;
-            }
-
-            rScnParts.machineToPart.resize(rScnParts.machines.ids.capacity());
-            rScnParts.partToMachines.ids_reserve(rScnParts.partIds.capacity());
-            rScnParts.partToMachines.data_reserve(rScnParts.machines.ids.capacity());
-
-            std::size_t const remapMachOffset = rVSVB.remapMachOffsets[vhId];
-            std::size_t const remapPartOffset = rVSVB.remapPartOffsets[vhId];
-
-            // Update rScnParts machine->part map
-            for (MachAnyId const srcMach : pVData->m_machines.ids.bitview().zeros())
-            {
-                MachAnyId const dstMach = rVSVB.remapMachs[remapMachOffset + srcMach];
-                PartId const    srcPart = pVData->m_machToPart[srcMach];
-                PartId const    dstPart = rVSVB.remapParts[remapPartOffset + srcPart];
-
-                rScnParts.machineToPart[dstMach] = dstPart;
-            }
-
-            // Update rScnParts part->machine multimap
-            for (PartId const srcPart : pVData->m_partIds.bitview().zeros())
-            {
-                PartId const dstPart = rVSVB.remapParts[remapPartOffset + srcPart];
-
-                auto const& srcPairs = pVData->m_partToMachines[srcPart];
-
-                rScnParts.partToMachines.emplace(dstPart, srcPairs.size());
-                auto dstPairs = rScnParts.partToMachines[dstPart];
-
-                for (int i = 0; i < srcPairs.size(); ++i)
-                {
-                    MachinePair const&  srcPair  = srcPairs[i];
-                    MachinePair&        rDstPair = dstPairs[i];
-                    MachAnyId const     srcMach  = pVData->m_machines.perType[srcPair.type].localToAny[srcPair.local];
-                    MachAnyId const     dstMach  = rVSVB.remapMachs[remapMachOffset + srcMach];
-                    MachTypeId const    dstType  = srcPair.type;
-                    MachLocalId const   dstLocal = rScnParts.machines.machToLocal[dstMach];
-
-                    rDstPair = { .local = dstLocal, .type = dstType };
-                }
-            }
-        }
+        SysVehicleSpawnVB::update_part_machine_maps(rVehicleSpawn, rVehicleSpawnVB, rScnParts);
     });
 
     rBuilder.task()
@@ -406,53 +297,16 @@ Session setup_vehicle_spawn_vb(
         .run_on     ({tgVhSp.spawnRequest(UseOrRun)})
         .sync_with  ({tgVhSpVB.dataVB(UseOrRun), tgVhSpVB.remapMachs(UseOrRun), tgVhSpVB.remapNodes(Modify_), tgParts.nodeIds(New), tgParts.connect(New)})
         .push_to    (out.m_tasks)
-        .args       ({             idVehicleSpawn,                    idVehicleSpawnVB,           idScnParts})
-        .func([] (ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts) noexcept
+        .args       ({                   idVehicleSpawn,                    idVehicleSpawnVB,           idScnParts})
+        .func([] (ACtxVehicleSpawn const& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, ACtxParts& rScnParts) noexcept
     {
-        std::size_t const newVehicleCount = rVehicleSpawn.new_vehicle_count();
-        ACtxVehicleSpawnVB &rVSVB = rVehicleSpawnVB;
-
-        rVSVB.remapNodeOffsets.resize(newVehicleCount * NodeTypeReg_t::size());
-        auto remapNodeOffsets2d = rVSVB.remap_node_offsets_2d();
+        SysVehicleSpawnVB::create_nodes(rVehicleSpawn, rVehicleSpawnVB, rScnParts);
 
-        // Add up bounds needed for all nodes of every type for remaps
-        std::size_t remapNodeTotal = 0;
-        for (VehicleData const* pVData : rVSVB.dataVB)
+        // Add new connections to the flat copies read by machine and node update loops
+        for (NodeTypeId nodeType = 0; nodeType < NodeTypeReg_t::largest(); ++nodeType)
         {
-            if (pVData == nullptr)
-            {
-                continue;
-            }
-            for (PerNodeType const &rSrcNodeType : pVData->m_nodePerType)
-            {
-                remapNodeTotal += rSrcNodeType.nodeIds.capacity();
-            }
-        }
-        rVSVB.remapNodes.resize(remapNodeTotal);
-
-        std::size_t nodeRemapUsed = 0;
-
-        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
-        {
-            VehicleData const* pVData = rVSVB.dataVB[vhId];
-            if (pVData == nullptr)
-            {
-                continue;
-            }
-
-            auto machRemap = arrayView(std::as_const(rVSVB.remapMachs)).exceptPrefix(rVSVB.remapMachOffsets[vhId]);
-
-            for (NodeTypeId nodeType = 0; nodeType < NodeTypeReg_t::largest(); ++nodeType)
-            {
-                PerNodeType const &rSrcNodeType = pVData->m_nodePerType[nodeType];
-
-                std::size_t const remapSize = rSrcNodeType.nodeIds.capacity();
-                auto nodeRemapOut = arrayView(rVSVB.remapNodes).sliceSize(nodeRemapUsed, remapSize);
-                remapNodeOffsets2d[vhId.value][nodeType] = nodeRemapUsed;
-                nodeRemapUsed += remapSize;
-                copy_nodes(rSrcNodeType, pVData->m_machines, machRemap,
-                           rScnParts.nodePerType[nodeType], rScnParts.machines, nodeRemapOut);
-            }
+            compile_nodes_update(rScnParts.nodePerType[nodeType], rScnParts.machines,
+                                 rScnParts.nodeCompiledPerType[nodeType]);
         }
     });
 
@@ -476,63 +330,126 @@ Session setup_vehicle_spawn_vb(
             ActiveEnt const root = rPrefabs.spawnedEntsOffset[*itPrefab].front();
             ++itPrefab;
 
-            rScnParts.partToActive[partId]    = root;
+            rScnParts.partToActive[partId]    = SysActiveEnt::active_ent_ref(rBasic, root);
             rScnParts.activeToPart[root]      = partId;
         }
     });
 
     rBuilder.task()
-        .name       ("Copy float signal values from VehicleBuilder")
-        .run_on     ({tgVhSp.spawnRequest(UseOrRun)})
-        .sync_with  ({tgVhSp.spawnedParts(UseOrRun), tgVhSpVB.remapNodes(UseOrRun), tgSgFlt.sigFloatValues(New), tgSgFlt.sigFloatUpdExtIn(New)})
+        .name       ("Clear VehicleData vector after use")
+        .run_on     ({tgVhSp.spawnRequest(Clear)})
+        .sync_with  ({tgVhSpVB.dataVB(Clear)})
         .push_to    (out.m_tasks)
-        .args       ({             idVehicleSpawn,                          idVehicleSpawnVB,           idScnParts,                       idSigValFloat,                    idSigUpdFloat})
-        .func([] (ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts, SignalValues_t<float>& rSigValFloat, UpdateNodes<float>& rSigUpdFloat) noexcept
+        .args       ({               idVehicleSpawnVB})
+        .func([] (ACtxVehicleSpawnVB& rVehicleSpawnVB) noexcept
     {
-        Nodes const         &rFloatNodes    = rScnParts.nodePerType[gc_ntSigFloat];
-        std::size_t const   maxNodes        = rFloatNodes.nodeIds.capacity();
-        rSigUpdFloat.nodeNewValues.resize(maxNodes);
-        bitvector_resize(rSigUpdFloat.nodeDirty, maxNodes);
-        rSigValFloat.resize(maxNodes);
+        rVehicleSpawnVB.dataVB.clear();
+    });
 
-        std::size_t const           newVehicleCount     = rVehicleSpawn.new_vehicle_count();
-        ACtxVehicleSpawnVB const    &rVSVB              = rVehicleSpawnVB;
+    return out;
+} // setup_vehicle_spawn_vb
 
-        auto const remapNodeOffsets2d = rVSVB.remap_node_offsets_2d();
-        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
+Session setup_vehicle_build(
+        TopTaskBuilder&             rBuilder,
+        ArrayView<entt::any> const  topData,
+        Session const&              application,
+        Session const&              scene,
+        Session const&              vehicleSpawn,
+        Session const&              vehicleSpawnVB)
+{
+    OSP_DECLARE_GET_DATA_IDS(application,    TESTAPP_DATA_APPLICATION);
+    OSP_DECLARE_GET_DATA_IDS(vehicleSpawn,   TESTAPP_DATA_VEHICLE_SPAWN);
+    OSP_DECLARE_GET_DATA_IDS(vehicleSpawnVB, TESTAPP_DATA_VEHICLE_SPAWN_VB);
+    auto const tgScn    = scene         .get_pipelines<PlScene>();
+    auto const tgVhSp   = vehicleSpawn  .get_pipelines<PlVehicleSpawn>();
+    auto const tgVhSpVB = vehicleSpawnVB.get_pipelines<PlVehicleSpawnVB>();
+
+    Session out;
+    OSP_DECLARE_CREATE_DATA_IDS(out, topData, TESTAPP_DATA_VEHICLE_BUILD);
+
+    out.m_cleanup = tgScn.cleanup;
+
+    auto &rResources    = top_get< Resources >       (topData, idResources);
+    auto &rVehicleBuild = top_emplace< ACtxVehicleBuild >(topData, idVehicleBuild);
+
+    // Leave a thread for the main loop
+    std::size_t const workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1u;
+    rVehicleBuild.pService = std::make_unique<VehicleBuildService>(workerCount);
+    rVehicleBuild.pService->set_prefab_index(make_prefab_index(rResources));
+
+    rBuilder.task()
+        .name       ("Take vehicles built in the background and request to spawn them")
+        .run_on     ({tgScn.update(Run)})
+        .sync_with  ({tgVhSp.spawnRequest(Modify_), tgVhSpVB.dataVB(Modify_)})
+        .push_to    (out.m_tasks)
+        .args       ({             idVehicleBuild,                  idVehicleSpawn,                    idVehicleSpawnVB,           idResources})
+        .func([] (ACtxVehicleBuild& rVehicleBuild, ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB& rVehicleSpawnVB, Resources& rResources) noexcept
+    {
+        LGRN_ASSERTM(rVehicleBuild.spawning.empty(), "Vehicles taken last update were never released after spawning");
+
+        while (std::optional<VehicleBuildResult> result = rVehicleBuild.pService->poll())
         {
-            VehicleData const* pVData = rVSVB.dataVB[vhId];
-            if (pVData == nullptr)
+            create_prefab_owners(*result->pData, arrayView(std::as_const(result->prefabRefs)), rResources);
+
+            rVehicleSpawn.spawnRequest.push_back(result->spawn);
+            rVehicleSpawnVB.dataVB.push_back(result->pData.get());
+            rVehicleBuild.spawning.push_back(std::move(result->pData));
+        }
+    });
+
+    rBuilder.task()
+        .name       ("Release vehicles built in the background once they're done spawning")
+        .run_on     ({tgVhSp.spawnRequest(Clear)})
+        .sync_with  ({tgVhSpVB.dataVB(Clear)})
+        .push_to    (out.m_tasks)
+        .args       ({             idVehicleBuild,           idResources})
+        .func([] (ACtxVehicleBuild& rVehicleBuild, Resources& rResources) noexcept
+    {
+        // Scene parts hold their own owners by now
+        for (std::unique_ptr<VehicleData> &rpData : std::exchange(rVehicleBuild.spawning, {}))
+        {
+            for (osp::PrefabPair &rPrefabPair : rpData->m_partPrefabs)
             {
-                continue;
+                rResources.owner_destroy(gc_importer, std::move(rPrefabPair.m_importer));
             }
+        }
+    });
 
-            PerNodeType const&  srcFloatNodes       = pVData->m_nodePerType[gc_ntSigFloat];
-            entt::any const&    srcFloatValuesAny   = srcFloatNodes.m_nodeValues;
-            auto const&         srcFloatValues      = entt::any_cast< SignalValues_t<float> >(srcFloatValuesAny);
-            std::size_t const   nodeRemapOffset     = remapNodeOffsets2d[vhId.value][gc_ntSigFloat];
-            auto const          nodeRemap           = arrayView(rVSVB.remapNodes).exceptPrefix(nodeRemapOffset);
+    rBuilder.task()
+        .name       ("Stop VehicleBuildService and clear Resource owners")
+        .run_on     ({tgScn.cleanup(Run_)})
+        .push_to    (out.m_tasks)
+        .args       ({             idVehicleBuild,           idResources})
+        .func([] (ACtxVehicleBuild& rVehicleBuild, Resources& rResources) noexcept
+    {
+        rVehicleBuild.pService.reset();
 
-            for (NodeId const srcNode : srcFloatNodes.nodeIds.bitview().zeros())
+        for (std::unique_ptr<VehicleData> &rpData : std::exchange(rVehicleBuild.spawning, {}))
+        {
+            for (osp::PrefabPair &rPrefabPair : rpData->m_partPrefabs)
             {
-                NodeId const dstNode = nodeRemap[srcNode];
-                rSigValFloat[dstNode] = srcFloatValues[srcNode];
+                rResources.owner_destroy(gc_importer, std::move(rPrefabPair.m_importer));
             }
         }
     });
 
     return out;
-} // setup_vehicle_spawn_vb
+} // setup_vehicle_build
 
 Session setup_vehicle_spawn_draw(
         TopTaskBuilder&             rBuilder,
         ArrayView<entt::any> const  topData,
         Session const&              sceneRenderer,
+        Session const&              commonScene,
+        Session const&              parts,
         Session const&              vehicleSpawn)
 {
     OSP_DECLARE_GET_DATA_IDS(sceneRenderer, TESTAPP_DATA_SCENE_RENDERER);
+    OSP_DECLARE_GET_DATA_IDS(parts,         TESTAPP_DATA_PARTS);
     OSP_DECLARE_GET_DATA_IDS(vehicleSpawn,  TESTAPP_DATA_VEHICLE_SPAWN);
     auto const tgScnRdr = sceneRenderer .get_pipelines< PlSceneRenderer >();
+    auto const tgCS     = commonScene   .get_pipelines< PlCommonScene >();
+    auto const tgParts  = parts         .get_pipelines< PlParts >();
     auto const tgVhSp   = vehicleSpawn  .get_pipelines< PlVehicleSpawn >();
 
     Session out;
@@ -551,48 +468,137 @@ Session setup_vehicle_spawn_draw(
         }
     });
 
+    rBuilder.task()
+        .name       ("Enable Draw Transforms for root entities of split Welds")
+        .run_on     ({tgParts.weldSplit(UseOrRun)})
+        .sync_with  ({tgParts.mapWeldActive(Ready), tgCS.activeEntResized(Done), tgScnRdr.drawEntResized(Done)})
+        .push_to    (out.m_tasks)
+        .args       ({            idScnRender,                 idScnParts})
+        .func([] (ACtxSceneRender& rScnRender, ACtxParts const& rScnParts) noexcept
+    {
+        for (ACtxParts::WeldSplit const& split : rScnParts.weldSplitRequest)
+        {
+            if (split.newWeld != lgrn::id_null<WeldId>())
+            {
+                rScnRender.m_needDrawTf.set(std::size_t(rScnParts.weldToActive[split.newWeld]));
+            }
+        }
+    });
+
     return out;
 } // setup_vehicle_spawn_draw
 
 
-Session setup_signals_float(
+template <typename VALUE_T>
+Session setup_signals(
         TopTaskBuilder&             rBuilder,
         ArrayView<entt::any> const  topData,
         Session const&              scene,
-        Session const&              parts)
+        Session const&              parts,
+        Session const&              vehicleSpawn,
+        Session const&              vehicleSpawnVB)
 {
-    OSP_DECLARE_GET_DATA_IDS(parts, TESTAPP_DATA_PARTS);
-    auto const tgScn = scene.get_pipelines<PlScene>();
-    auto const tgParts = parts.get_pipelines<PlParts>();
+    OSP_DECLARE_GET_DATA_IDS(parts,             TESTAPP_DATA_PARTS);
+    OSP_DECLARE_GET_DATA_IDS(vehicleSpawn,      TESTAPP_DATA_VEHICLE_SPAWN);
+    OSP_DECLARE_GET_DATA_IDS(vehicleSpawnVB,    TESTAPP_DATA_VEHICLE_SPAWN_VB);
+    auto const tgScn    = scene         .get_pipelines<PlScene>();
+    auto const tgParts  = parts         .get_pipelines<PlParts>();
+    auto const tgVhSp   = vehicleSpawn  .get_pipelines<PlVehicleSpawn>();
+    auto const tgVhSpVB = vehicleSpawnVB.get_pipelines<PlVehicleSpawnVB>();
 
     Session out;
-    OSP_DECLARE_CREATE_DATA_IDS(out, topData, TESTAPP_DATA_SIGNALS_FLOAT);
-    auto const tgSgFlt = out.create_pipelines<PlSignalsFloat>(rBuilder);
+    OSP_DECLARE_CREATE_DATA_IDS(out, topData, TESTAPP_DATA_SIGNALS);
+    auto const tgSig = out.create_pipelines< PlSignals<VALUE_T> >(rBuilder);
 
-    rBuilder.pipeline(tgSgFlt.sigFloatValues)   .parent(tgScn.update);
-    rBuilder.pipeline(tgSgFlt.sigFloatUpdExtIn) .parent(tgScn.update);
-    rBuilder.pipeline(tgSgFlt.sigFloatUpdLoop)  .parent(tgParts.linkLoop);
+    rBuilder.pipeline(tgSig.sigValues)      .parent(tgScn.update);
+    rBuilder.pipeline(tgSig.sigUpdExtIn)    .parent(tgScn.update);
+    rBuilder.pipeline(tgSig.sigUpdLoop)     .parent(tgParts.linkLoop);
 
-    top_emplace< SignalValues_t<float> >    (topData, idSigValFloat);
-    top_emplace< UpdateNodes<float> >       (topData, idSigUpdFloat);
+    top_emplace< SignalValues_t<VALUE_T> >  (topData, idSigVal);
+    top_emplace< UpdateNodes<VALUE_T> >     (topData, idSigUpd);
+    top_emplace< SignalGraph >              (topData, idSigGraph);
+    top_emplace< UpdateNodesConcurrent<VALUE_T> >(topData, idSigUpdConc);
+    auto &rSigMachFuncs = top_emplace< MachineUpdateFuncs >(topData, idSigMachFuncs);
 
-    // NOTE: Consider supporting per-thread UpdateNodes<float> to allow multiple threads to write
-    //       new float values in parallel.
+    // Machine sessions register their update functions into this
+    rSigMachFuncs.perType.resize(MachTypeReg_t::size());
+
+    // Tasks that may run in parallel with other writers (eg. external inputs in sigUpdExtIn(Modify)
+    // such as "Write inputs to UserControl Machines", or MachUpd tasks of different machine types)
+    // write into idSigUpdConc instead of idSigUpd, using their WorkerContext::workerIndex.
+    // These writes are merged into idSigUpd at the start of the next NodeUpd.
 
     rBuilder.task()
-        .name       ("Update Signal<float> Nodes")
+        .name       ("Copy signal values from VehicleBuilder")
+        .run_on     ({tgVhSp.spawnRequest(UseOrRun)})
+        .sync_with  ({tgVhSp.spawnedParts(UseOrRun), tgVhSpVB.remapNodes(UseOrRun), tgSig.sigValues(New), tgSig.sigUpdExtIn(New)})
+        .push_to    (out.m_tasks)
+        .args       ({             idVehicleSpawn,                          idVehicleSpawnVB,           idScnParts,                         idSigVal,                      idSigUpd,             idSigGraph,                                idSigUpdConc})
+        .func([] (ACtxVehicleSpawn& rVehicleSpawn, ACtxVehicleSpawnVB const& rVehicleSpawnVB, ACtxParts& rScnParts, SignalValues_t<VALUE_T>& rSigVal, UpdateNodes<VALUE_T>& rSigUpd, SignalGraph& rSigGraph, UpdateNodesConcurrent<VALUE_T>& rSigUpdConc) noexcept
+    {
+        NodeTypeId const    nodeType        = signal_node_type<VALUE_T>();
+        Nodes const         &rNodes         = rScnParts.nodePerType[nodeType];
+        std::size_t const   maxNodes        = rNodes.nodeIds.capacity();
+        rSigUpd.nodeNewValues.resize(maxNodes);
+        bitvector_resize(rSigUpd.nodeDirty, maxNodes);
+        rSigVal.resize(maxNodes);
+        rSigUpdConc.resize(maxNodes, std::max(1u, std::thread::hardware_concurrency()));
+
+        std::size_t const           newVehicleCount     = rVehicleSpawn.new_vehicle_count();
+        ACtxVehicleSpawnVB const    &rVSVB              = rVehicleSpawnVB;
+
+        auto const remapNodeOffsets2d = rVSVB.remap_node_offsets_2d();
+        for (SpVehicleId vhId{0}; vhId.value < newVehicleCount; ++vhId.value)
+        {
+            VehicleData const* pVData = rVSVB.dataVB[vhId];
+            if (pVData == nullptr)
+            {
+                continue;
+            }
+
+            PerNodeType const&  srcNodes        = pVData->m_nodePerType[nodeType];
+            auto const*         pSrcValues      = entt::any_cast< SignalValues_t<VALUE_T> >(&srcNodes.m_nodeValues);
+            if (pSrcValues == nullptr)
+            {
+                continue; // Vehicle doesn't use this type of signal
+            }
+
+            std::size_t const   nodeRemapOffset = remapNodeOffsets2d[vhId.value][nodeType];
+            auto const          nodeRemap       = arrayView(rVSVB.remapNodes).exceptPrefix(nodeRemapOffset);
+
+            for (NodeId const srcNode : srcNodes.nodeIds.bitview().zeros())
+            {
+                NodeId const dstNode = nodeRemap[srcNode];
+                rSigVal[dstNode] = (*pSrcValues)[srcNode];
+            }
+        }
+
+        // New Machines and Nodes were connected, dependency order must be recalculated
+        rSigGraph.dirty = true;
+    });
+
+    rBuilder.task()
+        .name       ("Update Signal Nodes")
         .run_on     ({tgParts.linkLoop(EStgLink::NodeUpd)})
-        .sync_with  ({tgSgFlt.sigFloatUpdExtIn(Ready), tgParts.machUpdExtIn(Ready), tgSgFlt.sigFloatUpdLoop(Modify), tgSgFlt.sigFloatValues(Modify)})
+        .sync_with  ({tgSig.sigUpdExtIn(Ready), tgParts.machUpdExtIn(Ready), tgSig.sigUpdLoop(Modify), tgSig.sigValues(Modify)})
         .push_to    (out.m_tasks)
-        .args       ({               idSigUpdFloat,                       idSigValFloat,                idUpdMach,                 idScnParts})
-        .func([] (UpdateNodes<float>& rSigUpdFloat, SignalValues_t<float>& rSigValFloat, MachineUpdater& rUpdMach, ACtxParts const& rScnParts) noexcept
+        .args       ({                 idSigUpd,                         idSigVal,                idUpdMach,                 idScnParts,             idSigGraph,                    idSigMachFuncs,                                idSigUpdConc})
+        .func([] (UpdateNodes<VALUE_T>& rSigUpd, SignalValues_t<VALUE_T>& rSigVal, MachineUpdater& rUpdMach, ACtxParts const& rScnParts, SignalGraph& rSigGraph, MachineUpdateFuncs& rSigMachFuncs, UpdateNodesConcurrent<VALUE_T>& rSigUpdConc) noexcept
     {
-        if ( ! rSigUpdFloat.dirty )
+        // Collect values written by parallel tasks since the previous NodeUpd
+        rSigUpdConc.merge_into(rSigUpd);
+
+        if ( ! rSigUpd.dirty )
         {
             return; // Not dirty, nothing to do
         }
 
-        Nodes const &rFloatNodes = rScnParts.nodePerType[gc_ntSigFloat];
+        CompiledNodes const &rNodes = rScnParts.nodeCompiledPerType[signal_node_type<VALUE_T>()];
+
+        if (rSigGraph.dirty)
+        {
+            SysSignalGraph::build(rSigGraph, rNodes, rScnParts.machines);
+        }
 
         // NOTE: The various use of reset() clear entire bit arrays, which may or may
         //       not be expensive. They likely optimize to memset
@@ -603,32 +609,30 @@ Session setup_signals_float(
         }
         rUpdMach.machTypesDirty.reset();
 
-        // Sees which nodes changed, and writes into rUpdMach set dirty which MACHINES
-        // must be updated next
-        update_signal_nodes<float>(
-                rSigUpdFloat.nodeDirty.ones(),
-                rFloatNodes.nodeToMach,
+        // Apply node changes, then update machines with registered functions in dependency
+        // order. Chains of machines settle here within a single link loop iteration. Machine
+        // types without a function are left marked in rUpdMach for their MachUpd tasks.
+        bool const cyclesPending = propagate_signals<VALUE_T>(
+                rSigGraph,
+                rSigMachFuncs,
+                rNodes,
                 rScnParts.machines,
-                arrayView(rSigUpdFloat.nodeNewValues),
-                rSigValFloat,
+                rSigUpd,
+                rSigVal,
                 rUpdMach);
-        rSigUpdFloat.nodeDirty.reset();
-        rSigUpdFloat.dirty = false;
 
-        // Run tasks needed to update machine types that are dirty
-        bool anyMachineNotified = false;
-        for (MachTypeId const type : rUpdMach.machTypesDirty.ones())
-        {
-            anyMachineNotified = true;
-        }
-        if (anyMachineNotified && rUpdMach.requestMachineUpdateLoop.load())
+        if (cyclesPending)
         {
             rUpdMach.requestMachineUpdateLoop.store(true);
         }
     });
 
     return out;
-} // setup_signals_float
+} // setup_signals
+
+template Session setup_signals<float>  (TopTaskBuilder&, ArrayView<entt::any>, Session const&, Session const&, Session const&, Session const&);
+template Session setup_signals<int32_t>(TopTaskBuilder&, ArrayView<entt::any>, Session const&, Session const&, Session const&, Session const&);
+template Session setup_signals<bool>   (TopTaskBuilder&, ArrayView<entt::any>, Session const&, Session const&, Session const&, Session const&);
 
 
 } // namespace testapp::scenes
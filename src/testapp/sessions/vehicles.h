@@ -39,7 +39,11 @@ osp::Session setup_parts(
         osp::Session const&         scene);
 
 /**
- * @brief Float Signal Links, allowing Machines to pass floats to each other
+ * @brief Signal Links, allowing Machines to pass values of VALUE_T to each other
+ *
+ * Instantiated for float, int32_t, and bool. Each value type has its own Node type (see
+ * osp::link::signal_node_type), values, UpdateNodes, and tasks. Use TESTAPP_DATA_SIGNALS and
+ * PlSignals<VALUE_T> to access them, or TESTAPP_DATA_SIGNALS_FLOAT for float.
  *
  * Setup:
  * * Each machine type provides an update event tag in idMachEvtTags.
@@ -67,11 +71,14 @@ osp::Session setup_parts(
  * eg. A float signal can trigger a fuel valve that triggers a pressure sensor which outputs
  *     another float signal, all running within a single frame.
  */
-osp::Session setup_signals_float(
+template <typename VALUE_T>
+osp::Session setup_signals(
         osp::TopTaskBuilder&        rBuilder,
         osp::ArrayView<entt::any>   topData,
         osp::Session const&         scene,
-        osp::Session const&         parts);
+        osp::Session const&         parts,
+        osp::Session const&         vehicleSpawn,
+        osp::Session const&         vehicleSpawnVB);
 
 /**
  * @brief Links for Magic Rockets
@@ -110,6 +117,8 @@ osp::Session setup_vehicle_spawn_draw(
         osp::TopTaskBuilder&        rBuilder,
         osp::ArrayView<entt::any>   topData,
         osp::Session const&         sceneRenderer,
+        osp::Session const&         commonScene,
+        osp::Session const&         parts,
         osp::Session const&         vehicleSpawn);
 
 /**
@@ -123,9 +132,20 @@ osp::Session setup_vehicle_spawn_vb(
         osp::Session const&         commonScene,
         osp::Session const&         prefabs,
         osp::Session const&         parts,
-        osp::Session const&         vehicleSpawn,
-        osp::Session const&         signalsFloat);
-
+        osp::Session const&         vehicleSpawn);
 
+/**
+ * @brief Build vehicles on worker threads with VehicleBuildService, and spawn them once done
+ *
+ * Push VehicleBuildJobs to ACtxVehicleBuild::pService. Finished vehicles are added to
+ * ACtxVehicleSpawn::spawnRequest and ACtxVehicleSpawnVB::dataVB at the start of a scene update.
+ */
+osp::Session setup_vehicle_build(
+        osp::TopTaskBuilder&        rBuilder,
+        osp::ArrayView<entt::any>   topData,
+        osp::Session const&         application,
+        osp::Session const&         scene,
+        osp::Session const&         vehicleSpawn,
+        osp::Session const&         vehicleSpawnVB);
 
 }
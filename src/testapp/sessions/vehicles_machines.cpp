@@ -34,6 +34,7 @@
 #include <osp/core/Resources.h>
 #include <osp/drawing/drawing.h>
 #include <osp/drawing/drawing_fn.h>
+#include <osp/link/signal_propagation.h>
 #include <osp/util/UserInputHandler.h>
 
 using namespace adera;
@@ -154,7 +155,7 @@ Session setup_thrust_indicators(
             DrawEnt& rDrawEnt = rThrustIndicator.rktToDrawEnt[localId];
             if (rDrawEnt == lgrn::id_null<DrawEnt>())
             {
-                rDrawEnt = rScnRender.m_drawIds.create();
+                rDrawEnt = SysRender::create_draw_ent(rScnRender);
             }
         }
     });
@@ -162,10 +163,10 @@ Session setup_thrust_indicators(
     rBuilder.task()
         .name       ("Add mesh and materials to Thrust indicators")
         .run_on     ({tgWin.sync(Run)})
-        .sync_with  ({tgScnRdr.drawEntResized(Done), tgScnRdr.drawEnt(Ready), tgScnRdr.entMesh(New), tgScnRdr.material(New), tgScnRdr.materialDirty(Modify_), tgScnRdr.entMeshDirty(Modify_)})
+        .sync_with  ({tgScnRdr.drawEntResized(Done), tgScnRdr.drawEnt(Ready), tgScnRdr.entMesh(New), tgScnRdr.material(New), tgScnRdr.materialDirty(Modify_), tgScnRdr.entMeshDirty(Modify_), tgScnRdr.drawTfObservers(New)})
         .push_to    (out.m_tasks)
-        .args       ({         idBasic,                 idScnRender,             idDrawing,                      idDrawingRes,                 idScnParts,                             idSigValFloat,                 idThrustIndicator})
-        .func([]    (ACtxBasic& rBasic, ACtxSceneRender &rScnRender, ACtxDrawing& rDrawing, ACtxDrawingRes const& rDrawingRes, ACtxParts const& rScnParts, SignalValues_t<float> const& rSigValFloat, ThrustIndicator& rThrustIndicator) noexcept
+        .args       ({         idBasic,                 idScnRender,                 idDrawTfObservers,             idDrawing,                      idDrawingRes,                 idScnParts,                             idSigValFloat,                 idThrustIndicator})
+        .func([]    (ACtxBasic& rBasic, ACtxSceneRender &rScnRender, DrawTfObservers& rDrawTfObservers, ACtxDrawing& rDrawing, ACtxDrawingRes const& rDrawingRes, ACtxParts const& rScnParts, SignalValues_t<float> const& rSigValFloat, ThrustIndicator& rThrustIndicator) noexcept
     {
         Material            &rMat           = rScnRender.m_materials[rThrustIndicator.material];
         PerMachType const   &rockets        = rScnParts.machines.perType[gc_mtMagicRocket];
@@ -177,7 +178,7 @@ Session setup_thrust_indicators(
 
             MachAnyId const anyId           = rockets.localToAny[localId];
             PartId const    part            = rScnParts.machineToPart[anyId];
-            ActiveEnt const partEnt         = rScnParts.partToActive[part];
+            ActiveEnt const partEnt         = rScnParts.partToActive[part].ent;
 
             auto const&     portSpan        = floats.machToNode[anyId];
             NodeId const    throttleIn      = connected_node(portSpan, ports_magicrocket::gc_throttleIn.port);
@@ -209,8 +210,8 @@ Session setup_thrust_indicators(
             rScnRender.m_visible.set(drawEnt.value);
             rScnRender.m_opaque .set(drawEnt.value);
 
-            rScnRender.m_color              [drawEnt] = rThrustIndicator.color;
-            rScnRender.drawTfObserverEnable [partEnt] = 1;
+            rScnRender.m_color[drawEnt] = rThrustIndicator.color;
+            SysRender::observe_draw_tf(rDrawTfObservers, 0, partEnt);
 
             SysRender::needs_draw_transforms(rBasic.m_scnGraph, rScnRender.m_needDrawTf, partEnt);
         }
@@ -221,37 +222,38 @@ Session setup_thrust_indicators(
     DrawTfObservers::Observer &rObserver = rDrawTfObservers.observers[0];
 
     rObserver.data = { &rThrustIndicator, &rScnParts, &rSigValFloat };
-    rObserver.func = [] (ACtxSceneRender& rCtxScnRdr, Matrix4 const& drawTf, active::ActiveEnt ent, int depth, UserData_t data) noexcept
+    rObserver.func = [] (ACtxSceneRender& rCtxScnRdr, ArrayView<ActiveEnt const> ents, ArrayView<Matrix4 const> drawTfs, UserData_t data) noexcept
     {
         auto &rThrustIndicator          = *static_cast< ThrustIndicator* >          (data[0]);
         auto &rScnParts                 = *static_cast< ACtxParts* >                (data[1]);
         auto &rSigValFloat              = *static_cast< SignalValues_t<float>* >    (data[2]);
 
-        PerMachType const   &rockets    = rScnParts.machines.perType[gc_mtMagicRocket];
-        Nodes const         &floats     = rScnParts.nodePerType[gc_ntSigFloat];
+        auto const &rktPorts = rScnParts.nodeCompiledPerType[gc_ntSigFloat].perMachType[gc_mtMagicRocket];
 
-        PartId const        part        = rScnParts.activeToPart[ent];
-        ActiveEnt const     partEnt     = rScnParts.partToActive[part];
-
-        for (MachinePair const pair : rScnParts.partToMachines[part])
-        if (pair.type == gc_mtMagicRocket)
+        for (std::size_t i = 0; i < ents.size(); ++i)
         {
-            DrawEnt const   drawEnt         = rThrustIndicator.rktToDrawEnt[pair.local];
-            MachAnyId const anyId           = rockets.localToAny[pair.local];
+            Matrix4 const       &drawTf     = drawTfs[i];
+            PartId const        part        = rScnParts.activeToPart[ents[i]];
 
-            auto const&     portSpan        = floats.machToNode[anyId];
-            NodeId const    throttleIn      = connected_node(portSpan, ports_magicrocket::gc_throttleIn.port);
-            NodeId const    multiplierIn    = connected_node(portSpan, ports_magicrocket::gc_multiplierIn.port);
+            for (MachinePair const pair : rScnParts.partToMachines[part])
+            if (pair.type == gc_mtMagicRocket)
+            {
+                DrawEnt const   drawEnt         = rThrustIndicator.rktToDrawEnt[pair.local];
 
-            float const     throttle        = std::clamp(rSigValFloat[throttleIn], 0.0f, 1.0f);
-            float const     multiplier      = rSigValFloat[multiplierIn];
-            float const     thrustMag       = throttle * multiplier;
+                auto const      ports           = rktPorts.ports(pair.local);
+                NodeId const    throttleIn      = connected_node(ports, ports_magicrocket::gc_throttleIn.port);
+                NodeId const    multiplierIn    = connected_node(ports, ports_magicrocket::gc_multiplierIn.port);
+
+                float const     throttle        = std::clamp(rSigValFloat[throttleIn], 0.0f, 1.0f);
+                float const     multiplier      = rSigValFloat[multiplierIn];
+                float const     thrustMag       = throttle * multiplier;
 
-            rCtxScnRdr.m_drawTransform[drawEnt]
-                    = drawTf
-                    * Matrix4::scaling({1.0f, 1.0f, thrustMag * rThrustIndicator.indicatorScale})
-                    * Matrix4::translation({0.0f, 0.0f, -1.0f})
-                    * Matrix4::scaling({0.2f, 0.2f, 1.0f});
+                rCtxScnRdr.m_drawTransform[drawEnt]
+                        = drawTf
+                        * Matrix4::scaling({1.0f, 1.0f, thrustMag * rThrustIndicator.indicatorScale})
+                        * Matrix4::translation({0.0f, 0.0f, -1.0f})
+                        * Matrix4::scaling({0.2f, 0.2f, 1.0f});
+            }
         }
     };
 
@@ -296,21 +298,37 @@ Session setup_mach_rcsdriver(
         rUpdMach.localDirty[gc_mtRcsDriver].ints().resize(rScnParts.machines.perType[gc_mtRcsDriver].localIds.vec().capacity());
     });
 
-    rBuilder.task()
-        .name       ("RCS Drivers calculate new values")
-        .run_on     ({tgParts.linkLoop(MachUpd)})
-        .sync_with  ({tgParts.machUpdExtIn(Ready)})
-        .push_to    (out.m_tasks)
-        .args       ({      idScnParts,                idUpdMach,                       idSigValFloat,                    idSigUpdFloat})
-        .func([] (ACtxParts& rScnParts, MachineUpdater& rUpdMach, SignalValues_t<float>& rSigValFloat, UpdateNodes<float>& rSigUpdFloat) noexcept
+    auto &rScnParts     = top_get< ACtxParts >              (topData, idScnParts);
+    auto &rSigValFloat  = top_get< SignalValues_t<float> >  (topData, idSigValFloat);
+    auto &rSigUpdFloat  = top_get< UpdateNodes<float> >     (topData, idSigUpdFloat);
+    auto &rSigMachFuncs = top_get< MachineUpdateFuncs >     (topData, idSigMachFuncs);
+
+    auto const [idRcsBatch] = out.acquire_data<1>(topData);
+    auto &rRcsBatch = top_emplace< RcsDriverBatch >(topData, idRcsBatch);
+
+    // RCS Drivers are updated while float signals propagate, so their outputs are ready for the
+    // machines they drive within the same link loop iteration.
+    using UserData_t = MachineUpdateFuncs::UserData_t;
+
+    MachineUpdateFuncs::Entry &rEntry = rSigMachFuncs.perType[gc_mtRcsDriver];
+
+    rEntry.data = { &rScnParts, &rSigValFloat, &rSigUpdFloat, &rRcsBatch };
+    rEntry.func = [] (ArrayView<MachLocalId const> locals, UserData_t data) noexcept
     {
-        Nodes const &rFloatNodes = rScnParts.nodePerType[gc_ntSigFloat];
-        PerMachType &rRockets    = rScnParts.machines.perType[gc_mtRcsDriver];
+        auto &rScnParts     = *static_cast< ACtxParts* >                (data[0]);
+        auto &rSigValFloat  = *static_cast< SignalValues_t<float>* >    (data[1]);
+        auto &rSigUpdFloat  = *static_cast< UpdateNodes<float>* >       (data[2]);
+        auto &rRcsBatch     = *static_cast< RcsDriverBatch* >           (data[3]);
 
-        for (MachLocalId const local : rUpdMach.localDirty[gc_mtRcsDriver].ones())
+        auto const &rRcsPorts = rScnParts.nodeCompiledPerType[gc_ntSigFloat].perMachType[gc_mtRcsDriver];
+
+        // Gather inputs of RCS Drivers with a connected throttle output into SoA arrays
+        rRcsBatch.resize(locals.size());
+        std::size_t count = 0;
+
+        for (MachLocalId const local : locals)
         {
-            MachAnyId const mach     = rRockets.localToAny[local];
-            auto const      portSpan = lgrn::Span<NodeId const>{rFloatNodes.machToNode[mach]};
+            ArrayView<NodeId const> const portSpan = rRcsPorts.ports(local);
 
             NodeId const thrNode = connected_node(portSpan, ports_rcsdriver::gc_throttleOut.port);
             if (thrNode == lgrn::id_null<NodeId>())
@@ -318,48 +336,50 @@ Session setup_mach_rcsdriver(
                 continue; // Throttle Output not connected, calculations below are useless
             }
 
-            auto const rcs_read = [&rSigValFloat, portSpan] (float& rDstVar, PortEntry const& entry)
+            auto const rcs_read = [&rSigValFloat, portSpan, count] (std::vector<float>& rDstVec, PortEntry const& entry)
             {
                 NodeId const node = connected_node(portSpan, entry.port);
 
-                if (node != lgrn::id_null<NodeId>())
-                {
-                    rDstVar = rSigValFloat[node];
-                }
+                rDstVec[count] = (node != lgrn::id_null<NodeId>()) ? rSigValFloat[node] : 0.0f;
             };
 
-            Vector3 pos     {0.0f};
-            Vector3 dir     {0.0f};
-            Vector3 cmdLin  {0.0f};
-            Vector3 cmdAng  {0.0f};
-
-            rcs_read( pos.x(),    ports_rcsdriver::gc_posXIn    );
-            rcs_read( pos.y(),    ports_rcsdriver::gc_posYIn    );
-            rcs_read( pos.z(),    ports_rcsdriver::gc_posZIn    );
-            rcs_read( dir.x(),    ports_rcsdriver::gc_dirXIn    );
-            rcs_read( dir.y(),    ports_rcsdriver::gc_dirYIn    );
-            rcs_read( dir.z(),    ports_rcsdriver::gc_dirZIn    );
-            rcs_read( cmdLin.x(), ports_rcsdriver::gc_cmdLinXIn );
-            rcs_read( cmdLin.y(), ports_rcsdriver::gc_cmdLinYIn );
-            rcs_read( cmdLin.z(), ports_rcsdriver::gc_cmdLinZIn );
-            rcs_read( cmdAng.x(), ports_rcsdriver::gc_cmdAngXIn );
-            rcs_read( cmdAng.y(), ports_rcsdriver::gc_cmdAngYIn );
-            rcs_read( cmdAng.z(), ports_rcsdriver::gc_cmdAngZIn );
-
-            OSP_LOG_TRACE("RCS controller {} pitch = {}", local, cmdAng.x());
-            OSP_LOG_TRACE("RCS controller {} yaw = {}", local, cmdAng.y());
-            OSP_LOG_TRACE("RCS controller {} roll = {}", local, cmdAng.z());
-
-            float const thrCurr = rSigValFloat[thrNode];
-            float const thrNew = thruster_influence(pos, dir, cmdLin, cmdAng);
-
-            if (thrCurr != thrNew)
+            rcs_read( rRcsBatch.posX,     ports_rcsdriver::gc_posXIn    );
+            rcs_read( rRcsBatch.posY,     ports_rcsdriver::gc_posYIn    );
+            rcs_read( rRcsBatch.posZ,     ports_rcsdriver::gc_posZIn    );
+            rcs_read( rRcsBatch.dirX,     ports_rcsdriver::gc_dirXIn    );
+            rcs_read( rRcsBatch.dirY,     ports_rcsdriver::gc_dirYIn    );
+            rcs_read( rRcsBatch.dirZ,     ports_rcsdriver::gc_dirZIn    );
+            rcs_read( rRcsBatch.cmdLinX,  ports_rcsdriver::gc_cmdLinXIn );
+            rcs_read( rRcsBatch.cmdLinY,  ports_rcsdriver::gc_cmdLinYIn );
+            rcs_read( rRcsBatch.cmdLinZ,  ports_rcsdriver::gc_cmdLinZIn );
+            rcs_read( rRcsBatch.cmdAngX,  ports_rcsdriver::gc_cmdAngXIn );
+            rcs_read( rRcsBatch.cmdAngY,  ports_rcsdriver::gc_cmdAngYIn );
+            rcs_read( rRcsBatch.cmdAngZ,  ports_rcsdriver::gc_cmdAngZIn );
+
+            OSP_LOG_TRACE("RCS controller {} pitch = {}", local, rRcsBatch.cmdAngX[count]);
+            OSP_LOG_TRACE("RCS controller {} yaw = {}", local, rRcsBatch.cmdAngY[count]);
+            OSP_LOG_TRACE("RCS controller {} roll = {}", local, rRcsBatch.cmdAngZ[count]);
+
+            rRcsBatch.locals[count]   = local;
+            rRcsBatch.thrNodes[count] = thrNode;
+            ++count;
+        }
+
+        rRcsBatch.resize(count);
+
+        thruster_influence_batch(rRcsBatch);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            NodeId const thrNode = rRcsBatch.thrNodes[i];
+            float const  thrNew  = rRcsBatch.thrOut[i];
+
+            if (rSigValFloat[thrNode] != thrNew)
             {
                 rSigUpdFloat.assign(thrNode, thrNew);
-                rUpdMach.requestMachineUpdateLoop = true;
             }
         }
-    });
+    };
 
     return out;
 } // setup_mach_rcsdriver
@@ -382,6 +402,7 @@ struct VehicleControls
     input::EButtonControlIndex btnYawRt;
     input::EButtonControlIndex btnRollLf;
     input::EButtonControlIndex btnRollRt;
+    input::EButtonControlIndex btnStage;
 };
 
 Session setup_vehicle_control(
@@ -398,6 +419,7 @@ Session setup_vehicle_control(
     OSP_DECLARE_GET_DATA_IDS(signalsFloat,  TESTAPP_DATA_SIGNALS_FLOAT);
     auto const tgWin    = windowApp     .get_pipelines<PlWindowApp>();
     auto const tgScn    = scene         .get_pipelines<PlScene>();
+    auto const tgParts  = parts         .get_pipelines<PlParts>();
     auto const tgSgFlt  = signalsFloat  .get_pipelines<PlSignalsFloat>();
 
     Session out;
@@ -420,7 +442,8 @@ Session setup_vehicle_control(
         .btnYawLf   = rUserInput.button_subscribe("vehicle_yaw_lf"),
         .btnYawRt   = rUserInput.button_subscribe("vehicle_yaw_rt"),
         .btnRollLf  = rUserInput.button_subscribe("vehicle_roll_lf"),
-        .btnRollRt  = rUserInput.button_subscribe("vehicle_roll_rt")
+        .btnRollRt  = rUserInput.button_subscribe("vehicle_roll_rt"),
+        .btnStage   = rUserInput.button_subscribe("vehicle_stage")
     });
 
     rBuilder.task()
@@ -460,14 +483,42 @@ Session setup_vehicle_control(
         }
     });
 
+    rBuilder.task()
+        .name       ("Split the selected UserControl's part into its own Weld")
+        .run_on     ({tgScn.update(Run)})
+        .sync_with  ({tgWin.inputs(Run), tgParts.weldSplit(Modify_)})
+        .push_to    (out.m_tasks)
+        .args       ({      idScnParts,                               idUserInput,                       idVhControls})
+        .func([] (ACtxParts& rScnParts, input::UserInputHandler const &rUserInput, VehicleControls const& rVhControls) noexcept
+    {
+        if (   rVhControls.selectedUsrCtrl == lgrn::id_null<MachLocalId>()
+            || ! rUserInput.button_state(rVhControls.btnStage).m_triggered )
+        {
+            return;
+        }
+
+        PerMachType const&  rUsrCtrls   = rScnParts.machines.perType[gc_mtUserCtrl];
+        MachAnyId const     mach        = rUsrCtrls.localToAny[rVhControls.selectedUsrCtrl];
+        PartId const        part        = rScnParts.machineToPart[mach];
+        WeldId const        weld        = rScnParts.partToWeld[part];
+
+        if (rScnParts.weldToParts[weld].size() < 2)
+        {
+            return; // Nothing left to separate from
+        }
+
+        rScnParts.weldSplitRequest.push_back({ .parts = {part} });
+    });
+
     rBuilder.task()
         .name       ("Write inputs to UserControl Machines")
         .run_on     ({tgScn.update(Run)})
-        .sync_with  ({tgWin.inputs(Run), tgSgFlt.sigFloatUpdExtIn(Modify)})
+        .sync_with  ({tgWin.inputs(Run), tgSgFlt.sigUpdExtIn(Modify)})
         .push_to    (out.m_tasks)
-        .args       ({      idScnParts,                idUpdMach,                       idSigValFloat,                    idSigUpdFloat,                               idUserInput,                 idVhControls,           idDeltaTimeIn})
-        .func([] (ACtxParts& rScnParts, MachineUpdater& rUpdMach, SignalValues_t<float>& rSigValFloat, UpdateNodes<float>& rSigUpdFloat, input::UserInputHandler const& rUserInput, VehicleControls& rVhControls, float const deltaTimeIn) noexcept
+        .args       ({      idScnParts,                idUpdMach,                       idSigValFloat,                         idSigUpdConcFloat,                               idUserInput,                 idVhControls,           idDeltaTimeIn})
+        .func([] (ACtxParts& rScnParts, MachineUpdater& rUpdMach, SignalValues_t<float>& rSigValFloat, UpdateNodesConcurrent<float>& rSigUpdConc, input::UserInputHandler const& rUserInput, VehicleControls& rVhControls, float const deltaTimeIn, WorkerContext ctx) noexcept
     {
+        // Other tasks may write external signal inputs in the same stage, on other workers
         VehicleControls& rVC = rVhControls;
         auto const held = [&rUserInput] (input::EButtonControlIndex idx, float val) -> float
         {
@@ -498,7 +549,7 @@ Session setup_vehicle_control(
         auto const      portSpan    = lgrn::Span<NodeId const>{rFloatNodes.machToNode[mach]};
 
         bool changed = false;
-        auto const write_control = [&rSigValFloat, &rSigUpdFloat, &changed, portSpan] (PortEntry const& entry, float write, bool replace = true, float min = 0.0f, float max = 1.0f)
+        auto const write_control = [&rSigValFloat, &rSigUpdConc, &changed, portSpan, worker = ctx.workerIndex] (PortEntry const& entry, float write, bool replace = true, float min = 0.0f, float max = 1.0f)
         {
             NodeId const node = connected_node(portSpan, entry.port);
             if (node == lgrn::id_null<NodeId>())
@@ -511,7 +562,7 @@ Session setup_vehicle_control(
 
             if (oldVal != newVal)
             {
-                rSigUpdFloat.assign(node, newVal);
+                rSigUpdConc.assign(worker, node, newVal);
                 changed = true;
             }
         };
@@ -111,6 +111,71 @@ static void add_rcs_block(VehicleBuilder& rBuilder, VehicleBuilder::WeldVec_t& r
     rWeldTo.push_back({ nozzleB, nozzleTfB });
 }
 
+void build_simple_command_service_module(VehicleBuilder& rBuilder)
+{
+    VehicleBuilder::WeldVec_t toWeld;
+
+    auto const [ capsule, fueltank, engineA, engineB ] = rBuilder.create_parts<4>();
+    rBuilder.set_prefabs({
+        { capsule,  "phCapsule" },
+        { fueltank, "phFuselage" },
+        { engineA,  "phEngine" },
+        { engineB,  "phEngine" },
+    });
+
+    toWeld.push_back( {capsule,  quick_transform({ 0.0f,  0.0f,  3.0f}, {})} );
+    toWeld.push_back( {fueltank, quick_transform({ 0.0f,  0.0f,  0.0f}, {})} );
+    toWeld.push_back( {engineA,  quick_transform({ 0.7f,  0.0f, -2.9f}, {})} );
+    toWeld.push_back( {engineB,  quick_transform({-0.7f,  0.0f, -2.9f}, {})} );
+
+    namespace ports_magicrocket = adera::ports_magicrocket;
+    namespace ports_userctrl = adera::ports_userctrl;
+
+    auto const [ pitch, yaw, roll, throttle, thrustMul ] = rBuilder.create_nodes<5>(gc_ntSigFloat);
+
+    auto &rFloatValues = rBuilder.node_values< SignalValues_t<float> >(gc_ntSigFloat);
+    rFloatValues[thrustMul] = 50000.0f;
+
+    rBuilder.create_machine(capsule, gc_mtUserCtrl, {
+        { ports_userctrl::gc_throttleOut,   throttle },
+        { ports_userctrl::gc_pitchOut,      pitch    },
+        { ports_userctrl::gc_yawOut,        yaw      },
+        { ports_userctrl::gc_rollOut,       roll     }
+    } );
+
+    rBuilder.create_machine(engineA, gc_mtMagicRocket, {
+        { ports_magicrocket::gc_throttleIn, throttle },
+        { ports_magicrocket::gc_multiplierIn, thrustMul }
+    } );
+
+    rBuilder.create_machine(engineB, gc_mtMagicRocket, {
+        { ports_magicrocket::gc_throttleIn, throttle },
+        { ports_magicrocket::gc_multiplierIn, thrustMul }
+    } );
+
+    RCSInputs rcsInputs{pitch, yaw, roll};
+
+    static constexpr int const   rcsRingBlocks   = 4;
+    static constexpr int const   rcsRingCount    = 2;
+    static constexpr float const rcsRingZ        = -2.0f;
+    static constexpr float const rcsZStep        = 4.0f;
+    static constexpr float const rcsRadius       = 1.1f;
+    static constexpr float const rcsThrust       = 3000.0f;
+
+    for (int ring = 0; ring < rcsRingCount; ++ring)
+    {
+        Vector3 const rcsOset{rcsRadius, 0.0f, rcsRingZ + float(ring)*rcsZStep };
+
+        for (Rad ang = 0.0_degf; ang < Rad(360.0_degf); ang += Rad(360.0_degf)/rcsRingBlocks)
+        {
+           Quaternion const rotZ = Quaternion::rotation(ang, {0.0f, 0.0f, 1.0f});
+           add_rcs_block(rBuilder, toWeld, rcsInputs, rcsThrust, rotZ.transformVector(rcsOset), rotZ);
+        }
+    }
+
+    rBuilder.weld(toWeld);
+}
+
 Session setup_prebuilt_vehicles(
         TopTaskBuilder&             rBuilder,
         ArrayView<entt::any> const  topData,
@@ -134,67 +199,7 @@ Session setup_prebuilt_vehicles(
     // Build "PartVehicle"
     {
         VehicleBuilder vbuilder{&rResources};
-        VehicleBuilder::WeldVec_t toWeld;
-
-        auto const [ capsule, fueltank, engineA, engineB ] = vbuilder.create_parts<4>();
-        vbuilder.set_prefabs({
-            { capsule,  "phCapsule" },
-            { fueltank, "phFuselage" },
-            { engineA,  "phEngine" },
-            { engineB,  "phEngine" },
-        });
-
-        toWeld.push_back( {capsule,  quick_transform({ 0.0f,  0.0f,  3.0f}, {})} );
-        toWeld.push_back( {fueltank, quick_transform({ 0.0f,  0.0f,  0.0f}, {})} );
-        toWeld.push_back( {engineA,  quick_transform({ 0.7f,  0.0f, -2.9f}, {})} );
-        toWeld.push_back( {engineB,  quick_transform({-0.7f,  0.0f, -2.9f}, {})} );
-
-        namespace ports_magicrocket = adera::ports_magicrocket;
-        namespace ports_userctrl = adera::ports_userctrl;
-
-        auto const [ pitch, yaw, roll, throttle, thrustMul ] = vbuilder.create_nodes<5>(gc_ntSigFloat);
-
-        auto &rFloatValues = vbuilder.node_values< SignalValues_t<float> >(gc_ntSigFloat);
-        rFloatValues[thrustMul] = 50000.0f;
-
-        vbuilder.create_machine(capsule, gc_mtUserCtrl, {
-            { ports_userctrl::gc_throttleOut,   throttle },
-            { ports_userctrl::gc_pitchOut,      pitch    },
-            { ports_userctrl::gc_yawOut,        yaw      },
-            { ports_userctrl::gc_rollOut,       roll     }
-        } );
-
-        vbuilder.create_machine(engineA, gc_mtMagicRocket, {
-            { ports_magicrocket::gc_throttleIn, throttle },
-            { ports_magicrocket::gc_multiplierIn, thrustMul }
-        } );
-
-        vbuilder.create_machine(engineB, gc_mtMagicRocket, {
-            { ports_magicrocket::gc_throttleIn, throttle },
-            { ports_magicrocket::gc_multiplierIn, thrustMul }
-        } );
-
-        RCSInputs rcsInputs{pitch, yaw, roll};
-
-        static constexpr int const   rcsRingBlocks   = 4;
-        static constexpr int const   rcsRingCount    = 2;
-        static constexpr float const rcsRingZ        = -2.0f;
-        static constexpr float const rcsZStep        = 4.0f;
-        static constexpr float const rcsRadius       = 1.1f;
-        static constexpr float const rcsThrust       = 3000.0f;
-
-        for (int ring = 0; ring < rcsRingCount; ++ring)
-        {
-            Vector3 const rcsOset{rcsRadius, 0.0f, rcsRingZ + float(ring)*rcsZStep };
-
-            for (Rad ang = 0.0_degf; ang < Rad(360.0_degf); ang += Rad(360.0_degf)/rcsRingBlocks)
-            {
-               Quaternion const rotZ = Quaternion::rotation(ang, {0.0f, 0.0f, 1.0f});
-               add_rcs_block(vbuilder, toWeld, rcsInputs, rcsThrust, rotZ.transformVector(rcsOset), rotZ);
-            }
-        }
-
-        vbuilder.weld(toWeld);
+        build_simple_command_service_module(vbuilder);
 
         rPrebuiltVehicles[gc_pbvSimpleCommandServiceModule] = std::make_unique<VehicleData>(std::move(vbuilder.finalize_release()));
     }
@@ -49,6 +49,13 @@ struct PrebuiltVehicles : osp::KeyedVec< PrebuiltVhId, std::unique_ptr<adera::Ve
 
 inline PrebuiltVhId const gc_pbvSimpleCommandServiceModule = PrebuiltVhIdReg_t::create();
 
+/**
+ * @brief Add the parts, machines and welds of gc_pbvSimpleCommandServiceModule
+ *
+ * Only touches rBuilder, so it can be run on a VehicleBuildService worker.
+ */
+void build_simple_command_service_module(adera::VehicleBuilder& rBuilder);
+
 osp::Session setup_prebuilt_vehicles(
         osp::TopTaskBuilder&        rBuilder,
         osp::ArrayView<entt::any>   topData,
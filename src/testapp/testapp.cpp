@@ -127,6 +127,19 @@ void TestApp::clear_resource_owners()
         }
     });
 
+    // Mesh resources may contain osp::MeshLodChain, which owns simplified meshes
+    resource_for_each_type(gc_mesh, rResources, [&rResources] (osp::ResId const id)
+    {
+        auto * const pData = rResources.data_try_get<osp::MeshLodChain>(gc_mesh, id);
+        if (pData != nullptr)
+        {
+            for (osp::ResIdOwner_t &rOwner : std::move(pData->m_levels))
+            {
+                rResources.owner_destroy(gc_mesh, std::move(rOwner));
+            }
+        }
+    });
+
     // Importer data own a lot of other resources
     resource_for_each_type(gc_importer, rResources, [&rResources] (osp::ResId const id)
     {
@@ -182,7 +195,7 @@ void SingleThreadedExecutor::wait(TestAppTasks& rAppTasks)
     }
 
     osp::exec_update(rAppTasks.m_tasks, rAppTasks.m_graph, m_execContext);
-    osp::top_run_blocking(rAppTasks.m_tasks, rAppTasks.m_graph, rAppTasks.m_taskData, rAppTasks.m_topData, m_execContext);
+    osp::top_run_blocking(rAppTasks.m_tasks, rAppTasks.m_graph, rAppTasks.m_taskData, rAppTasks.m_topData, m_execContext, {.pScratch = &m_scratch});
 
     if (m_log != nullptr)
     {
@@ -26,6 +26,7 @@
 
 #include <osp/core/keyed_vector.h>
 #include <osp/core/resourcetypes.h>
+#include <osp/core/scratch_arena.h>
 #include <osp/tasks/tasks.h>
 #include <osp/tasks/top_execute.h>
 #include <osp/tasks/top_session.h>
@@ -110,6 +111,7 @@ public:
     bool is_running(TestAppTasks const& rAppTasks) override;
 
     osp::ExecContext                m_execContext;
+    osp::ScratchArena               m_scratch;
     std::shared_ptr<spdlog::logger> m_log;
 };
 
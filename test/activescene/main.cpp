@@ -0,0 +1,271 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/activescene/basic_fn.h>
+#include <osp/activescene/prefab_fn.h>
+#include <osp/core/Resources.h>
+#include <osp/vehicles/ImporterData.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace osp;
+using namespace osp::active;
+using osp::restypes::gc_importer;
+
+// Removed Ids stay taken until release_pending, so they can't be handed out again in the same frame
+TEST(SysActiveEnt, DeferredReuse)
+{
+    ACtxBasic basic;
+
+    ActiveEnt const a = basic.m_activeIds.create();
+    ActiveEnt const b = basic.m_activeIds.create();
+
+    SysActiveEnt::remove(basic, a);
+    EXPECT_TRUE(basic.m_activeIds.exists(a));
+
+    ActiveEnt const c = basic.m_activeIds.create();
+    EXPECT_NE(c, a);
+    EXPECT_NE(c, b);
+
+    // Removing twice in one frame is harmless
+    SysActiveEnt::remove(basic, a);
+
+    SysActiveEnt::release_pending(basic);
+    EXPECT_FALSE(basic.m_activeIds.exists(a));
+    EXPECT_TRUE(basic.m_activeIds.exists(b));
+    EXPECT_TRUE(basic.m_activeIds.exists(c));
+    EXPECT_TRUE(basic.m_activeIdsPendingFree.empty());
+
+    // Removing an ActiveEnt that doesn't exist does nothing
+    SysActiveEnt::remove(basic, a);
+    EXPECT_TRUE(basic.m_activeIdsPendingFree.empty());
+
+    // Now a's Id is free for reuse
+    EXPECT_EQ(basic.m_activeIds.create(), a);
+}
+
+// Refs go stale as soon as their ActiveEnt is removed, and stay stale after the Id is reused
+TEST(SysActiveEnt, StaleRef)
+{
+    ACtxBasic basic;
+
+    ActiveEnt const a = basic.m_activeIds.create();
+    ActiveEnt const b = basic.m_activeIds.create();
+
+    ActiveEntRef const refA = SysActiveEnt::active_ent_ref(basic, a);
+    ActiveEntRef const refB = SysActiveEnt::active_ent_ref(basic, b);
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, refA));
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, refB));
+    EXPECT_FALSE(SysActiveEnt::is_current(basic, ActiveEntRef{}));
+
+    SysActiveEnt::remove(basic, a);
+    EXPECT_FALSE(SysActiveEnt::is_current(basic, refA));
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, refB));
+
+    SysActiveEnt::release_pending(basic);
+    EXPECT_FALSE(SysActiveEnt::is_current(basic, refA));
+
+    ActiveEnt const reused = basic.m_activeIds.create();
+    ASSERT_EQ(reused, a);
+    EXPECT_FALSE(SysActiveEnt::is_current(basic, refA));
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, SysActiveEnt::active_ent_ref(basic, reused)));
+
+    // Ids created after the last remove() may be past the end of m_activeGeneration
+    ActiveEnt const late = basic.m_activeIds.create();
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, SysActiveEnt::active_ent_ref(basic, late)));
+}
+
+// Generations are uint16_t and wrap around to 0; refs from just before the wrap are still stale
+TEST(SysActiveEnt, GenerationWrap)
+{
+    ACtxBasic basic;
+
+    ActiveEnt const ent = basic.m_activeIds.create();
+
+    ActiveEntRef ref = SysActiveEnt::active_ent_ref(basic, ent);
+    for (uint32_t i = 0; i < UINT16_MAX; ++i)
+    {
+        SysActiveEnt::remove(basic, ent);
+        SysActiveEnt::release_pending(basic);
+        ASSERT_EQ(basic.m_activeIds.create(), ent);
+
+        ASSERT_FALSE(SysActiveEnt::is_current(basic, ref));
+        ref = SysActiveEnt::active_ent_ref(basic, ent);
+    }
+
+    EXPECT_EQ(ref.generation, UINT16_MAX);
+
+    SysActiveEnt::remove(basic, ent);
+    SysActiveEnt::release_pending(basic);
+    ASSERT_EQ(basic.m_activeIds.create(), ent);
+
+    ActiveEntRef const wrapped = SysActiveEnt::active_ent_ref(basic, ent);
+    EXPECT_EQ(wrapped.generation, 0u);
+    EXPECT_FALSE(SysActiveEnt::is_current(basic, ref));
+    EXPECT_TRUE(SysActiveEnt::is_current(basic, wrapped));
+}
+
+//-----------------------------------------------------------------------------
+
+// Tree "A( B(C), D )" followed by a sibling subtree "E(F)"
+TEST(SubtreeBuilder, AddTree)
+{
+    ACtxBasic basic;
+    ACtxSceneGraph &rScnGraph = basic.m_scnGraph;
+
+    std::array<ActiveEnt, 6> ents;
+    basic.m_activeIds.create(ents.begin(), ents.end());
+    rScnGraph.resize(basic.m_activeIds.capacity());
+
+    auto const [A, B, C, D, E, F] = ents;
+    std::array<uint32_t, 6> const descendants{3, 1, 0, 0, 1, 0};
+
+    {
+        SubtreeBuilder bldRoot = SysSceneGraph::add_descendants(rScnGraph, ents.size());
+        bldRoot.add_tree(osp::arrayView(ents.data(), ents.size()),
+                         osp::arrayView(descendants.data(), descendants.size()));
+        EXPECT_EQ(bldRoot.remaining(), 0u);
+    }
+
+    // Tree order matches the input, with the root at position 0
+    ASSERT_EQ(rScnGraph.m_treeDescendants[0], 6u);
+    for (std::size_t i = 0; i < ents.size(); ++i)
+    {
+        EXPECT_EQ(rScnGraph.m_treeToEnt[TreePos_t(i + 1)], ents[i]);
+        EXPECT_EQ(rScnGraph.m_treeDescendants[TreePos_t(i + 1)], descendants[i]);
+        EXPECT_EQ(rScnGraph.m_entToTreePos[ents[i]], TreePos_t(i + 1));
+    }
+
+    ActiveEnt const root = lgrn::id_null<ActiveEnt>();
+    EXPECT_EQ(rScnGraph.m_entParent[A], root);
+    EXPECT_EQ(rScnGraph.m_entParent[B], A);
+    EXPECT_EQ(rScnGraph.m_entParent[C], B);
+    EXPECT_EQ(rScnGraph.m_entParent[D], A);
+    EXPECT_EQ(rScnGraph.m_entParent[E], root);
+    EXPECT_EQ(rScnGraph.m_entParent[F], E);
+
+    std::vector<ActiveEnt> childrenOfA;
+    for (ActiveEnt const child : SysSceneGraph::children(rScnGraph, A))
+    {
+        childrenOfA.push_back(child);
+    }
+    EXPECT_EQ(childrenOfA, (std::vector<ActiveEnt>{B, D}));
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief Make an importer with two prefabs: "A( B(C), D )" and a lone "E"
+ */
+ResId make_test_importer(Resources &rResources, PkgId pkg, float massOfB)
+{
+    ResId const importer = rResources.create(gc_importer, pkg, SharedString::create_reference("prefabs"));
+
+    auto &rImportData = rResources.data_add<ImporterData>(gc_importer, importer);
+    rImportData.m_objDescendants    = {3, 1, 0, 0, 0};
+    rImportData.m_objTransforms     .assign(5, Matrix4{});
+    rImportData.m_objTransforms[1]  = Matrix4::translation({0.0f, 0.0f, 2.0f});
+
+    auto &rPrefabs = rResources.data_add<Prefabs>(gc_importer, importer);
+    rPrefabs.m_objShape             = {EShape::None, EShape::Box, EShape::None, EShape::None, EShape::Sphere};
+    rPrefabs.m_objMass              = {0.0f, massOfB, 0.0f, 0.0f, 1.0f};
+    rPrefabs.m_prefabNames          = {"A", "E"};
+
+    std::array<ObjId, 4>   const objsA   {0, 1, 2, 3};
+    std::array<int32_t, 4> const parentsA{-1, 0, 1, 0};
+    std::array<ObjId, 1>   const objsE   {4};
+    std::array<int32_t, 1> const parentsE{-1};
+
+    rPrefabs.m_prefabs          .ids_reserve(2);
+    rPrefabs.m_prefabs          .data_reserve(5);
+    rPrefabs.m_prefabParents    .ids_reserve(2);
+    rPrefabs.m_prefabParents    .data_reserve(5);
+    rPrefabs.m_prefabs          .emplace(0, objsA.begin(),      objsA.end());
+    rPrefabs.m_prefabParents    .emplace(0, parentsA.begin(),   parentsA.end());
+    rPrefabs.m_prefabs          .emplace(1, objsE.begin(),      objsE.end());
+    rPrefabs.m_prefabParents    .emplace(1, parentsE.begin(),   parentsE.end());
+
+    return importer;
+}
+
+// Templates are made once per (importer, prefab), and copy everything needed to spawn
+TEST(SysPrefabInit, GetOrMakeTemplate)
+{
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<ImporterData>(gc_importer);
+    resources.data_register<Prefabs>(gc_importer);
+
+    PkgId const pkg = resources.pkg_create();
+    ResId const importerA = make_test_importer(resources, pkg, 2.0f);
+    ResId const importerB = make_test_importer(resources, pkg, 4.0f);
+
+    ACtxPrefabs prefabs;
+
+    // Miss: a new template is made from the importer's data
+    std::size_t const tmplA0 = SysPrefabInit::get_or_make_template(prefabs, resources, importerA, 0);
+    ASSERT_EQ(prefabs.templates.size(), 1u);
+    {
+        PrefabTemplate const &tmpl = prefabs.templates[tmplA0];
+        EXPECT_EQ(tmpl.importer, importerA);
+        EXPECT_EQ(tmpl.prefab, 0u);
+        EXPECT_EQ(tmpl.parents,     (std::vector<int32_t>{-1, 0, 1, 0}));
+        EXPECT_EQ(tmpl.descendants, (std::vector<uint32_t>{3, 1, 0, 0}));
+        EXPECT_EQ(tmpl.transforms[1], Matrix4::translation({0.0f, 0.0f, 2.0f}));
+        EXPECT_EQ(tmpl.masses[1], 2.0f);
+
+        // B has mass and shape, so it and its ancestor A have colliders. C and D don't
+        EXPECT_EQ(tmpl.hasColliders, (std::vector<bool>{true, true, false, false}));
+    }
+
+    // Hit: same index, nothing new made
+    EXPECT_EQ(SysPrefabInit::get_or_make_template(prefabs, resources, importerA, 0), tmplA0);
+    EXPECT_EQ(prefabs.templates.size(), 1u);
+
+    // Different prefab or different importer are misses
+    std::size_t const tmplA1 = SysPrefabInit::get_or_make_template(prefabs, resources, importerA, 1);
+    std::size_t const tmplB0 = SysPrefabInit::get_or_make_template(prefabs, resources, importerB, 0);
+    EXPECT_NE(tmplA1, tmplA0);
+    EXPECT_NE(tmplB0, tmplA0);
+    EXPECT_NE(tmplB0, tmplA1);
+    ASSERT_EQ(prefabs.templates.size(), 3u);
+    EXPECT_EQ(prefabs.templates[tmplA1].shapes, (std::vector<EShape>{EShape::Sphere}));
+    EXPECT_EQ(prefabs.templates[tmplB0].masses[1], 4.0f);
+
+    EXPECT_EQ(SysPrefabInit::get_or_make_template(prefabs, resources, importerA, 1), tmplA1);
+    EXPECT_EQ(SysPrefabInit::get_or_make_template(prefabs, resources, importerB, 0), tmplB0);
+    EXPECT_EQ(prefabs.templates.size(), 3u);
+
+    SysPrefabInit::clear_templates(prefabs);
+    EXPECT_TRUE(prefabs.templates.empty());
+    EXPECT_TRUE(prefabs.templateIndex.empty());
+
+    // Miss again after clearing
+    EXPECT_EQ(SysPrefabInit::get_or_make_template(prefabs, resources, importerB, 0), 0u);
+    EXPECT_EQ(prefabs.templates.size(), 1u);
+}
@@ -0,0 +1,141 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <adera/activescene/vehicles_vb_fn.h>
+
+#include <osp/core/Resources.h>
+#include <osp/link/signal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace adera;
+using namespace osp;
+using namespace osp::active;
+using namespace osp::link;
+
+using osp::restypes::gc_importer;
+
+MachTypeId const gc_mtBenchCtrl   = MachTypeReg_t::create();
+MachTypeId const gc_mtBenchEngine = MachTypeReg_t::create();
+
+PortEntry const gc_benchCtrlOut     { gc_ntSigFloat, 0, gc_sigOut };
+PortEntry const gc_benchEngineIn    { gc_ntSigFloat, 0, gc_sigIn };
+PortEntry const gc_benchEngineMulIn { gc_ntSigFloat, 1, gc_sigIn };
+
+/**
+ * @brief Same vehicle as test/vehicles SpawnManyIdentical: a controller driving a row of engines
+ */
+VehicleData make_bench_vehicle(Resources &rResources)
+{
+    VehicleBuilder vbuilder{&rResources};
+
+    auto const parts = vbuilder.create_parts<8>();
+    auto const [ throttle, thrustMul ] = vbuilder.create_nodes<2>(gc_ntSigFloat);
+
+    vbuilder.node_values< SignalValues_t<float> >(gc_ntSigFloat)[thrustMul] = 42.0f;
+
+    vbuilder.create_machine(parts[0], gc_mtBenchCtrl, {
+        { gc_benchCtrlOut, throttle }
+    } );
+
+    for (std::size_t i = 1; i < parts.size(); ++i)
+    {
+        vbuilder.create_machine(parts[i], gc_mtBenchEngine, {
+            { gc_benchEngineIn,      throttle },
+            { gc_benchEngineMulIn,   thrustMul }
+        } );
+    }
+
+    VehicleBuilder::WeldVec_t toWeld;
+    for (PartId const part : parts)
+    {
+        toWeld.push_back({part, Matrix4{}});
+    }
+    vbuilder.weld(toWeld);
+
+    return vbuilder.finalize_release();
+}
+
+/**
+ * @brief Time spawning many copies of the same vehicle into an empty scene
+ *
+ * Usage: bench_vehicles [vehicle count] [repeats]
+ */
+int main(int argc, char** argv)
+{
+    std::size_t const vehicleCount  = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    std::size_t const repeats       = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    if (vehicleCount == 0 || repeats == 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [vehicle count] [repeats]\n";
+        return 1;
+    }
+
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<Prefabs>(gc_importer);
+
+    VehicleData const vehicle = make_bench_vehicle(resources);
+
+    std::vector<double> times;
+    times.reserve(repeats);
+
+    for (std::size_t i = 0; i < repeats; ++i)
+    {
+        ACtxParts scnParts;
+        scnParts.machines.perType.resize(MachTypeReg_t::size());
+        scnParts.nodePerType.resize(NodeTypeReg_t::size());
+
+        ACtxVehicleSpawn    vehicleSpawn;
+        ACtxVehicleSpawnVB  vehicleSpawnVB;
+
+        vehicleSpawn.spawnRequest.resize(vehicleCount);
+        vehicleSpawnVB.dataVB.resize(vehicleCount, &vehicle);
+
+        auto const start = std::chrono::steady_clock::now();
+
+        SysVehicleSpawnVB::create_parts_and_welds   (vehicleSpawn, vehicleSpawnVB, scnParts);
+        SysVehicleSpawnVB::create_machines          (vehicleSpawn, vehicleSpawnVB, scnParts);
+        SysVehicleSpawnVB::update_part_machine_maps (vehicleSpawn, vehicleSpawnVB, scnParts);
+        SysVehicleSpawnVB::create_nodes             (vehicleSpawn, vehicleSpawnVB, scnParts);
+
+        auto const end = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    std::cout << "Spawned " << vehicleCount << " vehicles, " << repeats << " repeats: "
+              << "min " << times.front() << "ms, "
+              << "median " << times[times.size() / 2] << "ms, "
+              << "max " << times.back() << "ms\n";
+
+    return 0;
+}
@@ -0,0 +1,496 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/drawing/culling_fn.h>
+#include <osp/drawing/mesh_lod.h>
+
+#include <Magnum/Math/Functions.h>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+
+using namespace osp;
+using namespace osp::active;
+using namespace osp::draw;
+
+namespace
+{
+
+/**
+ * @brief Scene with a single unit cube mesh, and DrawEnts to place it with
+ */
+struct CullingScene
+{
+    CullingScene()
+    {
+        cube = drawing.m_meshIds.create();
+        drawing.m_meshBounds.resize(drawing.m_meshIds.capacity());
+        bitvector_resize(drawing.m_meshHasBounds, drawing.m_meshIds.capacity());
+        drawing.m_meshBounds[cube] = Magnum::Range3D{Vector3{-0.5f}, Vector3{0.5f}};
+        drawing.m_meshHasBounds.set(std::size_t(cube));
+    }
+
+    ~CullingScene()
+    {
+        SysRender::clear_owners(scnRender, drawing);
+    }
+
+    /**
+     * @brief Add a visible DrawEnt at a position, with the cube mesh if hasMesh
+     */
+    DrawEnt add(Vector3 const pos, bool const hasMesh = true)
+    {
+        DrawEnt const drawEnt = SysRender::create_draw_ent(scnRender);
+        scnRender.resize_draw();
+
+        scnRender.m_visible.set(std::size_t(drawEnt));
+        scnRender.m_drawTransform[drawEnt] = Matrix4::translation(pos);
+        if (hasMesh)
+        {
+            scnRender.m_mesh[drawEnt] = drawing.m_meshRefCounts.ref_add(cube);
+        }
+        return drawEnt;
+    }
+
+    void cull(ViewProjMatrix const& viewProj)
+    {
+        SysCulling::update_draw_bounds(culling, scnRender, drawing);
+        SysCulling::update_subtree_bounds(culling, scnRender, scnGraph);
+        SysCulling::cull(culling, scnRender, scnGraph, viewProj);
+    }
+
+    bool in_view(DrawEnt const drawEnt) const
+    {
+        return culling.visibleInView.test(std::size_t(drawEnt));
+    }
+
+    ACtxDrawing         drawing;
+    ACtxSceneRender     scnRender;
+    ACtxSceneGraph      scnGraph;
+    ACtxCulling         culling;
+    MeshId              cube;
+};
+
+/**
+ * @brief Camera at the origin looking down -Z, with a 90 degree square frustum
+ *
+ * At a distance d in front of the camera, the frustum spans from -d to d on X and Y.
+ */
+ViewProjMatrix test_view_proj()
+{
+    Camera camera;
+    camera.m_near           = 1.0f;
+    camera.m_far            = 100.0f;
+    camera.m_fov            = Deg{90.0f};
+    camera.m_aspectRatio    = 1.0f;
+
+    return ViewProjMatrix{Matrix4{}, camera.perspective()};
+}
+
+} // namespace
+
+// Boxes fully inside, fully outside, and straddling each of the frustum planes
+TEST(SysCulling, FrustumPlanes)
+{
+    CullingScene scene;
+
+    DrawEnt const inside        = scene.add({  0.0f,   0.0f,  -10.0f});
+    DrawEnt const outsideLeft   = scene.add({-50.0f,   0.0f,  -10.0f});
+    DrawEnt const outsideTop    = scene.add({  0.0f,  50.0f,  -10.0f});
+    DrawEnt const straddleLeft  = scene.add({-10.0f,   0.0f,  -10.0f});
+    DrawEnt const straddleRight = scene.add({ 10.0f,   0.0f,  -10.0f});
+    DrawEnt const behind        = scene.add({  0.0f,   0.0f,   10.0f});
+
+    // Box spans z = 0.25 to -0.75, between the camera and the near plane at z = -1
+    DrawEnt const beforeNear    = scene.add({  0.0f,   0.0f,   -0.25f});
+    DrawEnt const straddleNear  = scene.add({  0.0f,   0.0f,   -1.0f});
+    DrawEnt const straddleFar   = scene.add({  0.0f,   0.0f, -100.0f});
+    DrawEnt const beyondFar     = scene.add({  0.0f,   0.0f, -102.0f});
+
+    scene.cull(test_view_proj());
+
+    EXPECT_TRUE (scene.in_view(inside));
+    EXPECT_FALSE(scene.in_view(outsideLeft));
+    EXPECT_FALSE(scene.in_view(outsideTop));
+    EXPECT_TRUE (scene.in_view(straddleLeft));
+    EXPECT_TRUE (scene.in_view(straddleRight));
+    EXPECT_FALSE(scene.in_view(behind));
+    EXPECT_FALSE(scene.in_view(beforeNear));
+    EXPECT_TRUE (scene.in_view(straddleNear));
+    EXPECT_TRUE (scene.in_view(straddleFar));
+    EXPECT_FALSE(scene.in_view(beyondFar));
+}
+
+// DrawEnts without bounds are never culled, and invisible DrawEnts are never in view
+TEST(SysCulling, UnboundedAndInvisible)
+{
+    CullingScene scene;
+
+    DrawEnt const noMesh    = scene.add({-50.0f, 0.0f, 10.0f}, false);
+    DrawEnt const hidden    = scene.add({  0.0f, 0.0f, -10.0f});
+    scene.scnRender.m_visible.reset(std::size_t(hidden));
+
+    scene.cull(test_view_proj());
+
+    EXPECT_TRUE (scene.in_view(noMesh));
+    EXPECT_FALSE(scene.in_view(hidden));
+}
+
+// Boxes are tested 64 at a time; make sure DrawEnts past the first batch are culled too
+TEST(SysCulling, ManyBatches)
+{
+    CullingScene scene;
+
+    std::vector<DrawEnt> drawEnts;
+    for (int i = 0; i < 200; ++i)
+    {
+        // Alternate between in view and behind the camera
+        float const z = (i % 2 == 0) ? -10.0f : 10.0f;
+        drawEnts.push_back(scene.add({0.0f, 0.0f, z}));
+    }
+
+    scene.cull(test_view_proj());
+
+    for (std::size_t i = 0; i < drawEnts.size(); ++i)
+    {
+        EXPECT_EQ(scene.in_view(drawEnts[i]), i % 2 == 0);
+    }
+}
+
+namespace
+{
+
+/**
+ * @brief Bumpy square grid of (size-1)^2 quads, indexed, with positions only
+ */
+Magnum::Trade::MeshData make_grid_mesh(uint32_t const size)
+{
+    using namespace Magnum::Trade;
+    using Corrade::Containers::Array;
+    using Corrade::Containers::arrayCast;
+
+    Array<char> vertexData{Corrade::NoInit, std::size_t(size) * size * sizeof(Vector3)};
+    auto const positions = arrayCast<Vector3>(vertexData);
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            float const fx = float(x) * 0.25f;
+            float const fy = float(y) * 0.25f;
+            positions[y * size + x] = {fx, fy, std::sin(fx) * std::cos(fy)};
+        }
+    }
+
+    std::size_t const quads = std::size_t(size - 1) * (size - 1);
+    Array<char> indexData{Corrade::NoInit, quads * 6 * sizeof(Magnum::UnsignedInt)};
+    auto const indices = arrayCast<Magnum::UnsignedInt>(indexData);
+    std::size_t i = 0;
+    for (uint32_t y = 0; y + 1 < size; ++y)
+    {
+        for (uint32_t x = 0; x + 1 < size; ++x)
+        {
+            uint32_t const v = y * size + x;
+            for (uint32_t const index : {v, v + 1, v + size, v + 1, v + size + 1, v + size})
+            {
+                indices[i++] = index;
+            }
+        }
+    }
+
+    return MeshData{MeshPrimitive::Triangles,
+                    std::move(indexData), MeshIndexData{indices},
+                    std::move(vertexData), {MeshAttributeData{MeshAttribute::Position, positions}}};
+}
+
+std::vector<uint32_t> mesh_indices(Magnum::Trade::MeshData const& mesh)
+{
+    auto const indices = mesh.indicesAsArray();
+    return {indices.begin(), indices.end()};
+}
+
+} // namespace
+
+// Simplifying further never adds triangles back, and never reduces the error
+TEST(MeshLod, SimplifyMonotonic)
+{
+    Magnum::Trade::MeshData const mesh = make_grid_mesh(24);
+    auto const positions = mesh.positions3DAsArray();
+    std::vector<uint32_t> const indices = mesh_indices(mesh);
+
+    std::size_t prevTriangles = indices.size() / 3;
+    float       prevError     = 0.0f;
+
+    for (std::size_t target = prevTriangles; target >= 8; target /= 2)
+    {
+        std::vector<uint32_t> out;
+        float const error = osp::draw::simplify_triangles(positions, indices, target, out);
+
+        std::size_t const triangles = out.size() / 3;
+        EXPECT_LE(triangles, prevTriangles);
+        EXPECT_GE(error, prevError);
+
+        prevTriangles = triangles;
+        prevError     = error;
+    }
+
+    EXPECT_LT(prevTriangles, indices.size() / 3);
+}
+
+// Each generated level has fewer triangles and at least as much error as the one before
+TEST(MeshLod, ComputeLodsMonotonic)
+{
+    Magnum::Trade::MeshData const mesh = make_grid_mesh(32);
+
+    osp::draw::GeneratedMeshLods const lods = osp::draw::compute_mesh_lods(mesh, 4, 0.5f);
+
+    ASSERT_FALSE(lods.m_levels.empty());
+    ASSERT_EQ(lods.m_levels.size(), lods.m_errors.size());
+
+    std::size_t prevTriangles = mesh.indexCount() / 3;
+    float       prevError     = 0.0f;
+    for (std::size_t i = 0; i < lods.m_levels.size(); ++i)
+    {
+        std::size_t const triangles = lods.m_levels[i].indexCount() / 3;
+        EXPECT_LT(triangles, prevTriangles);
+        EXPECT_GE(lods.m_errors[i], prevError);
+
+        prevTriangles = triangles;
+        prevError     = lods.m_errors[i];
+    }
+}
+
+// Meshes already at or below the target come back unchanged
+TEST(MeshLod, AlreadyMinimal)
+{
+    Magnum::Trade::MeshData const mesh = make_grid_mesh(4);
+    auto const positions = mesh.positions3DAsArray();
+    std::vector<uint32_t> const indices = mesh_indices(mesh);
+    std::size_t const triangles = indices.size() / 3;
+
+    std::vector<uint32_t> out;
+    EXPECT_EQ(osp::draw::simplify_triangles(positions, indices, triangles, out), 0.0f);
+    EXPECT_EQ(out, indices);
+
+    float error = -1.0f;
+    Corrade::Containers::Optional<Magnum::Trade::MeshData> const lod
+            = osp::draw::create_mesh_lod(mesh, triangles, error);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(error, 0.0f);
+
+    // Vertices are renumbered in order of first use, but every triangle keeps its positions
+    auto const lodPositions = lod->positions3DAsArray();
+    std::vector<uint32_t> const lodIndices = mesh_indices(*lod);
+    ASSERT_EQ(lodIndices.size(), indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        EXPECT_EQ(lodPositions[lodIndices[i]], positions[indices[i]]);
+    }
+
+    // 18 triangles is too few to be worth any levels
+    EXPECT_TRUE(osp::draw::compute_mesh_lods(mesh).m_levels.empty());
+}
+
+// Removing from the middle moves the last DrawEnt into the gap and keeps denseIndex in sync
+TEST(SysRender, DrawEntSwapRemove)
+{
+    ACtxSceneRender scnRender;
+
+    std::array<DrawEnt, 4> ents;
+    for (DrawEnt &rEnt : ents)
+    {
+        rEnt = SysRender::create_draw_ent(scnRender);
+    }
+    scnRender.resize_draw();
+
+    DrawEntPacked const &packed = scnRender.m_drawPacked;
+    ASSERT_EQ(packed.ents.size(), 4u);
+
+    SysRender::remove_draw_ent(scnRender, ents[1]);
+
+    ASSERT_EQ(packed.ents.size(), 3u);
+    EXPECT_EQ(packed.ents[1], ents[3]);
+    EXPECT_EQ(packed.denseIndex[ents[3]], 1u);
+    EXPECT_EQ(packed.denseIndex[ents[1]], DrawEntPacked::smc_null);
+    EXPECT_EQ(packed.swapRemoved, 1u);
+
+    // Removing the last one doesn't need a swap
+    SysRender::remove_draw_ent(scnRender, ents[2]);
+    EXPECT_EQ(packed.swapRemoved, 1u);
+
+    // Removing twice is a no-op
+    SysRender::remove_draw_ent(scnRender, ents[1]);
+    EXPECT_EQ(packed.removed, 2u);
+
+    ASSERT_EQ(packed.ents.size(), 2u);
+    for (std::size_t i = 0; i < packed.ents.size(); ++i)
+    {
+        EXPECT_EQ(packed.denseIndex[packed.ents[i]], i);
+    }
+
+    DrawEntStats const stats = SysRender::draw_ent_stats(scnRender);
+    EXPECT_EQ(stats.live,       2u);
+    EXPECT_EQ(stats.peakLive,   4u);
+    EXPECT_EQ(stats.removed,    2u);
+}
+
+// Removing a DrawEnt bumps its generation, so refs made before are stale even once the Id is reused
+TEST(SysRender, DrawEntGenerations)
+{
+    ACtxSceneRender scnRender;
+
+    DrawEnt const keep = SysRender::create_draw_ent(scnRender);
+    DrawEnt const gone = SysRender::create_draw_ent(scnRender);
+    scnRender.resize_draw();
+
+    DrawEntRef const keepRef = SysRender::draw_ent_ref(scnRender, keep);
+    DrawEntRef const goneRef = SysRender::draw_ent_ref(scnRender, gone);
+
+    EXPECT_TRUE(SysRender::is_current(scnRender, keepRef));
+    EXPECT_TRUE(SysRender::is_current(scnRender, goneRef));
+    EXPECT_FALSE(SysRender::is_current(scnRender, DrawEntRef{}));
+
+    uint16_t const genBefore = scnRender.m_drawPacked.generation[gone];
+    SysRender::remove_draw_ent(scnRender, gone);
+    EXPECT_EQ(scnRender.m_drawPacked.generation[gone], genBefore + 1);
+
+    // Stale right away, while the Id is still taken and pending release
+    EXPECT_FALSE(SysRender::is_current(scnRender, goneRef));
+    EXPECT_TRUE(SysRender::is_current(scnRender, keepRef));
+
+    SysRender::release_pending_draw_ents(scnRender);
+    EXPECT_FALSE(SysRender::is_current(scnRender, goneRef));
+
+    // Create until the removed Id is handed out again
+    DrawEnt reused = lgrn::id_null<DrawEnt>();
+    for (std::size_t i = 0; i <= scnRender.m_drawIds.capacity() && reused != gone; ++i)
+    {
+        reused = SysRender::create_draw_ent(scnRender);
+    }
+    scnRender.resize_draw();
+    ASSERT_EQ(reused, gone);
+
+    EXPECT_FALSE(SysRender::is_current(scnRender, goneRef));
+    EXPECT_TRUE(SysRender::is_current(scnRender, SysRender::draw_ent_ref(scnRender, reused)));
+    EXPECT_TRUE(SysRender::is_current(scnRender, keepRef));
+}
+
+// Removed Ids stay taken until release_pending_draw_ents, so they can't be handed out again in the
+// same frame
+TEST(SysRender, DrawEntDeferredReuse)
+{
+    ACtxSceneRender scnRender;
+
+    DrawEnt const a = SysRender::create_draw_ent(scnRender);
+    DrawEnt const b = SysRender::create_draw_ent(scnRender);
+    scnRender.resize_draw();
+
+    SysRender::remove_draw_ent(scnRender, a);
+    EXPECT_TRUE(scnRender.m_drawIds.exists(a));
+
+    DrawEnt const c = SysRender::create_draw_ent(scnRender);
+    scnRender.resize_draw();
+    EXPECT_NE(c, a);
+    EXPECT_NE(c, b);
+
+    // Removing twice in one frame is harmless
+    SysRender::remove_draw_ent(scnRender, a);
+    EXPECT_EQ(scnRender.m_drawIdsPendingFree.size(), 1u);
+
+    SysRender::release_pending_draw_ents(scnRender);
+    EXPECT_FALSE(scnRender.m_drawIds.exists(a));
+    EXPECT_TRUE(scnRender.m_drawIds.exists(b));
+    EXPECT_TRUE(scnRender.m_drawIds.exists(c));
+    EXPECT_TRUE(scnRender.m_drawIdsPendingFree.empty());
+
+    // Removing a DrawEnt that doesn't exist does nothing
+    SysRender::remove_draw_ent(scnRender, a);
+    EXPECT_TRUE(scnRender.m_drawIdsPendingFree.empty());
+
+    // Now a's Id is free for reuse
+    EXPECT_EQ(SysRender::create_draw_ent(scnRender), a);
+}
+
+// Observers only receive draw transforms of ActiveEnts they registered and that weren't unobserved
+TEST(SysRender, DrawTfObservers)
+{
+    struct Received
+    {
+        std::vector<ActiveEnt>  ents;
+        std::vector<Matrix4>    tfs;
+        int                     calls{0};
+    };
+
+    ACtxSceneRender     scnRender;
+    DrawTfObservers     observers;
+    Received            received[2];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        observers.observers[i].data = { &received[i] };
+        observers.observers[i].func = [] (ACtxSceneRender& rCtxScnRdr, ArrayView<ActiveEnt const> ents, ArrayView<Matrix4 const> drawTfs, DrawTfObservers::UserData_t data) noexcept
+        {
+            auto &rReceived = *static_cast<Received*>(data[0]);
+            rReceived.ents.insert(rReceived.ents.end(), ents.begin(), ents.end());
+            rReceived.tfs .insert(rReceived.tfs .end(), drawTfs.begin(), drawTfs.end());
+            ++rReceived.calls;
+        };
+    }
+
+    SysRender::observe_draw_tf(observers, 0, ActiveEnt{1});
+    SysRender::observe_draw_tf(observers, 0, ActiveEnt{5});
+    SysRender::observe_draw_tf(observers, 1, ActiveEnt{5});
+    SysRender::observe_draw_tf(observers, 1, ActiveEnt{40});
+    SysRender::unobserve_draw_tf(observers, ActiveEnt{40});
+
+    // Unobserving something never observed, or out of range, is a no-op
+    SysRender::unobserve_draw_tf(observers, ActiveEnt{2});
+    SysRender::unobserve_draw_tf(observers, ActiveEnt{1000});
+
+    for (uint32_t ent = 0; ent < 64; ++ent)
+    {
+        SysRender::gather_draw_tf(observers, Matrix4::translation({float(ent), 0.0f, 0.0f}), ActiveEnt{ent});
+    }
+    ASSERT_EQ(observers.batchEnts.size(), 2u);
+
+    SysRender::dispatch_draw_tf(observers, scnRender);
+
+    EXPECT_EQ(received[0].calls, 1);
+    EXPECT_EQ(received[0].ents, (std::vector<ActiveEnt>{ActiveEnt{1}, ActiveEnt{5}}));
+    ASSERT_EQ(received[0].tfs.size(), 2u);
+    EXPECT_EQ(received[0].tfs[1].translation().x(), 5.0f);
+
+    EXPECT_EQ(received[1].calls, 1);
+    EXPECT_EQ(received[1].ents, (std::vector<ActiveEnt>{ActiveEnt{5}}));
+
+    // Batch is cleared after dispatching, and observers aren't called with nothing
+    EXPECT_TRUE(observers.batchEnts.empty());
+    SysRender::dispatch_draw_tf(observers, scnRender);
+    EXPECT_EQ(received[0].calls, 1);
+    EXPECT_EQ(received[1].calls, 1);
+}
@@ -0,0 +1,315 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/core/Resources.h>
+#include <osp/drawing/own_restypes.h>
+#include <osp/util/logging.h>
+#include <osp/vehicles/gltf_cache.h>
+#include <osp/vehicles/ImporterData.h>
+#include <osp/vehicles/load_tinygltf.h>
+
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/TextureData.h>
+
+#include <Corrade/Containers/StringStlView.h>
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+using namespace osp;
+using namespace osp::restypes;
+
+using Magnum::Trade::ImageData2D;
+using Magnum::Trade::MeshData;
+using Magnum::Trade::TextureData;
+
+// Small Part with a texture, a mesh, and a prefab
+static std::string const gc_gltfPath = OSP_TEST_OSPDATA "/adera/ph_capsule.sturdy.gltf";
+
+void register_gltf_types(Resources &rResources)
+{
+    // The loaders log through osp::t_logger
+    static Logger_t const logger = spdlog::stdout_color_mt("test");
+    set_thread_logger(logger);
+
+    rResources.resize_types(ResTypeIdReg_t::size());
+    rResources.data_register<ImageData2D>(gc_image);
+    rResources.data_register<TextureData>(gc_texture);
+    rResources.data_register<TextureImgSource>(gc_texture);
+    rResources.data_register<MeshData>(gc_mesh);
+    rResources.data_register<MeshLodChain>(gc_mesh);
+    rResources.data_register<ImporterData>(gc_importer);
+    rResources.data_register<Prefabs>(gc_importer);
+    register_tinygltf_resources(rResources);
+}
+
+/**
+ * @brief Release everything owned by importers, textures, and mesh LOD chains
+ */
+void release_owners(Resources &rResources)
+{
+    auto const for_each_res = [&rResources] (ResTypeId const type, auto&& do_thing)
+    {
+        lgrn::IdRegistry<ResId> const &rReg = rResources.ids(type);
+        for (std::size_t i = 0; i < rReg.capacity(); ++i)
+        {
+            if (rReg.exists(ResId(i)))
+            {
+                do_thing(ResId(i));
+            }
+        }
+    };
+
+    for_each_res(gc_texture, [&rResources] (ResId const id)
+    {
+        if (auto *pData = rResources.data_try_get<TextureImgSource>(gc_texture, id))
+        {
+            rResources.owner_destroy(gc_image, std::move(*pData));
+        }
+    });
+
+    for_each_res(gc_mesh, [&rResources] (ResId const id)
+    {
+        if (auto *pData = rResources.data_try_get<MeshLodChain>(gc_mesh, id))
+        {
+            for (ResIdOwner_t &rOwner : pData->m_levels)
+            {
+                rResources.owner_destroy(gc_mesh, std::move(rOwner));
+            }
+        }
+    });
+
+    for_each_res(gc_importer, [&rResources] (ResId const id)
+    {
+        if (auto *pData = rResources.data_try_get<ImporterData>(gc_importer, id))
+        {
+            for (ResIdOwner_t &rOwner : pData->m_images)
+            {
+                rResources.owner_destroy(gc_image, std::move(rOwner));
+            }
+            for (ResIdOwner_t &rOwner : pData->m_textures)
+            {
+                rResources.owner_destroy(gc_texture, std::move(rOwner));
+            }
+            for (ResIdOwner_t &rOwner : pData->m_meshes)
+            {
+                rResources.owner_destroy(gc_mesh, std::move(rOwner));
+            }
+        }
+    });
+}
+
+/**
+ * @return Empty directory for a test to write cache files into
+ */
+std::string fresh_cache_dir(std::string_view const name)
+{
+    std::filesystem::path const dir = std::filesystem::temp_directory_path() / "osp_test_gltf_cache" / name;
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
+
+std::string cache_file_path(std::string const& cacheDir)
+{
+    std::optional<uint64_t> const hash = hash_file(gc_gltfPath);
+    EXPECT_TRUE(hash.has_value());
+    return gltf_cache_path(cacheDir, hash.value_or(0));
+}
+
+/**
+ * @brief Load gc_gltfPath into a new Resources with load_tinygltf_files_cached, then throw it away
+ *
+ * @return true if the file loaded
+ */
+bool load_cached_once(std::string const& cacheDir)
+{
+    Resources resources;
+    register_gltf_types(resources);
+
+    std::array<std::string, 1> const files{gc_gltfPath};
+    std::vector<ResId> const loaded = load_tinygltf_files_cached(
+            arrayView(files.data(), files.size()), cacheDir, resources, resources.pkg_create(), 1);
+
+    bool const ok = loaded.size() == 1 && loaded[0] != lgrn::id_null<ResId>();
+    release_owners(resources);
+    return ok;
+}
+
+void expect_same_importer(Resources const& a, ResId const importerA, Resources const& b, ResId const importerB)
+{
+    auto const &dataA = a.data_get<ImporterData const>(gc_importer, importerA);
+    auto const &dataB = b.data_get<ImporterData const>(gc_importer, importerB);
+
+    EXPECT_EQ(dataA.m_objParents,       dataB.m_objParents);
+    EXPECT_EQ(dataA.m_objDescendants,   dataB.m_objDescendants);
+    EXPECT_EQ(dataA.m_objMeshes,        dataB.m_objMeshes);
+    EXPECT_EQ(dataA.m_objMaterials,     dataB.m_objMaterials);
+    EXPECT_EQ(dataA.m_objTransforms,    dataB.m_objTransforms);
+
+    ASSERT_EQ(dataA.m_objNames.size(), dataB.m_objNames.size());
+    for (std::size_t i = 0; i < dataA.m_objNames.size(); ++i)
+    {
+        EXPECT_EQ(std::string_view{dataA.m_objNames[i]}, std::string_view{dataB.m_objNames[i]});
+    }
+
+    ASSERT_EQ(dataA.m_images.size(), dataB.m_images.size());
+    for (std::size_t i = 0; i < dataA.m_images.size(); ++i)
+    {
+        auto const &imgA = a.data_get<ImageData2D const>(gc_image, dataA.m_images[i]);
+        auto const &imgB = b.data_get<ImageData2D const>(gc_image, dataB.m_images[i]);
+        EXPECT_EQ(imgA.size(),          imgB.size());
+        EXPECT_EQ(imgA.format(),        imgB.format());
+        EXPECT_EQ(imgA.data().size(),   imgB.data().size());
+    }
+
+    ASSERT_EQ(dataA.m_meshes.size(), dataB.m_meshes.size());
+    for (std::size_t i = 0; i < dataA.m_meshes.size(); ++i)
+    {
+        auto const &meshA = a.data_get<MeshData const>(gc_mesh, dataA.m_meshes[i]);
+        auto const &meshB = b.data_get<MeshData const>(gc_mesh, dataB.m_meshes[i]);
+        EXPECT_EQ(meshA.vertexCount(),      meshB.vertexCount());
+        EXPECT_EQ(meshA.indexCount(),       meshB.indexCount());
+        EXPECT_EQ(meshA.attributeCount(),   meshB.attributeCount());
+
+        auto const *pChainA = a.data_try_get<MeshLodChain const>(gc_mesh, dataA.m_meshes[i]);
+        auto const *pChainB = b.data_try_get<MeshLodChain const>(gc_mesh, dataB.m_meshes[i]);
+        ASSERT_EQ(pChainA != nullptr, pChainB != nullptr);
+        if (pChainA != nullptr)
+        {
+            EXPECT_EQ(pChainA->m_errors, pChainB->m_errors);
+        }
+    }
+
+    auto const &prefabsA = a.data_get<Prefabs const>(gc_importer, importerA);
+    auto const &prefabsB = b.data_get<Prefabs const>(gc_importer, importerB);
+
+    EXPECT_EQ(prefabsA.m_prefabNames,   prefabsB.m_prefabNames);
+    EXPECT_EQ(prefabsA.m_objShape,      prefabsB.m_objShape);
+    EXPECT_EQ(prefabsA.m_objMass,       prefabsB.m_objMass);
+
+    for (PrefabId prefab = 0; prefab < prefabsA.m_prefabNames.size(); ++prefab)
+    {
+        auto const objsA    = prefabsA.m_prefabs[prefab];
+        auto const objsB    = prefabsB.m_prefabs[prefab];
+        auto const parentsA = prefabsA.m_prefabParents[prefab];
+        auto const parentsB = prefabsB.m_prefabParents[prefab];
+        EXPECT_TRUE(std::equal(objsA.begin(),    objsA.end(),    objsB.begin(),    objsB.end()));
+        EXPECT_TRUE(std::equal(parentsA.begin(), parentsA.end(), parentsB.begin(), parentsB.end()));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// A file loaded from its cache has the same data as one loaded from glTF
+TEST(GltfCache, WriteAndReadBack)
+{
+    std::string const cacheDir = fresh_cache_dir("WriteAndReadBack");
+
+    Resources fromGltf;
+    register_gltf_types(fromGltf);
+
+    // No cache yet, so this loads the glTF and writes a cache file
+    std::array<std::string, 1> const files{gc_gltfPath};
+    std::vector<ResId> const loaded = load_tinygltf_files_cached(
+            arrayView(files.data(), files.size()), cacheDir, fromGltf, fromGltf.pkg_create(), 1);
+    ASSERT_EQ(loaded.size(), 1u);
+    ASSERT_NE(loaded[0], lgrn::id_null<ResId>());
+    ASSERT_TRUE(std::filesystem::exists(cache_file_path(cacheDir)));
+
+    Resources fromCache;
+    register_gltf_types(fromCache);
+
+    ResId const cached = load_gltf_cache(gc_gltfPath, cacheDir, fromCache, fromCache.pkg_create());
+    ASSERT_NE(cached, lgrn::id_null<ResId>());
+
+    expect_same_importer(fromGltf, loaded[0], fromCache, cached);
+
+    release_owners(fromGltf);
+    release_owners(fromCache);
+}
+
+// Truncated or overwritten cache files are ignored, and the glTF is loaded normally instead
+TEST(GltfCache, CorruptFallsBack)
+{
+    std::string const cacheDir  = fresh_cache_dir("CorruptFallsBack");
+    std::string const cachePath = cache_file_path(cacheDir);
+
+    ASSERT_TRUE(load_cached_once(cacheDir));
+    std::uintmax_t const fullSize = std::filesystem::file_size(cachePath);
+    ASSERT_GT(fullSize, sizeof(GltfCacheHeader));
+
+    auto const expect_cache_rejected = [&cacheDir] ()
+    {
+        Resources resources;
+        register_gltf_types(resources);
+        EXPECT_EQ(load_gltf_cache(gc_gltfPath, cacheDir, resources, resources.pkg_create()),
+                  lgrn::id_null<ResId>());
+        release_owners(resources);
+    };
+
+    auto const expect_cache_usable = [&cacheDir] ()
+    {
+        Resources resources;
+        register_gltf_types(resources);
+        EXPECT_NE(load_gltf_cache(gc_gltfPath, cacheDir, resources, resources.pkg_create()),
+                  lgrn::id_null<ResId>());
+        release_owners(resources);
+    };
+
+    // Truncated partway through the section data, like an interrupted write
+    std::filesystem::resize_file(cachePath, fullSize / 2);
+    expect_cache_rejected();
+
+    // Falls back to loading the glTF, and writes a good cache file again
+    EXPECT_TRUE(load_cached_once(cacheDir));
+    EXPECT_EQ(std::filesystem::file_size(cachePath), fullSize);
+    expect_cache_usable();
+
+    // Truncated to less than a header
+    std::filesystem::resize_file(cachePath, sizeof(GltfCacheHeader) - 1);
+    expect_cache_rejected();
+    EXPECT_TRUE(load_cached_once(cacheDir));
+    expect_cache_usable();
+
+    // Same size, but the section table is garbage
+    {
+        std::fstream file{cachePath, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(sizeof(GltfCacheHeader));
+        std::string const garbage(256, '\xAB');
+        file.write(garbage.data(), std::streamsize(garbage.size()));
+    }
+    EXPECT_EQ(std::filesystem::file_size(cachePath), fullSize);
+    expect_cache_rejected();
+    EXPECT_TRUE(load_cached_once(cacheDir));
+    expect_cache_usable();
+}
@@ -0,0 +1,727 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <adera/machines/links.h>
+
+#include <osp/core/bitvector.h>
+#include <osp/link/machines.h>
+#include <osp/link/signal.h>
+#include <osp/link/signal_propagation.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace adera;
+using namespace osp;
+using namespace osp::link;
+
+namespace
+{
+
+struct RcsInput
+{
+    Vector3 pos;
+    Vector3 dir;
+    Vector3 cmdLin;
+    Vector3 cmdAng;
+};
+
+void batch_push(RcsDriverBatch& rBatch, std::size_t const i, RcsInput const& in)
+{
+    rBatch.posX[i]      = in.pos.x();       rBatch.posY[i]      = in.pos.y();       rBatch.posZ[i]      = in.pos.z();
+    rBatch.dirX[i]      = in.dir.x();       rBatch.dirY[i]      = in.dir.y();       rBatch.dirZ[i]      = in.dir.z();
+    rBatch.cmdLinX[i]   = in.cmdLin.x();    rBatch.cmdLinY[i]   = in.cmdLin.y();    rBatch.cmdLinZ[i]   = in.cmdLin.z();
+    rBatch.cmdAngX[i]   = in.cmdAng.x();    rBatch.cmdAngY[i]   = in.cmdAng.y();    rBatch.cmdAngZ[i]   = in.cmdAng.z();
+}
+
+/**
+ * @brief Check thruster_influence_batch against thruster_influence for each input
+ *
+ * Normalizing then taking the dot product rounds differently than dividing the dot product by
+ * both lengths, so results may land on either side of the 0.01 cutoff when they are right at it.
+ */
+void expect_batch_matches(std::vector<RcsInput> const& inputs)
+{
+    RcsDriverBatch batch;
+    batch.resize(inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        batch_push(batch, i, inputs[i]);
+    }
+
+    thruster_influence_batch(batch);
+
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        RcsInput const &in = inputs[i];
+        float const expected = thruster_influence(in.pos, in.dir, in.cmdLin, in.cmdAng);
+        float const actual   = batch.thrOut[i];
+
+        ASSERT_FALSE(std::isnan(actual)) << "input " << i;
+
+        bool const atCutoff = std::min(expected, actual) == 0.0f && std::max(expected, actual) < 0.0101f;
+        if ( ! atCutoff )
+        {
+            ASSERT_NEAR(expected, actual, 1e-4f) << "input " << i;
+        }
+    }
+}
+
+} // namespace
+
+// Random thrusters and commands, with some components zeroed to hit the inactive cases
+TEST(RcsDriver, BatchMatchesRandom)
+{
+    std::mt19937 gen{1234};
+    std::uniform_real_distribution<float> value{-10.0f, 10.0f};
+    std::uniform_int_distribution<int> zeroMask{0, 15};
+
+    auto const random_vec = [&] ()
+    {
+        return Vector3{value(gen), value(gen), value(gen)};
+    };
+
+    std::vector<RcsInput> inputs(200000);
+    for (RcsInput &rIn : inputs)
+    {
+        int const mask = zeroMask(gen);
+        rIn.pos     = (mask & 1) ? Vector3{0.0f} : random_vec();
+        rIn.dir     = random_vec().normalized();
+        rIn.cmdLin  = (mask & 2) ? Vector3{0.0f} : random_vec();
+        rIn.cmdAng  = (mask & 4) ? Vector3{0.0f} : random_vec();
+    }
+
+    // Not a multiple of the batch's internal block size
+    inputs.resize(inputs.size() - 13);
+
+    expect_batch_matches(inputs);
+}
+
+// Degenerate and non-finite inputs must give the same result, and never NaN
+TEST(RcsDriver, BatchMatchesDegenerate)
+{
+    float const nan = std::numeric_limits<float>::quiet_NaN();
+
+    Vector3 const pos{1.0f, 2.0f, 3.0f};
+    Vector3 const dir = Vector3{1.0f, -1.0f, 0.5f}.normalized();
+    Vector3 const cmd{0.3f, -0.2f, 0.9f};
+
+    std::vector<RcsInput> const inputs
+    {
+        // Everything zero
+        { Vector3{0.0f},    Vector3{0.0f},  Vector3{0.0f},  Vector3{0.0f} },
+        // Thruster at the origin, no torque to normalize
+        { Vector3{0.0f},    dir,            cmd,            cmd },
+        { Vector3{0.0f},    dir,            Vector3{0.0f},  cmd },
+        // Thruster pointing along its position, cross product is exactly zero
+        { dir * 2.0f,       dir,            cmd,            cmd },
+        { dir * 2.0f,       dir,            cmd,            Vector3{0.0f} },
+        // Zero direction
+        { pos,              Vector3{0.0f},  cmd,            cmd },
+        // Opposing commands, negative influence
+        { pos,              dir,            -dir,           Vector3{0.0f} },
+        // Exactly along the command, influence clamped to 1
+        { pos,              dir,            dir,            Vector3{0.0f} },
+        // NaN in each input
+        { Vector3{nan},     dir,            cmd,            cmd },
+        { Vector3{nan},     dir,            cmd,            Vector3{0.0f} },
+        { pos,              Vector3{nan},   cmd,            cmd },
+        { pos,              dir,            Vector3{nan},   cmd },
+        { pos,              dir,            cmd,            Vector3{nan} },
+        { pos,              dir,            Vector3{nan},   Vector3{nan} },
+    };
+
+    expect_batch_matches(inputs);
+}
+
+// Many workers write Node values at once, then everything is merged on one thread
+TEST(UpdateNodesConcurrent, MultithreadedAssignAndMerge)
+{
+    constexpr std::size_t const c_nodeCount     = 1000;
+    constexpr std::size_t const c_workerCount   = 8;
+    constexpr int const         c_repeats       = 50;
+    constexpr NodeId const      c_sharedNode    = c_nodeCount - 1;
+
+    UpdateNodesConcurrent<float> conc;
+    conc.resize(c_nodeCount, c_workerCount);
+
+    UpdateNodes<float> upd;
+    upd.nodeNewValues.resize(c_nodeCount, 0.0f);
+    bitvector_resize(upd.nodeDirty, c_nodeCount);
+
+    for (int repeat = 0; repeat < c_repeats; ++repeat)
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t worker = 0; worker < c_workerCount; ++worker)
+        {
+            threads.emplace_back([&conc, worker, repeat] ()
+            {
+                // Each worker has its own nodes. Nodes with (node % 16 >= 8) are never written.
+                for (NodeId node = NodeId(worker); node < c_sharedNode; node += 16)
+                {
+                    conc.assign(worker, node, float(node + repeat));
+                }
+
+                // Every worker writes this one, the highest worker index wins
+                conc.assign(worker, c_sharedNode, float(worker));
+            });
+        }
+        for (std::thread &rThread : threads)
+        {
+            rThread.join();
+        }
+
+        upd.nodeDirty.reset();
+        upd.dirty = false;
+
+        ASSERT_TRUE(conc.merge_into(upd));
+        EXPECT_TRUE(upd.dirty);
+
+        for (NodeId node = 0; node < c_sharedNode; ++node)
+        {
+            bool const written = (node % 16) < c_workerCount;
+            ASSERT_EQ(upd.nodeDirty.test(node), written) << "node " << node;
+            if (written)
+            {
+                ASSERT_EQ(upd.nodeNewValues[node], float(node + repeat)) << "node " << node;
+            }
+        }
+        EXPECT_TRUE(upd.nodeDirty.test(c_sharedNode));
+        EXPECT_EQ(upd.nodeNewValues[c_sharedNode], float(c_workerCount - 1));
+
+        // Everything was moved out
+        EXPECT_FALSE(conc.merge_into(upd));
+    }
+}
+
+// Two workers write the same Node; the higher worker index wins no matter who wrote first
+TEST(UpdateNodesConcurrent, SameNodeHighestWorkerWins)
+{
+    constexpr NodeId const c_node = 70; // Second dirty word
+
+    UpdateNodesConcurrent<float> conc;
+    conc.resize(128, 3);
+
+    UpdateNodes<float> upd;
+    upd.nodeNewValues.resize(128, 0.0f);
+    bitvector_resize(upd.nodeDirty, 128);
+
+    conc.assign(2, c_node, 2.0f);
+    conc.assign(0, c_node, 0.0f);
+    conc.assign(1, c_node, 1.0f);
+
+    ASSERT_TRUE(conc.merge_into(upd));
+    EXPECT_TRUE(upd.nodeDirty.test(c_node));
+    EXPECT_FALSE(upd.nodeDirty.test(c_node - 1));
+    EXPECT_FALSE(upd.nodeDirty.test(c_node + 1));
+    EXPECT_EQ(upd.nodeNewValues[c_node], 2.0f);
+
+    // Same worker writing twice keeps its last value
+    conc.assign(0, c_node, 5.0f);
+    conc.assign(1, c_node, 3.0f);
+    conc.assign(1, c_node, 4.0f);
+
+    ASSERT_TRUE(conc.merge_into(upd));
+    EXPECT_EQ(upd.nodeNewValues[c_node], 4.0f);
+}
+
+namespace
+{
+
+constexpr MachTypeId const gc_testTypeCount = 3;
+
+struct TestNetwork
+{
+    TestNetwork()
+    {
+        machines.perType.resize(gc_testTypeCount);
+    }
+
+    Machines    machines;
+    Nodes       nodes;
+};
+
+/**
+ * @brief Add Machines connected to newly created Nodes, the same way spawning a vehicle does
+ *
+ * Existing Nodes and Machines are left untouched, as compile_nodes_update requires.
+ */
+void add_random_machines(
+        TestNetwork& rNet, std::mt19937& rGen, std::size_t const machCount, std::size_t const nodeCount, std::size_t const maxPorts)
+{
+    Machines    &rMachines  = rNet.machines;
+    Nodes       &rNodes     = rNet.nodes;
+
+    std::vector<NodeId> newNodes(nodeCount);
+    for (NodeId &rNode : newNodes)
+    {
+        rNode = rNodes.nodeIds.create();
+    }
+
+    std::uniform_int_distribution<int>          typeDist{0, gc_testTypeCount - 1};
+    std::uniform_int_distribution<std::size_t>  portCountDist{1, maxPorts};
+    std::uniform_int_distribution<std::size_t>  nodeDist{0, nodeCount}; // nodeCount for not connected
+
+    std::vector<std::vector<Junction>> newJuncs(nodeCount);
+
+    for (std::size_t i = 0; i < machCount; ++i)
+    {
+        auto const          type    = MachTypeId(typeDist(rGen));
+        MachAnyId const     mach    = rMachines.ids.create();
+        PerMachType         &rType  = rMachines.perType[type];
+        MachLocalId const   local   = rType.localIds.create();
+
+        rMachines.machTypes     .resize(rMachines.ids.capacity());
+        rMachines.machToLocal   .resize(rMachines.ids.capacity());
+        rType.localToAny        .resize(rType.localIds.capacity());
+        rMachines.machTypes[mach]   = type;
+        rMachines.machToLocal[mach] = local;
+        rType.localToAny[local]     = mach;
+
+        std::size_t const portCount = portCountDist(rGen);
+        rNodes.machToNode.ids_reserve(rMachines.ids.capacity());
+        rNodes.machToNode.data_reserve(rNodes.machToNode.data_size() + portCount);
+        NodeId *pPorts = rNodes.machToNode.emplace(mach, portCount);
+
+        for (std::size_t port = 0; port < portCount; ++port)
+        {
+            std::size_t const nodeIndex = nodeDist(rGen);
+            if (nodeIndex == nodeCount)
+            {
+                pPorts[port] = lgrn::id_null<NodeId>();
+                continue;
+            }
+            pPorts[port] = newNodes[nodeIndex];
+            newJuncs[nodeIndex].push_back({ .local = local, .type = type, .custom = JuncCustom(port % 2) });
+        }
+    }
+
+    rNodes.nodeToMach.ids_reserve(rNodes.nodeIds.capacity());
+    for (std::size_t i = 0; i < nodeCount; ++i)
+    {
+        rNodes.nodeToMach.data_reserve(rNodes.nodeToMach.data_size() + newJuncs[i].size());
+        Junction *pJuncs = rNodes.nodeToMach.emplace(newNodes[i], newJuncs[i].size());
+        std::copy(newJuncs[i].begin(), newJuncs[i].end(), pJuncs);
+    }
+}
+
+void expect_compiled_equal(CompiledNodes const& a, CompiledNodes const& b)
+{
+    ASSERT_EQ(a.perMachType.size(), b.perMachType.size());
+    for (MachTypeId type = 0; type < a.perMachType.size(); ++type)
+    {
+        CompiledNodes::MachTypePorts const &portsA = a.perMachType[type];
+        CompiledNodes::MachTypePorts const &portsB = b.perMachType[type];
+        EXPECT_EQ(portsA.portCount,  portsB.portCount)  << "type " << type;
+        EXPECT_EQ(portsA.localCount, portsB.localCount) << "type " << type;
+        EXPECT_EQ(portsA.portNodes,  portsB.portNodes)  << "type " << type;
+    }
+
+    ASSERT_EQ(a.nodeJuncOffsets, b.nodeJuncOffsets);
+    ASSERT_EQ(a.nodeJuncs.size(), b.nodeJuncs.size());
+    for (std::size_t i = 0; i < a.nodeJuncs.size(); ++i)
+    {
+        EXPECT_EQ(a.nodeJuncs[i].local,  b.nodeJuncs[i].local);
+        EXPECT_EQ(a.nodeJuncs[i].type,   b.nodeJuncs[i].type);
+        EXPECT_EQ(a.nodeJuncs[i].custom, b.nodeJuncs[i].custom);
+    }
+}
+
+} // namespace
+
+// Compiling after each batch of added Machines must give the same result as compiling from scratch
+TEST(CompiledNodes, IncrementalMatchesFull)
+{
+    std::mt19937 gen{42};
+    TestNetwork net;
+    CompiledNodes incremental;
+
+    // Port counts grow over time, so some batches overflow a Machine type's stride
+    for (std::size_t batch = 0; batch < 20; ++batch)
+    {
+        std::size_t const maxPorts = 2 + batch / 4;
+        add_random_machines(net, gen, 1 + batch % 7, 1 + batch % 5, maxPorts);
+
+        compile_nodes_update(net.nodes, net.machines, incremental);
+
+        CompiledNodes full;
+        compile_nodes(net.nodes, net.machines, full);
+
+        expect_compiled_equal(incremental, full);
+
+        // Every Machine's ports are found through the compiled copy
+        for (MachAnyId const mach : net.machines.ids.bitview().zeros())
+        {
+            MachTypeId const  type  = net.machines.machTypes[mach];
+            MachLocalId const local = net.machines.machToLocal[mach];
+            auto const ports    = incremental.perMachType[type].ports(local);
+            auto const expected = net.nodes.machToNode[mach];
+
+            ASSERT_GE(ports.size(), expected.size());
+            for (std::size_t port = 0; port < ports.size(); ++port)
+            {
+                EXPECT_EQ(ports[port], connected_node(expected, PortId(port)));
+            }
+        }
+    }
+}
+
+namespace
+{
+
+constexpr MachTypeId const gc_mtSatAdd  = 0; ///< Output is the sum of inputs plus one, up to SignalNet::cap
+constexpr MachTypeId const gc_mtAdd     = 1; ///< Output is the sum of inputs plus one
+
+/**
+ * @brief Machines that each read some int32_t Nodes and write one, updated by propagate_signals
+ */
+struct SignalNet
+{
+    SignalNet()
+    {
+        machines.perType.resize(2);
+    }
+
+    NodeId add_node()
+    {
+        NodeId const node = nodes.nodeIds.create();
+        nodeJuncs.resize(nodes.nodeIds.capacity());
+        return node;
+    }
+
+    /**
+     * @brief Add a Machine with inputs on the first ports and its output on the last port
+     */
+    MachAnyId add_machine(MachTypeId const type, std::initializer_list<NodeId> const inputs, NodeId const output)
+    {
+        MachAnyId const     mach    = machines.ids.create();
+        PerMachType         &rType  = machines.perType[type];
+        MachLocalId const   local   = rType.localIds.create();
+
+        machines.machTypes      .resize(machines.ids.capacity());
+        machines.machToLocal    .resize(machines.ids.capacity());
+        rType.localToAny        .resize(rType.localIds.capacity());
+        machines.machTypes[mach]    = type;
+        machines.machToLocal[mach]  = local;
+        rType.localToAny[local]     = mach;
+
+        std::vector<NodeId> ports{inputs};
+        ports.push_back(output);
+
+        nodes.machToNode.ids_reserve(machines.ids.capacity());
+        nodes.machToNode.data_reserve(nodes.machToNode.data_size() + ports.size());
+        std::copy(ports.begin(), ports.end(), nodes.machToNode.emplace(mach, ports.size()));
+
+        for (NodeId const in : inputs)
+        {
+            nodeJuncs[in].push_back({ .local = local, .type = type, .custom = gc_sigIn });
+        }
+        nodeJuncs[output].push_back({ .local = local, .type = type, .custom = gc_sigOut });
+
+        return mach;
+    }
+
+    /**
+     * @brief Compile Nodes and build the SignalGraph once all Machines are added
+     */
+    void finish(int32_t const satCap)
+    {
+        cap = satCap;
+
+        std::size_t const nodeCapacity = nodes.nodeIds.capacity();
+
+        nodes.nodeToMach.ids_reserve(nodeCapacity);
+        for (NodeId const node : nodes.nodeIds.bitview().zeros())
+        {
+            nodes.nodeToMach.data_reserve(nodes.nodeToMach.data_size() + nodeJuncs[node].size());
+            std::copy(nodeJuncs[node].begin(), nodeJuncs[node].end(),
+                      nodes.nodeToMach.emplace(node, nodeJuncs[node].size()));
+        }
+
+        compile_nodes(nodes, machines, compiled);
+        SysSignalGraph::build(graph, compiled, machines);
+
+        values.resize(nodeCapacity, 0);
+        upd.nodeNewValues.resize(nodeCapacity, 0);
+        bitvector_resize(upd.nodeDirty, nodeCapacity);
+
+        bitvector_resize(updMach.machTypesDirty, machines.perType.size());
+        updMach.localDirty.resize(machines.perType.size());
+        funcs.perType.resize(machines.perType.size());
+        for (MachTypeId type = 0; type < machines.perType.size(); ++type)
+        {
+            bitvector_resize(updMach.localDirty[type], machines.perType[type].localIds.capacity());
+        }
+
+        updateCount.assign(machines.ids.capacity(), 0);
+
+        funcs.perType[gc_mtSatAdd]  = { &update<gc_mtSatAdd>,  { this } };
+        funcs.perType[gc_mtAdd]     = { &update<gc_mtAdd>,     { this } };
+    }
+
+    template <MachTypeId TYPE>
+    static void update(ArrayView<MachLocalId const> locals, MachineUpdateFuncs::UserData_t data) noexcept
+    {
+        SignalNet &rNet = *static_cast<SignalNet*>(data[0]);
+
+        for (MachLocalId const local : locals)
+        {
+            ++rNet.updateCount[rNet.machines.perType[TYPE].localToAny[local]];
+
+            ArrayView<NodeId const> const ports = rNet.compiled.perMachType[TYPE].ports(local);
+
+            int32_t sum = 1;
+            for (NodeId const in : ports.exceptSuffix(1))
+            {
+                sum += rNet.values[in];
+            }
+            if constexpr (TYPE == gc_mtSatAdd)
+            {
+                sum = std::min(sum, rNet.cap);
+            }
+
+            NodeId const out = ports[ports.size() - 1];
+            if (rNet.values[out] != sum)
+            {
+                rNet.upd.assign(out, sum);
+            }
+        }
+    }
+
+    /**
+     * @brief Set an input Node's value, then propagate
+     *
+     * @return Return value of propagate_signals
+     */
+    bool set_and_propagate(NodeId const node, int32_t const value)
+    {
+        upd.assign(node, value);
+        return propagate_signals<int32_t>(graph, funcs, compiled, machines, upd, values, updMach, 8);
+    }
+
+    int total_updates() const
+    {
+        return std::accumulate(updateCount.begin(), updateCount.end(), 0);
+    }
+
+    Machines                            machines;
+    Nodes                               nodes;
+    std::vector<std::vector<Junction>>  nodeJuncs;
+
+    CompiledNodes                       compiled;
+    SignalGraph                         graph;
+    MachineUpdateFuncs                  funcs;
+
+    UpdateNodes<int32_t>                upd;
+    SignalValues_t<int32_t>             values;
+    MachineUpdater                      updMach;
+
+    std::vector<int>                    updateCount; ///< Times each Machine was updated
+    int32_t                             cap{0};
+};
+
+} // namespace
+
+// A -> B -> C: one level each, and every Machine updates once
+TEST(SignalPropagation, LinearChain)
+{
+    SignalNet net;
+    NodeId const n0 = net.add_node();
+    NodeId const n1 = net.add_node();
+    NodeId const n2 = net.add_node();
+    NodeId const n3 = net.add_node();
+    MachAnyId const a = net.add_machine(gc_mtAdd, {n0}, n1);
+    MachAnyId const b = net.add_machine(gc_mtAdd, {n1}, n2);
+    MachAnyId const c = net.add_machine(gc_mtAdd, {n2}, n3);
+    net.finish(0);
+
+    ASSERT_EQ(net.graph.levelOffsets, (std::vector<uint32_t>{0, 1, 2, 3}));
+    EXPECT_EQ(net.graph.order, (std::vector<MachAnyId>{a, b, c}));
+    EXPECT_TRUE(net.graph.cyclic.empty());
+
+    EXPECT_FALSE(net.set_and_propagate(n0, 10));
+
+    EXPECT_EQ(net.values[n1], 11);
+    EXPECT_EQ(net.values[n2], 12);
+    EXPECT_EQ(net.values[n3], 13);
+    EXPECT_EQ(net.updateCount[a], 1);
+    EXPECT_EQ(net.updateCount[b], 1);
+    EXPECT_EQ(net.updateCount[c], 1);
+    EXPECT_FALSE(net.upd.dirty);
+}
+
+// A feeds B and C, which both feed D. D waits for both and updates once.
+TEST(SignalPropagation, Diamond)
+{
+    SignalNet net;
+    NodeId const n0 = net.add_node();
+    NodeId const n1 = net.add_node();
+    NodeId const n2 = net.add_node();
+    NodeId const n3 = net.add_node();
+    NodeId const n4 = net.add_node();
+    MachAnyId const a = net.add_machine(gc_mtAdd, {n0}, n1);
+    MachAnyId const b = net.add_machine(gc_mtAdd, {n1}, n2);
+    MachAnyId const c = net.add_machine(gc_mtAdd, {n1}, n3);
+    MachAnyId const d = net.add_machine(gc_mtAdd, {n2, n3}, n4);
+    net.finish(0);
+
+    ASSERT_EQ(net.graph.levelOffsets, (std::vector<uint32_t>{0, 1, 3, 4}));
+    EXPECT_EQ(net.graph.order[0], a);
+    EXPECT_EQ(net.graph.order[3], d);
+    EXPECT_TRUE(std::is_permutation(net.graph.order.begin() + 1, net.graph.order.begin() + 3,
+                                    std::vector<MachAnyId>{b, c}.begin()));
+    EXPECT_TRUE(net.graph.cyclic.empty());
+
+    EXPECT_FALSE(net.set_and_propagate(n0, 10));
+
+    EXPECT_EQ(net.values[n4], 12 + 12 + 1);
+    EXPECT_EQ(net.total_updates(), 4);
+    EXPECT_EQ(net.updateCount[d], 1);
+}
+
+// A Machine reading its own output is cyclic, and settles once its output stops changing
+TEST(SignalPropagation, SelfLoop)
+{
+    SignalNet net;
+    NodeId const n0 = net.add_node();
+    NodeId const n1 = net.add_node();
+    MachAnyId const s = net.add_machine(gc_mtSatAdd, {n0, n1}, n1);
+    net.finish(3);
+
+    EXPECT_TRUE(net.graph.order.empty());
+    EXPECT_EQ(net.graph.cyclic, (std::vector<MachAnyId>{s}));
+
+    EXPECT_FALSE(net.set_and_propagate(n0, 0));
+
+    EXPECT_EQ(net.values[n1], 3);
+    EXPECT_FALSE(net.upd.dirty);
+}
+
+// Two Machines feeding each other, saturating so the cycle settles within maxCycleIterations
+TEST(SignalPropagation, TwoNodeCycleSettles)
+{
+    SignalNet net;
+    NodeId const n0 = net.add_node();
+    NodeId const n1 = net.add_node();
+    NodeId const n2 = net.add_node();
+    MachAnyId const a = net.add_machine(gc_mtSatAdd, {n0, n2}, n1);
+    MachAnyId const b = net.add_machine(gc_mtSatAdd, {n1}, n2);
+    net.finish(4);
+
+    EXPECT_TRUE(net.graph.order.empty());
+    EXPECT_EQ(net.graph.cyclic, (std::vector<MachAnyId>{a, b}));
+
+    EXPECT_FALSE(net.set_and_propagate(n0, 0));
+
+    EXPECT_EQ(net.values[n1], 4);
+    EXPECT_EQ(net.values[n2], 4);
+    EXPECT_FALSE(net.upd.dirty);
+}
+
+// Two Machines feeding each other without limit never settle. Propagation stops after
+// maxCycleIterations and leaves the last changes in UpdateNodes for the next link loop iteration.
+TEST(SignalPropagation, CycleHitsIterationLimit)
+{
+    SignalNet net;
+    NodeId const n0 = net.add_node();
+    NodeId const n1 = net.add_node();
+    NodeId const n2 = net.add_node();
+    net.add_machine(gc_mtAdd, {n0, n2}, n1);
+    net.add_machine(gc_mtAdd, {n1}, n2);
+    net.finish(0);
+
+    EXPECT_TRUE(net.set_and_propagate(n0, 0));
+
+    // One Machine becomes dirty per iteration: 8 iterations, then the extra unapplied run
+    EXPECT_EQ(net.total_updates(), 8 + 1);
+    EXPECT_TRUE(net.upd.dirty);
+
+    // Continuing picks up where it left off
+    int32_t const n1Before = net.values[n1];
+    EXPECT_TRUE(propagate_signals<int32_t>(net.graph, net.funcs, net.compiled, net.machines,
+                                           net.upd, net.values, net.updMach, 8));
+    EXPECT_GT(net.values[n1], n1Before);
+}
+
+namespace
+{
+
+/**
+ * @brief Write a value through UpdateNodes and UpdateNodesConcurrent, then apply it with
+ *        update_signal_nodes, checking the Machine reading that Node is notified
+ */
+template <typename VALUE_T>
+void check_signal_type(VALUE_T const value)
+{
+    SignalNet net; // Only used for its Machines and Nodes, values here are VALUE_T
+    NodeId const in  = net.add_node();
+    NodeId const out = net.add_node();
+    MachAnyId const mach = net.add_machine(gc_mtAdd, {in}, out);
+    net.finish(0);
+
+    MachLocalId const local = net.machines.machToLocal[mach];
+
+    std::size_t const nodeCapacity = net.nodes.nodeIds.capacity();
+
+    SignalValues_t<VALUE_T> values(nodeCapacity, VALUE_T{});
+    UpdateNodes<VALUE_T>    upd;
+    upd.nodeNewValues.resize(nodeCapacity, VALUE_T{});
+    bitvector_resize(upd.nodeDirty, nodeCapacity);
+
+    UpdateNodesConcurrent<VALUE_T> conc;
+    conc.resize(nodeCapacity, 2);
+
+    // Written by a MachUpd-style task, merged at the start of "Update Signal Nodes"
+    conc.assign(1, in, value);
+    ASSERT_TRUE(conc.merge_into(upd));
+    EXPECT_TRUE(upd.nodeDirty.test(in));
+    EXPECT_EQ(upd.nodeNewValues[in], value);
+
+    // Written directly, doesn't notify anything since out is only connected to an output
+    upd.assign(out, value);
+
+    EXPECT_TRUE(update_signal_nodes<VALUE_T>(upd.nodeDirty.ones(), net.compiled, net.machines,
+                                             upd.nodeNewValues, values, net.updMach));
+    EXPECT_EQ(values[in],  value);
+    EXPECT_EQ(values[out], value);
+    EXPECT_TRUE(net.updMach.machTypesDirty.test(gc_mtAdd));
+    EXPECT_TRUE(net.updMach.localDirty[gc_mtAdd].test(local));
+}
+
+} // namespace
+
+// Signal Nodes of each value type setup_signals is instantiated for
+TEST(SignalTypes, AssignAndUpdateNodes)
+{
+    check_signal_type<float>(2.5f);
+    check_signal_type<int32_t>(-7);
+    check_signal_type<bool>(true);
+}
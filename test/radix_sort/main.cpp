@@ -0,0 +1,145 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/core/radix_sort.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+using osp::radix_sort_u64;
+
+namespace
+{
+
+struct Item
+{
+    uint64_t    key;
+    uint32_t    order; ///< Position before sorting, to check stability
+};
+
+constexpr auto gc_itemKey = [] (Item const& item) noexcept { return item.key; };
+
+std::vector<Item> make_items(std::vector<uint64_t> const& keys)
+{
+    std::vector<Item> out;
+    out.reserve(keys.size());
+    for (uint64_t const key : keys)
+    {
+        out.push_back({key, uint32_t(out.size())});
+    }
+    return out;
+}
+
+void expect_same(std::vector<Item> const& a, std::vector<Item> const& b)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(a[i].key,   b[i].key);
+        EXPECT_EQ(a[i].order, b[i].order);
+    }
+}
+
+} // namespace
+
+TEST(RadixSort, EmptyAndSingle)
+{
+    std::vector<Item> scratch;
+
+    std::vector<Item> empty;
+    radix_sort_u64(empty, scratch, gc_itemKey);
+    EXPECT_TRUE(empty.empty());
+
+    std::vector<Item> single = make_items({0xDEADBEEF'12345678u});
+    radix_sort_u64(single, scratch, gc_itemKey);
+    ASSERT_EQ(single.size(), 1u);
+    EXPECT_EQ(single[0].key, 0xDEADBEEF'12345678u);
+}
+
+// Keys with identical low bytes are only put in order by the last passes
+TEST(RadixSort, HighBytesOnly)
+{
+    std::vector<Item> items = make_items({
+            0xFF00000000000000u,
+            0x0100000000000000u,
+            0x0000010000000000u,
+            0x8000000000000000u,
+            0x0001000000000000u });
+    std::vector<Item> scratch;
+
+    radix_sort_u64(items, scratch, gc_itemKey);
+
+    std::vector<uint64_t> const expected{
+            0x0000010000000000u,
+            0x0001000000000000u,
+            0x0100000000000000u,
+            0x8000000000000000u,
+            0xFF00000000000000u };
+    ASSERT_EQ(items.size(), expected.size());
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        EXPECT_EQ(items[i].key, expected[i]);
+    }
+}
+
+// Items with equal keys keep their original relative order
+TEST(RadixSort, Stable)
+{
+    std::vector<Item> items = make_items({3, 1, 3, 2, 1, 3, 0x300, 2, 0x300, 1});
+    std::vector<Item> expected = items;
+    std::vector<Item> scratch;
+
+    radix_sort_u64(items, scratch, gc_itemKey);
+    std::stable_sort(expected.begin(), expected.end(),
+                     [] (Item const& a, Item const& b) { return a.key < b.key; });
+
+    expect_same(items, expected);
+}
+
+// Compare against std::stable_sort with random keys, both full range and with many duplicates
+TEST(RadixSort, MatchesStableSort)
+{
+    std::mt19937_64 gen{1234};
+    std::vector<Item> scratch;
+
+    for (uint64_t const mask : {~uint64_t(0), uint64_t(0xFF), uint64_t(0xF0F0'0000'0000'0F0F)})
+    {
+        for (std::size_t const size : {2u, 63u, 1000u, 20000u})
+        {
+            std::vector<uint64_t> keys(size);
+            std::generate(keys.begin(), keys.end(), [&gen, mask] { return gen() & mask; });
+
+            std::vector<Item> items = make_items(keys);
+            std::vector<Item> expected = items;
+
+            radix_sort_u64(items, scratch, gc_itemKey);
+            std::stable_sort(expected.begin(), expected.end(),
+                             [] (Item const& a, Item const& b) { return a.key < b.key; });
+
+            expect_same(items, expected);
+        }
+    }
+}
@@ -27,6 +27,9 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 using namespace osp;
 
 struct ImageData { int m_dummy{0}; };
@@ -142,3 +145,134 @@ TEST(Resources, RefCounting)
 
 
 }
+
+// Test that commit() maps each staged resource to the ResId it was created as
+TEST(Resources, CommitBatch)
+{
+    Resources res = setup_basic();
+    PkgId pkgA = res.pkg_create();
+    PkgId pkgB = res.pkg_create();
+
+    // Existing resources, so committed ResIds don't line up with BatchResIds
+    ResId const existingMesh = res.create(restypes::gc_mesh, pkgA, SharedString::create_reference("MeshOld"));
+    res.data_add<MeshData>(restypes::gc_mesh, existingMesh, MeshData{-1});
+
+    ResourceBatch batch;
+    BatchResId const meshA   = batch.create(restypes::gc_mesh,    pkgA, SharedString::create_reference("MeshA"));
+    BatchResId const imageA  = batch.create(restypes::gc_image,   pkgA, SharedString::create_reference("ImageA"));
+    BatchResId const meshB   = batch.create(restypes::gc_mesh,    pkgB, SharedString::create_reference("MeshB"));
+    BatchResId const texB    = batch.create(restypes::gc_texture, pkgB, SharedString::create_reference("TexB"));
+    EXPECT_EQ(batch.size(), 4u);
+
+    // Stage data out of order, and several types for one resource
+    batch.data_add<ExtraData>   (meshB,  ExtraData{23});
+    batch.data_add<TextureData> (texB,   TextureData{4});
+    batch.data_add<MeshData>    (meshA,  MeshData{10});
+    batch.data_add<ImageData>   (imageA, ImageData{2});
+    batch.data_add<MeshData>    (meshB,  MeshData{20});
+    batch.data_add<ExtraData>   (texB,   ExtraData{44});
+
+    std::vector<ResId> const ids = res.commit(std::move(batch));
+    EXPECT_TRUE(batch.empty()); // NOLINT(bugprone-use-after-move)
+    ASSERT_EQ(ids.size(), 4u);
+
+    EXPECT_EQ(res.find(restypes::gc_mesh,    pkgA, "MeshA"),  ids[meshA]);
+    EXPECT_EQ(res.find(restypes::gc_image,   pkgA, "ImageA"), ids[imageA]);
+    EXPECT_EQ(res.find(restypes::gc_mesh,    pkgB, "MeshB"),  ids[meshB]);
+    EXPECT_EQ(res.find(restypes::gc_texture, pkgB, "TexB"),   ids[texB]);
+    EXPECT_EQ(res.name(restypes::gc_mesh, ids[meshB]), "MeshB");
+
+    EXPECT_EQ(res.data_get<MeshData>    (restypes::gc_mesh,    ids[meshA]).m_dummy,   10);
+    EXPECT_EQ(res.data_try_get<ExtraData>(restypes::gc_mesh,   ids[meshA]),           nullptr);
+    EXPECT_EQ(res.data_get<ImageData>   (restypes::gc_image,   ids[imageA]).m_dummy,  2);
+    EXPECT_EQ(res.data_get<MeshData>    (restypes::gc_mesh,    ids[meshB]).m_dummy,   20);
+    EXPECT_EQ(res.data_get<ExtraData>   (restypes::gc_mesh,    ids[meshB]).m_dummy,   23);
+    EXPECT_EQ(res.data_get<TextureData> (restypes::gc_texture, ids[texB]).m_dummy,    4);
+    EXPECT_EQ(res.data_get<ExtraData>   (restypes::gc_texture, ids[texB]).m_dummy,    44);
+
+    // Existing data is untouched
+    EXPECT_EQ(res.data_get<MeshData>(restypes::gc_mesh, existingMesh).m_dummy, -1);
+}
+
+// Test readers and owners on many threads at once, then publishing a batch
+TEST(Resources, ConcurrentRead)
+{
+    constexpr int const c_imageCount    = 64;
+    constexpr int const c_threadCount   = 8;
+    constexpr int const c_repeats       = 1000;
+
+    Resources res = setup_basic();
+    PkgId pkgA = res.pkg_create();
+
+    std::vector<SharedString> names;
+    for (int i = 0; i < c_imageCount; ++i)
+    {
+        names.push_back(SharedString::create("Image" + std::to_string(i)));
+        ResId const id = res.create(restypes::gc_image, pkgA, names.back());
+        res.data_add<ImageData>(restypes::gc_image, id, ImageData{i});
+    }
+
+    std::vector<ResourceBatch> batches(c_threadCount);
+    std::vector<int> mismatches(c_threadCount, 0);
+
+    res.concurrent_read_begin();
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < c_threadCount; ++t)
+        {
+            threads.emplace_back([&res, &names, &batches, &mismatches, pkgA, t] ()
+            {
+                std::vector<ResIdOwner_t> owners;
+                for (int n = 0; n < c_repeats; ++n)
+                {
+                    int const i = (n + t) % c_imageCount;
+                    ResId const id = res.find(restypes::gc_image, pkgA, names[i]);
+                    if (id == lgrn::id_null<ResId>() || res.data_get<ImageData const>(restypes::gc_image, id).m_dummy != i)
+                    {
+                        ++ mismatches[t];
+                    }
+                    owners.push_back(res.owner_create(restypes::gc_image, id));
+                }
+                for (ResIdOwner_t &rOwner : owners)
+                {
+                    res.owner_destroy(restypes::gc_image, std::move(rOwner));
+                }
+
+                BatchResId const batchId = batches[t].create(restypes::gc_mesh, pkgA, SharedString::create("Mesh" + std::to_string(t)));
+                batches[t].data_add<MeshData>(batchId, MeshData{t});
+                batches[t].data_add<ExtraData>(batchId, ExtraData{-t});
+            });
+        }
+        for (std::thread &rThread : threads)
+        {
+            rThread.join();
+        }
+    }
+    res.concurrent_read_end();
+
+    for (int t = 0; t < c_threadCount; ++t)
+    {
+        EXPECT_EQ(mismatches[t], 0);
+
+        std::vector<ResId> const ids = res.commit(std::move(batches[t]));
+        ASSERT_EQ(ids.size(), 1u);
+        EXPECT_EQ(res.find(restypes::gc_mesh, pkgA, "Mesh" + std::to_string(t)), ids[0]);
+        EXPECT_EQ(res.data_get<MeshData>(restypes::gc_mesh, ids[0]).m_dummy, t);
+        EXPECT_EQ(res.data_get<ExtraData>(restypes::gc_mesh, ids[0]).m_dummy, -t);
+    }
+
+    // Owner counts are back to zero, Resources would assert on destruction otherwise
+
+    #ifdef NDEBUG
+        GTEST_SKIP(); // following death tests use asserts
+    #endif
+
+    // Creating resources while concurrent readers may be running
+    EXPECT_DEATH({
+        Resources resB = setup_basic();
+        PkgId pkgB = resB.pkg_create();
+
+        resB.concurrent_read_begin();
+        [[maybe_unused]] ResId id = resB.create(restypes::gc_image, pkgB, SharedString::create_reference("Image0"));
+    }, "m_concurrentRead");
+}
@@ -0,0 +1,150 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/core/scratch_arena.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using osp::ScratchArena;
+using osp::ScratchVec_t;
+
+// Every allocation is aligned as requested and doesn't overlap the one before it
+TEST(ScratchArena, Alignment)
+{
+    ScratchArena arena{1024};
+
+    std::vector<std::pair<std::uintptr_t, std::size_t>> allocs;
+    for (std::size_t const align : {1, 2, 4, 8, 16, 32, 64, 1, 64})
+    {
+        for (std::size_t const size : {1, 3, 7, 24})
+        {
+            auto const ptr = reinterpret_cast<std::uintptr_t>(arena.allocate(size, align));
+            EXPECT_EQ(ptr % align, 0u);
+            allocs.emplace_back(ptr, size);
+        }
+    }
+
+    for (std::size_t i = 0; i < allocs.size(); ++i)
+    {
+        for (std::size_t j = i + 1; j < allocs.size(); ++j)
+        {
+            auto const [a, aSize] = allocs[i];
+            auto const [b, bSize] = allocs[j];
+            EXPECT_TRUE(a + aSize <= b || b + bSize <= a);
+        }
+    }
+}
+
+// Running out of space adds blocks; memory from earlier blocks stays valid
+TEST(ScratchArena, Growth)
+{
+    constexpr std::size_t sc_blockSize = 256;
+    constexpr std::size_t sc_count     = 20;
+    constexpr std::size_t sc_size      = 100;
+
+    ScratchArena arena{sc_blockSize};
+    EXPECT_EQ(arena.capacity(), 0u);
+
+    std::vector<unsigned char*> allocs;
+    for (std::size_t i = 0; i < sc_count; ++i)
+    {
+        auto *pData = static_cast<unsigned char*>(arena.allocate(sc_size, 4));
+        std::memset(pData, int(i), sc_size);
+        allocs.push_back(pData);
+    }
+
+    EXPECT_EQ(arena.used(), sc_count * sc_size);
+    EXPECT_GT(arena.capacity(), sc_blockSize);
+
+    // Bigger than a block
+    auto *pBig = static_cast<unsigned char*>(arena.allocate(sc_blockSize * 4, 8));
+    std::memset(pBig, 0xFF, sc_blockSize * 4);
+
+    for (std::size_t i = 0; i < sc_count; ++i)
+    {
+        for (std::size_t j = 0; j < sc_size; ++j)
+        {
+            ASSERT_EQ(allocs[i][j], (unsigned char)(i));
+        }
+    }
+}
+
+// reset() merges blocks into one, after which the same workload doesn't allocate again
+TEST(ScratchArena, ResetReuse)
+{
+    ScratchArena arena{256};
+
+    auto const workload = [&arena] ()
+    {
+        for (std::size_t i = 0; i < 20; ++i)
+        {
+            std::memset(arena.allocate(100, 4), 0, 100);
+        }
+    };
+
+    workload();
+    std::size_t const capacity = arena.capacity();
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    void *pFirst = arena.allocate(100, 4);
+    arena.reset();
+    EXPECT_EQ(arena.allocate(100, 4), pFirst);
+    arena.reset();
+
+    for (int run = 0; run < 5; ++run)
+    {
+        workload();
+        EXPECT_EQ(arena.capacity(), capacity);
+        arena.reset();
+    }
+}
+
+TEST(ScratchArena, ScratchVec)
+{
+    ScratchArena arena{128};
+
+    for (int run = 0; run < 3; ++run)
+    {
+        {
+            ScratchVec_t<int> vec{arena};
+            for (int i = 0; i < 1000; ++i)
+            {
+                vec.push_back(i);
+            }
+            for (int i = 0; i < 1000; ++i)
+            {
+                ASSERT_EQ(vec[i], i);
+            }
+        }
+        arena.reset();
+    }
+}
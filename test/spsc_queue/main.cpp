@@ -0,0 +1,127 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <osp/core/spsc_queue.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using osp::SpscQueue;
+
+// Values come out in the order they went in, and pushing to a full queue is rejected
+TEST(SpscQueue, OrderAndFull)
+{
+    SpscQueue<std::unique_ptr<int>> queue{5}; // Rounded up to 8
+
+    EXPECT_FALSE(queue.try_pop().has_value());
+
+    for (int i = 0; i < 8; ++i)
+    {
+        auto value = std::make_unique<int>(i);
+        ASSERT_TRUE(queue.try_push(std::move(value)));
+        EXPECT_EQ(value, nullptr);
+    }
+    EXPECT_EQ(queue.size(), 8u);
+
+    // Rejected value is left untouched
+    auto rejected = std::make_unique<int>(100);
+    EXPECT_FALSE(queue.try_push(std::move(rejected)));
+    ASSERT_NE(rejected, nullptr);
+    EXPECT_EQ(*rejected, 100);
+
+    // Wrap around the end of the ring a few times
+    for (int i = 8; i < 40; ++i)
+    {
+        std::optional<std::unique_ptr<int>> popped = queue.try_pop();
+        ASSERT_TRUE(popped.has_value());
+        EXPECT_EQ(**popped, i - 8);
+        ASSERT_TRUE(queue.try_push(std::make_unique<int>(i)));
+    }
+
+    for (int i = 32; i < 40; ++i)
+    {
+        std::optional<std::unique_ptr<int>> popped = queue.try_pop();
+        ASSERT_TRUE(popped.has_value());
+        EXPECT_EQ(**popped, i);
+    }
+
+    EXPECT_FALSE(queue.try_pop().has_value());
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+// One producer thread and one consumer thread through a small queue, so it's often full or empty
+TEST(SpscQueue, ProducerConsumerThreads)
+{
+    constexpr uint32_t sc_count = 200000;
+
+    SpscQueue<uint32_t> queue{4};
+
+    std::thread producer{[&queue] ()
+    {
+        for (uint32_t i = 0; i < sc_count; ++i)
+        {
+            uint32_t value = i;
+            while ( ! queue.try_push(std::move(value)) )
+            {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    uint32_t expected = 0;
+    while (expected < sc_count)
+    {
+        if (std::optional<uint32_t> const popped = queue.try_pop())
+        {
+            ASSERT_EQ(*popped, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+// Values still in the queue are destroyed with it
+TEST(SpscQueue, DestroyWithValues)
+{
+    auto const token = std::make_shared<int>(0);
+    {
+        SpscQueue<std::shared_ptr<int>> queue{4};
+        for (int i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(queue.try_push(std::shared_ptr<int>{token}));
+        }
+        (void) queue.try_pop();
+        EXPECT_EQ(token.use_count(), 3);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}
@@ -0,0 +1,810 @@
+/**
+ * Open Space Program
+ * Copyright © 2019-2023 Open Space Program Project
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <adera/activescene/vehicles_vb_fn.h>
+#include <adera/activescene/VehicleBuildService.h>
+#include <adera/activescene/VehicleFile.h>
+#include <adera/machines/links.h>
+
+#include <osp/activescene/basic_fn.h>
+#include <osp/activescene/vehicles_fn.h>
+
+#include <osp/core/Resources.h>
+#include <osp/link/signal.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+
+using namespace adera;
+using namespace osp;
+using namespace osp::active;
+using namespace osp::link;
+
+using osp::restypes::gc_importer;
+
+MachTypeId const gc_mtTestCtrl   = MachTypeReg_t::create();
+MachTypeId const gc_mtTestEngine = MachTypeReg_t::create();
+
+PortEntry const gc_testCtrlOut      { gc_ntSigFloat, 0, gc_sigOut };
+PortEntry const gc_testEngineIn     { gc_ntSigFloat, 0, gc_sigIn };
+PortEntry const gc_testEngineMulIn  { gc_ntSigFloat, 1, gc_sigIn };
+
+/**
+ * @brief Vehicle with a controller driving a row of engines, welded as one piece
+ */
+VehicleData make_test_vehicle(Resources &rResources)
+{
+    VehicleBuilder vbuilder{&rResources};
+
+    auto const parts = vbuilder.create_parts<8>();
+    auto const [ throttle, thrustMul ] = vbuilder.create_nodes<2>(gc_ntSigFloat);
+
+    vbuilder.node_values< SignalValues_t<float> >(gc_ntSigFloat)[thrustMul] = 42.0f;
+
+    vbuilder.create_machine(parts[0], gc_mtTestCtrl, {
+        { gc_testCtrlOut, throttle }
+    } );
+
+    for (std::size_t i = 1; i < parts.size(); ++i)
+    {
+        vbuilder.create_machine(parts[i], gc_mtTestEngine, {
+            { gc_testEngineIn,      throttle },
+            { gc_testEngineMulIn,   thrustMul }
+        } );
+    }
+
+    VehicleBuilder::WeldVec_t toWeld;
+    for (PartId const part : parts)
+    {
+        toWeld.push_back({part, Matrix4{}});
+    }
+    vbuilder.weld(toWeld);
+
+    return vbuilder.finalize_release();
+}
+
+void spawn(ACtxVehicleSpawn &rVehicleSpawn, ACtxVehicleSpawnVB &rVehicleSpawnVB, ACtxParts &rScnParts)
+{
+    SysVehicleSpawnVB::create_parts_and_welds   (rVehicleSpawn, rVehicleSpawnVB, rScnParts);
+    SysVehicleSpawnVB::create_machines          (rVehicleSpawn, rVehicleSpawnVB, rScnParts);
+    SysVehicleSpawnVB::update_part_machine_maps (rVehicleSpawn, rVehicleSpawnVB, rScnParts);
+    SysVehicleSpawnVB::create_nodes             (rVehicleSpawn, rVehicleSpawnVB, rScnParts);
+}
+
+// Spawn many copies of the same vehicle in one go, then check that every copy is wired up the
+// same way as the original
+TEST(Vehicles, SpawnManyIdentical)
+{
+    constexpr std::size_t sc_vehicleCount = 1000;
+
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<Prefabs>(gc_importer);
+
+    VehicleData const vehicle = make_test_vehicle(resources);
+
+    ACtxParts scnParts;
+    scnParts.machines.perType.resize(MachTypeReg_t::size());
+    scnParts.nodePerType.resize(NodeTypeReg_t::size());
+
+    ACtxVehicleSpawn    vehicleSpawn;
+    ACtxVehicleSpawnVB  vehicleSpawnVB;
+
+    vehicleSpawn.spawnRequest.resize(sc_vehicleCount);
+    vehicleSpawnVB.dataVB.resize(sc_vehicleCount, &vehicle);
+
+    spawn(vehicleSpawn, vehicleSpawnVB, scnParts);
+
+    std::size_t const partCount = vehicle.m_partIds.size();
+    std::size_t const machCount = vehicle.m_machines.ids.size();
+
+    ASSERT_EQ(scnParts.partIds.size(),      sc_vehicleCount * partCount);
+    ASSERT_EQ(scnParts.weldIds.size(),      sc_vehicleCount * vehicle.m_weldIds.size());
+    ASSERT_EQ(scnParts.machines.ids.size(), sc_vehicleCount * machCount);
+    ASSERT_EQ(scnParts.nodePerType[gc_ntSigFloat].nodeIds.size(),
+              sc_vehicleCount * vehicle.m_nodePerType[gc_ntSigFloat].nodeIds.size());
+
+    Nodes const &scnNodes = scnParts.nodePerType[gc_ntSigFloat];
+
+    for (uint32_t spVhInt = 0; spVhInt < sc_vehicleCount; ++spVhInt)
+    {
+        SpPartId const partOffset = vehicleSpawn.spawnedPartOffsets[SpVehicleId{spVhInt}];
+        SpMachAnyId const machOffset = vehicleSpawn.spawnedMachOffsets[SpVehicleId{spVhInt}];
+
+        // Every part is in the same weld
+        WeldId const weld = scnParts.partToWeld[vehicleSpawn.spawnedParts[partOffset]];
+        EXPECT_EQ(scnParts.weldToParts[weld].size(), partCount);
+
+        for (uint32_t i = 0; i < machCount; ++i)
+        {
+            MachAnyId const     mach    = vehicleSpawn.spawnedMachs[SpMachAnyId{machOffset.value + i}];
+            MachTypeId const    type    = scnParts.machines.machTypes[mach];
+            MachLocalId const   local   = scnParts.machines.machToLocal[mach];
+            PartId const        part    = scnParts.machineToPart[mach];
+
+            EXPECT_EQ(scnParts.machines.perType[type].localToAny[local], mach);
+            EXPECT_EQ(scnParts.partToWeld[part], weld);
+
+            // Part-to-machine map points back to this machine
+            auto const pairs = scnParts.partToMachines[part];
+            ASSERT_EQ(pairs.size(), 1u);
+            EXPECT_EQ(pairs[0].type,  type);
+            EXPECT_EQ(pairs[0].local, local);
+
+            // Every port is connected to a node that connects back to this machine
+            for (NodeId const node : scnNodes.machToNode[mach])
+            {
+                ASSERT_NE(node, lgrn::id_null<NodeId>());
+                auto const juncs = scnNodes.nodeToMach[node];
+                EXPECT_TRUE(std::any_of(juncs.begin(), juncs.end(), [type, local] (Junction const& junc)
+                {
+                    return junc.type == type && junc.local == local;
+                }));
+            }
+        }
+
+        // Throttle node is shared by the controller and all engines
+        MachAnyId const ctrl = vehicleSpawn.spawnedMachs[machOffset];
+        EXPECT_EQ(scnNodes.nodeToMach[scnNodes.machToNode[ctrl][0]].size(), machCount);
+    }
+}
+
+template <typename A_T, typename B_T>
+void expect_same_ids(A_T const& a, B_T const& b)
+{
+    ASSERT_EQ(a.capacity(), b.capacity());
+    for (std::size_t id = 0; id < a.capacity(); ++id)
+    {
+        EXPECT_EQ(a.exists(id), b.exists(id));
+    }
+}
+
+// Save a vehicle, load it back, and check that the VehicleData and its template are unchanged
+TEST(VehicleFile, RoundTrip)
+{
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<Prefabs>(gc_importer);
+
+    VehicleData const vehicle = make_test_vehicle(resources);
+
+    std::string const path = (std::filesystem::temp_directory_path() / "osp_test_roundtrip.ospveh").string();
+    ASSERT_TRUE(SysVehicleFile::write(vehicle, resources, path));
+
+    std::optional<VehicleFileView> const file = VehicleFileView::map(path);
+    ASSERT_TRUE(file.has_value());
+
+    VehicleData const loaded = SysVehicleFile::load(*file, resources);
+
+    // Parts and Welds
+
+    expect_same_ids(loaded.m_partIds, vehicle.m_partIds);
+    expect_same_ids(loaded.m_weldIds, vehicle.m_weldIds);
+
+    for (PartId const part : vehicle.m_partIds.bitview().zeros())
+    {
+        EXPECT_EQ(loaded.m_partTransformWeld[part], vehicle.m_partTransformWeld[part]);
+        EXPECT_EQ(loaded.m_partToWeld[part],        vehicle.m_partToWeld[part]);
+
+        auto const loadedPairs = loaded.m_partToMachines[part];
+        auto const pairs       = vehicle.m_partToMachines[part];
+        ASSERT_EQ(loadedPairs.size(), pairs.size());
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+        {
+            EXPECT_EQ(loadedPairs[i].type,  pairs[i].type);
+            EXPECT_EQ(loadedPairs[i].local, pairs[i].local);
+        }
+    }
+
+    for (WeldId const weld : vehicle.m_weldIds.bitview().zeros())
+    {
+        auto const loadedParts = loaded.m_weldToParts[weld];
+        auto const parts       = vehicle.m_weldToParts[weld];
+        EXPECT_TRUE(std::equal(loadedParts.begin(), loadedParts.end(), parts.begin(), parts.end()));
+    }
+
+    // Machines
+
+    expect_same_ids(loaded.m_machines.ids, vehicle.m_machines.ids);
+
+    for (MachAnyId const mach : vehicle.m_machines.ids.bitview().zeros())
+    {
+        MachTypeId const  type  = vehicle.m_machines.machTypes[mach];
+        MachLocalId const local = vehicle.m_machines.machToLocal[mach];
+
+        EXPECT_EQ(loaded.m_machines.machTypes[mach],   type);
+        EXPECT_EQ(loaded.m_machines.machToLocal[mach], local);
+        EXPECT_EQ(loaded.m_machToPart[mach],           vehicle.m_machToPart[mach]);
+        EXPECT_EQ(loaded.m_machines.perType[type].localToAny[local], mach);
+    }
+
+    // Nodes
+
+    PerNodeType const &loadedNodes  = loaded.m_nodePerType[gc_ntSigFloat];
+    PerNodeType const &nodes        = vehicle.m_nodePerType[gc_ntSigFloat];
+
+    expect_same_ids(loadedNodes.nodeIds, nodes.nodeIds);
+
+    auto const &loadedValues    = entt::any_cast< SignalValues_t<float> const& >(loadedNodes.m_nodeValues);
+    auto const &values          = entt::any_cast< SignalValues_t<float> const& >(nodes.m_nodeValues);
+
+    for (NodeId const node : nodes.nodeIds.bitview().zeros())
+    {
+        EXPECT_EQ(loadedValues[node], values[node]);
+        EXPECT_EQ(loadedNodes.m_nodeConnectCount[node], nodes.m_nodeConnectCount[node]);
+
+        auto const loadedJuncs = loadedNodes.nodeToMach[node];
+        auto const juncs       = nodes.nodeToMach[node];
+        ASSERT_EQ(loadedJuncs.size(), juncs.size());
+        for (std::size_t i = 0; i < juncs.size(); ++i)
+        {
+            EXPECT_EQ(loadedJuncs[i].type,   juncs[i].type);
+            EXPECT_EQ(loadedJuncs[i].local,  juncs[i].local);
+            EXPECT_EQ(loadedJuncs[i].custom, juncs[i].custom);
+        }
+    }
+
+    for (MachAnyId const mach : vehicle.m_machines.ids.bitview().zeros())
+    {
+        auto const loadedPorts = loadedNodes.machToNode[mach];
+        auto const ports       = nodes.machToNode[mach];
+        EXPECT_TRUE(std::equal(loadedPorts.begin(), loadedPorts.end(), ports.begin(), ports.end()));
+    }
+
+    // Template is rebuilt from the loaded data
+
+    VehicleTemplate const &loadedTmpl   = loaded.m_template;
+    VehicleTemplate const &tmpl         = vehicle.m_template;
+
+    EXPECT_EQ(loadedTmpl.parts,         tmpl.parts);
+    EXPECT_EQ(loadedTmpl.partMachs,     tmpl.partMachs);
+    EXPECT_EQ(loadedTmpl.welds,         tmpl.welds);
+    EXPECT_EQ(loadedTmpl.weldParts,     tmpl.weldParts);
+    EXPECT_EQ(loadedTmpl.machs,         tmpl.machs);
+    EXPECT_EQ(loadedTmpl.machTypes,     tmpl.machTypes);
+    EXPECT_EQ(loadedTmpl.machParts,     tmpl.machParts);
+    EXPECT_EQ(loadedTmpl.nodePerType[gc_ntSigFloat].nodeJuncMach, tmpl.nodePerType[gc_ntSigFloat].nodeJuncMach);
+    EXPECT_EQ(loadedTmpl.nodePerType[gc_ntSigFloat].machPortNode, tmpl.nodePerType[gc_ntSigFloat].machPortNode);
+
+    std::filesystem::remove(path);
+}
+
+// Truncated files and files with IDs or offsets out of range must be rejected by map
+TEST(VehicleFile, RejectCorrupt)
+{
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<Prefabs>(gc_importer);
+
+    VehicleData const vehicle = make_test_vehicle(resources);
+
+    std::string const path = (std::filesystem::temp_directory_path() / "osp_test_corrupt.ospveh").string();
+    ASSERT_TRUE(SysVehicleFile::write(vehicle, resources, path));
+
+    std::vector<char> original;
+    {
+        std::ifstream in{path, std::ios::binary};
+        original.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    auto const section_offset = [&original] (uint32_t const index)
+    {
+        FileSection section;
+        std::memcpy(&section, original.data() + sizeof(VehicleFileHeader) + index * sizeof(FileSection), sizeof(FileSection));
+        return std::size_t(section.offset);
+    };
+
+    // Overwrite element i of a section with value, then check if the result still maps
+    auto const maps_with = [&] (uint32_t const index, std::size_t const i, auto const value)
+    {
+        std::vector<char> bytes = original;
+        std::memcpy(bytes.data() + section_offset(index) + i * sizeof(value), &value, sizeof(value));
+
+        std::ofstream{path, std::ios::binary | std::ios::trunc}.write(bytes.data(), std::streamsize(bytes.size()));
+        return VehicleFileView::map(path).has_value();
+    };
+
+    auto const sec  = [] (EVehicleSection const section) { return vehicle_file_section(section); };
+    auto const nsec = [] (ENodeSection const section) { return vehicle_file_section(gc_ntSigFloat, section); };
+
+    // Unmodified copy is accepted
+    EXPECT_TRUE(maps_with(sec(EVehicleSection::PartIds), 0, uint64_t(vehicle.m_partIds.capacity())));
+
+    // Registry capacity larger than its bitset
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::PartIds), 0, uint64_t(100000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::MachIds), 0, ~uint64_t(0)));
+
+    // IDs out of range
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::PartToWeld),  0, WeldId(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::WeldToPart),  0, PartId(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::MachTypes),   0, MachTypeId(MachTypeReg_t::size())));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::MachToLocal), 0, MachLocalId(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::MachToPart),  0, PartId(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::LocalToAny),  0, MachAnyId(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::PartPrefab),  0, uint32_t(5)));
+    EXPECT_FALSE(maps_with(nsec(ENodeSection::NodeToMach),    0, Junction{ .local = 1000, .type = gc_mtTestEngine }));
+    EXPECT_FALSE(maps_with(nsec(ENodeSection::MachToNode),    0, NodeId(1000)));
+    EXPECT_FALSE(maps_with(nsec(ENodeSection::NodeValueType), 0, uint32_t(1000)));
+
+    // CSR offsets past the end of their data
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::WeldToPartOffsets), vehicle.m_weldIds.capacity(), uint32_t(1000)));
+    EXPECT_FALSE(maps_with(sec(EVehicleSection::PartToMachOffsets), 0, uint32_t(1)));
+
+    // Truncated file
+    {
+        std::ofstream{path, std::ios::binary | std::ios::trunc}.write(original.data(), std::streamsize(original.size() / 2));
+        EXPECT_FALSE(VehicleFileView::map(path).has_value());
+    }
+
+    std::filesystem::remove(path);
+}
+
+/**
+ * @brief Command module layout like testapp's gc_pbvSimpleCommandServiceModule: a capsule with a
+ *        user controller, two engines, and an RCS nozzle, using adera's Machine types and Prefabs
+ */
+VehicleData make_command_module(Resources &rResources)
+{
+    namespace ports_magicrocket = adera::ports_magicrocket;
+    namespace ports_rcsdriver   = adera::ports_rcsdriver;
+    namespace ports_userctrl    = adera::ports_userctrl;
+
+    VehicleBuilder vbuilder{&rResources};
+
+    auto const [ capsule, fueltank, engineA, engineB, nozzle ] = vbuilder.create_parts<5>();
+    vbuilder.set_prefabs({
+        { capsule,  "phCapsule" },
+        { fueltank, "phFuselage" },
+        { engineA,  "phEngine" },
+        { engineB,  "phEngine" },
+        { nozzle,   "phLinRCS" }
+    });
+
+    auto const [ pitch, yaw, roll, throttle, thrustMul, rcsOut ] = vbuilder.create_nodes<6>(gc_ntSigFloat);
+    vbuilder.node_values< SignalValues_t<float> >(gc_ntSigFloat)[thrustMul] = 50000.0f;
+
+    vbuilder.create_machine(capsule, gc_mtUserCtrl, {
+        { ports_userctrl::gc_throttleOut,   throttle },
+        { ports_userctrl::gc_pitchOut,      pitch    },
+        { ports_userctrl::gc_yawOut,        yaw      },
+        { ports_userctrl::gc_rollOut,       roll     }
+    } );
+
+    for (PartId const engine : {engineA, engineB})
+    {
+        vbuilder.create_machine(engine, gc_mtMagicRocket, {
+            { ports_magicrocket::gc_throttleIn,     throttle  },
+            { ports_magicrocket::gc_multiplierIn,   thrustMul }
+        } );
+    }
+
+    vbuilder.create_machine(nozzle, gc_mtRcsDriver, {
+        { ports_rcsdriver::gc_cmdAngXIn,    pitch  },
+        { ports_rcsdriver::gc_cmdAngYIn,    yaw    },
+        { ports_rcsdriver::gc_cmdAngZIn,    roll   },
+        { ports_rcsdriver::gc_throttleOut,  rcsOut }
+    } );
+    vbuilder.create_machine(nozzle, gc_mtMagicRocket, {
+        { ports_magicrocket::gc_throttleIn,     rcsOut    },
+        { ports_magicrocket::gc_multiplierIn,   thrustMul }
+    } );
+
+    VehicleBuilder::WeldVec_t toWeld;
+    toWeld.push_back({ capsule,  Matrix4::translation({ 0.0f, 0.0f,  3.0f}) });
+    toWeld.push_back({ fueltank, Matrix4{} });
+    toWeld.push_back({ engineA,  Matrix4::translation({ 0.7f, 0.0f, -2.9f}) });
+    toWeld.push_back({ engineB,  Matrix4::translation({-0.7f, 0.0f, -2.9f}) });
+    toWeld.push_back({ nozzle,   Matrix4::translation({ 1.1f, 0.0f, -2.0f}) });
+    vbuilder.weld(toWeld);
+
+    return vbuilder.finalize_release();
+}
+
+void release_prefab_owners(VehicleData &rVehicle, Resources &rResources)
+{
+    for (PrefabPair &rPrefabPair : rVehicle.m_partPrefabs)
+    {
+        rResources.owner_destroy(gc_importer, std::move(rPrefabPair.m_importer));
+    }
+}
+
+// Round trip a vehicle with Prefabs from a loaded importer, and several Machine types per Part.
+// The loaded copy must spawn the same as the original.
+TEST(VehicleFile, RoundTripCommandModule)
+{
+    Resources resources;
+    resources.resize_types(ResTypeIdReg_t::size());
+    resources.data_register<Prefabs>(gc_importer);
+
+    // Stand-in for a loaded glTF importer, only the Prefab names are needed
+    PkgId const pkg = resources.pkg_create();
+    ResId const importer = resources.create(gc_importer, pkg, SharedString::create_reference("parts"));
+    resources.data_add<Prefabs>(gc_importer, importer).m_prefabNames
+            = { "phCapsule", "phEngine", "phFuselage", "phLinRCS", "phUnused" };
+
+    VehicleData vehicle = make_command_module(resources);
+
+    std::string const path = (std::filesystem::temp_directory_path() / "osp_test_command_module.ospveh").string();
+    ASSERT_TRUE(SysVehicleFile::write(vehicle, resources, path));
+
+    std::optional<VehicleFileView> const file = VehicleFileView::map(path);
+    ASSERT_TRUE(file.has_value());
+
+    VehicleData loaded = SysVehicleFile::load(*file, resources);
+
+    // Prefabs are found again by name
+    for (PartId const part : vehicle.m_partIds.bitview().zeros())
+    {
+        PrefabPair const &prefab       = vehicle.m_partPrefabs[part];
+        PrefabPair const &loadedPrefab = loaded.m_partPrefabs[part];
+        ASSERT_TRUE(prefab.m_importer.has_value());
+        ASSERT_TRUE(loadedPrefab.m_importer.has_value());
+        EXPECT_EQ(loadedPrefab.m_importer.value(), importer);
+        EXPECT_EQ(loadedPrefab.m_prefabId,         prefab.m_prefabId);
+        EXPECT_EQ(loaded.m_partTransformWeld[part], vehicle.m_partTransformWeld[part]);
+    }
+
+    // Spawn both and compare what ends up in the scene
+
+    ACtxParts scnParts;
+    scnParts.machines.perType.resize(MachTypeReg_t::size());
+    scnParts.nodePerType.resize(NodeTypeReg_t::size());
+
+    ACtxVehicleSpawn    vehicleSpawn;
+    ACtxVehicleSpawnVB  vehicleSpawnVB;
+    vehicleSpawn.spawnRequest.resize(2);
+    vehicleSpawnVB.dataVB.resize(2);
+    vehicleSpawnVB.dataVB[SpVehicleId{0}] = &vehicle;
+    vehicleSpawnVB.dataVB[SpVehicleId{1}] = &loaded;
+    spawn(vehicleSpawn, vehicleSpawnVB, scnParts);
+
+    std::size_t const machCount = vehicle.m_machines.ids.size();
+    ASSERT_EQ(scnParts.machines.ids.size(), 2 * machCount);
+
+    Nodes const &scnNodes = scnParts.nodePerType[gc_ntSigFloat];
+    for (uint32_t i = 0; i < machCount; ++i)
+    {
+        MachAnyId const a = vehicleSpawn.spawnedMachs[SpMachAnyId{i}];
+        MachAnyId const b = vehicleSpawn.spawnedMachs[SpMachAnyId{uint32_t(machCount) + i}];
+
+        EXPECT_EQ(scnParts.machines.machTypes[a], scnParts.machines.machTypes[b]);
+        EXPECT_EQ(scnNodes.machToNode[a].size(), scnNodes.machToNode[b].size());
+
+        // Same port layout, each connected node has the same number of junctions
+        auto const portsA = scnNodes.machToNode[a];
+        auto const portsB = scnNodes.machToNode[b];
+        for (std::size_t port = 0; port < std::min(portsA.size(), portsB.size()); ++port)
+        {
+            ASSERT_EQ(portsA[port] == lgrn::id_null<NodeId>(), portsB[port] == lgrn::id_null<NodeId>());
+            if (portsA[port] != lgrn::id_null<NodeId>())
+            {
+                EXPECT_EQ(scnNodes.nodeToMach[portsA[port]].size(), scnNodes.nodeToMach[portsB[port]].size());
+            }
+        }
+    }
+
+    auto const &values       = entt::any_cast< SignalValues_t<float> const& >(vehicle.m_nodePerType[gc_ntSigFloat].m_nodeValues);
+    auto const &loadedValues = entt::any_cast< SignalValues_t<float> const& >(loaded.m_nodePerType[gc_ntSigFloat].m_nodeValues);
+    EXPECT_EQ(loadedValues, values);
+
+    release_prefab_owners(vehicle, resources);
+    release_prefab_owners(loaded,  resources);
+
+    std::filesystem::remove(path);
+}
+
+/**
+ * @brief Add a weld of partCount parts, each with its own ActiveEnt under the weld's root ActiveEnt
+ */
+WeldId add_test_weld(ACtxParts& rScnParts, ACtxBasic& rBasic, std::size_t const partCount, Matrix4 const& rootTf)
+{
+    std::vector<PartId> parts(partCount);
+    rScnParts.partIds.create(parts.begin(), parts.end());
+    WeldId const weld = rScnParts.weldIds.create();
+
+    std::size_t const maxParts = rScnParts.partIds.capacity();
+    std::size_t const maxWelds = rScnParts.weldIds.capacity();
+    rScnParts.partToWeld    .resize(maxParts, lgrn::id_null<WeldId>());
+    rScnParts.partToActive  .resize(maxParts);
+    rScnParts.weldToActive  .resize(maxWelds, lgrn::id_null<ActiveEnt>());
+    rScnParts.weldToParts.ids_reserve(maxWelds);
+    rScnParts.weldToParts.data_reserve(rScnParts.weldToParts.data_size() + partCount);
+
+    PartId *pParts = rScnParts.weldToParts.emplace(weld, partCount);
+    std::copy(parts.begin(), parts.end(), pParts);
+
+    ActiveEnt const root = rBasic.m_activeIds.create();
+    std::vector<ActiveEnt> partEnts(partCount);
+    rBasic.m_activeIds.create(partEnts.begin(), partEnts.end());
+    rBasic.m_scnGraph.resize(rBasic.m_activeIds.capacity());
+
+    rBasic.m_transform.emplace(root, ACompTransform{rootTf});
+    rScnParts.weldToActive[weld] = root;
+
+    SubtreeBuilder bldRoot = SysSceneGraph::add_descendants(rBasic.m_scnGraph, uint32_t(partCount + 1));
+    SubtreeBuilder bldWeld = bldRoot.add_child(root, uint32_t(partCount));
+
+    for (std::size_t i = 0; i < partCount; ++i)
+    {
+        rScnParts.partToWeld[parts[i]]      = weld;
+        rScnParts.partToActive[parts[i]]    = SysActiveEnt::active_ent_ref(rBasic, partEnts[i]);
+        rBasic.m_transform.emplace(partEnts[i], ACompTransform{Matrix4::translation({float(i), 0.0f, 0.0f})});
+        bldWeld.add_child(partEnts[i]);
+    }
+
+    return weld;
+}
+
+std::vector<ActiveEnt> children_of(ACtxSceneGraph const& scnGraph, ActiveEnt const parent)
+{
+    std::vector<ActiveEnt> out;
+    for (ActiveEnt const child : SysSceneGraph::children(scnGraph, parent))
+    {
+        out.push_back(child);
+    }
+    return out;
+}
+
+void expect_parts_consistent(ACtxParts const& scnParts)
+{
+    std::size_t partCount = 0;
+    for (WeldId const weld : scnParts.weldIds.bitview().zeros())
+    {
+        for (PartId const part : scnParts.weldToParts[weld])
+        {
+            EXPECT_EQ(scnParts.partToWeld[part], weld);
+            ++partCount;
+        }
+    }
+    EXPECT_EQ(partCount, scnParts.partIds.size());
+}
+
+void expect_scene_graph_consistent(ACtxSceneGraph const& scnGraph)
+{
+    for (TreePos_t pos = 1; pos < scnGraph.m_treeToEnt.size(); ++pos)
+    {
+        EXPECT_EQ(scnGraph.m_entToTreePos[scnGraph.m_treeToEnt[pos]], pos);
+    }
+}
+
+// Split one part off a two-part weld, then move it under a new root entity
+TEST(SysParts, SplitTwoPartWeld)
+{
+    ACtxParts scnParts;
+    ACtxBasic basic;
+
+    Matrix4 const rootTf = Matrix4::translation({1.0f, 2.0f, 3.0f}) * Matrix4::scaling({2.0f, 2.0f, 2.0f});
+
+    WeldId const oldWeld = add_test_weld(scnParts, basic, 2, rootTf);
+    PartId const partA   = scnParts.weldToParts[oldWeld][0];
+    PartId const partB   = scnParts.weldToParts[oldWeld][1];
+    ActiveEnt const oldRoot = scnParts.weldToActive[oldWeld];
+    ActiveEnt const entA    = scnParts.partToActive[partA].ent;
+    ActiveEnt const entB    = scnParts.partToActive[partB].ent;
+    Matrix4 const   entBTf  = basic.m_transform.get(entB).m_transform;
+
+    std::array<PartId, 1> const toSplit{partB};
+    WeldId const newWeld = SysParts::split_weld(scnParts, arrayView(toSplit));
+
+    ASSERT_NE(newWeld, lgrn::id_null<WeldId>());
+    EXPECT_NE(newWeld, oldWeld);
+    EXPECT_EQ(scnParts.weldIds.size(), 2u);
+
+    expect_parts_consistent(scnParts);
+    ASSERT_EQ(scnParts.weldToParts[oldWeld].size(), 1u);
+    ASSERT_EQ(scnParts.weldToParts[newWeld].size(), 1u);
+    EXPECT_EQ(scnParts.weldToParts[oldWeld][0], partA);
+    EXPECT_EQ(scnParts.weldToParts[newWeld][0], partB);
+
+    auto const &dirty = scnParts.weldDirty;
+    EXPECT_NE(std::find(dirty.begin(), dirty.end(), oldWeld), dirty.end());
+    EXPECT_NE(std::find(dirty.begin(), dirty.end(), newWeld), dirty.end());
+
+    ActiveEnt const newRoot = basic.m_activeIds.create();
+    basic.m_scnGraph.resize(basic.m_activeIds.capacity());
+
+    SysParts::move_weld_to_new_root(scnParts, basic, newWeld, oldRoot, newRoot);
+
+    EXPECT_EQ(scnParts.weldToActive[oldWeld], oldRoot);
+    EXPECT_EQ(scnParts.weldToActive[newWeld], newRoot);
+
+    // New root takes the old root's transform, part entities keep theirs relative to it
+    EXPECT_EQ(basic.m_transform.get(newRoot).m_transform, rootTf);
+    EXPECT_EQ(basic.m_transform.get(entB).m_transform, entBTf);
+
+    EXPECT_EQ(basic.m_scnGraph.m_entParent[newRoot], lgrn::id_null<ActiveEnt>());
+    EXPECT_EQ(basic.m_scnGraph.m_entParent[entA], oldRoot);
+    EXPECT_EQ(basic.m_scnGraph.m_entParent[entB], newRoot);
+    EXPECT_EQ(children_of(basic.m_scnGraph, oldRoot), std::vector<ActiveEnt>{entA});
+    EXPECT_EQ(children_of(basic.m_scnGraph, newRoot), std::vector<ActiveEnt>{entB});
+    expect_scene_graph_consistent(basic.m_scnGraph);
+}
+
+// Splits that would leave a weld empty change nothing
+TEST(SysParts, UnsplittableWeld)
+{
+    ACtxParts scnParts;
+    ACtxBasic basic;
+
+    WeldId const single = add_test_weld(scnParts, basic, 1, Matrix4{});
+    WeldId const pair   = add_test_weld(scnParts, basic, 2, Matrix4{});
+
+    std::vector<PartId> const singleParts(scnParts.weldToParts[single].begin(), scnParts.weldToParts[single].end());
+    std::vector<PartId> const pairParts  (scnParts.weldToParts[pair].begin(),   scnParts.weldToParts[pair].end());
+
+    EXPECT_EQ(SysParts::split_weld(scnParts, arrayView(singleParts)),       lgrn::id_null<WeldId>());
+    EXPECT_EQ(SysParts::split_weld(scnParts, arrayView(pairParts)),         lgrn::id_null<WeldId>());
+    EXPECT_EQ(SysParts::split_weld(scnParts, ArrayView<PartId const>{}),    lgrn::id_null<WeldId>());
+
+    EXPECT_EQ(scnParts.weldIds.size(), 2u);
+    EXPECT_TRUE(scnParts.weldDirty.empty());
+    expect_parts_consistent(scnParts);
+
+    auto const singleNow = scnParts.weldToParts[single];
+    auto const pairNow   = scnParts.weldToParts[pair];
+    EXPECT_TRUE(std::equal(singleNow.begin(), singleNow.end(), singleParts.begin(), singleParts.end()));
+    EXPECT_TRUE(std::equal(pairNow.begin(),   pairNow.end(),   pairParts.begin(),   pairParts.end()));
+}
+
+VehicleBuildJob make_two_part_job(float const x)
+{
+    return {
+        .func = [] (VehicleBuilder& rBuilder, entt::any const&)
+        {
+            (void) rBuilder.create_parts<2>();
+        },
+        .spawn = { .position = {x, 0.0f, 0.0f} }
+    };
+}
+
+/**
+ * @brief Poll until count results are received, or give up after a few seconds
+ */
+std::vector<VehicleBuildResult> poll_results(VehicleBuildService& rService, std::size_t const count)
+{
+    std::vector<VehicleBuildResult> out;
+    auto const timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (out.size() < count && std::chrono::steady_clock::now() < timeout)
+    {
+        if (std::optional<VehicleBuildResult> result = rService.poll())
+        {
+            out.push_back(std::move(*result));
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    return out;
+}
+
+// With a single worker, vehicles come back in the order they were submitted
+TEST(VehicleBuildService, SingleWorkerOrder)
+{
+    constexpr std::size_t sc_count = 100;
+
+    VehicleBuildService service{1, 8};
+
+    std::size_t submitted = 0;
+    std::vector<VehicleBuildResult> results;
+    while (results.size() < sc_count)
+    {
+        while (submitted < sc_count && service.submit(make_two_part_job(float(submitted))))
+        {
+            ++submitted;
+        }
+        if (std::optional<VehicleBuildResult> result = service.poll())
+        {
+            results.push_back(std::move(*result));
+        }
+    }
+
+    EXPECT_EQ(service.in_flight(), 0u);
+    for (std::size_t i = 0; i < sc_count; ++i)
+    {
+        EXPECT_EQ(results[i].spawn.position.x(), float(i));
+        ASSERT_NE(results[i].pData, nullptr);
+        EXPECT_EQ(results[i].pData->m_partIds.size(), 2u);
+    }
+}
+
+std::atomic<bool> g_releaseJobs{false};
+
+// Jobs are rejected once the worker is busy and its queue is full
+TEST(VehicleBuildService, FullQueue)
+{
+    g_releaseJobs.store(false);
+
+    VehicleBuildService service{1, 2};
+
+    // Let blocked jobs finish even if an assertion returns early, or the destructor would wait
+    // on the worker forever
+    struct Release
+    {
+        ~Release()
+        {
+            g_releaseJobs.store(true);
+            g_releaseJobs.notify_all();
+        }
+    } release;
+
+    auto const blocking_job = [] (int const id)
+    {
+        return VehicleBuildJob{
+            .func = [] (VehicleBuilder&, entt::any const&)
+            {
+                g_releaseJobs.wait(false);
+            },
+            .description = id
+        };
+    };
+
+    // Worker holds at most one job while blocked, plus 2 in its queue
+    std::size_t accepted = 0;
+    while (service.submit(blocking_job(int(accepted))))
+    {
+        ++accepted;
+        ASSERT_LE(accepted, 3u);
+    }
+    EXPECT_GE(accepted, 2u);
+    EXPECT_EQ(service.in_flight(), accepted);
+
+    // Rejected job is left untouched
+    VehicleBuildJob rejected = blocking_job(42);
+    EXPECT_FALSE(service.submit(std::move(rejected)));
+    ASSERT_NE(entt::any_cast<int>(&rejected.description), nullptr);
+    EXPECT_EQ(entt::any_cast<int>(rejected.description), 42);
+
+    g_releaseJobs.store(true);
+    g_releaseJobs.notify_all();
+
+    EXPECT_EQ(poll_results(service, accepted).size(), accepted);
+    EXPECT_EQ(service.in_flight(), 0u);
+}
+
+// Destroying the service with jobs queued and results unclaimed stops the workers and frees both
+TEST(VehicleBuildService, DestroyInFlight)
+{
+    auto const token = std::make_shared<int>(0);
+    {
+        VehicleBuildService service{2, 4};
+        for (int i = 0; i < 8; ++i)
+        {
+            VehicleBuildJob job = make_two_part_job(float(i));
+            job.description = token;
+            EXPECT_TRUE(service.submit(std::move(job)));
+        }
+        EXPECT_EQ(service.in_flight(), 8u);
+    }
+    EXPECT_EQ(token.use_count(), 1);
+}